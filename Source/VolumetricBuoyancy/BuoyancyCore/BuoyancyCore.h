@@ -0,0 +1,1327 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "BuoyancyCoreMath.h"
+
+#include <algorithm>
+
+/* Profiling hook, timed scope around stage of solve: PlaneFit, WaveSampling, Classify or Clip.
+ * Module defines BUOYANCY_CORE_ENGINE and the hook comes from buoyancy stats wherever this header is included,
+ * outside of engine (benchmark) it is empty.
+ */
+#if BUOYANCY_CORE_ENGINE
+#include "Misc/BuoyancyStats.h"
+#ifndef BUOYANCY_CORE_SCOPE
+#error "Misc/BuoyancyStats.h has to define BUOYANCY_CORE_SCOPE"
+#endif
+#elif !defined(BUOYANCY_CORE_SCOPE)
+#define BUOYANCY_CORE_SCOPE(Stage)
+#endif
+
+/* Loop hint: iterations of next loop don't depend on each other through memory. Loops over many structure-of-arrays
+ * buffers need it, compilers give up on checking that many buffers for overlap and leave them scalar.
+ */
+#if defined(__clang__)
+#define BUOYANCY_CORE_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define BUOYANCY_CORE_IVDEP _Pragma("GCC ivdep")
+#elif defined(_MSC_VER)
+#define BUOYANCY_CORE_IVDEP __pragma(loop(ivdep))
+#else
+#define BUOYANCY_CORE_IVDEP
+#endif
+
+/* Engine independent buoyancy math: volume, clipping, plane fit and forces.
+ * Works on plain vectors and index buffers and never allocates, all buffers are owned by caller.
+ * Used by UBuoyancyHelper in game and by BuoyancyBench outside of engine.
+ */
+namespace BuoyancyCore
+{
+	/* Read only view of triangle mesh, vertices packed as structure of arrays */
+	struct FMeshView
+	{
+		const float* VertexX;
+		const float* VertexY;
+		const float* VertexZ;
+
+		/* 3 indices per triangle */
+		const int32_t* Indices;
+
+		int32_t NumVertices;
+		int32_t NumTriangles;
+
+		FMeshView()
+			: VertexX(nullptr), VertexY(nullptr), VertexZ(nullptr), Indices(nullptr), NumVertices(0), NumTriangles(0)
+		{
+		}
+
+		FVec3 GetVertex(int32_t Index) const
+		{
+			return FVec3(VertexX[Index], VertexY[Index], VertexZ[Index]);
+		}
+	};
+
+	/* Triangles using each vertex, triangles of vertex i are Triangles[Start[i]] .. Triangles[Start[i + 1] - 1] */
+	struct FVertexTriangles
+	{
+		/* NumVertices + 1 offsets */
+		const int32_t* Start;
+
+		/* 3 * NumTriangles triangle indices */
+		const int32_t* Triangles;
+
+		FVertexTriangles()
+			: Start(nullptr), Triangles(nullptr)
+		{
+		}
+	};
+
+	/* State of ComputeSubmergedVolumeIncremental kept between updates of single body.
+	 * Buffers are owned by caller and may be rebound between updates as long as their contents are kept.
+	 */
+	struct FIncrementalVolume
+	{
+		/* Triangles of every vertex of mesh, see BuildVertexTriangles */
+		FVertexTriangles Adjacency;
+
+		/* Mesh.NumVertices signs of depths in last update */
+		int8_t* VertexSigns;
+
+		/* Mesh.NumTriangles classes of triangles in last update */
+		uint8_t* TriangleClasses;
+
+		/* Mesh.NumTriangles ints each: list of crossing triangles, slot of every triangle in it and queue of triangles to reclassify */
+		int32_t* CrossingTriangles;
+		int32_t* CrossingSlots;
+		int32_t* Queue;
+
+		int32_t NumCrossing;
+
+		/* Triangles reclassified in last update, all of them when state was rebuilt */
+		int32_t NumReclassified;
+
+		/* False rebuilds state from scratch in next update */
+		bool bValid;
+
+		/* Sums over fully submerged triangles of terms of tetrahedron with apex P, see AddWetTriangle.
+		 * Double precision because triangles are added and removed for the whole life of body.
+		 */
+		double SumNormal[3];
+		double SumOffset;
+		double SumMoment[3][3];
+		double SumOffsetCorners[3];
+
+		FIncrementalVolume()
+			: VertexSigns(nullptr), TriangleClasses(nullptr), CrossingTriangles(nullptr), CrossingSlots(nullptr), Queue(nullptr)
+			, NumCrossing(0), NumReclassified(0), bValid(false)
+		{
+		}
+	};
+
+	/* Plane approximating water surface around body */
+	struct FWaterPlane
+	{
+		FVec3 Normal;
+		FVec3 Location;
+
+		FWaterPlane()
+			: Normal(0.0f, 0.0f, 1.0f)
+		{
+		}
+	};
+
+	/* State of simulated body in world space */
+	struct FBodyState
+	{
+		/* Location and rotation of mesh origin */
+		FVec3 Location;
+		FQuat Rotation;
+
+		FVec3 CenterOfMass;
+		FVec3 LinearVelocity;
+
+		/* Angular velocity in degrees */
+		FVec3 AngularVelocity;
+
+		float Mass;
+
+		FBodyState()
+			: Mass(0.0f)
+		{
+		}
+	};
+
+	/* Constant properties of buoyant body */
+	struct FBodyParams
+	{
+		/* Total volume of mesh */
+		float BodyVolume;
+
+		/* Density of body, 1000.0f is density of water */
+		float DensityOfBody;
+
+		/* Length of body along X axis */
+		float BodyLengthX;
+
+		/* Drag mass per body mass and submerged volume, DensityOfBody * 1e-7 / BodyVolume */
+		float DragMassPerVolume;
+
+		/* BodyLengthX squared, lever of angular drag */
+		float LengthSquared;
+
+		FBodyParams()
+			: BodyVolume(0.0f), DensityOfBody(500.0f), BodyLengthX(0.0f), DragMassPerVolume(0.0f), LengthSquared(0.0f)
+		{
+		}
+
+		/* Body with drag constants computed once, ComputeForces only scales them by mass and submerged volume */
+		FBodyParams(float InBodyVolume, float InDensityOfBody, float InBodyLengthX)
+			: BodyVolume(InBodyVolume), DensityOfBody(InDensityOfBody), BodyLengthX(InBodyLengthX)
+		{
+			DragMassPerVolume = InBodyVolume > 0.0f ? (InDensityOfBody * 0.0000001f) / InBodyVolume : 0.0f;
+			LengthSquared = InBodyLengthX * InBodyLengthX;
+		}
+	};
+
+	/* Properties of water */
+	struct FWaterParams
+	{
+		/* 1g/cm^3 -> 1000kg/m^3 */
+		float Density;
+		float LinearDrag;
+		float AngularDrag;
+
+		/* Velocity of water around body: current, flow field and orbital velocity of waves */
+		FVec3 Velocity;
+		float GravityZ;
+
+		FWaterParams()
+			: Density(0.0001f), LinearDrag(50000.0f), AngularDrag(500.0f), GravityZ(-980.0f)
+		{
+		}
+	};
+
+	/* Forces to apply to body */
+	struct FForces
+	{
+		bool bHasForce;
+		FVec3 Force;
+
+		/* World location Force is applied at */
+		FVec3 ForceLocation;
+		FVec3 Torque;
+
+		FForces()
+			: bHasForce(false)
+		{
+		}
+	};
+
+	inline float ComputeTetrahedronVolume(FVec3& Center, const FVec3& Point, const FVec3& Vertex1, const FVec3& Vertex2, const FVec3& Vertex3)
+	{
+		const FVec3 A = Vertex2 - Vertex1;
+		const FVec3 B = Vertex3 - Vertex1;
+		const FVec3 R = Point - Vertex1;
+
+		const float Volume = (1.0f / 6.0f) * FVec3::Dot(FVec3::Cross(B, A), R);
+
+		Center += (0.25f * Volume) * (Vertex1 + Vertex2 + Vertex3 + Point);
+
+		return Volume;
+	}
+
+	/* Volume below water of triangle crossing the surface, Depth1 and Depth2 must have different signs */
+	inline float ClipTriangle(FVec3& Center, const FVec3& Point, const FVec3& Vertex1, const FVec3& Vertex2, const FVec3& Vertex3, float Depth1, float Depth2, float Depth3)
+	{
+		float Volume = 0.0f;
+		const FVec3 Vc1 = Vertex1 + (Depth1 / (Depth1 - Depth2)) * (Vertex2 - Vertex1);
+
+		if (Depth1 < 0.0f)
+		{
+			if (Depth3 < 0.0f)
+			{
+				const FVec3 Vc2 = Vertex2 + (Depth2 / (Depth2 - Depth3)) * (Vertex3 - Vertex2);
+
+				Volume += ComputeTetrahedronVolume(Center, Point, Vc1, Vc2, Vertex1);
+				Volume += ComputeTetrahedronVolume(Center, Point, Vc2, Vertex3, Vertex1);
+			}
+			else
+			{
+				const FVec3 Vc2 = Vertex1 + (Depth1 / (Depth1 - Depth3)) * (Vertex3 - Vertex1);
+
+				Volume += ComputeTetrahedronVolume(Center, Point, Vc1, Vc2, Vertex1);
+			}
+		}
+		else
+		{
+			if (Depth3 < 0.0f)
+			{
+				const FVec3 Vc2 = Vertex1 + (Depth1 / (Depth1 - Depth3)) * (Vertex3 - Vertex1);
+
+				Volume += ComputeTetrahedronVolume(Center, Point, Vc1, Vertex2, Vertex3);
+				Volume += ComputeTetrahedronVolume(Center, Point, Vc1, Vertex3, Vc2);
+			}
+			else
+			{
+				const FVec3 Vc2 = Vertex2 + (Depth2 / (Depth2 - Depth3)) * (Vertex3 - Vertex2);
+
+				Volume += ComputeTetrahedronVolume(Center, Point, Vc1, Vertex2, Vc2);
+			}
+		}
+
+		return Volume;
+	}
+
+	/* Total volume of closed mesh
+	 *	@param Mesh						Mesh for calculation
+	 *	@param Centroid		(out)		Center of volume in mesh space
+	 */
+	inline float ComputeVolume(const FMeshView& Mesh, FVec3& Centroid)
+	{
+		float Volume = 0.0f;
+		FVec3 Center;
+
+		for (int32_t TriIndex = 0; TriIndex < Mesh.NumTriangles; ++TriIndex)
+		{
+			const FVec3 V0 = Mesh.GetVertex(Mesh.Indices[(TriIndex * 3) + 0]);
+			const FVec3 V1 = Mesh.GetVertex(Mesh.Indices[(TriIndex * 3) + 1]);
+			const FVec3 V2 = Mesh.GetVertex(Mesh.Indices[(TriIndex * 3) + 2]);
+
+			Volume += ComputeTetrahedronVolume(Center, FVec3(), V0, V1, V2);
+		}
+
+		Centroid = (Volume != 0.0f) ? Center * (1.0f / Volume) : FVec3();
+
+		return Volume;
+	}
+
+	/* Volume of mesh below water surface given by signed depth of every vertex, everything in mesh space.
+	 * Triangles are clipped by interpolating depths along edges, so surface doesn't have to be planar.
+	 *	@param Mesh						Mesh for calculation
+	 *	@param Depths					Mesh.NumVertices signed distances to surface, negative is under water
+	 *	@param Up						Direction out of water in mesh space, used to find point on surface
+	 *	@param Centroid		(out)		Center of submerged volume in mesh space
+	 */
+	inline float ComputeSubmergedVolumeFromDepths(const FMeshView& Mesh, const float* Depths, const FVec3& Up, FVec3& Centroid)
+	{
+		BUOYANCY_CORE_SCOPE(Clip);
+
+		const float TINY_DEPTH = -1e-6f;
+
+		const float* VertexX = Mesh.VertexX;
+		const float* VertexY = Mesh.VertexY;
+		const float* VertexZ = Mesh.VertexZ;
+
+		int32_t SampleVertex = -1;
+
+		for (int32_t i = 0; i < Mesh.NumVertices; ++i)
+		{
+			if (Depths[i] < TINY_DEPTH)
+			{
+				SampleVertex = i;
+				break;
+			}
+		}
+
+		Centroid = FVec3();
+
+		/* Return if no vertices are submerged */
+		if (SampleVertex < 0)
+		{
+			return 0.0f;
+		}
+
+		/* Find a point on the water surface. */
+		const FVec3 Point = Mesh.GetVertex(SampleVertex) - Depths[SampleVertex] * Up;
+
+		float Volume = 0.0f;
+		const int32_t* Indices = Mesh.Indices;
+
+		for (int32_t TriIndex = 0; TriIndex < Mesh.NumTriangles; ++TriIndex)
+		{
+			const int32_t I0 = Indices[(TriIndex * 3) + 0];
+			const int32_t I1 = Indices[(TriIndex * 3) + 1];
+			const int32_t I2 = Indices[(TriIndex * 3) + 2];
+
+			const float Depth1 = Depths[I0];
+			const float Depth2 = Depths[I1];
+			const float Depth3 = Depths[I2];
+
+			// Fully dry triangles don't contribute, skip them before touching vertices
+			if (Depth1 >= 0.0f && Depth2 >= 0.0f && Depth3 >= 0.0f)
+			{
+				continue;
+			}
+
+			const FVec3 Vertex1(VertexX[I0], VertexY[I0], VertexZ[I0]);
+			const FVec3 Vertex2(VertexX[I1], VertexY[I1], VertexZ[I1]);
+			const FVec3 Vertex3(VertexX[I2], VertexY[I2], VertexZ[I2]);
+
+			if (Depth1 * Depth2 < 0.0f)
+			{
+				Volume += ClipTriangle(Centroid, Point, Vertex1, Vertex2, Vertex3, Depth1, Depth2, Depth3);
+			}
+			else if (Depth1 * Depth3 < 0.0f)
+			{
+				Volume += ClipTriangle(Centroid, Point, Vertex3, Vertex1, Vertex2, Depth3, Depth1, Depth2);
+			}
+			else if (Depth2 * Depth3 < 0.0f)
+			{
+				Volume += ClipTriangle(Centroid, Point, Vertex2, Vertex3, Vertex1, Depth2, Depth3, Depth1);
+			}
+			else
+			{
+				Volume += ComputeTetrahedronVolume(Centroid, Point, Vertex1, Vertex2, Vertex3);
+			}
+		}
+
+		const float TINY_VOLUME = 1e-6f;
+		if (Volume <= TINY_VOLUME)
+		{
+			Centroid = FVec3();
+			return 0.0f;
+		}
+
+		Centroid *= 1.0f / Volume;
+
+		return Volume;
+	}
+
+	/* Signed distance of every vertex to plane Dot(Normal, Vertex) = Offset
+	 *	@param Depths		(out)		Mesh.NumVertices floats
+	 */
+	inline void ComputePlaneDepths(const FMeshView& Mesh, const FVec3& Normal, float Offset, float* Depths)
+	{
+		BUOYANCY_CORE_SCOPE(Classify);
+
+		const float* VertexX = Mesh.VertexX;
+		const float* VertexY = Mesh.VertexY;
+		const float* VertexZ = Mesh.VertexZ;
+
+		for (int32_t i = 0; i < Mesh.NumVertices; ++i)
+		{
+			Depths[i] = Normal.X * VertexX[i] + Normal.Y * VertexY[i] + Normal.Z * VertexZ[i] - Offset;
+		}
+	}
+
+	/* Volume of mesh below plane Dot(Normal, Vertex) = Offset, everything in mesh space
+	 *	@param Mesh						Mesh for calculation
+	 *	@param Normal					Plane normal, pointing out of water
+	 *	@param Offset					Plane offset along normal
+	 *	@param Depths		(scratch)	Mesh.NumVertices floats, receives signed distance of every vertex
+	 *	@param Centroid		(out)		Center of submerged volume in mesh space
+	 */
+	inline float ComputeSubmergedVolume(const FMeshView& Mesh, const FVec3& Normal, float Offset, float* Depths, FVec3& Centroid)
+	{
+		ComputePlaneDepths(Mesh, Normal, Offset, Depths);
+
+		return ComputeSubmergedVolumeFromDepths(Mesh, Depths, Normal, Centroid);
+	}
+
+	/* Fill vertex to triangle adjacency of mesh
+	 *	@param OutStart		(out)		Mesh.NumVertices + 1 ints
+	 *	@param OutTriangles	(out)		3 * Mesh.NumTriangles ints
+	 */
+	inline void BuildVertexTriangles(const FMeshView& Mesh, int32_t* OutStart, int32_t* OutTriangles)
+	{
+		for (int32_t i = 0; i <= Mesh.NumVertices; ++i)
+		{
+			OutStart[i] = 0;
+		}
+
+		for (int32_t i = 0; i < Mesh.NumTriangles * 3; ++i)
+		{
+			++OutStart[Mesh.Indices[i] + 1];
+		}
+
+		for (int32_t i = 0; i < Mesh.NumVertices; ++i)
+		{
+			OutStart[i + 1] += OutStart[i];
+		}
+
+		// Start of every vertex is used as write cursor, it ends at start of next vertex
+		for (int32_t i = 0; i < Mesh.NumTriangles * 3; ++i)
+		{
+			OutTriangles[OutStart[Mesh.Indices[i]]++] = i / 3;
+		}
+
+		for (int32_t i = Mesh.NumVertices; i > 0; --i)
+		{
+			OutStart[i] = OutStart[i - 1];
+		}
+
+		OutStart[0] = 0;
+	}
+
+	enum ETriangleClass : uint8_t
+	{
+		Triangle_Dry = 0,
+		Triangle_Wet = 1,
+		Triangle_Crossing = 2,
+
+		/* Flag of triangle waiting in queue */
+		Triangle_Queued = 0x80
+	};
+
+	inline int8_t GetDepthSign(float Depth)
+	{
+		return Depth < 0.0f ? -1 : (Depth > 0.0f ? 1 : 0);
+	}
+
+	/* Same classification as ComputeSubmergedVolumeFromDepths: dry when nothing is below, crossing when vertices are on both sides */
+	inline uint8_t ClassifyTriangle(int8_t Sign1, int8_t Sign2, int8_t Sign3)
+	{
+		const bool bAnyBelow = Sign1 < 0 || Sign2 < 0 || Sign3 < 0;
+		const bool bAnyAbove = Sign1 > 0 || Sign2 > 0 || Sign3 > 0;
+
+		return bAnyBelow ? (bAnyAbove ? Triangle_Crossing : Triangle_Wet) : Triangle_Dry;
+	}
+
+	/* Add (Scale 1) or remove (Scale -1) fully submerged triangle from sums of incremental state.
+	 * Tetrahedron of triangle with apex P has volume (Dot(N, P) - C) / 6 and volume weighted center
+	 * (Dot(N, P) - C) * (S + P) / 24, where N = Cross(V3 - V1, V2 - V1), C = Dot(N, V1) and S = V1 + V2 + V3.
+	 * Both are linear in sums of N, C, S * N^T and C * S, so wet triangles never have to be visited again.
+	 */
+	inline void AddWetTriangle(const FMeshView& Mesh, int32_t TriIndex, double Scale, FIncrementalVolume& State)
+	{
+		const FVec3 Vertex1 = Mesh.GetVertex(Mesh.Indices[(TriIndex * 3) + 0]);
+		const FVec3 Vertex2 = Mesh.GetVertex(Mesh.Indices[(TriIndex * 3) + 1]);
+		const FVec3 Vertex3 = Mesh.GetVertex(Mesh.Indices[(TriIndex * 3) + 2]);
+
+		const FVec3 Normal = FVec3::Cross(Vertex3 - Vertex1, Vertex2 - Vertex1);
+		const double Offset = Scale * FVec3::Dot(Normal, Vertex1);
+		const FVec3 Corners = Vertex1 + Vertex2 + Vertex3;
+
+		State.SumOffset += Offset;
+
+		for (int32_t i = 0; i < 3; ++i)
+		{
+			State.SumNormal[i] += Scale * Normal[i];
+			State.SumOffsetCorners[i] += Offset * Corners[i];
+
+			for (int32_t j = 0; j < 3; ++j)
+			{
+				State.SumMoment[i][j] += Scale * Corners[i] * Normal[j];
+			}
+		}
+	}
+
+	/* Move triangle to its new class, updating sums and list of crossing triangles */
+	inline void SetTriangleClass(const FMeshView& Mesh, int32_t TriIndex, uint8_t NewClass, FIncrementalVolume& State)
+	{
+		const uint8_t OldClass = State.TriangleClasses[TriIndex] & ~Triangle_Queued;
+		State.TriangleClasses[TriIndex] = NewClass;
+
+		if (OldClass == NewClass)
+		{
+			return;
+		}
+
+		if (OldClass == Triangle_Wet)
+		{
+			AddWetTriangle(Mesh, TriIndex, -1.0, State);
+		}
+		else if (OldClass == Triangle_Crossing)
+		{
+			const int32_t Slot = State.CrossingSlots[TriIndex];
+			const int32_t Last = State.CrossingTriangles[--State.NumCrossing];
+
+			State.CrossingTriangles[Slot] = Last;
+			State.CrossingSlots[Last] = Slot;
+			State.CrossingSlots[TriIndex] = -1;
+		}
+
+		if (NewClass == Triangle_Wet)
+		{
+			AddWetTriangle(Mesh, TriIndex, 1.0, State);
+		}
+		else if (NewClass == Triangle_Crossing)
+		{
+			State.CrossingSlots[TriIndex] = State.NumCrossing;
+			State.CrossingTriangles[State.NumCrossing++] = TriIndex;
+		}
+	}
+
+	/* Same result as ComputeSubmergedVolumeFromDepths, but only triangles whose vertices changed side of surface
+	 * since last update are reclassified. Fully submerged triangles are kept as running sums and only triangles
+	 * crossing the surface are clipped, so cost after the depth pass follows the waterline, not the whole mesh.
+	 *	@param Mesh						Mesh for calculation, must stay the same while State is valid
+	 *	@param Depths					Mesh.NumVertices signed distances to surface, negative is under water
+	 *	@param Up						Direction out of water in mesh space, used to find point on surface
+	 *	@param State		(in/out)	State of body from previous update
+	 *	@param Centroid		(out)		Center of submerged volume in mesh space
+	 */
+	inline float ComputeSubmergedVolumeIncremental(const FMeshView& Mesh, const float* Depths, const FVec3& Up, FIncrementalVolume& State, FVec3& Centroid)
+	{
+		const float TINY_DEPTH = -1e-6f;
+
+		int32_t SampleVertex = -1;
+
+		if (!State.bValid)
+		{
+			BUOYANCY_CORE_SCOPE(Classify);
+
+			State.NumCrossing = 0;
+			State.SumOffset = 0.0;
+
+			for (int32_t i = 0; i < 3; ++i)
+			{
+				State.SumNormal[i] = 0.0;
+				State.SumOffsetCorners[i] = 0.0;
+				State.SumMoment[i][0] = State.SumMoment[i][1] = State.SumMoment[i][2] = 0.0;
+			}
+
+			for (int32_t i = 0; i < Mesh.NumVertices; ++i)
+			{
+				State.VertexSigns[i] = GetDepthSign(Depths[i]);
+				SampleVertex = (SampleVertex < 0 && Depths[i] < TINY_DEPTH) ? i : SampleVertex;
+			}
+
+			for (int32_t TriIndex = 0; TriIndex < Mesh.NumTriangles; ++TriIndex)
+			{
+				State.TriangleClasses[TriIndex] = Triangle_Dry;
+				State.CrossingSlots[TriIndex] = -1;
+
+				SetTriangleClass(Mesh, TriIndex, ClassifyTriangle(State.VertexSigns[Mesh.Indices[(TriIndex * 3) + 0]],
+					State.VertexSigns[Mesh.Indices[(TriIndex * 3) + 1]], State.VertexSigns[Mesh.Indices[(TriIndex * 3) + 2]]), State);
+			}
+
+			State.NumReclassified = Mesh.NumTriangles;
+			State.bValid = true;
+		}
+		else
+		{
+			BUOYANCY_CORE_SCOPE(Classify);
+
+			int32_t NumQueued = 0;
+
+			for (int32_t i = 0; i < Mesh.NumVertices; ++i)
+			{
+				SampleVertex = (SampleVertex < 0 && Depths[i] < TINY_DEPTH) ? i : SampleVertex;
+
+				const int8_t Sign = GetDepthSign(Depths[i]);
+				if (Sign == State.VertexSigns[i])
+				{
+					continue;
+				}
+
+				State.VertexSigns[i] = Sign;
+
+				for (int32_t j = State.Adjacency.Start[i]; j < State.Adjacency.Start[i + 1]; ++j)
+				{
+					const int32_t TriIndex = State.Adjacency.Triangles[j];
+
+					if ((State.TriangleClasses[TriIndex] & Triangle_Queued) == 0)
+					{
+						State.TriangleClasses[TriIndex] |= Triangle_Queued;
+						State.Queue[NumQueued++] = TriIndex;
+					}
+				}
+			}
+
+			for (int32_t q = 0; q < NumQueued; ++q)
+			{
+				const int32_t TriIndex = State.Queue[q];
+
+				SetTriangleClass(Mesh, TriIndex, ClassifyTriangle(State.VertexSigns[Mesh.Indices[(TriIndex * 3) + 0]],
+					State.VertexSigns[Mesh.Indices[(TriIndex * 3) + 1]], State.VertexSigns[Mesh.Indices[(TriIndex * 3) + 2]]), State);
+			}
+
+			State.NumReclassified = NumQueued;
+		}
+
+		Centroid = FVec3();
+
+		/* Return if no vertices are submerged */
+		if (SampleVertex < 0)
+		{
+			return 0.0f;
+		}
+
+		BUOYANCY_CORE_SCOPE(Clip);
+
+		/* Find a point on the water surface. */
+		const FVec3 Point = Mesh.GetVertex(SampleVertex) - Depths[SampleVertex] * Up;
+
+		// Fully submerged triangles from sums
+		const double PointOffset = State.SumNormal[0] * Point.X + State.SumNormal[1] * Point.Y + State.SumNormal[2] * Point.Z - State.SumOffset;
+		double WetCenter[3];
+
+		for (int32_t i = 0; i < 3; ++i)
+		{
+			const double Moment = State.SumMoment[i][0] * Point.X + State.SumMoment[i][1] * Point.Y + State.SumMoment[i][2] * Point.Z;
+			WetCenter[i] = (Moment - State.SumOffsetCorners[i] + Point[i] * PointOffset) * (1.0 / 24.0);
+		}
+
+		float Volume = static_cast<float>(PointOffset * (1.0 / 6.0));
+		Centroid = FVec3(static_cast<float>(WetCenter[0]), static_cast<float>(WetCenter[1]), static_cast<float>(WetCenter[2]));
+
+		// Triangles crossing the surface are clipped every update
+		for (int32_t c = 0; c < State.NumCrossing; ++c)
+		{
+			const int32_t TriIndex = State.CrossingTriangles[c];
+
+			const int32_t I0 = Mesh.Indices[(TriIndex * 3) + 0];
+			const int32_t I1 = Mesh.Indices[(TriIndex * 3) + 1];
+			const int32_t I2 = Mesh.Indices[(TriIndex * 3) + 2];
+
+			const FVec3 Vertex1 = Mesh.GetVertex(I0);
+			const FVec3 Vertex2 = Mesh.GetVertex(I1);
+			const FVec3 Vertex3 = Mesh.GetVertex(I2);
+
+			const float Depth1 = Depths[I0];
+			const float Depth2 = Depths[I1];
+			const float Depth3 = Depths[I2];
+
+			if (Depth1 * Depth2 < 0.0f)
+			{
+				Volume += ClipTriangle(Centroid, Point, Vertex1, Vertex2, Vertex3, Depth1, Depth2, Depth3);
+			}
+			else if (Depth1 * Depth3 < 0.0f)
+			{
+				Volume += ClipTriangle(Centroid, Point, Vertex3, Vertex1, Vertex2, Depth3, Depth1, Depth2);
+			}
+			else
+			{
+				Volume += ClipTriangle(Centroid, Point, Vertex2, Vertex3, Vertex1, Depth2, Depth3, Depth1);
+			}
+		}
+
+		const float TINY_VOLUME = 1e-6f;
+		if (Volume <= TINY_VOLUME)
+		{
+			Centroid = FVec3();
+			return 0.0f;
+		}
+
+		Centroid *= 1.0f / Volume;
+
+		return Volume;
+	}
+
+	/* Transform mesh vertices to world, mesh origin is placed at Origin
+	 *	@param OutX, OutY, OutZ	(out)	Mesh.NumVertices floats each
+	 */
+	inline void TransformVertices(const FMeshView& Mesh, const FQuat& Rotation, const FVec3& Origin, float* OutX, float* OutY, float* OutZ)
+	{
+		for (int32_t i = 0; i < Mesh.NumVertices; ++i)
+		{
+			const FVec3 Vertex = Origin + Rotation.RotateVector(Mesh.GetVertex(i));
+
+			OutX[i] = Vertex.X;
+			OutY[i] = Vertex.Y;
+			OutZ[i] = Vertex.Z;
+		}
+	}
+
+	/* Regular grid of water heights over rectangle, sampled with bilinear interpolation */
+	struct FHeightGrid
+	{
+		/* World location of first sample */
+		float OriginX;
+		float OriginY;
+
+		float CellSizeX;
+		float CellSizeY;
+
+		/* Number of samples along each axis, at least 2 */
+		int32_t NumX;
+		int32_t NumY;
+
+		/* NumX * NumY heights, row by row along X */
+		const float* Heights;
+
+		FHeightGrid()
+			: OriginX(0.0f), OriginY(0.0f), CellSizeX(1.0f), CellSizeY(1.0f), NumX(0), NumY(0), Heights(nullptr)
+		{
+		}
+
+		/* Grid with NumX * NumY samples covering rectangle from Min to Max */
+		static FHeightGrid FromBounds(float MinX, float MinY, float MaxX, float MaxY, int32_t InNumX, int32_t InNumY, const float* InHeights)
+		{
+			FHeightGrid Grid;
+			Grid.OriginX = MinX;
+			Grid.OriginY = MinY;
+			Grid.NumX = InNumX;
+			Grid.NumY = InNumY;
+			Grid.CellSizeX = (MaxX > MinX) ? (MaxX - MinX) / (InNumX - 1) : 1.0f;
+			Grid.CellSizeY = (MaxY > MinY) ? (MaxY - MinY) / (InNumY - 1) : 1.0f;
+			Grid.Heights = InHeights;
+			return Grid;
+		}
+
+		/* Location of sample, used to fill Heights */
+		void GetSampleLocation(int32_t IndexX, int32_t IndexY, float& OutX, float& OutY) const
+		{
+			OutX = OriginX + IndexX * CellSizeX;
+			OutY = OriginY + IndexY * CellSizeY;
+		}
+
+		/* Bilinear height at location, clamped to grid */
+		float Sample(float X, float Y) const
+		{
+			float U = (X - OriginX) / CellSizeX;
+			float V = (Y - OriginY) / CellSizeY;
+
+			U = (U < 0.0f) ? 0.0f : ((U > NumX - 1) ? static_cast<float>(NumX - 1) : U);
+			V = (V < 0.0f) ? 0.0f : ((V > NumY - 1) ? static_cast<float>(NumY - 1) : V);
+
+			int32_t CellX = static_cast<int32_t>(U);
+			int32_t CellY = static_cast<int32_t>(V);
+			CellX = (CellX > NumX - 2) ? NumX - 2 : CellX;
+			CellY = (CellY > NumY - 2) ? NumY - 2 : CellY;
+
+			const float FracX = U - CellX;
+			const float FracY = V - CellY;
+
+			const float* Row0 = Heights + CellY * NumX + CellX;
+			const float* Row1 = Row0 + NumX;
+
+			const float H0 = Row0[0] + (Row0[1] - Row0[0]) * FracX;
+			const float H1 = Row1[0] + (Row1[1] - Row1[0]) * FracX;
+
+			return H0 + (H1 - H0) * FracY;
+		}
+	};
+
+	/* Horizontal velocities of water on regular grid, like rivers or tidal streams. Both grids share layout. */
+	struct FFlowField
+	{
+		FHeightGrid VelocityX;
+		FHeightGrid VelocityY;
+
+		bool IsValid() const
+		{
+			return VelocityX.Heights != nullptr && VelocityY.Heights != nullptr && VelocityX.NumX >= 2 && VelocityX.NumY >= 2;
+		}
+
+		/* Bilinear velocity at location, clamped to grid, zero without grid */
+		FVec3 Sample(float X, float Y) const
+		{
+			return IsValid() ? FVec3(VelocityX.Sample(X, Y), VelocityY.Sample(X, Y), 0.0f) : FVec3();
+		}
+	};
+
+	/* Vertical depth of world vertices below water heights sampled at every vertex */
+	inline void ComputeSurfaceDepths(const float* WorldZ, const float* SurfaceZ, int32_t NumVertices, float* Depths)
+	{
+		BUOYANCY_CORE_SCOPE(Classify);
+
+		for (int32_t i = 0; i < NumVertices; ++i)
+		{
+			Depths[i] = WorldZ[i] - SurfaceZ[i];
+		}
+	}
+
+	/* Vertical depth of world vertices below water heights interpolated from grid */
+	inline void ComputeSurfaceDepths(const float* WorldX, const float* WorldY, const float* WorldZ, int32_t NumVertices, const FHeightGrid& Grid, float* Depths)
+	{
+		BUOYANCY_CORE_SCOPE(Classify);
+
+		for (int32_t i = 0; i < NumVertices; ++i)
+		{
+			Depths[i] = WorldZ[i] - Grid.Sample(WorldX[i], WorldY[i]);
+		}
+	}
+
+	/* Least squares plane through points on water surface, fitted as height field z = A * x + B * y + C.
+	 * Solves 2x2 normal equations in closed form, cost is one pass over points. When points are collinear
+	 * in XY slope across the line can't be observed and the most horizontal plane containing the line is used,
+	 * single point or coincident points give horizontal plane. Normal always points up.
+	 *	@param Points					Points on water surface
+	 *	@param NumPoints				Number of points
+	 */
+	inline FWaterPlane FitPlane(const FVec3* Points, int32_t NumPoints)
+	{
+		BUOYANCY_CORE_SCOPE(PlaneFit);
+
+		FWaterPlane Plane;
+
+		if (NumPoints <= 0)
+		{
+			return Plane;
+		}
+
+		// Find Plane Centroid
+		FVec3 Sum;
+		for (int32_t i = 0; i < NumPoints; ++i)
+		{
+			Sum += Points[i];
+		}
+
+		const FVec3 Centroid = Sum * (1.0f / NumPoints);
+
+		// Set Plane Location
+		Plane.Location = Centroid;
+
+		// Sums relative to centroid keep precision far from world origin
+		float SumXX = 0.0f, SumXY = 0.0f, SumYY = 0.0f;
+		float SumXZ = 0.0f, SumYZ = 0.0f;
+
+		for (int32_t i = 0; i < NumPoints; ++i)
+		{
+			const float DiffX = Points[i].X - Centroid.X;
+			const float DiffY = Points[i].Y - Centroid.Y;
+			const float DiffZ = Points[i].Z - Centroid.Z;
+
+			SumXX += DiffX * DiffX;
+			SumXY += DiffX * DiffY;
+			SumYY += DiffY * DiffY;
+
+			SumXZ += DiffX * DiffZ;
+			SumYZ += DiffY * DiffZ;
+		}
+
+		const float Trace = SumXX + SumYY;
+
+		// All points at the same XY
+		if (Trace <= 1e-6f)
+		{
+			return Plane;
+		}
+
+		float SlopeX, SlopeY;
+
+		const float Det = SumXX * SumYY - SumXY * SumXY;
+
+		if (Det > 1e-6f * Trace * Trace)
+		{
+			const float InvDet = 1.0f / Det;
+
+			SlopeX = (SumYY * SumXZ - SumXY * SumYZ) * InvDet;
+			SlopeY = (SumXX * SumYZ - SumXY * SumXZ) * InvDet;
+		}
+		else
+		{
+			// Collinear points, slope only along the line (minimum norm solution)
+			const float HalfDiff = 0.5f * (SumXX - SumYY);
+			const float Largest = 0.5f * Trace + std::sqrt(HalfDiff * HalfDiff + SumXY * SumXY);
+
+			// Eigenvector of Largest, pick better conditioned of the two equivalent forms
+			float DirX = SumXY, DirY = Largest - SumXX;
+			if (DirX * DirX + DirY * DirY < (Largest - SumYY) * (Largest - SumYY) + SumXY * SumXY)
+			{
+				DirX = Largest - SumYY;
+				DirY = SumXY;
+			}
+
+			const float InvLength = 1.0f / std::sqrt(DirX * DirX + DirY * DirY);
+			DirX *= InvLength;
+			DirY *= InvLength;
+
+			const float Slope = (DirX * SumXZ + DirY * SumYZ) / Largest;
+
+			SlopeX = Slope * DirX;
+			SlopeY = Slope * DirY;
+		}
+
+		Plane.Normal = FVec3(-SlopeX, -SlopeY, 1.0f).GetSafeNormal();
+
+		return Plane;
+	}
+
+	/* Z of cross product of B - A and C - A, positive when A, B, C turn counter clockwise */
+	inline float Cross2D(const FVec3& A, const FVec3& B, const FVec3& C)
+	{
+		return (B.X - A.X) * (C.Y - A.Y) - (B.Y - A.Y) * (C.X - A.X);
+	}
+
+	/* Convex hull of mesh vertices projected on XY plane, that is the largest possible waterline of mesh
+	 *	@param Order		(scratch)	Mesh.NumVertices ints
+	 *	@param OutHull		(out)		2 * Mesh.NumVertices points, receives hull counter clockwise with Z = 0
+	 *	@return							Number of hull points, 1 or 2 when mesh is flat in XY
+	 */
+	inline int32_t ComputeFootprint(const FMeshView& Mesh, int32_t* Order, FVec3* OutHull)
+	{
+		if (Mesh.NumVertices <= 0)
+		{
+			return 0;
+		}
+
+		for (int32_t i = 0; i < Mesh.NumVertices; ++i)
+		{
+			Order[i] = i;
+		}
+
+		std::sort(Order, Order + Mesh.NumVertices, [&Mesh](int32_t A, int32_t B)
+		{
+			return Mesh.VertexX[A] < Mesh.VertexX[B] || (Mesh.VertexX[A] == Mesh.VertexX[B] && Mesh.VertexY[A] < Mesh.VertexY[B]);
+		});
+
+		// Monotone chain, lower hull left to right and upper hull back, collinear points are dropped
+		int32_t NumHull = 0;
+
+		for (int32_t i = 0; i < Mesh.NumVertices; ++i)
+		{
+			const FVec3 Point(Mesh.VertexX[Order[i]], Mesh.VertexY[Order[i]], 0.0f);
+
+			while (NumHull >= 2 && Cross2D(OutHull[NumHull - 2], OutHull[NumHull - 1], Point) <= 0.0f)
+			{
+				--NumHull;
+			}
+
+			OutHull[NumHull++] = Point;
+		}
+
+		const int32_t NumLower = NumHull + 1;
+
+		for (int32_t i = Mesh.NumVertices - 2; i >= 0; --i)
+		{
+			const FVec3 Point(Mesh.VertexX[Order[i]], Mesh.VertexY[Order[i]], 0.0f);
+
+			while (NumHull >= NumLower && Cross2D(OutHull[NumHull - 2], OutHull[NumHull - 1], Point) <= 0.0f)
+			{
+				--NumHull;
+			}
+
+			OutHull[NumHull++] = Point;
+		}
+
+		// Last point repeats the first one
+		NumHull = NumHull > 1 ? NumHull - 1 : NumHull;
+
+		// All vertices at the same XY
+		if (NumHull == 2 && OutHull[0].X == OutHull[1].X && OutHull[0].Y == OutHull[1].Y)
+		{
+			NumHull = 1;
+		}
+
+		return NumHull;
+	}
+
+	/* Closest point of convex footprint to Point, Point itself when it is inside */
+	inline FVec3 ClampToFootprint(const FVec3* Hull, int32_t NumHull, const FVec3& Point)
+	{
+		bool bInside = NumHull >= 3;
+
+		for (int32_t i = 0; i < NumHull && bInside; ++i)
+		{
+			bInside = Cross2D(Hull[i], Hull[(i + 1) % NumHull], Point) >= 0.0f;
+		}
+
+		if (bInside || NumHull <= 0)
+		{
+			return Point;
+		}
+
+		FVec3 Closest = Hull[0];
+		float ClosestDistSquared = FVec3::DistSquared(Point, Closest);
+
+		for (int32_t i = 0; i < NumHull; ++i)
+		{
+			const FVec3& A = Hull[i];
+			const FVec3 Edge = Hull[(i + 1) % NumHull] - A;
+			const float EdgeSizeSquared = Edge.SizeSquared();
+
+			const float T = EdgeSizeSquared > 0.0f ? std::min(std::max(FVec3::Dot(Point - A, Edge) / EdgeSizeSquared, 0.0f), 1.0f) : 0.0f;
+			const FVec3 Candidate = A + Edge * T;
+			const float DistSquared = FVec3::DistSquared(Point, Candidate);
+
+			if (DistSquared < ClosestDistSquared)
+			{
+				Closest = Candidate;
+				ClosestDistSquared = DistSquared;
+			}
+		}
+
+		return Closest;
+	}
+
+	/* Points where water surface is sampled for plane fit of body. Grid over bounds of footprint,
+	 * with points outside footprint moved to its edge and points closer than half of spacing merged.
+	 * Bodies smaller than Spacing get 2 x 2 points, longer ones one point every Spacing along each axis.
+	 *	@param Hull, NumHull			Footprint from ComputeFootprint
+	 *	@param Spacing					Wanted distance between points, 0 uses 3 x 3 grid
+	 *	@param MaxPoints				Capacity of OutPoints, at least 4
+	 *	@param OutPoints	(out)		Points in mesh space with Z = 0
+	 *	@return							Number of points
+	 */
+	inline int32_t GenerateClippingPoints(const FVec3* Hull, int32_t NumHull, float Spacing, int32_t MaxPoints, FVec3* OutPoints)
+	{
+		if (NumHull <= 0 || MaxPoints <= 0)
+		{
+			return 0;
+		}
+
+		FVec3 Min = Hull[0];
+		FVec3 Max = Hull[0];
+
+		for (int32_t i = 1; i < NumHull; ++i)
+		{
+			Min = FVec3(std::min(Min.X, Hull[i].X), std::min(Min.Y, Hull[i].Y), 0.0f);
+			Max = FVec3(std::max(Max.X, Hull[i].X), std::max(Max.Y, Hull[i].Y), 0.0f);
+		}
+
+		const FVec3 Size = Max - Min;
+
+		int32_t NumX = 3;
+		int32_t NumY = 3;
+
+		if (Spacing > 0.0f)
+		{
+			NumX = std::max(2, static_cast<int32_t>(std::ceil(Size.X / Spacing)) + 1);
+			NumY = std::max(2, static_cast<int32_t>(std::ceil(Size.Y / Spacing)) + 1);
+		}
+
+		// Drop rows along longer side first
+		while (NumX * NumY > MaxPoints && (NumX > 2 || NumY > 2))
+		{
+			if ((NumX >= NumY && NumX > 2) || NumY <= 2)
+			{
+				--NumX;
+			}
+			else
+			{
+				--NumY;
+			}
+		}
+
+		const float StepX = Size.X / (NumX - 1);
+		const float StepY = Size.Y / (NumY - 1);
+		const float MergeDistance = 0.5f * std::min(StepX > 0.0f ? StepX : StepY, StepY > 0.0f ? StepY : StepX);
+		const float MergeDistSquared = MergeDistance * MergeDistance;
+
+		int32_t NumPoints = 0;
+
+		for (int32_t x = 0; x < NumX; ++x)
+		{
+			for (int32_t y = 0; y < NumY && NumPoints < MaxPoints; ++y)
+			{
+				const FVec3 Point = ClampToFootprint(Hull, NumHull, FVec3(Min.X + x * StepX, Min.Y + y * StepY, 0.0f));
+
+				bool bMerged = false;
+				for (int32_t i = 0; i < NumPoints && !bMerged; ++i)
+				{
+					bMerged = FVec3::DistSquared(Point, OutPoints[i]) <= MergeDistSquared;
+				}
+
+				if (!bMerged)
+				{
+					OutPoints[NumPoints++] = Point;
+				}
+			}
+		}
+
+		return NumPoints;
+	}
+
+	/* Buoyancy and drag forces for submerged part of body
+	 *	@param SubmergedVolume			Volume below water
+	 *	@param SubmergedCentroid		World center of submerged volume
+	 *	@param Forces		(out)		Calculated forces
+	 */
+	inline void ComputeForces(const FBodyState& State, const FBodyParams& Body, const FWaterParams& Water, float SubmergedVolume, const FVec3& SubmergedCentroid, FForces& Forces)
+	{
+		Forces = FForces();
+
+		if (SubmergedVolume <= 0.0f)
+		{
+			return;
+		}
+
+		const FVec3 PlaneNormal = FVec3(0.0f, 0.0f, 1.0f);
+
+		const FVec3 BuoyantForce = (Water.Density * SubmergedVolume * -Water.GravityZ) * PlaneNormal;
+		const float PartialMass = Body.DragMassPerVolume * State.Mass * SubmergedVolume;
+		const FVec3 Rc = SubmergedCentroid - State.CenterOfMass;
+		const FVec3 Vc = State.LinearVelocity + FVec3::Cross(State.AngularVelocity * 0.0001f, Rc);
+		const FVec3 DragForce = (PartialMass * Water.LinearDrag) * (Water.Velocity - Vc);
+
+		const FVec3 TotalForce = BuoyantForce + DragForce;
+		const FVec3 TotalDrag = FVec3::Cross(Rc, TotalForce);
+
+		const FVec3 DragTorque = (-PartialMass * Water.AngularDrag * Body.LengthSquared) * State.AngularVelocity;
+
+		Forces.bHasForce = true;
+		Forces.Force = TotalForce;
+		Forces.ForceLocation = SubmergedCentroid;
+		Forces.Torque = TotalDrag + DragTorque;
+	}
+
+	/* Add forces of one hull section to forces of whole body, sum acts at center of mass of body
+	 *	@param Section					Forces of section
+	 *	@param CenterOfMass				World center of mass of body
+	 *	@param Body			(in/out)	Sum of sections, start with default forces
+	 */
+	inline void AddSectionForces(const FForces& Section, const FVec3& CenterOfMass, FForces& Body)
+	{
+		if (!Section.bHasForce)
+		{
+			return;
+		}
+
+		if (!Body.bHasForce)
+		{
+			Body = FForces();
+			Body.bHasForce = true;
+			Body.ForceLocation = CenterOfMass;
+		}
+
+		// Force moved to center of mass brings its lever torque along
+		Body.Force += Section.Force;
+		Body.Torque += FVec3::Cross(Section.ForceLocation - Body.ForceLocation, Section.Force) + Section.Torque;
+	}
+
+	/* Whole buoyancy solve of single body: plane fit, submerged volume and forces
+	 *	@param Mesh						Buoyant mesh
+	 *	@param State					Current state of body
+	 *	@param SurfacePoints			World points on water surface around body
+	 *	@param NumSurfacePoints			Number of surface points
+	 *	@param Depths		(scratch)	Mesh.NumVertices floats
+	 *	@param Forces		(out)		Calculated forces
+	 *	@param Incremental	(in/out)	State of incremental volume update, null computes volume from scratch
+	 *	@return							Submerged volume
+	 */
+	inline float SolveBody(const FMeshView& Mesh, const FBodyState& State, const FBodyParams& Body, const FWaterParams& Water, const FVec3* SurfacePoints, int32_t NumSurfacePoints, float* Depths, FForces& Forces,
+		FIncrementalVolume* Incremental = nullptr)
+	{
+		const FWaterPlane Plane = FitPlane(SurfacePoints, NumSurfacePoints);
+
+		// Mesh is treated as if its origin was at center of mass
+		const FVec3 Normal = State.Rotation.Inverse().RotateVector(Plane.Normal);
+		const float Offset = FVec3::Dot(Plane.Normal, Plane.Location - State.CenterOfMass);
+
+		FVec3 Centroid;
+		float SubmergedVolume;
+
+		if (Incremental)
+		{
+			ComputePlaneDepths(Mesh, Normal, Offset, Depths);
+			SubmergedVolume = ComputeSubmergedVolumeIncremental(Mesh, Depths, Normal, *Incremental, Centroid);
+		}
+		else
+		{
+			SubmergedVolume = ComputeSubmergedVolume(Mesh, Normal, Offset, Depths, Centroid);
+		}
+
+		const FVec3 WorldCentroid = State.CenterOfMass + State.Rotation.RotateVector(Centroid);
+
+		ComputeForces(State, Body, Water, SubmergedVolume, WorldCentroid, Forces);
+
+		return SubmergedVolume;
+	}
+
+	/* Buoyancy solve of single body against non planar water surface
+	 *	@param Mesh						Buoyant mesh
+	 *	@param State					Current state of body
+	 *	@param Depths					Mesh.NumVertices vertical depths of vertices placed at center of mass, see ComputeSurfaceDepths
+	 *	@param Forces		(out)		Calculated forces
+	 *	@param Incremental	(in/out)	State of incremental volume update, null computes volume from scratch
+	 *	@return							Submerged volume
+	 */
+	inline float SolveBodySurface(const FMeshView& Mesh, const FBodyState& State, const FBodyParams& Body, const FWaterParams& Water, const float* Depths, FForces& Forces,
+		FIncrementalVolume* Incremental = nullptr)
+	{
+		const FVec3 Up = State.Rotation.Inverse().RotateVector(FVec3(0.0f, 0.0f, 1.0f));
+
+		FVec3 Centroid;
+		const float SubmergedVolume = Incremental ? ComputeSubmergedVolumeIncremental(Mesh, Depths, Up, *Incremental, Centroid)
+			: ComputeSubmergedVolumeFromDepths(Mesh, Depths, Up, Centroid);
+
+		const FVec3 WorldCentroid = State.CenterOfMass + State.Rotation.RotateVector(Centroid);
+
+		ComputeForces(State, Body, Water, SubmergedVolume, WorldCentroid, Forces);
+
+		return SubmergedVolume;
+	}
+
+	/* Where body is relative to water surface, decided from bounds only */
+	enum class EBodyPhase : uint8_t
+	{
+		/* Whole body is above highest wave */
+		Dry,
+
+		/* Whole body is below lowest wave */
+		Submerged,
+
+		/* Body may cross surface, needs full solve */
+		Crossing
+	};
+
+	/* Vertical extent of mesh space box placed with its origin at Origin
+	 *	@param BoundsMin, BoundsMax		Mesh space bounds
+	 *	@param OutMinZ, OutMaxZ	(out)	World height range of rotated box
+	 */
+	inline void ComputeVerticalExtent(const FVec3& BoundsMin, const FVec3& BoundsMax, const FQuat& Rotation, const FVec3& Origin, float& OutMinZ, float& OutMaxZ)
+	{
+		// World Z of mesh space vector is its dot product with world up in mesh space
+		const FVec3 Up = Rotation.Inverse().RotateVector(FVec3(0.0f, 0.0f, 1.0f));
+		const FVec3 Center = (BoundsMin + BoundsMax) * 0.5f;
+		const FVec3 Extent = (BoundsMax - BoundsMin) * 0.5f;
+
+		const float CenterZ = Origin.Z + FVec3::Dot(Up, Center);
+		const float HalfHeight = std::fabs(Up.X) * Extent.X + std::fabs(Up.Y) * Extent.Y + std::fabs(Up.Z) * Extent.Z;
+
+		OutMinZ = CenterZ - HalfHeight;
+		OutMaxZ = CenterZ + HalfHeight;
+	}
+
+	/* Classify body by its height range against conservative range of water surface heights */
+	inline EBodyPhase ClassifyBody(float MinZ, float MaxZ, float SurfaceMinZ, float SurfaceMaxZ)
+	{
+		if (MinZ >= SurfaceMaxZ)
+		{
+			return EBodyPhase::Dry;
+		}
+
+		if (MaxZ <= SurfaceMinZ)
+		{
+			return EBodyPhase::Submerged;
+		}
+
+		return EBodyPhase::Crossing;
+	}
+
+	/* Buoyancy of fully submerged body from its precomputed volume, no clipping needed
+	 *	@param State					Current state of body
+	 *	@param LocalCentroid			Center of whole volume in mesh space, see ComputeVolume
+	 *	@param Forces		(out)		Calculated forces
+	 *	@return							Submerged volume, which is Body.BodyVolume
+	 */
+	inline float SolveBodySubmerged(const FBodyState& State, const FBodyParams& Body, const FWaterParams& Water, const FVec3& LocalCentroid, FForces& Forces)
+	{
+		const FVec3 WorldCentroid = State.CenterOfMass + State.Rotation.RotateVector(LocalCentroid);
+
+		ComputeForces(State, Body, Water, Body.BodyVolume, WorldCentroid, Forces);
+
+		return Body.BodyVolume;
+	}
+
+	/* Area of mesh cross section at plane, from central difference of submerged volume
+	 *	@param Normal					Plane normal in mesh space, pointing out of water
+	 *	@param Offset					Plane offset along normal
+	 *	@param Step						Distance plane is moved up and down by
+	 *	@param Depths		(scratch)	Mesh.NumVertices floats
+	 */
+	inline float ComputeWaterplaneArea(const FMeshView& Mesh, const FVec3& Normal, float Offset, float Step, float* Depths)
+	{
+		FVec3 Centroid;
+		const float VolumeAbove = ComputeSubmergedVolume(Mesh, Normal, Offset + Step, Depths, Centroid);
+		const float VolumeBelow = ComputeSubmergedVolume(Mesh, Normal, Offset - Step, Depths, Centroid);
+
+		return (VolumeAbove - VolumeBelow) / (2.0f * Step);
+	}
+
+	/* Buoyancy from submerged volume of earlier solve, corrected linearly for change of depth.
+	 * With waterplane area this is a vertical spring around rest depth, without it volume is just held.
+	 *	@param State					Current state of body
+	 *	@param Volume					Submerged volume at reference depth
+	 *	@param LocalCentroid			Center of submerged volume relative to center of mass in mesh space
+	 *	@param WaterplaneArea			Change of volume per depth around reference depth
+	 *	@param DepthChange				How much deeper below surface center of mass is than at reference
+	 *	@param Forces		(out)		Calculated forces
+	 *	@return							Estimated submerged volume
+	 */
+	inline float SolveBodyHeld(const FBodyState& State, const FBodyParams& Body, const FWaterParams& Water, float Volume, const FVec3& LocalCentroid, float WaterplaneArea, float DepthChange, FForces& Forces)
+	{
+		float HeldVolume = Volume + WaterplaneArea * DepthChange;
+		HeldVolume = HeldVolume < 0.0f ? 0.0f : (HeldVolume > Body.BodyVolume ? Body.BodyVolume : HeldVolume);
+
+		const FVec3 WorldCentroid = State.CenterOfMass + State.Rotation.RotateVector(LocalCentroid);
+
+		ComputeForces(State, Body, Water, HeldVolume, WorldCentroid, Forces);
+
+		return HeldVolume;
+	}
+}
@@ -0,0 +1,206 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+/* Engine independent math used by buoyancy core. Layout of FVec3 matches FVector. */
+namespace BuoyancyCore
+{
+	struct FVec3
+	{
+		float X;
+		float Y;
+		float Z;
+
+		FVec3()
+			: X(0.0f), Y(0.0f), Z(0.0f)
+		{
+		}
+
+		FVec3(float InX, float InY, float InZ)
+			: X(InX), Y(InY), Z(InZ)
+		{
+		}
+
+		FVec3 operator+(const FVec3& V) const { return FVec3(X + V.X, Y + V.Y, Z + V.Z); }
+		FVec3 operator-(const FVec3& V) const { return FVec3(X - V.X, Y - V.Y, Z - V.Z); }
+		FVec3 operator*(float Scale) const { return FVec3(X * Scale, Y * Scale, Z * Scale); }
+		FVec3 operator-() const { return FVec3(-X, -Y, -Z); }
+
+		FVec3& operator+=(const FVec3& V) { X += V.X; Y += V.Y; Z += V.Z; return *this; }
+		FVec3& operator-=(const FVec3& V) { X -= V.X; Y -= V.Y; Z -= V.Z; return *this; }
+		FVec3& operator*=(float Scale) { X *= Scale; Y *= Scale; Z *= Scale; return *this; }
+
+		float operator[](int32_t Index) const { return (&X)[Index]; }
+		float& operator[](int32_t Index) { return (&X)[Index]; }
+
+		float SizeSquared() const { return X * X + Y * Y + Z * Z; }
+		float Size() const { return std::sqrt(SizeSquared()); }
+
+		FVec3 GetSafeNormal() const
+		{
+			const float SquareSum = SizeSquared();
+			if (SquareSum < 1e-8f)
+			{
+				return FVec3();
+			}
+
+			return *this * (1.0f / std::sqrt(SquareSum));
+		}
+
+		static float Dot(const FVec3& A, const FVec3& B)
+		{
+			return A.X * B.X + A.Y * B.Y + A.Z * B.Z;
+		}
+
+		static FVec3 Cross(const FVec3& A, const FVec3& B)
+		{
+			return FVec3(A.Y * B.Z - A.Z * B.Y, A.Z * B.X - A.X * B.Z, A.X * B.Y - A.Y * B.X);
+		}
+
+		static float DistSquared(const FVec3& A, const FVec3& B)
+		{
+			return (A - B).SizeSquared();
+		}
+	};
+
+	inline FVec3 operator*(float Scale, const FVec3& V)
+	{
+		return V * Scale;
+	}
+
+	/* Rotation quaternion, same convention as FQuat */
+	struct FQuat
+	{
+		float X;
+		float Y;
+		float Z;
+		float W;
+
+		FQuat()
+			: X(0.0f), Y(0.0f), Z(0.0f), W(1.0f)
+		{
+		}
+
+		FQuat(float InX, float InY, float InZ, float InW)
+			: X(InX), Y(InY), Z(InZ), W(InW)
+		{
+		}
+
+		/* Rotation of Angle radians around normalized Axis */
+		static FQuat FromAxisAngle(const FVec3& Axis, float Angle)
+		{
+			const float HalfSin = std::sin(0.5f * Angle);
+			return FQuat(Axis.X * HalfSin, Axis.Y * HalfSin, Axis.Z * HalfSin, std::cos(0.5f * Angle));
+		}
+
+		FQuat Inverse() const
+		{
+			return FQuat(-X, -Y, -Z, W);
+		}
+
+		FQuat operator*(const FQuat& Q) const
+		{
+			return FQuat(
+				W * Q.X + X * Q.W + Y * Q.Z - Z * Q.Y,
+				W * Q.Y - X * Q.Z + Y * Q.W + Z * Q.X,
+				W * Q.Z + X * Q.Y - Y * Q.X + Z * Q.W,
+				W * Q.W - X * Q.X - Y * Q.Y - Z * Q.Z);
+		}
+
+		FVec3 RotateVector(const FVec3& V) const
+		{
+			const FVec3 Q(X, Y, Z);
+			const FVec3 T = FVec3::Cross(Q, V) * 2.0f;
+			return V + (T * W) + FVec3::Cross(Q, T);
+		}
+	};
+
+	/* Row major 3x3 matrix */
+	struct FMat3
+	{
+		float M[3][3];
+
+		FMat3()
+		{
+			for (int32_t i = 0; i < 3; ++i)
+			{
+				for (int32_t j = 0; j < 3; ++j)
+				{
+					M[i][j] = (i == j) ? 1.0f : 0.0f;
+				}
+			}
+		}
+
+		FMat3(const FVec3& Row0, const FVec3& Row1, const FVec3& Row2)
+		{
+			for (int32_t j = 0; j < 3; ++j)
+			{
+				M[0][j] = Row0[j];
+				M[1][j] = Row1[j];
+				M[2][j] = Row2[j];
+			}
+		}
+
+		float Determinant() const
+		{
+			return M[0][0] * (M[1][1] * M[2][2] - M[1][2] * M[2][1])
+				- M[0][1] * (M[1][0] * M[2][2] - M[1][2] * M[2][0])
+				+ M[0][2] * (M[1][0] * M[2][1] - M[1][1] * M[2][0]);
+		}
+
+		/* Inverse from adjugate, caller has to make sure Determinant is not zero */
+		FMat3 Inverse() const
+		{
+			const float InvDet = 1.0f / Determinant();
+
+			FMat3 Result;
+			Result.M[0][0] = (M[1][1] * M[2][2] - M[1][2] * M[2][1]) * InvDet;
+			Result.M[0][1] = (M[0][2] * M[2][1] - M[0][1] * M[2][2]) * InvDet;
+			Result.M[0][2] = (M[0][1] * M[1][2] - M[0][2] * M[1][1]) * InvDet;
+			Result.M[1][0] = (M[1][2] * M[2][0] - M[1][0] * M[2][2]) * InvDet;
+			Result.M[1][1] = (M[0][0] * M[2][2] - M[0][2] * M[2][0]) * InvDet;
+			Result.M[1][2] = (M[0][2] * M[1][0] - M[0][0] * M[1][2]) * InvDet;
+			Result.M[2][0] = (M[1][0] * M[2][1] - M[1][1] * M[2][0]) * InvDet;
+			Result.M[2][1] = (M[0][1] * M[2][0] - M[0][0] * M[2][1]) * InvDet;
+			Result.M[2][2] = (M[0][0] * M[1][1] - M[0][1] * M[1][0]) * InvDet;
+			return Result;
+		}
+
+		FMat3 operator*(const FMat3& Other) const
+		{
+			FMat3 Result;
+			for (int32_t i = 0; i < 3; ++i)
+			{
+				for (int32_t j = 0; j < 3; ++j)
+				{
+					Result.M[i][j] = M[i][0] * Other.M[0][j] + M[i][1] * Other.M[1][j] + M[i][2] * Other.M[2][j];
+				}
+			}
+			return Result;
+		}
+
+		FMat3 operator*(float Scale) const
+		{
+			FMat3 Result;
+			for (int32_t i = 0; i < 3; ++i)
+			{
+				for (int32_t j = 0; j < 3; ++j)
+				{
+					Result.M[i][j] = M[i][j] * Scale;
+				}
+			}
+			return Result;
+		}
+
+		FVec3 operator*(const FVec3& V) const
+		{
+			return FVec3(
+				M[0][0] * V.X + M[0][1] * V.Y + M[0][2] * V.Z,
+				M[1][0] * V.X + M[1][1] * V.Y + M[1][2] * V.Z,
+				M[2][0] * V.X + M[2][1] * V.Y + M[2][2] * V.Z);
+		}
+	};
+}
@@ -0,0 +1,136 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "FixedStep.h"
+
+/* File format of recorded fixed step session, written by FBuoyancyRecorder and replayed by BuoyancyBench --replay.
+ * Everything needed to simulate bodies again is in the file: waves, clock rate, hulls and every state of every body.
+ *
+ *	FSessionHeader
+ *	Waves			7 * NumComponents floats: WaveVectorX, WaveVectorY, AngularFrequency, Phase, DisplacementScaleX, DisplacementScaleY, Amplitude
+ *	NumBodies *		FSessionBody, followed by NumHulls * (FSessionHull, VertexX, VertexY, VertexZ, Indices)
+ *	Records			FSessionRecord until end of file
+ *
+ * Writers take any archive with Serialize(void* Data, int64 Size), like FArchive.
+ */
+namespace BuoyancyCore
+{
+	static const uint32_t SessionMagic = 0x53455942; // 'BYES'
+	static const uint32_t SessionVersion = 2;
+
+	struct FSessionHeader
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		int32_t StepsPerSecond;
+		int32_t NumComponents;
+		int32_t NumBodies;
+	};
+
+	struct FSessionBody
+	{
+		FWaterParams Water;
+		FVec3 LocalCenterOfMass;
+		FVec3 LocalInertia;
+		float LinearDamping;
+		float AngularDamping;
+		float MaxAngularVelocity;
+		int32_t SurfaceIterations;
+		int32_t NumHulls;
+	};
+
+	struct FSessionHull
+	{
+		FBodyParams Body;
+		float MassFraction;
+		int32_t NumVertices;
+		int32_t NumTriangles;
+	};
+
+	enum class ESessionRecord : int32_t
+	{
+		/* State after simulating Step */
+		Step,
+
+		/* State was replaced at Step: first state of body, correction from server or skipped steps */
+		Reset
+	};
+
+	struct FSessionRecord
+	{
+		ESessionRecord Type;
+		int32_t Body;
+		int32_t Step;
+		FBodyState State;
+	};
+
+	static_assert(sizeof(FBodyState) == 17 * 4, "FBodyState is written to session as 17 floats");
+
+	template <typename ArchiveType, typename DataType>
+	inline void WriteSessionData(ArchiveType& Ar, const DataType* Data, int32_t Num)
+	{
+		Ar.Serialize(const_cast<DataType*>(Data), static_cast<int64_t>(sizeof(DataType)) * Num);
+	}
+
+	template <typename ArchiveType>
+	inline void WriteSessionHeader(ArchiveType& Ar, const FGerstnerSpectrumView& Waves, int32_t StepsPerSecond, int32_t NumBodies)
+	{
+		FSessionHeader Header;
+		Header.Magic = SessionMagic;
+		Header.Version = SessionVersion;
+		Header.StepsPerSecond = StepsPerSecond;
+		Header.NumComponents = Waves.NumComponents;
+		Header.NumBodies = NumBodies;
+		WriteSessionData(Ar, &Header, 1);
+
+		const float* Arrays[] = { Waves.WaveVectorX, Waves.WaveVectorY, Waves.AngularFrequency, Waves.Phase, Waves.DisplacementScaleX, Waves.DisplacementScaleY, Waves.Amplitude };
+		for (const float* Array : Arrays)
+		{
+			WriteSessionData(Ar, Array, Waves.NumComponents);
+		}
+	}
+
+	template <typename ArchiveType>
+	inline void WriteSessionBody(ArchiveType& Ar, const FFixedStepBody& Body)
+	{
+		FSessionBody SessionBody;
+		SessionBody.Water = Body.Water;
+		SessionBody.LocalCenterOfMass = Body.LocalCenterOfMass;
+		SessionBody.LocalInertia = Body.LocalInertia;
+		SessionBody.LinearDamping = Body.LinearDamping;
+		SessionBody.AngularDamping = Body.AngularDamping;
+		SessionBody.MaxAngularVelocity = Body.MaxAngularVelocity;
+		SessionBody.SurfaceIterations = Body.SurfaceIterations;
+		SessionBody.NumHulls = Body.NumHulls;
+		WriteSessionData(Ar, &SessionBody, 1);
+
+		for (int32_t h = 0; h < Body.NumHulls; ++h)
+		{
+			const FFixedStepHull& Hull = Body.Hulls[h];
+
+			FSessionHull SessionHull;
+			SessionHull.Body = Hull.Body;
+			SessionHull.MassFraction = Hull.MassFraction;
+			SessionHull.NumVertices = Hull.Mesh.NumVertices;
+			SessionHull.NumTriangles = Hull.Mesh.NumTriangles;
+			WriteSessionData(Ar, &SessionHull, 1);
+
+			WriteSessionData(Ar, Hull.Mesh.VertexX, Hull.Mesh.NumVertices);
+			WriteSessionData(Ar, Hull.Mesh.VertexY, Hull.Mesh.NumVertices);
+			WriteSessionData(Ar, Hull.Mesh.VertexZ, Hull.Mesh.NumVertices);
+			WriteSessionData(Ar, Hull.Mesh.Indices, Hull.Mesh.NumTriangles * 3);
+		}
+	}
+
+	template <typename ArchiveType>
+	inline void WriteSessionRecord(ArchiveType& Ar, ESessionRecord Type, int32_t Body, int32_t Step, const FBodyState& State)
+	{
+		FSessionRecord Record;
+		Record.Type = Type;
+		Record.Body = Body;
+		Record.Step = Step;
+		Record.State = State;
+		WriteSessionData(Ar, &Record, 1);
+	}
+}
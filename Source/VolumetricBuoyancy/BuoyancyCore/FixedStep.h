@@ -0,0 +1,264 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "BuoyancyCore.h"
+#include "GerstnerWaves.h"
+
+/* Fixed step simulation of buoyant body without physics engine.
+ * Waves, forces and integration are scalar code of this header only, waves use SinCos instead of libm,
+ * so the same build reproduces motion exactly from initial state, wave spectrum and clock step.
+ * Used by AActorBuoyant in FixedStep update mode and by session replay of BuoyancyBench.
+ */
+namespace BuoyancyCore
+{
+	/* Hull section of fixed step body, like FBuoyantBodyData its mesh is placed with origin at center of mass of body */
+	struct FFixedStepHull
+	{
+		FMeshView Mesh;
+		FBodyParams Body;
+
+		/* Part of body mass carried by this hull */
+		float MassFraction;
+
+		FFixedStepHull()
+			: MassFraction(1.0f)
+		{
+		}
+	};
+
+	/* Constant properties of fixed step body */
+	struct FFixedStepBody
+	{
+		const FFixedStepHull* Hulls;
+		int32_t NumHulls;
+
+		FWaterParams Water;
+
+		/* Center of mass in space of mesh origin */
+		FVec3 LocalCenterOfMass;
+
+		/* Principal moments of inertia around center of mass, kg * cm^2 */
+		FVec3 LocalInertia;
+
+		/* Same meaning as damping of physics body */
+		float LinearDamping;
+		float AngularDamping;
+
+		/* Degrees per second */
+		float MaxAngularVelocity;
+
+		/* Newton iterations of surface height, see SampleSurfaceHeights */
+		int32_t SurfaceIterations;
+
+		FFixedStepBody()
+			: Hulls(nullptr), NumHulls(0), LinearDamping(0.01f), AngularDamping(0.0f), MaxAngularVelocity(1500.0f), SurfaceIterations(1)
+		{
+		}
+
+		int32_t GetMaxVertices() const
+		{
+			int32_t MaxVertices = 0;
+			for (int32_t i = 0; i < NumHulls; ++i)
+			{
+				MaxVertices = std::max(MaxVertices, Hulls[i].Mesh.NumVertices);
+			}
+			return MaxVertices;
+		}
+	};
+
+	/* Caller owned buffers of fixed step solve, every pointer holds GetMaxVertices() floats */
+	struct FFixedStepScratch
+	{
+		static const int32_t FloatsPerVertex = 15;
+
+		float* WorldX;
+		float* WorldY;
+		float* WorldZ;
+		float* SurfaceX;
+		float* SurfaceY;
+		float* SurfaceZ;
+		float* Depths;
+		FWaveSampleBuffers Samples;
+
+		FFixedStepScratch()
+			: WorldX(nullptr), WorldY(nullptr), WorldZ(nullptr), SurfaceX(nullptr), SurfaceY(nullptr), SurfaceZ(nullptr), Depths(nullptr)
+		{
+		}
+
+		/* Split single buffer of FloatsPerVertex * MaxVertices floats */
+		static FFixedStepScratch FromBuffer(float* Buffer, int32_t MaxVertices)
+		{
+			float* Next = Buffer;
+			auto Take = [&Next, MaxVertices]() { float* Result = Next; Next += MaxVertices; return Result; };
+
+			FFixedStepScratch Scratch;
+			Scratch.WorldX = Take();
+			Scratch.WorldY = Take();
+			Scratch.WorldZ = Take();
+			Scratch.SurfaceX = Take();
+			Scratch.SurfaceY = Take();
+			Scratch.SurfaceZ = Take();
+			Scratch.Depths = Take();
+			Scratch.Samples.DisplacementX = Take();
+			Scratch.Samples.DisplacementY = Take();
+			Scratch.Samples.DisplacementZ = Take();
+			Scratch.Samples.SlopeXX = Take();
+			Scratch.Samples.SlopeXY = Take();
+			Scratch.Samples.SlopeYY = Take();
+			Scratch.Samples.SlopeZX = Take();
+			Scratch.Samples.SlopeZY = Take();
+			return Scratch;
+		}
+	};
+
+	/* Wave time of clock step. Computed in double, so every machine gets the same float for the same step. */
+	inline float GetStepTime(int32_t Step, int32_t StepsPerSecond)
+	{
+		return static_cast<float>(static_cast<double>(Step) / StepsPerSecond);
+	}
+
+	/* Highest possible surface, vertical displacement never exceeds sum of amplitudes */
+	inline float GetMaxWaveHeight(const FGerstnerSpectrumView& Waves)
+	{
+		float Sum = 0.0f;
+		for (int32_t i = 0; i < Waves.NumComponents; ++i)
+		{
+			Sum += std::fabs(Waves.Amplitude[i]);
+		}
+		return Sum;
+	}
+
+	/* Sum of forces of all hulls against wave surface at Time, every hull is clipped by surface height at its vertices
+	 *	@param Waves					Full spectrum, fixed step bodies don't use wave LOD
+	 *	@param State					Current state of body
+	 *	@param Scratch		(scratch)	Buffers for largest hull
+	 *	@param Forces		(out)		Sum of forces of hulls, acting at center of mass
+	 */
+	inline void ComputeFixedStepForces(const FGerstnerSpectrumView& Waves, const FFixedStepBody& Body, const FBodyState& State, float Time, const FFixedStepScratch& Scratch, FForces& Forces)
+	{
+		Forces = FForces();
+
+		const float MaxWaveHeight = GetMaxWaveHeight(Waves);
+
+		auto Evaluate = [&Waves, Time](const float* X, const float* Y, int32_t NumSamples, const FWaveSampleBuffers& Out)
+		{
+			BUOYANCY_CORE_SCOPE(WaveSampling);
+			EvaluateGerstner(Waves, X, Y, NumSamples, Time, Out, Waves.NumComponents);
+		};
+
+		for (int32_t h = 0; h < Body.NumHulls; ++h)
+		{
+			const FFixedStepHull& Hull = Body.Hulls[h];
+			const int32_t NumVertices = Hull.Mesh.NumVertices;
+
+			FBodyState HullState = State;
+			HullState.Mass = State.Mass * Hull.MassFraction;
+
+			TransformVertices(Hull.Mesh, State.Rotation, State.CenterOfMass, Scratch.WorldX, Scratch.WorldY, Scratch.WorldZ);
+
+			float MinZ = Scratch.WorldZ[0];
+			float MaxZ = Scratch.WorldZ[0];
+			for (int32_t i = 1; i < NumVertices; ++i)
+			{
+				MinZ = std::min(MinZ, Scratch.WorldZ[i]);
+				MaxZ = std::max(MaxZ, Scratch.WorldZ[i]);
+			}
+
+			// Above highest wave nothing is submerged, below lowest one waves don't have to be sampled
+			if (MinZ > MaxWaveHeight)
+			{
+				continue;
+			}
+
+			if (MaxZ < -MaxWaveHeight)
+			{
+				for (int32_t i = 0; i < NumVertices; ++i)
+				{
+					Scratch.SurfaceZ[i] = -MaxWaveHeight;
+				}
+			}
+			else
+			{
+				SampleSurfaceHeights(Evaluate, Scratch.WorldX, Scratch.WorldY, NumVertices, Body.SurfaceIterations, Scratch.SurfaceX, Scratch.SurfaceY, Scratch.Samples, Scratch.SurfaceZ);
+			}
+
+			ComputeSurfaceDepths(Scratch.WorldZ, Scratch.SurfaceZ, NumVertices, Scratch.Depths);
+
+			FForces HullForces;
+			SolveBodySurface(Hull.Mesh, HullState, Hull.Body, Body.Water, Scratch.Depths, HullForces);
+
+			AddSectionForces(HullForces, State.CenterOfMass, Forces);
+		}
+	}
+
+	/* Semi-implicit Euler step of rigid body under Forces and gravity of Body.Water.
+	 * Forces are applied like physics body applies them: Force at ForceLocation and Torque on top of it.
+	 */
+	inline void IntegrateBody(const FFixedStepBody& Body, const FForces& Forces, float DeltaTime, FBodyState& State)
+	{
+		const float DegreesToRadians = 3.1415926535897932f / 180.0f;
+
+		FVec3 Force = FVec3(0.0f, 0.0f, Body.Water.GravityZ * State.Mass);
+		FVec3 Torque;
+
+		if (Forces.bHasForce)
+		{
+			Force += Forces.Force;
+			Torque = Forces.Torque + FVec3::Cross(Forces.ForceLocation - State.CenterOfMass, Forces.Force);
+		}
+
+		State.LinearVelocity += Force * (DeltaTime / State.Mass);
+		State.LinearVelocity *= std::max(0.0f, 1.0f - Body.LinearDamping * DeltaTime);
+
+		// Inertia is diagonal in mesh space, so angular acceleration is solved there
+		const FQuat InverseRotation = State.Rotation.Inverse();
+		const FVec3 LocalTorque = InverseRotation.RotateVector(Torque);
+		FVec3 LocalAngularVelocity = InverseRotation.RotateVector(State.AngularVelocity * DegreesToRadians);
+
+		for (int32_t Axis = 0; Axis < 3; ++Axis)
+		{
+			if (Body.LocalInertia[Axis] > 0.0f)
+			{
+				LocalAngularVelocity[Axis] += LocalTorque[Axis] * (DeltaTime / Body.LocalInertia[Axis]);
+			}
+		}
+
+		FVec3 AngularVelocity = State.Rotation.RotateVector(LocalAngularVelocity) * std::max(0.0f, 1.0f - Body.AngularDamping * DeltaTime);
+
+		const float MaxAngularVelocity = Body.MaxAngularVelocity * DegreesToRadians;
+		if (AngularVelocity.SizeSquared() > MaxAngularVelocity * MaxAngularVelocity)
+		{
+			AngularVelocity = AngularVelocity.GetSafeNormal() * MaxAngularVelocity;
+		}
+
+		State.AngularVelocity = AngularVelocity * (1.0f / DegreesToRadians);
+		State.CenterOfMass += State.LinearVelocity * DeltaTime;
+
+		// dq/dt = 0.5 * w * q
+		const FQuat Spin = FQuat(AngularVelocity.X, AngularVelocity.Y, AngularVelocity.Z, 0.0f) * State.Rotation;
+		const float HalfStep = 0.5f * DeltaTime;
+		FQuat Rotation(State.Rotation.X + Spin.X * HalfStep, State.Rotation.Y + Spin.Y * HalfStep, State.Rotation.Z + Spin.Z * HalfStep, State.Rotation.W + Spin.W * HalfStep);
+
+		const float InvSize = 1.0f / std::sqrt(Rotation.X * Rotation.X + Rotation.Y * Rotation.Y + Rotation.Z * Rotation.Z + Rotation.W * Rotation.W);
+		State.Rotation = FQuat(Rotation.X * InvSize, Rotation.Y * InvSize, Rotation.Z * InvSize, Rotation.W * InvSize);
+
+		State.Location = State.CenterOfMass - State.Rotation.RotateVector(Body.LocalCenterOfMass);
+	}
+
+	/* Advance body by one clock step, forces are taken at wave time of Step */
+	inline void StepBody(const FGerstnerSpectrumView& Waves, const FFixedStepBody& Body, int32_t Step, int32_t StepsPerSecond, const FFixedStepScratch& Scratch, FBodyState& State)
+	{
+		FForces Forces;
+		ComputeFixedStepForces(Waves, Body, State, GetStepTime(Step, StepsPerSecond), Scratch, Forces);
+
+		IntegrateBody(Body, Forces, 1.0f / StepsPerSecond, State);
+	}
+
+	/* Principal moments of inertia of solid box, fallback when body has no inertia of its own */
+	inline FVec3 ComputeBoxInertia(float Mass, const FVec3& Size)
+	{
+		const float Scale = Mass / 12.0f;
+		return FVec3(Scale * (Size.Y * Size.Y + Size.Z * Size.Z), Scale * (Size.X * Size.X + Size.Z * Size.Z), Scale * (Size.X * Size.X + Size.Y * Size.Y));
+	}
+}
@@ -0,0 +1,237 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "BuoyancyCoreMath.h"
+
+/* Gerstner wave queries that don't depend on how displacements are evaluated.
+ * Gerstner waves move surface points horizontally too, so displacement evaluated at XY is the height of
+ * the surface somewhere else. Height at XY needs the undisplaced point P with P + D(P).XY = XY.
+ */
+namespace BuoyancyCore
+{
+	/* Gerstner spectrum as flat arrays, same layout as FWaveSpectrum */
+	struct FGerstnerSpectrumView
+	{
+		const float* WaveVectorX;
+		const float* WaveVectorY;
+		const float* AngularFrequency;
+		const float* Phase;
+		const float* DisplacementScaleX;
+		const float* DisplacementScaleY;
+		const float* Amplitude;
+
+		int32_t NumComponents;
+
+		FGerstnerSpectrumView()
+			: WaveVectorX(nullptr), WaveVectorY(nullptr), AngularFrequency(nullptr), Phase(nullptr)
+			, DisplacementScaleX(nullptr), DisplacementScaleY(nullptr), Amplitude(nullptr), NumComponents(0)
+		{
+		}
+	};
+
+	/* Output of wave evaluation, one float per sample in every buffer.
+	 * Slopes are derivatives of displacement along world X and Y, null slopes are not evaluated.
+	 * Horizontal slopes of Gerstner waves are symmetric, so dDx/dy = dDy/dx is stored once.
+	 * Velocities are derivatives of displacement in time, orbital velocity of water at surface. Null velocities are not evaluated.
+	 */
+	struct FWaveSampleBuffers
+	{
+		float* DisplacementX;
+		float* DisplacementY;
+		float* DisplacementZ;
+
+		/* dDx/dx, dDx/dy, dDy/dy */
+		float* SlopeXX;
+		float* SlopeXY;
+		float* SlopeYY;
+
+		/* dDz/dx, dDz/dy */
+		float* SlopeZX;
+		float* SlopeZY;
+
+		/* dD/dt */
+		float* VelocityX;
+		float* VelocityY;
+		float* VelocityZ;
+
+		FWaveSampleBuffers()
+			: DisplacementX(nullptr), DisplacementY(nullptr), DisplacementZ(nullptr)
+			, SlopeXX(nullptr), SlopeXY(nullptr), SlopeYY(nullptr), SlopeZX(nullptr), SlopeZY(nullptr)
+			, VelocityX(nullptr), VelocityY(nullptr), VelocityZ(nullptr)
+		{
+		}
+
+		bool HasSlopes() const
+		{
+			return SlopeXX != nullptr;
+		}
+
+		bool HasVelocities() const
+		{
+			return VelocityX != nullptr;
+		}
+	};
+
+	/* Sin and cos with the same range reduction and minimax polynomials as FMath::SinCos.
+	 * Doesn't call libm, so the result is the same with every standard library, fixed step bodies depend on it.
+	 */
+	inline void SinCos(float Value, float& OutSin, float& OutCos)
+	{
+		const float Pi = 3.1415926535897932f;
+		const float HalfPi = 1.57079632679f;
+
+		// Map Value to [-PI, PI]
+		float Quotient = (0.5f / Pi) * Value;
+		Quotient = static_cast<float>(static_cast<int32_t>(Value >= 0.0f ? Quotient + 0.5f : Quotient - 0.5f));
+		float Y = Value - (2.0f * Pi) * Quotient;
+
+		// Map Y to [-PI/2, PI/2] with Sin(Y) = Sin(PI - Y), Cos changes sign
+		float Sign = 1.0f;
+		if (Y > HalfPi)
+		{
+			Y = Pi - Y;
+			Sign = -1.0f;
+		}
+		else if (Y < -HalfPi)
+		{
+			Y = -Pi - Y;
+			Sign = -1.0f;
+		}
+
+		const float Y2 = Y * Y;
+
+		// 11-degree minimax approximation
+		OutSin = (((((-2.3889859e-08f * Y2 + 2.7525562e-06f) * Y2 - 0.00019840874f) * Y2 + 0.0083333310f) * Y2 - 0.16666667f) * Y2 + 1.0f) * Y;
+
+		// 10-degree minimax approximation
+		OutCos = Sign * (((((-2.6051615e-07f * Y2 + 2.4760495e-05f) * Y2 - 0.0013888378f) * Y2 + 0.041666638f) * Y2 - 0.5f) * Y2 + 1.0f);
+	}
+
+	/* Scalar displacement of NumSamples positions using first NumComponents components, same sum as FWaveSpectrum::Evaluate */
+	inline void EvaluateGerstner(const FGerstnerSpectrumView& Spectrum, const float* X, const float* Y, int32_t NumSamples, float Time, const FWaveSampleBuffers& Out, int32_t NumComponents)
+	{
+		NumComponents = NumComponents < Spectrum.NumComponents ? NumComponents : Spectrum.NumComponents;
+
+		for (int32_t s = 0; s < NumSamples; ++s)
+		{
+			float SumX = 0.0f, SumY = 0.0f, SumZ = 0.0f;
+			float SumXX = 0.0f, SumXY = 0.0f, SumYY = 0.0f, SumZX = 0.0f, SumZY = 0.0f;
+			float SumVX = 0.0f, SumVY = 0.0f, SumVZ = 0.0f;
+
+			for (int32_t i = 0; i < NumComponents; ++i)
+			{
+				const float WavePhase = Spectrum.WaveVectorX[i] * X[s] + (Spectrum.WaveVectorY[i] * Y[s] + (Time * Spectrum.AngularFrequency[i] + Spectrum.Phase[i]));
+				float Sin, Cos;
+				SinCos(WavePhase, Sin, Cos);
+
+				SumX += Spectrum.DisplacementScaleX[i] * Cos;
+				SumY += Spectrum.DisplacementScaleY[i] * Cos;
+				SumZ += Spectrum.Amplitude[i] * Sin;
+
+				SumXX -= Spectrum.DisplacementScaleX[i] * Spectrum.WaveVectorX[i] * Sin;
+				SumXY -= Spectrum.DisplacementScaleX[i] * Spectrum.WaveVectorY[i] * Sin;
+				SumYY -= Spectrum.DisplacementScaleY[i] * Spectrum.WaveVectorY[i] * Sin;
+				SumZX += Spectrum.Amplitude[i] * Spectrum.WaveVectorX[i] * Cos;
+				SumZY += Spectrum.Amplitude[i] * Spectrum.WaveVectorY[i] * Cos;
+
+				// Derivative of phase in time is AngularFrequency, same sin and cos as displacement
+				SumVX -= Spectrum.DisplacementScaleX[i] * Spectrum.AngularFrequency[i] * Sin;
+				SumVY -= Spectrum.DisplacementScaleY[i] * Spectrum.AngularFrequency[i] * Sin;
+				SumVZ += Spectrum.Amplitude[i] * Spectrum.AngularFrequency[i] * Cos;
+			}
+
+			Out.DisplacementX[s] = SumX;
+			Out.DisplacementY[s] = SumY;
+			Out.DisplacementZ[s] = SumZ;
+
+			if (Out.HasSlopes())
+			{
+				Out.SlopeXX[s] = SumXX;
+				Out.SlopeXY[s] = SumXY;
+				Out.SlopeYY[s] = SumYY;
+				Out.SlopeZX[s] = SumZX;
+				Out.SlopeZY[s] = SumZY;
+			}
+
+			if (Out.HasVelocities())
+			{
+				Out.VelocityX[s] = SumVX;
+				Out.VelocityY[s] = SumVY;
+				Out.VelocityZ[s] = SumVZ;
+			}
+		}
+	}
+
+	/* Height of displaced surface exactly above every sample position.
+	 * Every iteration is one batched evaluation with slopes followed by Newton step on P + D(P).XY = XY,
+	 * height is extrapolated along surface slope to the new P, so no evaluation is spent only on height.
+	 * 0 iterations is plain displacement at XY, 1 iteration costs the same sin/cos and removes most of the error,
+	 * 2 iterations are converged for any wave which doesn't fold over. Where it folds the step falls back to fixed point.
+	 *	@param Evaluate					Callable (X, Y, NumSamples, const FWaveSampleBuffers& Out) evaluating displacements,
+	 *									slopes only when Out.HasSlopes()
+	 *	@param X, Y						NumSamples world positions
+	 *	@param NumIterations			Number of evaluations
+	 *	@param SurfaceX, SurfaceY (out)	NumSamples undisplaced positions whose displaced point lies above sample
+	 *	@param Samples		(scratch)	Displacements and slopes of last evaluation, also velocities when Samples has them
+	 *	@param OutZ			(out)		NumSamples surface heights, may be Samples.DisplacementZ
+	 */
+	template <typename EvaluatorType>
+	inline void SampleSurfaceHeights(const EvaluatorType& Evaluate, const float* X, const float* Y, int32_t NumSamples, int32_t NumIterations,
+		float* SurfaceX, float* SurfaceY, const FWaveSampleBuffers& Samples, float* OutZ)
+	{
+		for (int32_t i = 0; i < NumSamples; ++i)
+		{
+			SurfaceX[i] = X[i];
+			SurfaceY[i] = Y[i];
+		}
+
+		if (NumIterations <= 0)
+		{
+			FWaveSampleBuffers Displacements = Samples;
+			Displacements.SlopeXX = Displacements.SlopeXY = Displacements.SlopeYY = Displacements.SlopeZX = Displacements.SlopeZY = nullptr;
+
+			Evaluate(SurfaceX, SurfaceY, NumSamples, Displacements);
+
+			for (int32_t i = 0; i < NumSamples; ++i)
+			{
+				OutZ[i] = Samples.DisplacementZ[i];
+			}
+			return;
+		}
+
+		// Below this determinant of (I + horizontal slope) surface is close to folding and Newton step is unreliable
+		const float MIN_DETERMINANT = 0.05f;
+
+		for (int32_t Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			Evaluate(SurfaceX, SurfaceY, NumSamples, Samples);
+
+			for (int32_t i = 0; i < NumSamples; ++i)
+			{
+				const float ResidualX = SurfaceX[i] + Samples.DisplacementX[i] - X[i];
+				const float ResidualY = SurfaceY[i] + Samples.DisplacementY[i] - Y[i];
+
+				const float A = 1.0f + Samples.SlopeXX[i];
+				const float B = Samples.SlopeXY[i];
+				const float D = 1.0f + Samples.SlopeYY[i];
+				const float Determinant = A * D - B * B;
+
+				float StepX = -ResidualX;
+				float StepY = -ResidualY;
+
+				if (Determinant > MIN_DETERMINANT)
+				{
+					const float InvDeterminant = 1.0f / Determinant;
+					StepX = (B * ResidualY - D * ResidualX) * InvDeterminant;
+					StepY = (B * ResidualX - A * ResidualY) * InvDeterminant;
+				}
+
+				OutZ[i] = Samples.DisplacementZ[i] + Samples.SlopeZX[i] * StepX + Samples.SlopeZY[i] * StepY;
+
+				SurfaceX[i] += StepX;
+				SurfaceY[i] += StepY;
+			}
+		}
+	}
+}
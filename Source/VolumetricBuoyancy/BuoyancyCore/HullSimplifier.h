@@ -0,0 +1,481 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "BuoyancyCore.h"
+
+/* Offline simplification of buoyancy meshes into low poly proxies and report of proxy error against source mesh.
+ * Meant for editor and tools, runtime only loads stored proxy. Same rules as rest of core: caller owns all buffers.
+ */
+namespace BuoyancyCore
+{
+	/* Scratch buffers of SimplifyHull */
+	struct FSimplifyScratch
+	{
+		/* Mesh.NumVertices each */
+		int64_t* CellKeys;
+		int32_t* Order;
+		int32_t* Clusters;
+
+		/* 10 doubles per source vertex, error quadric of every cluster */
+		double* Quadrics;
+
+		/* 4 doubles per source vertex, vertex sum and count of every cluster, later its representative */
+		double* Sums;
+
+		/* Mesh.NumTriangles ints */
+		int32_t* TriangleOrder;
+
+		FSimplifyScratch()
+			: CellKeys(nullptr), Order(nullptr), Clusters(nullptr), Quadrics(nullptr), Sums(nullptr), TriangleOrder(nullptr)
+		{
+		}
+	};
+
+	/* Simplified mesh, buffers need capacity of source mesh */
+	struct FHullBuffers
+	{
+		float* VertexX;
+		float* VertexY;
+		float* VertexZ;
+		int32_t* Indices;
+
+		int32_t NumVertices;
+		int32_t NumTriangles;
+
+		FHullBuffers()
+			: VertexX(nullptr), VertexY(nullptr), VertexZ(nullptr), Indices(nullptr), NumVertices(0), NumTriangles(0)
+		{
+		}
+
+		FMeshView GetView() const
+		{
+			FMeshView View;
+			View.VertexX = VertexX;
+			View.VertexY = VertexY;
+			View.VertexZ = VertexZ;
+			View.Indices = Indices;
+			View.NumVertices = NumVertices;
+			View.NumTriangles = NumTriangles;
+			return View;
+		}
+	};
+
+	/* Error of proxy against source mesh, see MeasureProxyError */
+	struct FProxyError
+	{
+		/* Difference of total volumes relative to source volume */
+		double VolumeError;
+
+		/* Largest difference of submerged volumes relative to source volume */
+		double MaxSubmergedVolumeError;
+
+		/* Largest distance between submerged centroids relative to diagonal of source bounds */
+		double MaxCentroidError;
+
+		int32_t NumSamples;
+
+		FProxyError()
+			: VolumeError(0.0), MaxSubmergedVolumeError(0.0), MaxCentroidError(0.0), NumSamples(0)
+		{
+		}
+	};
+
+	inline void ComputeBounds(const FMeshView& Mesh, FVec3& OutMin, FVec3& OutMax)
+	{
+		OutMin = FVec3(Mesh.VertexX[0], Mesh.VertexY[0], Mesh.VertexZ[0]);
+		OutMax = OutMin;
+
+		for (int32_t i = 1; i < Mesh.NumVertices; ++i)
+		{
+			const FVec3 Vertex = Mesh.GetVertex(i);
+			for (int32_t Axis = 0; Axis < 3; ++Axis)
+			{
+				OutMin[Axis] = std::min(OutMin[Axis], Vertex[Axis]);
+				OutMax[Axis] = std::max(OutMax[Axis], Vertex[Axis]);
+			}
+		}
+	}
+
+	/* Compare triangles by their sorted indices, so the same triangle with any winding ends up next to each other */
+	inline bool IsTriangleLess(const int32_t* Indices, int32_t TriA, int32_t TriB)
+	{
+		int32_t A[3] = { Indices[TriA * 3], Indices[TriA * 3 + 1], Indices[TriA * 3 + 2] };
+		int32_t B[3] = { Indices[TriB * 3], Indices[TriB * 3 + 1], Indices[TriB * 3 + 2] };
+		std::sort(A, A + 3);
+		std::sort(B, B + 3);
+
+		return A[0] != B[0] ? A[0] < B[0] : (A[1] != B[1] ? A[1] < B[1] : A[2] < B[2]);
+	}
+
+	/* +1 when triangle winds the same way as its sorted indices, -1 otherwise */
+	inline int32_t GetTriangleParity(const int32_t* Tri)
+	{
+		// Rotate smallest index first, rotation keeps winding
+		const int32_t First = (Tri[0] < Tri[1] && Tri[0] < Tri[2]) ? 0 : (Tri[1] < Tri[2] ? 1 : 2);
+		return Tri[(First + 1) % 3] < Tri[(First + 2) % 3] ? 1 : -1;
+	}
+
+	/* Simplify closed mesh by merging vertices on grid of CellSize. Every cluster is replaced by point minimizing
+	 * squared distance to planes of its triangles, clamped into its cell.
+	 * Merging vertices keeps every edge shared by the same triangles, so closed mesh stays closed and its volume stays defined.
+	 * Collapsed triangles and pairs of the same triangle with opposite winding are removed.
+	 *	@param Mesh						Closed source mesh
+	 *	@param CellSize					Size of grid cell, 0 only welds vertices
+	 *	@param Scratch		(scratch)	Buffers sized for Mesh
+	 *	@param Out			(out)		Simplified mesh
+	 *	@return							Number of triangles of simplified mesh
+	 */
+	inline int32_t SimplifyHull(const FMeshView& Mesh, float CellSize, FSimplifyScratch& Scratch, FHullBuffers& Out)
+	{
+		Out.NumVertices = 0;
+		Out.NumTriangles = 0;
+
+		if (Mesh.NumVertices <= 0 || Mesh.NumTriangles <= 0)
+		{
+			return 0;
+		}
+
+		FVec3 BoundsMin, BoundsMax;
+		ComputeBounds(Mesh, BoundsMin, BoundsMax);
+
+		// Cell coordinates are packed into 21 bits per axis
+		const float MaxExtent = std::max(BoundsMax.X - BoundsMin.X, std::max(BoundsMax.Y - BoundsMin.Y, BoundsMax.Z - BoundsMin.Z));
+		CellSize = std::max(CellSize, std::max(MaxExtent, 1e-6f) / static_cast<float>(1 << 20));
+
+		const float InvCellSize = 1.0f / CellSize;
+
+		for (int32_t i = 0; i < Mesh.NumVertices; ++i)
+		{
+			const int64_t CellX = static_cast<int64_t>((Mesh.VertexX[i] - BoundsMin.X) * InvCellSize);
+			const int64_t CellY = static_cast<int64_t>((Mesh.VertexY[i] - BoundsMin.Y) * InvCellSize);
+			const int64_t CellZ = static_cast<int64_t>((Mesh.VertexZ[i] - BoundsMin.Z) * InvCellSize);
+
+			Scratch.CellKeys[i] = (CellX << 42) | (CellY << 21) | CellZ;
+			Scratch.Order[i] = i;
+		}
+
+		const int64_t* CellKeys = Scratch.CellKeys;
+		std::sort(Scratch.Order, Scratch.Order + Mesh.NumVertices, [CellKeys](int32_t A, int32_t B) { return CellKeys[A] < CellKeys[B]; });
+
+		int32_t NumClusters = 0;
+		for (int32_t i = 0; i < Mesh.NumVertices; ++i)
+		{
+			const int32_t Vertex = Scratch.Order[i];
+			if (i > 0 && CellKeys[Vertex] != CellKeys[Scratch.Order[i - 1]])
+			{
+				++NumClusters;
+			}
+
+			Scratch.Clusters[Vertex] = NumClusters;
+		}
+		++NumClusters;
+
+		for (int32_t i = 0; i < NumClusters * 10; ++i)
+		{
+			Scratch.Quadrics[i] = 0.0;
+		}
+
+		for (int32_t i = 0; i < NumClusters * 4; ++i)
+		{
+			Scratch.Sums[i] = 0.0;
+		}
+
+		for (int32_t i = 0; i < Mesh.NumVertices; ++i)
+		{
+			double* Sum = Scratch.Sums + Scratch.Clusters[i] * 4;
+			Sum[0] += Mesh.VertexX[i];
+			Sum[1] += Mesh.VertexY[i];
+			Sum[2] += Mesh.VertexZ[i];
+			Sum[3] += 1.0;
+		}
+
+		// Area weighted plane quadrics: a2 ab ac ad b2 bc bd c2 cd d2
+		for (int32_t TriIndex = 0; TriIndex < Mesh.NumTriangles; ++TriIndex)
+		{
+			const int32_t* Tri = Mesh.Indices + TriIndex * 3;
+			const FVec3 V1 = Mesh.GetVertex(Tri[0]);
+			const FVec3 Normal = FVec3::Cross(Mesh.GetVertex(Tri[1]) - V1, Mesh.GetVertex(Tri[2]) - V1);
+
+			const double DoubleArea = Normal.Size();
+			if (DoubleArea <= 0.0)
+			{
+				continue;
+			}
+
+			const double A = Normal.X / DoubleArea;
+			const double B = Normal.Y / DoubleArea;
+			const double C = Normal.Z / DoubleArea;
+			const double D = -(A * V1.X + B * V1.Y + C * V1.Z);
+			const double Weight = 0.5 * DoubleArea;
+
+			const double Terms[10] = { A * A, A * B, A * C, A * D, B * B, B * C, B * D, C * C, C * D, D * D };
+
+			for (int32_t Corner = 0; Corner < 3; ++Corner)
+			{
+				double* Quadric = Scratch.Quadrics + Scratch.Clusters[Tri[Corner]] * 10;
+				for (int32_t i = 0; i < 10; ++i)
+				{
+					Quadric[i] += Weight * Terms[i];
+				}
+			}
+		}
+
+		// Representative of cluster, quadric is regularized toward vertex mean so flat and crease clusters stay in place
+		for (int32_t Cluster = 0; Cluster < NumClusters; ++Cluster)
+		{
+			const double* Q = Scratch.Quadrics + Cluster * 10;
+			double* Sum = Scratch.Sums + Cluster * 4;
+
+			const double Mean[3] = { Sum[0] / Sum[3], Sum[1] / Sum[3], Sum[2] / Sum[3] };
+			const double Lambda = 1e-3 * (Q[0] + Q[4] + Q[7]) + 1e-12;
+
+			const double M[3][3] =
+			{
+				{ Q[0] + Lambda, Q[1], Q[2] },
+				{ Q[1], Q[4] + Lambda, Q[5] },
+				{ Q[2], Q[5], Q[7] + Lambda }
+			};
+			const double R[3] = { -Q[3] + Lambda * Mean[0], -Q[6] + Lambda * Mean[1], -Q[8] + Lambda * Mean[2] };
+
+			const double Det = M[0][0] * (M[1][1] * M[2][2] - M[1][2] * M[2][1]) - M[0][1] * (M[1][0] * M[2][2] - M[1][2] * M[2][0])
+				+ M[0][2] * (M[1][0] * M[2][1] - M[1][1] * M[2][0]);
+
+			double Point[3] = { Mean[0], Mean[1], Mean[2] };
+			if (std::fabs(Det) > 1e-30)
+			{
+				// Cramer's rule
+				for (int32_t Axis = 0; Axis < 3; ++Axis)
+				{
+					double Column[3][3];
+					for (int32_t Row = 0; Row < 3; ++Row)
+					{
+						for (int32_t Col = 0; Col < 3; ++Col)
+						{
+							Column[Row][Col] = Col == Axis ? R[Row] : M[Row][Col];
+						}
+					}
+
+					Point[Axis] = (Column[0][0] * (Column[1][1] * Column[2][2] - Column[1][2] * Column[2][1]) - Column[0][1] * (Column[1][0] * Column[2][2] - Column[1][2] * Column[2][0])
+						+ Column[0][2] * (Column[1][0] * Column[2][1] - Column[1][1] * Column[2][0])) / Det;
+				}
+			}
+
+			// Keep point inside cell of its vertices
+			const double CellMin[3] =
+			{
+				BoundsMin.X + std::floor((Mean[0] - BoundsMin.X) * InvCellSize) * CellSize,
+				BoundsMin.Y + std::floor((Mean[1] - BoundsMin.Y) * InvCellSize) * CellSize,
+				BoundsMin.Z + std::floor((Mean[2] - BoundsMin.Z) * InvCellSize) * CellSize
+			};
+
+			for (int32_t Axis = 0; Axis < 3; ++Axis)
+			{
+				Sum[Axis] = std::min(std::max(Point[Axis], CellMin[Axis]), CellMin[Axis] + CellSize);
+			}
+		}
+
+		for (int32_t TriIndex = 0; TriIndex < Mesh.NumTriangles; ++TriIndex)
+		{
+			const int32_t* Tri = Mesh.Indices + TriIndex * 3;
+			const int32_t C1 = Scratch.Clusters[Tri[0]];
+			const int32_t C2 = Scratch.Clusters[Tri[1]];
+			const int32_t C3 = Scratch.Clusters[Tri[2]];
+
+			if (C1 == C2 || C2 == C3 || C3 == C1)
+			{
+				continue;
+			}
+
+			int32_t* OutTri = Out.Indices + Out.NumTriangles * 3;
+			OutTri[0] = C1;
+			OutTri[1] = C2;
+			OutTri[2] = C3;
+			++Out.NumTriangles;
+		}
+
+		// Opposite copies of the same triangle enclose nothing, only their net count is kept
+		const int32_t* Indices = Out.Indices;
+		for (int32_t i = 0; i < Out.NumTriangles; ++i)
+		{
+			Scratch.TriangleOrder[i] = i;
+		}
+		std::sort(Scratch.TriangleOrder, Scratch.TriangleOrder + Out.NumTriangles, [Indices](int32_t A, int32_t B) { return IsTriangleLess(Indices, A, B); });
+
+		for (int32_t RunStart = 0; RunStart < Out.NumTriangles; )
+		{
+			int32_t RunEnd = RunStart + 1;
+			int32_t NetParity = GetTriangleParity(Out.Indices + Scratch.TriangleOrder[RunStart] * 3);
+
+			while (RunEnd < Out.NumTriangles && !IsTriangleLess(Indices, Scratch.TriangleOrder[RunStart], Scratch.TriangleOrder[RunEnd]))
+			{
+				NetParity += GetTriangleParity(Out.Indices + Scratch.TriangleOrder[RunEnd] * 3);
+				++RunEnd;
+			}
+
+			// Remove triangles whose parity is cancelled by opposite ones
+			int32_t NumKeep[2] = { NetParity < 0 ? -NetParity : 0, NetParity > 0 ? NetParity : 0 };
+			for (int32_t i = RunStart; i < RunEnd; ++i)
+			{
+				int32_t* Tri = Out.Indices + Scratch.TriangleOrder[i] * 3;
+				const int32_t Side = GetTriangleParity(Tri) > 0 ? 1 : 0;
+
+				if (NumKeep[Side] > 0)
+				{
+					--NumKeep[Side];
+				}
+				else
+				{
+					Tri[0] = -1;
+				}
+			}
+
+			RunStart = RunEnd;
+		}
+
+		// Compact triangles and clusters still in use, Order maps cluster to output vertex
+		for (int32_t i = 0; i < NumClusters; ++i)
+		{
+			Scratch.Order[i] = -1;
+		}
+
+		int32_t NumTriangles = 0;
+		for (int32_t TriIndex = 0; TriIndex < Out.NumTriangles; ++TriIndex)
+		{
+			const int32_t* Tri = Out.Indices + TriIndex * 3;
+			if (Tri[0] < 0)
+			{
+				continue;
+			}
+
+			int32_t* OutTri = Out.Indices + NumTriangles * 3;
+			for (int32_t Corner = 0; Corner < 3; ++Corner)
+			{
+				const int32_t Cluster = Tri[Corner];
+				if (Scratch.Order[Cluster] < 0)
+				{
+					const double* Point = Scratch.Sums + Cluster * 4;
+					Out.VertexX[Out.NumVertices] = static_cast<float>(Point[0]);
+					Out.VertexY[Out.NumVertices] = static_cast<float>(Point[1]);
+					Out.VertexZ[Out.NumVertices] = static_cast<float>(Point[2]);
+					Scratch.Order[Cluster] = Out.NumVertices++;
+				}
+
+				OutTri[Corner] = Scratch.Order[Cluster];
+			}
+			++NumTriangles;
+		}
+
+		Out.NumTriangles = NumTriangles;
+
+		return NumTriangles;
+	}
+
+	/* Simplify mesh to at most MaxTriangles with smallest grid that fits, see SimplifyHull
+	 *	@return							Cell size of result, 0 when Mesh already fits
+	 */
+	inline float SimplifyHullToBudget(const FMeshView& Mesh, int32_t MaxTriangles, FSimplifyScratch& Scratch, FHullBuffers& Out)
+	{
+		// Closed mesh needs at least tetrahedron
+		MaxTriangles = std::max(MaxTriangles, 4);
+
+		if (SimplifyHull(Mesh, 0.0f, Scratch, Out) <= MaxTriangles)
+		{
+			return 0.0f;
+		}
+
+		FVec3 BoundsMin, BoundsMax;
+		ComputeBounds(Mesh, BoundsMin, BoundsMax);
+		const float MaxExtent = std::max(BoundsMax.X - BoundsMin.X, std::max(BoundsMax.Y - BoundsMin.Y, BoundsMax.Z - BoundsMin.Z));
+
+		// Triangle count falls roughly with square of cell size, search on log scale
+		float Low = MaxExtent * 1e-5f;
+		float High = MaxExtent;
+
+		for (int32_t Iteration = 0; Iteration < 24; ++Iteration)
+		{
+			const float Mid = std::sqrt(Low * High);
+			if (SimplifyHull(Mesh, Mid, Scratch, Out) <= MaxTriangles)
+			{
+				High = Mid;
+			}
+			else
+			{
+				Low = Mid;
+			}
+		}
+
+		SimplifyHull(Mesh, High, Scratch, Out);
+
+		return High;
+	}
+
+	/* Compare submerged volume and centroid of proxy with source mesh for planes at NumDepths depths across source mesh,
+	 * tilted up to MaxTilt radians in 8 directions. Everything in mesh space.
+	 *	@param SourceDepths	(scratch)	Source.NumVertices floats
+	 *	@param ProxyDepths	(scratch)	Proxy.NumVertices floats
+	 */
+	inline FProxyError MeasureProxyError(const FMeshView& Source, const FMeshView& Proxy, int32_t NumDepths, int32_t NumTilts, float MaxTilt, float* SourceDepths, float* ProxyDepths)
+	{
+		FProxyError Error;
+
+		FVec3 Centroid;
+		const double SourceVolume = ComputeVolume(Source, Centroid);
+		const double ProxyVolume = Proxy.NumTriangles > 0 ? ComputeVolume(Proxy, Centroid) : 0.0;
+
+		if (SourceVolume <= 0.0)
+		{
+			return Error;
+		}
+
+		Error.VolumeError = std::fabs(ProxyVolume - SourceVolume) / SourceVolume;
+
+		FVec3 BoundsMin, BoundsMax;
+		ComputeBounds(Source, BoundsMin, BoundsMax);
+		const double Diagonal = std::max((BoundsMax - BoundsMin).Size(), 1e-6f);
+
+		const int32_t NumDirections = 8;
+
+		for (int32_t Tilt = 0; Tilt <= NumTilts; ++Tilt)
+		{
+			const float TiltAngle = NumTilts > 0 ? MaxTilt * Tilt / NumTilts : 0.0f;
+
+			for (int32_t Direction = 0; Direction < (Tilt > 0 ? NumDirections : 1); ++Direction)
+			{
+				const float Azimuth = 6.2831853f * Direction / NumDirections;
+				const FVec3 Normal(std::sin(TiltAngle) * std::cos(Azimuth), std::sin(TiltAngle) * std::sin(Azimuth), std::cos(TiltAngle));
+
+				float MinOffset = FVec3::Dot(Normal, Source.GetVertex(0));
+				float MaxOffset = MinOffset;
+				for (int32_t i = 1; i < Source.NumVertices; ++i)
+				{
+					const float Offset = FVec3::Dot(Normal, Source.GetVertex(i));
+					MinOffset = std::min(MinOffset, Offset);
+					MaxOffset = std::max(MaxOffset, Offset);
+				}
+
+				for (int32_t Depth = 0; Depth < NumDepths; ++Depth)
+				{
+					const float Offset = MinOffset + (MaxOffset - MinOffset) * (Depth + 0.5f) / NumDepths;
+
+					FVec3 SourceCentroid, ProxyCentroid;
+					const float SourceSubmerged = ComputeSubmergedVolume(Source, Normal, Offset, SourceDepths, SourceCentroid);
+					const float ProxySubmerged = Proxy.NumTriangles > 0 ? ComputeSubmergedVolume(Proxy, Normal, Offset, ProxyDepths, ProxyCentroid) : 0.0f;
+
+					Error.MaxSubmergedVolumeError = std::max(Error.MaxSubmergedVolumeError, std::fabs(ProxySubmerged - SourceSubmerged) / SourceVolume);
+
+					// Centroid of sliver means nothing
+					if (SourceSubmerged > 0.01 * SourceVolume)
+					{
+						const double CentroidError = ProxySubmerged > 0.0f ? (ProxyCentroid - SourceCentroid).Size() / Diagonal : 1.0;
+						Error.MaxCentroidError = std::max(Error.MaxCentroidError, CentroidError);
+					}
+
+					++Error.NumSamples;
+				}
+			}
+		}
+
+		return Error;
+	}
+}
@@ -0,0 +1,486 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "BuoyancyCore.h"
+#include "GerstnerWaves.h"
+
+/* Buoyancy of many small floating objects without meshes or physics bodies.
+ * Every instance is a sphere, box or capsule split into 4 lobes at (+-LobeOffsetX, +-LobeOffsetY) of its local space.
+ * Submerged part of lobe is analytic against water plane at lobe: t = (Depth + Reach) / (2 * Reach) clamped to [0, 1] is linear
+ * for box and t^2 * (3 - 2t) for sphere, exact for spheres and axis aligned boxes, so only tilted boxes and capsules are approximated.
+ * Lobes at different heights give righting torque. State and shape are structure-of-arrays and solved with own integrator
+ * in single branch free pass over all instances, which compilers vectorize.
+ * Used by AInstancedBuoyancyActor and by BuoyancyBench.
+ */
+namespace BuoyancyCore
+{
+	enum class EInstanceShape : uint8_t
+	{
+		Sphere,
+		Box,
+		Capsule
+	};
+
+	/* Constant properties of one instance, written into FInstanceBuffers by SetShape */
+	struct FInstanceShape
+	{
+		/* Lobe centers in local space of instance */
+		float LobeOffsetX;
+		float LobeOffsetY;
+
+		/* Vertical reach of lobe from its center is LobeRadius + |local axes Z| dot LobeExtent */
+		float LobeRadius;
+		FVec3 LobeExtent;
+
+		/* 0 submerged volume grows linearly with depth like box, 1 like sphere */
+		float Roundness;
+
+		float Volume;
+		float Mass;
+
+		/* Principal moments of inertia, kg * cm^2 */
+		FVec3 LocalInertia;
+
+		/* Longest size squared over mean moment of inertia per mass, lever of angular drag like FBodyParams::LengthSquared */
+		float AngularDragScale;
+
+		FInstanceShape()
+			: LobeOffsetX(0.0f), LobeOffsetY(0.0f), LobeRadius(0.0f), Roundness(0.0f), Volume(0.0f), Mass(0.0f), AngularDragScale(0.0f)
+		{
+		}
+	};
+
+	/* Shape of instance with center of mass at its center
+	 *	@param Shape				Sphere uses Extent.X as radius, box Extent as half size,
+	 *								capsule lies along local X with radius Extent.Y and Extent.X half length of its cylinder
+	 *	@param Extent				Size of shape, see Shape
+	 *	@param DensityOfBody		Same meaning as FBodyParams::DensityOfBody, 1000.0f is density of water
+	 *	@param WaterDensity			Density of water, converts DensityOfBody into mass
+	 */
+	inline FInstanceShape MakeInstanceShape(EInstanceShape Shape, const FVec3& Extent, float DensityOfBody, float WaterDensity)
+	{
+		const float PI = 3.1415926535897932f;
+
+		FInstanceShape Result;
+		float LongestSize = 0.0f;
+
+		if (Shape == EInstanceShape::Sphere)
+		{
+			const float Radius = Extent.X;
+
+			Result.LobeRadius = Radius;
+			Result.Roundness = 1.0f;
+			Result.Volume = (4.0f / 3.0f) * PI * Radius * Radius * Radius;
+			LongestSize = 2.0f * Radius;
+		}
+		else if (Shape == EInstanceShape::Box)
+		{
+			// Quarter of box around each lobe
+			Result.LobeOffsetX = 0.5f * Extent.X;
+			Result.LobeOffsetY = 0.5f * Extent.Y;
+			Result.LobeExtent = FVec3(0.5f * Extent.X, 0.5f * Extent.Y, Extent.Z);
+			Result.Volume = 8.0f * Extent.X * Extent.Y * Extent.Z;
+			LongestSize = 2.0f * std::max(Extent.X, std::max(Extent.Y, Extent.Z));
+		}
+		else
+		{
+			const float Radius = Extent.Y;
+			const float HalfLength = Extent.X;
+
+			// Half of capsule around each end, lobes on Y coincide
+			Result.LobeOffsetX = 0.5f * HalfLength;
+			Result.LobeRadius = Radius;
+			Result.LobeExtent = FVec3(0.5f * HalfLength, 0.0f, 0.0f);
+			Result.Roundness = 1.0f;
+			Result.Volume = PI * Radius * Radius * (2.0f * HalfLength + (4.0f / 3.0f) * Radius);
+			LongestSize = 2.0f * (HalfLength + Radius);
+		}
+
+		Result.Mass = Result.Volume * WaterDensity * (DensityOfBody / 1000.0f);
+
+		if (Shape == EInstanceShape::Sphere)
+		{
+			const float Moment = 0.4f * Result.Mass * Extent.X * Extent.X;
+			Result.LocalInertia = FVec3(Moment, Moment, Moment);
+		}
+		else if (Shape == EInstanceShape::Box)
+		{
+			const float Scale = Result.Mass / 3.0f;
+			Result.LocalInertia = FVec3(Scale * (Extent.Y * Extent.Y + Extent.Z * Extent.Z), Scale * (Extent.X * Extent.X + Extent.Z * Extent.Z), Scale * (Extent.X * Extent.X + Extent.Y * Extent.Y));
+		}
+		else
+		{
+			// Solid cylinder as long as whole capsule
+			const float Radius = Extent.Y;
+			const float Length = LongestSize;
+			const float Cross = Result.Mass * (3.0f * Radius * Radius + Length * Length) / 12.0f;
+			Result.LocalInertia = FVec3(0.5f * Result.Mass * Radius * Radius, Cross, Cross);
+		}
+
+		const float MeanInertia = (Result.LocalInertia.X + Result.LocalInertia.Y + Result.LocalInertia.Z) / 3.0f;
+		Result.AngularDragScale = MeanInertia > 0.0f ? LongestSize * LongestSize * Result.Mass / MeanInertia : 0.0f;
+
+		return Result;
+	}
+
+	/* Caller owned structure-of-arrays of instances, every pointer holds capacity of instances.
+	 * Angular velocity is in radians per second, unlike FBodyState.
+	 */
+	struct FInstanceBuffers
+	{
+		static const int32_t FloatsPerInstance = 32;
+
+		/* State */
+		float* PositionX;
+		float* PositionY;
+		float* PositionZ;
+		float* RotationX;
+		float* RotationY;
+		float* RotationZ;
+		float* RotationW;
+		float* VelocityX;
+		float* VelocityY;
+		float* VelocityZ;
+		float* AngularVelocityX;
+		float* AngularVelocityY;
+		float* AngularVelocityZ;
+
+		/* Shape, see FInstanceShape */
+		float* LobeOffsetX;
+		float* LobeOffsetY;
+		float* LobeRadius;
+		float* LobeExtentX;
+		float* LobeExtentY;
+		float* LobeExtentZ;
+		float* Roundness;
+		float* Volume;
+		float* InverseMass;
+		float* InverseInertiaX;
+		float* InverseInertiaY;
+		float* InverseInertiaZ;
+		float* AngularDragScale;
+
+		/* Input of step: height of water surface above instance and its slopes along X and Y */
+		float* SurfaceZ;
+		float* SurfaceSlopeX;
+		float* SurfaceSlopeY;
+
+		/* Input of step: horizontal velocity of water at instance on top of FInstanceStepParams::Water.Velocity */
+		float* WaterVelocityX;
+		float* WaterVelocityY;
+
+		/* Output of step: submerged part of instance volume, 0 - 1 */
+		float* Submerged;
+
+		FInstanceBuffers()
+			: PositionX(nullptr), PositionY(nullptr), PositionZ(nullptr), RotationX(nullptr), RotationY(nullptr), RotationZ(nullptr), RotationW(nullptr)
+			, VelocityX(nullptr), VelocityY(nullptr), VelocityZ(nullptr), AngularVelocityX(nullptr), AngularVelocityY(nullptr), AngularVelocityZ(nullptr)
+			, LobeOffsetX(nullptr), LobeOffsetY(nullptr), LobeRadius(nullptr), LobeExtentX(nullptr), LobeExtentY(nullptr), LobeExtentZ(nullptr)
+			, Roundness(nullptr), Volume(nullptr), InverseMass(nullptr), InverseInertiaX(nullptr), InverseInertiaY(nullptr), InverseInertiaZ(nullptr)
+			, AngularDragScale(nullptr), SurfaceZ(nullptr), SurfaceSlopeX(nullptr), SurfaceSlopeY(nullptr), WaterVelocityX(nullptr), WaterVelocityY(nullptr)
+			, Submerged(nullptr)
+		{
+		}
+
+		/* Split single buffer of FloatsPerInstance * Capacity floats */
+		static FInstanceBuffers FromBuffer(float* Buffer, int32_t Capacity)
+		{
+			float* Next = Buffer;
+			auto Take = [&Next, Capacity]() { float* Result = Next; Next += Capacity; return Result; };
+
+			FInstanceBuffers Buffers;
+			Buffers.PositionX = Take();
+			Buffers.PositionY = Take();
+			Buffers.PositionZ = Take();
+			Buffers.RotationX = Take();
+			Buffers.RotationY = Take();
+			Buffers.RotationZ = Take();
+			Buffers.RotationW = Take();
+			Buffers.VelocityX = Take();
+			Buffers.VelocityY = Take();
+			Buffers.VelocityZ = Take();
+			Buffers.AngularVelocityX = Take();
+			Buffers.AngularVelocityY = Take();
+			Buffers.AngularVelocityZ = Take();
+			Buffers.LobeOffsetX = Take();
+			Buffers.LobeOffsetY = Take();
+			Buffers.LobeRadius = Take();
+			Buffers.LobeExtentX = Take();
+			Buffers.LobeExtentY = Take();
+			Buffers.LobeExtentZ = Take();
+			Buffers.Roundness = Take();
+			Buffers.Volume = Take();
+			Buffers.InverseMass = Take();
+			Buffers.InverseInertiaX = Take();
+			Buffers.InverseInertiaY = Take();
+			Buffers.InverseInertiaZ = Take();
+			Buffers.AngularDragScale = Take();
+			Buffers.SurfaceZ = Take();
+			Buffers.SurfaceSlopeX = Take();
+			Buffers.SurfaceSlopeY = Take();
+			Buffers.WaterVelocityX = Take();
+			Buffers.WaterVelocityY = Take();
+			Buffers.Submerged = Take();
+			return Buffers;
+		}
+
+		/* Write shape of instance, state is left untouched */
+		void SetShape(int32_t Index, const FInstanceShape& Shape) const
+		{
+			LobeOffsetX[Index] = Shape.LobeOffsetX;
+			LobeOffsetY[Index] = Shape.LobeOffsetY;
+			LobeRadius[Index] = Shape.LobeRadius;
+			LobeExtentX[Index] = Shape.LobeExtent.X;
+			LobeExtentY[Index] = Shape.LobeExtent.Y;
+			LobeExtentZ[Index] = Shape.LobeExtent.Z;
+			Roundness[Index] = Shape.Roundness;
+			Volume[Index] = Shape.Volume;
+			InverseMass[Index] = Shape.Mass > 0.0f ? 1.0f / Shape.Mass : 0.0f;
+			InverseInertiaX[Index] = Shape.LocalInertia.X > 0.0f ? 1.0f / Shape.LocalInertia.X : 0.0f;
+			InverseInertiaY[Index] = Shape.LocalInertia.Y > 0.0f ? 1.0f / Shape.LocalInertia.Y : 0.0f;
+			InverseInertiaZ[Index] = Shape.LocalInertia.Z > 0.0f ? 1.0f / Shape.LocalInertia.Z : 0.0f;
+			AngularDragScale[Index] = Shape.AngularDragScale;
+		}
+
+		/* Write state of instance, inputs of next step start as still flat water at height 0 */
+		void SetState(int32_t Index, const FVec3& Position, const FQuat& Rotation, const FVec3& Velocity, const FVec3& AngularVelocity) const
+		{
+			PositionX[Index] = Position.X;
+			PositionY[Index] = Position.Y;
+			PositionZ[Index] = Position.Z;
+			RotationX[Index] = Rotation.X;
+			RotationY[Index] = Rotation.Y;
+			RotationZ[Index] = Rotation.Z;
+			RotationW[Index] = Rotation.W;
+			VelocityX[Index] = Velocity.X;
+			VelocityY[Index] = Velocity.Y;
+			VelocityZ[Index] = Velocity.Z;
+			AngularVelocityX[Index] = AngularVelocity.X;
+			AngularVelocityY[Index] = AngularVelocity.Y;
+			AngularVelocityZ[Index] = AngularVelocity.Z;
+			SurfaceZ[Index] = 0.0f;
+			SurfaceSlopeX[Index] = 0.0f;
+			SurfaceSlopeY[Index] = 0.0f;
+			WaterVelocityX[Index] = 0.0f;
+			WaterVelocityY[Index] = 0.0f;
+			Submerged[Index] = 0.0f;
+		}
+
+		/* Copy first NumInstances instances into other buffers, used when buffers grow */
+		void CopyTo(const FInstanceBuffers& Other, int32_t NumInstances) const
+		{
+			float* const* From = &PositionX;
+			float* const* To = &Other.PositionX;
+			for (int32_t i = 0; i < FloatsPerInstance; ++i)
+			{
+				std::copy(From[i], From[i] + NumInstances, To[i]);
+			}
+		}
+
+		/* Remove instance and move instances after it one place down, the same as removing instance of instanced static mesh */
+		void RemoveInstance(int32_t Index, int32_t NumInstances) const
+		{
+			float* const* Buffers = &PositionX;
+			for (int32_t i = 0; i < FloatsPerInstance; ++i)
+			{
+				std::copy(Buffers[i] + Index + 1, Buffers[i] + NumInstances, Buffers[i] + Index);
+			}
+		}
+	};
+
+	// CopyTo and RemoveInstance walk buffers as array of pointers
+	static_assert(sizeof(FInstanceBuffers) == FInstanceBuffers::FloatsPerInstance * sizeof(float*), "Every buffer of FInstanceBuffers has to be float pointer");
+
+	/* Constants of instance step shared by all instances */
+	struct FInstanceStepParams
+	{
+		/* Density, drag and gravity of water, Velocity is uniform current added to per instance water velocity */
+		FWaterParams Water;
+
+		/* Same meaning as FBodyParams::DensityOfBody, scales drag like for buoyant bodies */
+		float DensityOfBody;
+
+		/* Same meaning as damping of physics body */
+		float LinearDamping;
+		float AngularDamping;
+
+		/* Radians per second */
+		float MaxAngularVelocity;
+
+		FInstanceStepParams()
+			: DensityOfBody(500.0f), LinearDamping(0.01f), AngularDamping(0.0f), MaxAngularVelocity(26.0f)
+		{
+		}
+	};
+
+	/* Surface slopes along world X and Y from displacement slopes of surface height query.
+	 * Slopes are taken at undisplaced point P, surface point is P + D(P), so height slope is (I + dD.XY/dP)^-T * dD.Z/dP.
+	 *	@param Samples					Displacements with slopes from SampleSurfaceHeights
+	 *	@param OutSlopeX, OutSlopeY	(out)	NumSamples slopes of surface height
+	 */
+	inline void ComputeSurfaceSlopes(const FWaveSampleBuffers& Samples, int32_t NumSamples, float* OutSlopeX, float* OutSlopeY)
+	{
+		// Same limit as Newton step of SampleSurfaceHeights, folding surface keeps slope of displacement only
+		const float MIN_DETERMINANT = 0.05f;
+
+		for (int32_t i = 0; i < NumSamples; ++i)
+		{
+			const float A = 1.0f + Samples.SlopeXX[i];
+			const float B = Samples.SlopeXY[i];
+			const float D = 1.0f + Samples.SlopeYY[i];
+			const float Determinant = A * D - B * B;
+			const float InvDeterminant = 1.0f / std::max(Determinant, MIN_DETERMINANT);
+
+			OutSlopeX[i] = (D * Samples.SlopeZX[i] - B * Samples.SlopeZY[i]) * InvDeterminant;
+			OutSlopeY[i] = (A * Samples.SlopeZY[i] - B * Samples.SlopeZX[i]) * InvDeterminant;
+		}
+	}
+
+	/* Part of lobe volume below water, Depth of lobe center and Reach > 0 */
+	inline float ComputeLobeSubmerged(float Depth, float Reach, float Roundness)
+	{
+		const float T = std::min(std::max((Depth + Reach) / (2.0f * Reach), 0.0f), 1.0f);
+		return T + Roundness * (T * T * (3.0f - 2.0f * T) - T);
+	}
+
+	/* Single semi-implicit Euler step of all instances against water surface in their SurfaceZ, SurfaceSlope and WaterVelocity.
+	 * Buoyancy of lobes acts at lobe centers, drag acts at center like ComputeForces of buoyant bodies and is implicit,
+	 * so small instances stay stable at any frame time.
+	 *	@param Buffers		(in/out)	Instances, state is advanced and Submerged written
+	 *	@param NumInstances				Number of instances in Buffers
+	 *	@param Params					Water and damping shared by instances
+	 *	@param DeltaTime				Step length in seconds
+	 */
+	inline void StepInstances(const FInstanceBuffers& Buffers, int32_t NumInstances, const FInstanceStepParams& Params, float DeltaTime)
+	{
+		BUOYANCY_CORE_SCOPE(Instances);
+
+		// Smallest reach of lobe, keeps flat lobes of thin boxes from dividing by zero
+		const float MIN_REACH = 0.01f;
+
+		const float BuoyancyPerVolume = Params.Water.Density * -Params.Water.GravityZ * 0.25f;
+		const float LinearDragRate = Params.DensityOfBody * 0.0000001f * Params.Water.LinearDrag;
+		const float AngularDragRate = Params.DensityOfBody * 0.0000001f * Params.Water.AngularDrag;
+		const float LinearKeep = std::max(0.0f, 1.0f - Params.LinearDamping * DeltaTime);
+		const float AngularKeep = std::max(0.0f, 1.0f - Params.AngularDamping * DeltaTime);
+		const float MaxAngularSquared = Params.MaxAngularVelocity * Params.MaxAngularVelocity;
+		const float GravityStep = Params.Water.GravityZ * DeltaTime;
+		const float HalfStep = 0.5f * DeltaTime;
+
+		const FInstanceBuffers& B = Buffers;
+
+		BUOYANCY_CORE_IVDEP
+		for (int32_t i = 0; i < NumInstances; ++i)
+		{
+			const float QX = B.RotationX[i];
+			const float QY = B.RotationY[i];
+			const float QZ = B.RotationZ[i];
+			const float QW = B.RotationW[i];
+
+			// Columns of rotation matrix: world directions of local X, Y and Z
+			const float AxisXX = 1.0f - 2.0f * (QY * QY + QZ * QZ);
+			const float AxisXY = 2.0f * (QX * QY + QW * QZ);
+			const float AxisXZ = 2.0f * (QX * QZ - QW * QY);
+			const float AxisYX = 2.0f * (QX * QY - QW * QZ);
+			const float AxisYY = 1.0f - 2.0f * (QX * QX + QZ * QZ);
+			const float AxisYZ = 2.0f * (QY * QZ + QW * QX);
+			const float AxisZX = 2.0f * (QX * QZ + QW * QY);
+			const float AxisZY = 2.0f * (QY * QZ - QW * QX);
+			const float AxisZZ = 1.0f - 2.0f * (QX * QX + QY * QY);
+
+			const float Reach = std::max(B.LobeRadius[i] + std::fabs(AxisXZ) * B.LobeExtentX[i] + std::fabs(AxisYZ) * B.LobeExtentY[i] + std::fabs(AxisZZ) * B.LobeExtentZ[i], MIN_REACH);
+
+			// Lobe centers are Center +- OffsetX * AxisX +- OffsetY * AxisY
+			const float OffsetX = B.LobeOffsetX[i];
+			const float OffsetY = B.LobeOffsetY[i];
+			const float LobeXX = OffsetX * AxisXX, LobeXY = OffsetX * AxisXY, LobeXZ = OffsetX * AxisXZ;
+			const float LobeYX = OffsetY * AxisYX, LobeYY = OffsetY * AxisYY, LobeYZ = OffsetY * AxisYZ;
+
+			// Surface is plane through SurfaceZ with instance slopes, lobe depth is its height below plane
+			const float SlopeX = B.SurfaceSlopeX[i];
+			const float SlopeY = B.SurfaceSlopeY[i];
+			const float Depth = B.SurfaceZ[i] - B.PositionZ[i];
+			const float DepthX = SlopeX * LobeXX + SlopeY * LobeXY - LobeXZ;
+			const float DepthY = SlopeX * LobeYX + SlopeY * LobeYY - LobeYZ;
+			const float Roundness = B.Roundness[i];
+
+			const float SubmergedPP = ComputeLobeSubmerged(Depth + DepthX + DepthY, Reach, Roundness);
+			const float SubmergedPN = ComputeLobeSubmerged(Depth + DepthX - DepthY, Reach, Roundness);
+			const float SubmergedNP = ComputeLobeSubmerged(Depth - DepthX + DepthY, Reach, Roundness);
+			const float SubmergedNN = ComputeLobeSubmerged(Depth - DepthX - DepthY, Reach, Roundness);
+
+			const float Submerged = 0.25f * (SubmergedPP + SubmergedPN + SubmergedNP + SubmergedNN);
+
+			// Vertical lobe forces at lever (+-LobeX +- LobeY) give torque (LeverY * F, -LeverX * F, 0)
+			const float ForceScale = BuoyancyPerVolume * B.Volume[i];
+			const float ForceZ = 4.0f * ForceScale * Submerged;
+			const float SumX = ForceScale * ((SubmergedPP + SubmergedPN) - (SubmergedNP + SubmergedNN));
+			const float SumY = ForceScale * ((SubmergedPP + SubmergedNP) - (SubmergedPN + SubmergedNN));
+			const float TorqueX = LobeXY * SumX + LobeYY * SumY;
+			const float TorqueY = -(LobeXX * SumX + LobeYX * SumY);
+
+			// Linear velocity, drag towards water velocity is implicit
+			const float InverseMass = B.InverseMass[i];
+			const float LinearDrag = LinearDragRate * Submerged * DeltaTime;
+			const float LinearScale = LinearKeep / (1.0f + LinearDrag);
+			const float WaterX = Params.Water.Velocity.X + B.WaterVelocityX[i];
+			const float WaterY = Params.Water.Velocity.Y + B.WaterVelocityY[i];
+			const float WaterZ = Params.Water.Velocity.Z;
+
+			const float VelocityX = (B.VelocityX[i] + LinearDrag * WaterX) * LinearScale;
+			const float VelocityY = (B.VelocityY[i] + LinearDrag * WaterY) * LinearScale;
+			const float VelocityZ = (B.VelocityZ[i] + GravityStep + ForceZ * InverseMass * DeltaTime + LinearDrag * WaterZ) * LinearScale;
+
+			// Angular velocity in local space, where inertia is diagonal
+			const float OmegaX = B.AngularVelocityX[i];
+			const float OmegaY = B.AngularVelocityY[i];
+			const float OmegaZ = B.AngularVelocityZ[i];
+
+			const float LocalOmegaX = AxisXX * OmegaX + AxisXY * OmegaY + AxisXZ * OmegaZ + AxisXX * TorqueX * B.InverseInertiaX[i] * DeltaTime + AxisXY * TorqueY * B.InverseInertiaX[i] * DeltaTime;
+			const float LocalOmegaY = AxisYX * OmegaX + AxisYY * OmegaY + AxisYZ * OmegaZ + AxisYX * TorqueX * B.InverseInertiaY[i] * DeltaTime + AxisYY * TorqueY * B.InverseInertiaY[i] * DeltaTime;
+			const float LocalOmegaZ = AxisZX * OmegaX + AxisZY * OmegaY + AxisZZ * OmegaZ + AxisZX * TorqueX * B.InverseInertiaZ[i] * DeltaTime + AxisZY * TorqueY * B.InverseInertiaZ[i] * DeltaTime;
+
+			const float AngularDrag = AngularDragRate * B.AngularDragScale[i] * Submerged * DeltaTime;
+			const float AngularScale = AngularKeep / (1.0f + AngularDrag);
+
+			float NewOmegaX = (AxisXX * LocalOmegaX + AxisYX * LocalOmegaY + AxisZX * LocalOmegaZ) * AngularScale;
+			float NewOmegaY = (AxisXY * LocalOmegaX + AxisYY * LocalOmegaY + AxisZY * LocalOmegaZ) * AngularScale;
+			float NewOmegaZ = (AxisXZ * LocalOmegaX + AxisYZ * LocalOmegaY + AxisZZ * LocalOmegaZ) * AngularScale;
+
+			const float OmegaSquared = NewOmegaX * NewOmegaX + NewOmegaY * NewOmegaY + NewOmegaZ * NewOmegaZ;
+			const float Clamp = std::sqrt(MaxAngularSquared / std::max(OmegaSquared, MaxAngularSquared));
+			NewOmegaX *= Clamp;
+			NewOmegaY *= Clamp;
+			NewOmegaZ *= Clamp;
+
+			B.PositionX[i] += VelocityX * DeltaTime;
+			B.PositionY[i] += VelocityY * DeltaTime;
+			B.PositionZ[i] += VelocityZ * DeltaTime;
+			B.VelocityX[i] = VelocityX;
+			B.VelocityY[i] = VelocityY;
+			B.VelocityZ[i] = VelocityZ;
+			B.AngularVelocityX[i] = NewOmegaX;
+			B.AngularVelocityY[i] = NewOmegaY;
+			B.AngularVelocityZ[i] = NewOmegaZ;
+			B.Submerged[i] = Submerged;
+
+			// dq/dt = 0.5 * w * q
+			const float SpinX = NewOmegaX * QW + NewOmegaY * QZ - NewOmegaZ * QY;
+			const float SpinY = NewOmegaY * QW + NewOmegaZ * QX - NewOmegaX * QZ;
+			const float SpinZ = NewOmegaZ * QW + NewOmegaX * QY - NewOmegaY * QX;
+			const float SpinW = -(NewOmegaX * QX + NewOmegaY * QY + NewOmegaZ * QZ);
+
+			const float RotationX = QX + SpinX * HalfStep;
+			const float RotationY = QY + SpinY * HalfStep;
+			const float RotationZ = QZ + SpinZ * HalfStep;
+			const float RotationW = QW + SpinW * HalfStep;
+			const float InvSize = 1.0f / std::sqrt(RotationX * RotationX + RotationY * RotationY + RotationZ * RotationZ + RotationW * RotationW);
+
+			B.RotationX[i] = RotationX * InvSize;
+			B.RotationY[i] = RotationY * InvSize;
+			B.RotationZ[i] = RotationZ * InvSize;
+			B.RotationW[i] = RotationW * InvSize;
+		}
+	}
+}
@@ -0,0 +1,461 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "BuoyancyCore.h"
+
+/* Forces from pressure on every submerged triangle of hull instead of single force at submerged centroid.
+ * Hydrostatic pressure gives the same buoyancy as volume solve, dynamic pressure on triangles gives lift,
+ * speed dependent resistance and slamming. Costs more than volume solve, meant for few important bodies.
+ * Triangles are clipped into structure of arrays first, so pressure of all of them is one loop without branches.
+ */
+namespace BuoyancyCore
+{
+	/* Coefficients of pressure model, constant for body */
+	struct FPressureParams
+	{
+		/* Drag coefficient of faces moving into water, scales dynamic pressure 0.5 * Density * Speed^2 */
+		float PressureDrag;
+
+		/* Drag coefficient of faces moving away from water, low pressure behind them pulls them back */
+		float SuctionDrag;
+
+		/* Below this speed (cm/s) drag grows linearly instead of quadratically, keeps slow bodies damped */
+		float LinearDragSpeed;
+
+		/* Scale of ITTC 1957 skin friction line, 0 -> no viscous resistance */
+		float SkinFriction;
+
+		/* Kinematic viscosity of water in cm^2/s */
+		float KinematicViscosity;
+
+		/* Fraction of force stopping wetted part of hull within one update, applied when hull hits water */
+		float Slamming;
+
+		/* Change of swept volume rate per hull area (cm/s^2) at which slamming reaches full strength */
+		float SlammingMaxRate;
+
+		/* Slamming grows with (rate / SlammingMaxRate) ^ SlammingPower */
+		float SlammingPower;
+
+		/* Total area of hull, see ComputeSurfaceArea */
+		float SurfaceArea;
+
+		FPressureParams()
+			: PressureDrag(1.0f), SuctionDrag(0.5f), LinearDragSpeed(100.0f), SkinFriction(1.0f), KinematicViscosity(0.01f)
+			, Slamming(0.5f), SlammingMaxRate(10000.0f), SlammingPower(2.0f), SurfaceArea(0.0f)
+		{
+		}
+	};
+
+	/* Caller owned buffers of pressure solve. Mesh triangle is clipped into at most 2 submerged triangles,
+	 * all submerged triangle buffers hold 2 * Mesh.NumTriangles values.
+	 */
+	struct FPressureScratch
+	{
+		static const int32_t FloatsPerVertex = 3;
+		static const int32_t FloatsPerTriangle = 2 * 14 + 1;
+
+		/* Vertices rotated to world, relative to center of mass */
+		float* VertexX;
+		float* VertexY;
+		float* VertexZ;
+
+		/* Centroid of submerged triangle relative to center of mass */
+		float* CenterX;
+		float* CenterY;
+		float* CenterZ;
+
+		/* Point hydrostatic force of submerged triangle acts at, pressure grows with depth */
+		float* PressureCenterX;
+		float* PressureCenterY;
+		float* PressureCenterZ;
+
+		/* Area times outward normal */
+		float* AreaX;
+		float* AreaY;
+		float* AreaZ;
+
+		/* Mean depth of submerged triangle, negative */
+		float* Depth;
+
+		/* Dynamic and viscous force of submerged triangle */
+		float* ForceX;
+		float* ForceY;
+		float* ForceZ;
+
+		/* Area times speed of submerged triangle into water */
+		float* Sweep;
+
+		/* Mesh triangle submerged triangle was clipped from */
+		int32_t* Source;
+
+		/* Mesh.NumTriangles sums of Sweep of submerged triangles */
+		float* SourceSweep;
+
+		FPressureScratch()
+			: VertexX(nullptr), VertexY(nullptr), VertexZ(nullptr), CenterX(nullptr), CenterY(nullptr), CenterZ(nullptr)
+			, PressureCenterX(nullptr), PressureCenterY(nullptr), PressureCenterZ(nullptr), AreaX(nullptr), AreaY(nullptr), AreaZ(nullptr)
+			, Depth(nullptr), ForceX(nullptr), ForceY(nullptr), ForceZ(nullptr), Sweep(nullptr), Source(nullptr), SourceSweep(nullptr)
+		{
+		}
+
+		static int32_t GetNumFloats(int32_t NumVertices, int32_t NumTriangles)
+		{
+			return FloatsPerVertex * NumVertices + FloatsPerTriangle * NumTriangles;
+		}
+
+		/* Split single buffer of GetNumFloats floats, Sources holds 2 * NumTriangles ints */
+		static FPressureScratch FromBuffer(float* Buffer, int32_t* Sources, int32_t NumVertices, int32_t NumTriangles)
+		{
+			float* Next = Buffer;
+			auto Take = [&Next](int32_t Num) { float* Result = Next; Next += Num; return Result; };
+
+			FPressureScratch Scratch;
+			Scratch.VertexX = Take(NumVertices);
+			Scratch.VertexY = Take(NumVertices);
+			Scratch.VertexZ = Take(NumVertices);
+			Scratch.CenterX = Take(2 * NumTriangles);
+			Scratch.CenterY = Take(2 * NumTriangles);
+			Scratch.CenterZ = Take(2 * NumTriangles);
+			Scratch.PressureCenterX = Take(2 * NumTriangles);
+			Scratch.PressureCenterY = Take(2 * NumTriangles);
+			Scratch.PressureCenterZ = Take(2 * NumTriangles);
+			Scratch.AreaX = Take(2 * NumTriangles);
+			Scratch.AreaY = Take(2 * NumTriangles);
+			Scratch.AreaZ = Take(2 * NumTriangles);
+			Scratch.Depth = Take(2 * NumTriangles);
+			Scratch.ForceX = Take(2 * NumTriangles);
+			Scratch.ForceY = Take(2 * NumTriangles);
+			Scratch.ForceZ = Take(2 * NumTriangles);
+			Scratch.Sweep = Take(2 * NumTriangles);
+			Scratch.SourceSweep = Take(NumTriangles);
+			Scratch.Source = Sources;
+			return Scratch;
+		}
+	};
+
+	/* Swept volume of hull triangles in last solve, slamming comes from its change between solves */
+	struct FPressureHistory
+	{
+		/* Mesh.NumTriangles values */
+		float* Sweep;
+
+		/* False -> solve only records Sweep */
+		bool bValid;
+
+		FPressureHistory()
+			: Sweep(nullptr), bValid(false)
+		{
+		}
+	};
+
+	/* Max by value, std::max returns reference and keeps compiler from turning loops using it into vector selects */
+	inline float FloatMax(float A, float B)
+	{
+		return A > B ? A : B;
+	}
+
+	/* Total area of mesh surface */
+	inline float ComputeSurfaceArea(const FMeshView& Mesh)
+	{
+		float Area = 0.0f;
+
+		for (int32_t TriIndex = 0; TriIndex < Mesh.NumTriangles; ++TriIndex)
+		{
+			const FVec3 V0 = Mesh.GetVertex(Mesh.Indices[(TriIndex * 3) + 0]);
+			const FVec3 V1 = Mesh.GetVertex(Mesh.Indices[(TriIndex * 3) + 1]);
+			const FVec3 V2 = Mesh.GetVertex(Mesh.Indices[(TriIndex * 3) + 2]);
+
+			Area += 0.5f * FVec3::Cross(V1 - V0, V2 - V0).Size();
+		}
+
+		return Area;
+	}
+
+	/* Skin friction coefficient of ITTC 1957 line, Reynolds number is clamped where line stops making sense */
+	inline float ComputeSkinFriction(float Speed, float Length, float KinematicViscosity)
+	{
+		const float Reynolds = std::max(Speed * Length / std::max(KinematicViscosity, 1e-8f), 1e4f);
+		const float LogReynolds = std::log10(Reynolds) - 2.0f;
+
+		return 0.075f / (LogReynolds * LogReynolds);
+	}
+
+	/* Add submerged triangle, pressure center weights vertices by depth: integral of p * x over triangle is
+	 * Area / 12 * (sum p_i * x_i + sum p_i * sum x_i) for pressure p linear over triangle.
+	 */
+	inline void AddSubmergedTriangle(const FPressureScratch& Scratch, int32_t& NumSubmerged, int32_t Source, const FVec3& V0, const FVec3& V1, const FVec3& V2, float D0, float D1, float D2)
+	{
+		const int32_t i = NumSubmerged++;
+
+		const FVec3 Sum = V0 + V1 + V2;
+		const FVec3 Area = 0.5f * FVec3::Cross(V1 - V0, V2 - V0);
+		const float DepthSum = D0 + D1 + D2;
+
+		// Triangle touching surface has no pressure, its center doesn't matter
+		const FVec3 PressureCenter = DepthSum < -1e-6f ? (V0 * D0 + V1 * D1 + V2 * D2 + Sum * DepthSum) * (1.0f / (4.0f * DepthSum)) : Sum * (1.0f / 3.0f);
+
+		Scratch.CenterX[i] = Sum.X * (1.0f / 3.0f);
+		Scratch.CenterY[i] = Sum.Y * (1.0f / 3.0f);
+		Scratch.CenterZ[i] = Sum.Z * (1.0f / 3.0f);
+		Scratch.PressureCenterX[i] = PressureCenter.X;
+		Scratch.PressureCenterY[i] = PressureCenter.Y;
+		Scratch.PressureCenterZ[i] = PressureCenter.Z;
+		Scratch.AreaX[i] = Area.X;
+		Scratch.AreaY[i] = Area.Y;
+		Scratch.AreaZ[i] = Area.Z;
+		Scratch.Depth[i] = DepthSum * (1.0f / 3.0f);
+		Scratch.Source[i] = Source;
+	}
+
+	/* Clip every triangle below water into submerged triangles, keeping winding of mesh
+	 *	@param Depths					Mesh.NumVertices signed depths, negative is under water
+	 *	@return							Number of submerged triangles
+	 */
+	inline int32_t ClipSubmergedTriangles(const FMeshView& Mesh, const float* Depths, const FPressureScratch& Scratch)
+	{
+		BUOYANCY_CORE_SCOPE(Clip);
+
+		int32_t NumSubmerged = 0;
+		const int32_t* Indices = Mesh.Indices;
+
+		for (int32_t TriIndex = 0; TriIndex < Mesh.NumTriangles; ++TriIndex)
+		{
+			int32_t I[3] = { Indices[(TriIndex * 3) + 0], Indices[(TriIndex * 3) + 1], Indices[(TriIndex * 3) + 2] };
+
+			const int32_t NumWet = (Depths[I[0]] < 0.0f ? 1 : 0) + (Depths[I[1]] < 0.0f ? 1 : 0) + (Depths[I[2]] < 0.0f ? 1 : 0);
+
+			if (NumWet == 0)
+			{
+				continue;
+			}
+
+			if (NumWet == 1 || NumWet == 2)
+			{
+				// Rotate vertices so the odd one is first, rotation keeps winding
+				const bool bOddIsWet = NumWet == 1;
+				while ((Depths[I[0]] < 0.0f) != bOddIsWet)
+				{
+					const int32_t First = I[0];
+					I[0] = I[1];
+					I[1] = I[2];
+					I[2] = First;
+				}
+			}
+
+			const FVec3 V0(Scratch.VertexX[I[0]], Scratch.VertexY[I[0]], Scratch.VertexZ[I[0]]);
+			const FVec3 V1(Scratch.VertexX[I[1]], Scratch.VertexY[I[1]], Scratch.VertexZ[I[1]]);
+			const FVec3 V2(Scratch.VertexX[I[2]], Scratch.VertexY[I[2]], Scratch.VertexZ[I[2]]);
+			const float D0 = Depths[I[0]];
+			const float D1 = Depths[I[1]];
+			const float D2 = Depths[I[2]];
+
+			if (NumWet == 3)
+			{
+				AddSubmergedTriangle(Scratch, NumSubmerged, TriIndex, V0, V1, V2, D0, D1, D2);
+				continue;
+			}
+
+			// Points where edges from odd vertex cross the surface
+			const FVec3 Cut1 = V0 + (D0 / (D0 - D1)) * (V1 - V0);
+			const FVec3 Cut2 = V0 + (D0 / (D0 - D2)) * (V2 - V0);
+
+			if (NumWet == 1)
+			{
+				AddSubmergedTriangle(Scratch, NumSubmerged, TriIndex, V0, Cut1, Cut2, D0, 0.0f, 0.0f);
+			}
+			else
+			{
+				AddSubmergedTriangle(Scratch, NumSubmerged, TriIndex, Cut1, V1, V2, 0.0f, D1, D2);
+				AddSubmergedTriangle(Scratch, NumSubmerged, TriIndex, Cut1, V2, Cut2, 0.0f, D2, 0.0f);
+			}
+		}
+
+		return NumSubmerged;
+	}
+
+	/* Dynamic pressure and viscous force of every submerged triangle, see FPressureScratch for buffers.
+	 * Loop has no branches and buffers never overlap, so compiler turns it into vector code.
+	 *	@param RelativeVelocity			Velocity of center of mass relative to water
+	 *	@param AngularVelocity			Radians per second
+	 *	@param SkinFriction				0.5 * Density * friction coefficient
+	 */
+	inline void ComputeTriangleForces(const float* __restrict CenterX, const float* __restrict CenterY, const float* __restrict CenterZ,
+		const float* __restrict AreaX, const float* __restrict AreaY, const float* __restrict AreaZ,
+		float* __restrict ForceX, float* __restrict ForceY, float* __restrict ForceZ, float* __restrict Sweep, int32_t NumSubmerged,
+		const FPressureParams& Pressure, float Density, const FVec3& RelativeVelocity, const FVec3& AngularVelocity, float SkinFriction)
+	{
+		const float HalfDensity = 0.5f * Density;
+		const float PressureDrag = Pressure.PressureDrag;
+		const float SuctionDrag = Pressure.SuctionDrag;
+		const float LinearDragSpeed = Pressure.LinearDragSpeed;
+		const float LinearX = RelativeVelocity.X, LinearY = RelativeVelocity.Y, LinearZ = RelativeVelocity.Z;
+		const float AngularX = AngularVelocity.X, AngularY = AngularVelocity.Y, AngularZ = AngularVelocity.Z;
+
+		for (int32_t i = 0; i < NumSubmerged; ++i)
+		{
+			const float Area = std::sqrt(AreaX[i] * AreaX[i] + AreaY[i] * AreaY[i] + AreaZ[i] * AreaZ[i]);
+			const float InvArea = 1.0f / FloatMax(Area, 1e-12f);
+			const float NormalX = AreaX[i] * InvArea;
+			const float NormalY = AreaY[i] * InvArea;
+			const float NormalZ = AreaZ[i] * InvArea;
+
+			// Velocity of triangle through water
+			const float VelocityX = LinearX + AngularY * CenterZ[i] - AngularZ * CenterY[i];
+			const float VelocityY = LinearY + AngularZ * CenterX[i] - AngularX * CenterZ[i];
+			const float VelocityZ = LinearZ + AngularX * CenterY[i] - AngularY * CenterX[i];
+
+			const float Speed = std::sqrt(VelocityX * VelocityX + VelocityY * VelocityY + VelocityZ * VelocityZ);
+			const float NormalSpeed = VelocityX * NormalX + VelocityY * NormalY + VelocityZ * NormalZ;
+			const float CosAngle = NormalSpeed / FloatMax(Speed, 1e-6f);
+
+			// Faces moving into water are pushed back, faces moving away are pulled back
+			const float DynamicPressure = HalfDensity * Speed * FloatMax(Speed, LinearDragSpeed);
+			const float FacePressure = DynamicPressure * (PressureDrag * FloatMax(CosAngle, 0.0f) - SuctionDrag * FloatMax(-CosAngle, 0.0f));
+
+			// Friction acts against tangential part of velocity
+			const float TangentX = VelocityX - NormalSpeed * NormalX;
+			const float TangentY = VelocityY - NormalSpeed * NormalY;
+			const float TangentZ = VelocityZ - NormalSpeed * NormalZ;
+			const float Friction = SkinFriction * std::sqrt(TangentX * TangentX + TangentY * TangentY + TangentZ * TangentZ) * Area;
+
+			ForceX[i] = -FacePressure * AreaX[i] - Friction * TangentX;
+			ForceY[i] = -FacePressure * AreaY[i] - Friction * TangentY;
+			ForceZ[i] = -FacePressure * AreaZ[i] - Friction * TangentZ;
+			Sweep[i] = Area * FloatMax(NormalSpeed, 0.0f);
+		}
+	}
+
+	/* Slamming of submerged triangles whose hull triangle sweeps water faster than in last solve, added to their Force.
+	 * Slamming force would stop triangle's share of body mass within DeltaTime, scaled by how fast sweep grew.
+	 *	@param Mass						Mass of body
+	 *	@param DeltaTime				Time since last solve
+	 *	@param History		(in/out)	Sweep of last solve, receives sweep of this one
+	 */
+	inline void AddSlammingForces(const FMeshView& Mesh, const FPressureScratch& Scratch, int32_t NumSubmerged, const FPressureParams& Pressure, float Mass, float DeltaTime, FPressureHistory& History)
+	{
+		std::fill(Scratch.SourceSweep, Scratch.SourceSweep + Mesh.NumTriangles, 0.0f);
+
+		for (int32_t i = 0; i < NumSubmerged; ++i)
+		{
+			Scratch.SourceSweep[Scratch.Source[i]] += Scratch.Sweep[i];
+		}
+
+		if (History.bValid && DeltaTime > 0.0f && Pressure.Slamming > 0.0f && Pressure.SurfaceArea > 0.0f)
+		{
+			const float RateScale = 1.0f / (Pressure.SurfaceArea * DeltaTime * std::max(Pressure.SlammingMaxRate, 1e-6f));
+			const float StopScale = Pressure.Slamming * Mass / (Pressure.SurfaceArea * DeltaTime);
+
+			for (int32_t i = 0; i < NumSubmerged; ++i)
+			{
+				const int32_t Source = Scratch.Source[i];
+				const float Rate = (Scratch.SourceSweep[Source] - History.Sweep[Source]) * RateScale;
+
+				if (Rate <= 0.0f || Scratch.Sweep[i] <= 0.0f)
+				{
+					continue;
+				}
+
+				const float Area = std::sqrt(Scratch.AreaX[i] * Scratch.AreaX[i] + Scratch.AreaY[i] * Scratch.AreaY[i] + Scratch.AreaZ[i] * Scratch.AreaZ[i]);
+
+				// Force acts against normal, which is area vector divided by area
+				const float Scale = std::pow(std::min(Rate, 1.0f), Pressure.SlammingPower) * StopScale * Scratch.Sweep[i] / Area;
+
+				Scratch.ForceX[i] -= Scale * Scratch.AreaX[i];
+				Scratch.ForceY[i] -= Scale * Scratch.AreaY[i];
+				Scratch.ForceZ[i] -= Scale * Scratch.AreaZ[i];
+			}
+		}
+
+		std::copy(Scratch.SourceSweep, Scratch.SourceSweep + Mesh.NumTriangles, History.Sweep);
+		History.bValid = true;
+	}
+
+	/* Sum hydrostatic and triangle forces into force and torque at center of mass
+	 *	@param HydrostaticScale			Pressure per depth, Density * -GravityZ
+	 *	@return							Submerged volume, exact for planar surface
+	 */
+	inline float SumPressureForces(const FPressureScratch& Scratch, int32_t NumSubmerged, float HydrostaticScale, const FBodyState& State, FForces& Forces)
+	{
+		float Volume = 0.0f;
+		FVec3 Force;
+		FVec3 Torque;
+
+		for (int32_t i = 0; i < NumSubmerged; ++i)
+		{
+			const FVec3 Area(Scratch.AreaX[i], Scratch.AreaY[i], Scratch.AreaZ[i]);
+			const FVec3 Center(Scratch.CenterX[i], Scratch.CenterY[i], Scratch.CenterZ[i]);
+			const FVec3 PressureCenter(Scratch.PressureCenterX[i], Scratch.PressureCenterY[i], Scratch.PressureCenterZ[i]);
+
+			// Depth is negative, hydrostatic force pushes against outward normal
+			const FVec3 HydrostaticForce = Area * (HydrostaticScale * Scratch.Depth[i]);
+			const FVec3 TriangleForce(Scratch.ForceX[i], Scratch.ForceY[i], Scratch.ForceZ[i]);
+
+			Volume += Scratch.Depth[i] * Area.Z;
+			Force += HydrostaticForce + TriangleForce;
+			Torque += FVec3::Cross(PressureCenter, HydrostaticForce) + FVec3::Cross(Center, TriangleForce);
+		}
+
+		Forces = FForces();
+		Forces.bHasForce = NumSubmerged > 0;
+		Forces.Force = Force;
+		Forces.ForceLocation = State.CenterOfMass;
+		Forces.Torque = Torque;
+
+		return std::max(Volume, 0.0f);
+	}
+
+	/* Pressure solve of single body against non planar water surface
+	 *	@param Mesh						Buoyant mesh
+	 *	@param State					Current state of body
+	 *	@param Depths					Mesh.NumVertices vertical depths of vertices placed at center of mass, see ComputeSurfaceDepths
+	 *	@param DeltaTime				Time since last solve of body
+	 *	@param Scratch		(scratch)	Buffers for mesh, see FPressureScratch::FromBuffer
+	 *	@param History		(in/out)	Sweep of last solve, null -> no slamming
+	 *	@param Forces		(out)		Sum of forces of triangles, acting at center of mass
+	 *	@return							Submerged volume
+	 */
+	inline float SolveBodyPressureSurface(const FMeshView& Mesh, const FBodyState& State, const FBodyParams& Body, const FWaterParams& Water, const FPressureParams& Pressure,
+		const float* Depths, float DeltaTime, const FPressureScratch& Scratch, FPressureHistory* History, FForces& Forces)
+	{
+		const float DegreesToRadians = 3.1415926535897932f / 180.0f;
+
+		TransformVertices(Mesh, State.Rotation, FVec3(), Scratch.VertexX, Scratch.VertexY, Scratch.VertexZ);
+
+		const int32_t NumSubmerged = ClipSubmergedTriangles(Mesh, Depths, Scratch);
+
+		const FVec3 RelativeVelocity = State.LinearVelocity - Water.Velocity;
+
+		// Friction coefficient is one for whole hull, from its length and speed
+		const float SkinFriction = 0.5f * Water.Density * Pressure.SkinFriction * ComputeSkinFriction(RelativeVelocity.Size(), Body.BodyLengthX, Pressure.KinematicViscosity);
+
+		ComputeTriangleForces(Scratch.CenterX, Scratch.CenterY, Scratch.CenterZ, Scratch.AreaX, Scratch.AreaY, Scratch.AreaZ, Scratch.ForceX, Scratch.ForceY, Scratch.ForceZ, Scratch.Sweep,
+			NumSubmerged, Pressure, Water.Density, RelativeVelocity, State.AngularVelocity * DegreesToRadians, SkinFriction);
+
+		// Dry body still records its sweep, hitting water in next solve is what slams
+		if (History)
+		{
+			AddSlammingForces(Mesh, Scratch, NumSubmerged, Pressure, State.Mass, DeltaTime, *History);
+		}
+
+		return SumPressureForces(Scratch, NumSubmerged, Water.Density * -Water.GravityZ, State, Forces);
+	}
+
+	/* Pressure solve of single body against plane fitted through surface points, inputs match SolveBody
+	 *	@param Depths		(scratch)	Mesh.NumVertices floats
+	 */
+	inline float SolveBodyPressure(const FMeshView& Mesh, const FBodyState& State, const FBodyParams& Body, const FWaterParams& Water, const FPressureParams& Pressure,
+		const FVec3* SurfacePoints, int32_t NumSurfacePoints, float* Depths, float DeltaTime, const FPressureScratch& Scratch, FPressureHistory* History, FForces& Forces)
+	{
+		const FWaterPlane Plane = FitPlane(SurfacePoints, NumSurfacePoints);
+
+		// Mesh is treated as if its origin was at center of mass
+		const FVec3 Normal = State.Rotation.Inverse().RotateVector(Plane.Normal);
+		const float Offset = FVec3::Dot(Plane.Normal, Plane.Location - State.CenterOfMass);
+
+		ComputePlaneDepths(Mesh, Normal, Offset, Depths);
+
+		return SolveBodyPressureSurface(Mesh, State, Body, Water, Pressure, Depths, DeltaTime, Scratch, History, Forces);
+	}
+}
@@ -5,8 +5,11 @@
 #include "Misc/BuoyancyTypes.h"
 #include "Misc/BuoyancyHelper.h"
 #include "Ocean/OceanManager.h"
+#include "BuoyancyCore/FixedStep.h"
 #include "ActorBuoyant.generated.h"
 
+class ABuoyancyManager;
+
 /**
  * 
  */
@@ -25,29 +28,179 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Buoyancy)
 	AOceanManager* CurrentOceanManager;
 
+	/* Should buoyancy be evaluated once per frame or in every physics substep? */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Buoyancy)
+	EBuoyancyUpdateMode BuoyancyUpdateMode;
+
+	/* Should per frame buoyancy be solved together with other bodies by buoyancy manager instead of in own Tick? */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Buoyancy)
+	bool bUseBuoyancyManager;
+
+	/* Should clipping test points be generated from footprint of buoyant mesh and ocean wave length?
+	 * Otherwise 3 x 3 points on bounding box midplane are used.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Buoyancy)
+	bool bAdaptiveClippingPoints;
+
+	/* Triangle budget of buoyancy proxy simplified from BuoyantMesh in editor. 0 -> use collision mesh of BuoyantMesh directly. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|Proxy", meta = (ClampMin = "0"))
+	int32 ProxyMaxTriangles;
+
+	/* Simplified mesh used for buoyancy and its error against BuoyantMesh, rebuilt when ProxyMaxTriangles or mesh changes */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Buoyancy|Proxy")
+	FBuoyancyProxy BuoyancyProxy;
+
+	/* Seconds between states sent by server to correct clients in FixedStep update mode */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|FixedStep", meta = (ClampMin = "0.1"))
+	float CorrectionInterval;
+
+	/* Most steps simulated in single frame in FixedStep update mode, body further behind ocean clock skips steps
+	 * and waits for correction from server
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|FixedStep", meta = (ClampMin = "1"))
+	int32 MaxCatchUpSteps;
+
+	/* Last state sent by server in FixedStep update mode */
+	UPROPERTY(ReplicatedUsing = OnRep_FixedStepCorrection)
+	FBuoyancyCorrection FixedStepCorrection;
+
+	/* Buoyancy manager solving this actor, null if actor solves itself */
+	UPROPERTY(Transient)
+	ABuoyancyManager* BuoyancyManager;
+
 	AActorBuoyant(const FObjectInitializer& ObjectInitializer);
 
-	/* Buoyant mesh we use to calculate buoyancy for actor. It should have low amount of vertices.
-	 * WARNING! Use only single mesh models! 
+	/* Buoyant mesh we use to calculate buoyancy for actor. It should have low amount of vertices, see ProxyMaxTriangles.
+	 * WARNING! Use only single mesh models! Bodies made of several hulls should list them in Sections.
 	 */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Buoyancy)
 	UStaticMeshComponent* BuoyantMesh;
 
-	/* Informations about buoyancy for BuoyantMesh */
+	/* Informations about buoyancy for BuoyantMesh, also settings every section starts with */
 	UPROPERTY()
 	FBuoyantBodyData BuoyancyData;
 
+	/* Hull sections of body, like hulls of catamaran or compartments of ship. All of them move with BuoyantMesh
+	 * and are solved together, forces of sections are summed into single force and torque of body.
+	 * Empty -> BuoyantMesh is the only hull.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|Sections")
+	TArray<FBuoyantSection> Sections;
+
+	/* Buoyancy data of every valid entry of Sections, built in BeginPlay */
+	TArray<FBuoyantBodyData> SectionData;
+
+	/* Build SectionData from Sections, geometry of every section is moved to space of BuoyantMesh */
+	void BuildSections(float ClippingPointSpacing, int32 MaxClippingPoints);
+
+	/* Compute forces of all sections for single body state and sum them */
+	void ComputeSectionForces(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, float Time, float GravityZ, FBuoyancyForces& Forces);
+
 	virtual void DrawDebugHelpers();
 
 	virtual AOceanManager* FindOceanManager();
 
 	virtual void SetClippingTestPoints(TArray<FVector>& ClippingPoints);
 
+	/* Evaluate buoyancy for single physics substep, called by physics for PerSubstep update mode */
+	virtual void SubstepTick(float DeltaTime, FBodyInstance* BodyInstance);
+
+	/* Build own integrator of FixedStep update mode from current state of BuoyantMesh and turn off its physics */
+	void InitFixedStep();
+
+	/* Simulate fixed step body up to ocean clock, send correction on server and move BuoyantMesh */
+	void TickFixedStep();
+
+	/* Simulate fixed step body up to TargetStep of ocean clock */
+	void AdvanceFixedStep(int32 TargetStep);
+
+	/* Replace state of fixed step body: first state, correction or skipped steps */
+	void ResetFixedStep(int32 Step, const BuoyancyCore::FBodyState& State);
+
+	/* Apply correction from server and simulate again up to current step */
+	UFUNCTION()
+	void OnRep_FixedStepCorrection();
+
+private:
+
+	FCalculateCustomPhysics OnCalculateCustomPhysics;
+
+	/* Wave time and gravity of current substep, set in Tick and advanced by SubstepTick */
+	float SubstepWaveTime;
+
+	float SubstepGravityZ;
+
+	/* Water of substeps copied from ocean in Tick, physics thread never reads ocean itself while game thread may change it */
+	FOceanWaterView SubstepWater;
+
+	/* Copy of wave spectrum SubstepWater points to */
+	FWaveSpectrum SubstepSpectrum;
+
+	/* Own simulation of FixedStep update mode, hulls point to meshes of BuoyancyData or SectionData */
+	TArray<BuoyancyCore::FFixedStepHull> FixedStepHulls;
+
+	BuoyancyCore::FFixedStepBody FixedStepBody;
+
+	BuoyancyCore::FBodyState FixedStepState;
+
+	TArray<float> FixedStepScratch;
+
+	/* Ocean clock step FixedStepState belongs to */
+	int32 FixedStep;
+
 public:
-	
+
+	virtual void PostInitProperties() override;
+
 	virtual void BeginPlay() override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/* Simplify BuoyantMesh into BuoyancyProxy with ProxyMaxTriangles budget, clears proxy when budget is 0 */
+	void RebuildBuoyancyProxy();
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void Tick(float DeltaSeconds) override;
 
 	UStaticMeshComponent* GetBuoyantMesh() const;
+
+	AOceanManager* GetOceanManager() const;
+
+	FBuoyantBodyData& GetBuoyancyData();
+
+	/* Number of hull sections solved for actor, 1 when Sections is empty */
+	int32 GetNumBuoyancySections() const;
+
+	/* Buoyancy data of hull section, BuoyancyData when Sections is empty */
+	FBuoyantBodyData& GetBuoyancySection(int32 Index);
+
+	/* World box around all hull sections */
+	FBox GetBuoyancyBounds() const;
+
+	/* Has actor everything needed to compute buoyancy? */
+	bool CanComputeBuoyancy() const;
+
+	/* Is body simulated by its own fixed step integrator? */
+	bool IsFixedStep() const;
+
+	const BuoyancyCore::FFixedStepBody& GetFixedStepBody() const;
+
+	const BuoyancyCore::FBodyState& GetFixedStepState() const;
+
+	int32 GetFixedStep() const;
+
+	virtual void NotifyHit(UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit) override;
+
+	/* Solve buoyancy fully on next update, call after applying forces to sleeping body */
+	UFUNCTION(BlueprintCallable, Category = Buoyancy)
+	void WakeBuoyancy();
+
+	/* Is body settled and bobbing on spring model instead of full solve? */
+	UFUNCTION(BlueprintCallable, Category = Buoyancy)
+	bool IsBuoyancySleeping() const;
 };
@@ -0,0 +1,90 @@
+// Implementation created by David 'vebski' Niemiec
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "Misc/BuoyancyTypes.h"
+#include "Ocean/OceanWater.h"
+#include "BuoyancyManager.generated.h"
+
+class AActorBuoyant;
+
+/**
+ * Solves buoyancy for all registered buoyant actors at once.
+ * Body states are gathered on game thread, forces of hull sections of all bodies are computed in parallel on worker threads
+ * and then summed and applied to bodies in a single serial pass.
+ * Every section writes only its own result and sums run serially in registration order, so results never depend on
+ * number of worker threads or on bParallelSolve.
+ */
+UCLASS()
+class VOLUMETRICBUOYANCY_API ABuoyancyManager : public AActor
+{
+	GENERATED_BODY()
+
+protected:
+
+	ABuoyancyManager(const FObjectInitializer& ObjectInitializer);
+
+	/* Should bodies be solved on worker threads? */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Buoyancy)
+	bool bParallelSolve;
+
+	/* Number of hull sections solved by single task, every body has at least one */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Buoyancy, meta = (ClampMin = "1"))
+	int32 BodiesPerTask;
+
+	/* Bodies skipped by broad phase in last frame, above waves */
+	UPROPERTY(VisibleInstanceOnly, Transient, BlueprintReadOnly, Category = "Buoyancy|Stats")
+	int32 NumDryBodies;
+
+	/* Bodies solved without clipping in last frame, below waves */
+	UPROPERTY(VisibleInstanceOnly, Transient, BlueprintReadOnly, Category = "Buoyancy|Stats")
+	int32 NumSubmergedBodies;
+
+	/* Bodies clipped against waves in last frame */
+	UPROPERTY(VisibleInstanceOnly, Transient, BlueprintReadOnly, Category = "Buoyancy|Stats")
+	int32 NumCrossingBodies;
+
+	/* Sleeping bodies in last frame, they are counted in phases above too */
+	UPROPERTY(VisibleInstanceOnly, Transient, BlueprintReadOnly, Category = "Buoyancy|Stats")
+	int32 NumSleepingBodies;
+
+	/* Registered bodies */
+	UPROPERTY(Transient)
+	TArray<AActorBuoyant*> Bodies;
+
+	/* Per body snapshots and results, same order as Bodies */
+	TArray<FBuoyantBodyState> BodyStates;
+
+	TArray<FBuoyancyForces> BodyForces;
+
+	/* Ocean manager of each body, null if body can't be solved this frame */
+	TArray<const AOceanManager*> BodyOceans;
+
+	/* Water of each body, made on game thread before workers start */
+	TArray<FOceanWaterView> BodyWaters;
+
+	/* Hull sections of all solvable bodies, sections of single body are next to each other */
+	TArray<FBuoyantBodyData*> SectionData;
+
+	TArray<FBuoyancyForces> SectionForces;
+
+	/* Body of every section */
+	TArray<int32> SectionBodies;
+
+	/* First section of every body, NumBodies + 1 entries */
+	TArray<int32> BodySectionStart;
+
+	/* Oceans whose wave cache has to be updated this frame */
+	TArray<AOceanManager*> CachedOceans;
+
+public:
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	void RegisterBody(AActorBuoyant* Body);
+
+	void UnregisterBody(AActorBuoyant* Body);
+
+	/* Find buoyancy manager in world, spawns new one if there is none */
+	static ABuoyancyManager* Get(UWorld* World);
+};
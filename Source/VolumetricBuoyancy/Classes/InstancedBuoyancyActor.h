@@ -0,0 +1,156 @@
+// Implementation created by David 'vebski' Niemiec
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Misc/BuoyancyTypes.h"
+#include "Ocean/OceanManager.h"
+#include "BuoyancyCore/InstancedBuoyancy.h"
+#include "InstancedBuoyancyActor.generated.h"
+
+/* Shape buoyancy of floating instances is computed for */
+UENUM(BlueprintType)
+enum class EBuoyantInstanceShape : uint8
+{
+	Sphere,
+	Box,
+
+	/* Capsule lying along local X */
+	Capsule
+};
+
+/**
+ * Thousands of small floating objects (debris, crates, barrels) as instances of single mesh.
+ * Instances have no physics bodies, buoyancy core steps all of them in one vectorized pass with its own integrator
+ * against analytic submerged volume of Shape, waves of all instances are one batched query per frame.
+ * Instance the player interacts with can be promoted to full buoyant actor, see PromoteInstance.
+ */
+UCLASS()
+class VOLUMETRICBUOYANCY_API AInstancedBuoyancyActor : public AActor
+{
+	GENERATED_BODY()
+
+protected:
+
+	AInstancedBuoyancyActor(const FObjectInitializer& ObjectInitializer);
+
+	/* Floating instances, instances placed in editor float from BeginPlay. It has no collision, per instance bodies would cost more than whole solve. */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Buoyancy)
+	UInstancedStaticMeshComponent* InstancedMesh;
+
+	/* Current ocean manager on the level */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Buoyancy)
+	AOceanManager* CurrentOceanManager;
+
+	/* Shape buoyancy of every instance is computed for */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|Instances")
+	EBuoyantInstanceShape Shape;
+
+	/* Size of Shape for instance of scale 1: sphere radius in X, half size of box, capsule half length of its cylinder in X and radius in Y.
+	 * Zero -> fitted to bounds of mesh.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|Instances")
+	FVector ShapeExtent;
+
+	/* Density of instances, 1000.0f is density of water */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|Instances", meta = (ClampMin = "1.0"))
+	float DensityOfBody;
+
+	/* Same meaning as damping of physics body */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|Instances", meta = (ClampMin = "0.0"))
+	float LinearDamping;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|Instances", meta = (ClampMin = "0.0"))
+	float AngularDamping;
+
+	/* Degrees per second */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|Instances", meta = (ClampMin = "0.0"))
+	float MaxAngularVelocity;
+
+	/* Longest step of instance integrator, longer frames are split into up to 4 substeps against waves of the frame */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|Instances", meta = (ClampMin = "0.001"))
+	float MaxStepTime;
+
+	/* Scale of min amplitude of wave LOD, see AOceanManager::GetWaveLOD. 0 means full spectrum. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|Instances", meta = (ClampMin = "0.0"))
+	float WaveLODBias;
+
+	/* Tilt instances with slope of waves. Only Gerstner waves queried with Newton iterations have slopes, otherwise water is level. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|Instances")
+	bool bFollowWaveSlopes;
+
+	/* Actor spawned in place of promoted instance with its transform and velocity, usually AActorBuoyant with the same mesh */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Buoyancy|Promotion")
+	TSubclassOf<AActor> PromotedClass;
+
+	/* Structure-of-arrays of state and shape of instances, split into Instances */
+	TArray<float> InstanceData;
+
+	BuoyancyCore::FInstanceBuffers Instances;
+
+	int32 NumInstances;
+
+	int32 InstanceCapacity;
+
+	/* Scale of every instance, shapes are built scaled and transforms keep it */
+	TArray<FVector> InstanceScales;
+
+	/* Surface heights of all instances, one query per frame */
+	FWaveSampleBatch WaveSamples;
+
+	/* Box around instance locations of last update and size of largest instance, wave LOD of whole field */
+	FBox InstanceBounds;
+
+	float LargestInstanceSize;
+
+	virtual AOceanManager* FindOceanManager();
+
+	/* Grow buffers of instances to hold at least Capacity instances */
+	void ReserveInstances(int32 Capacity);
+
+	/* Add instance to buffers only, instanced mesh has to have it already. Returns index of instance. */
+	int32 AddInstanceState(const FTransform& WorldTransform, const FVector& Velocity);
+
+	/* Surface heights, slopes and water velocities of all instances into inputs of next step */
+	void SampleWaves(float Time);
+
+	/* Move instances of InstancedMesh to simulated state */
+	void UpdateInstanceTransforms();
+
+public:
+
+	virtual void BeginPlay() override;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	UInstancedStaticMeshComponent* GetInstancedMesh() const;
+
+	/* Add floating instance to instanced mesh and simulation, returns its index or INDEX_NONE when simulation has no ShapeExtent */
+	UFUNCTION(BlueprintCallable, Category = Buoyancy)
+	int32 AddFloatingInstance(const FTransform& WorldTransform, FVector Velocity);
+
+	/* Remove instance, instances after it move one index down like in instanced mesh */
+	UFUNCTION(BlueprintCallable, Category = Buoyancy)
+	void RemoveFloatingInstance(int32 Index);
+
+	UFUNCTION(BlueprintCallable, Category = Buoyancy)
+	int32 GetNumFloatingInstances() const;
+
+	/* World transform of simulated instance */
+	UFUNCTION(BlueprintCallable, Category = Buoyancy)
+	FTransform GetFloatingInstanceTransform(int32 Index) const;
+
+	/* Index of instance closest to Location within MaxDistance, INDEX_NONE if there is none */
+	UFUNCTION(BlueprintCallable, Category = Buoyancy)
+	int32 FindClosestInstance(FVector Location, float MaxDistance) const;
+
+	/* Replace instance with actor of PromotedClass in its place, moving with its velocity when actor simulates physics.
+	 * Call it when the player interacts with instance: hits, grabs or collides with it. Returns spawned actor or null.
+	 */
+	UFUNCTION(BlueprintCallable, Category = Buoyancy)
+	AActor* PromoteInstance(int32 Index);
+
+	/* Promote every instance within Radius of Location, returns spawned actors */
+	UFUNCTION(BlueprintCallable, Category = Buoyancy)
+	TArray<AActor*> PromoteInstancesInRadius(FVector Location, float Radius);
+};
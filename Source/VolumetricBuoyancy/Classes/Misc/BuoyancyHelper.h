@@ -24,6 +24,14 @@ public:
 	 */
 	static float ComputeVolume(UStaticMeshComponent* BuoyantMesh, FVector& VolumeCentroid);
 
+	/* Simplify collision mesh of component into closed proxy of at most MaxTriangles and measure its error.
+	 * Slow, meant for editor. Returns false if component has no usable mesh.
+	 *	@param BuoyantMesh				Mesh to simplify
+	 *	@param MaxTriangles				Triangle budget of proxy
+	 *	@param Proxy		(out)		Simplified mesh and its error report
+	 */
+	static bool BuildBuoyancyProxy(UStaticMeshComponent* BuoyantMesh, int32 MaxTriangles, FBuoyancyProxy& Proxy);
+
 	/* Calculate and apply buoyancy
 	*	@param OceanManager				Current ocean manager on level
 	*	@param BuoyantMesh				Mesh for calculation
@@ -31,32 +39,83 @@ public:
 	*/
 	static void ComputeBuoyancy(AOceanManager* OceanManager, UStaticMeshComponent* BuoyantMesh, FBuoyantBodyData& BuoyantData);
 
-private:
+	/* Take snapshot of body state for ComputeBuoyancyForces. Game thread only.
+	*	@param BuoyantMesh				Simulated mesh
+	*	@param State		(out)		Current state of body
+	*/
+	static void GetBodyState(UStaticMeshComponent* BuoyantMesh, FBuoyantBodyState& State);
 
-	static float ComputeTetrahedronVolume(FVector& Center, FVector Point, FVector Vertex1, FVector Vertex2, FVector Vertex3);
+	/* Take snapshot of body state inside physics substep, uses BuoyantData.LocalCenterOfMass.
+	*	@param BodyInstance				Simulated body
+	*	@param BuoyantData				Data about body
+	*	@param State		(out)		Current state of body
+	*/
+	static void GetBodyState(FBodyInstance* BodyInstance, const FBuoyantBodyData& BuoyantData, FBuoyantBodyState& State);
 
-	static float ClipTriangle(FVector& Center, FVector Point, FVector Vertex1, FVector Vertex2, FVector Vertex3, float Depth1, float Depth2, float Depth3);
+	/* Calculate buoyancy forces from snapshot of body. Touches only BuoyantData and Forces, so it is safe to call
+	*  for different bodies from multiple threads.
+	*	@param Ocean					Water of body, see AOceanManager::GetWaterView
+	*	@param State					Snapshot of body
+	*	@param Time						Time of waves
+	*	@param GravityZ					World gravity
+	*	@param BuoyantData				Data about body
+	*	@param Forces		(out)		Calculated forces
+	*/
+	static void ComputeBuoyancyForces(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, float Time, float GravityZ, FBuoyantBodyData& BuoyantData, FBuoyancyForces& Forces);
 
-	/* Calculate submerged volume of body
-	*	@param OceanManager				Current ocean manager on level
-	*	@param BuoyantMesh				Mesh for calculation
-	*	@param Centroid		(out)		Center of calculated volume
+	/* Add forces of one hull section to forces of whole body, so body gets single force and torque.
+	*	@param SectionForces			Forces of section
+	*	@param CenterOfMass				World center of mass of body, sum acts there
+	*	@param BodyForces	(in/out)	Sum of sections, start with default forces
 	*/
-	static float ComputeSubmergedVolume(AOceanManager* OceanManager, UStaticMeshComponent* BuoyantMesh, FClippingPlane& ClippingPlane, FVector& Centroid, FBuoyantBodyData& BuoyantData);
+	static void AddSectionForces(const FBuoyancyForces& SectionForces, const FVector& CenterOfMass, FBuoyancyForces& BodyForces);
+
+	/* Apply forces calculated by ComputeBuoyancyForces. Game thread only. */
+	static void ApplyBuoyancyForces(UStaticMeshComponent* BuoyantMesh, const FBuoyancyForces& Forces);
+
+	/* Apply forces calculated by ComputeBuoyancyForces to current physics substep only. */
+	static void ApplyBuoyancyForces(FBodyInstance* BodyInstance, const FBuoyancyForces& Forces);
+
+private:
+
+	/* Classify body against range of wave heights of ocean, EBuoyancyBodyPhase::Crossing when broad phase is disabled */
+	static EBuoyancyBodyPhase GetBodyPhase(const FOceanWaterView& Ocean, const BuoyancyCore::FBodyState& CoreState, const FBuoyantBodyData& BuoyantData);
+
+	/* Plane or wave surface clipping of body crossing surface, returns submerged volume */
+	static float SolveCrossingBody(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, const BuoyancyCore::FBodyState& CoreState, const BuoyancyCore::FBodyParams& Body,
+		const BuoyancyCore::FWaterParams& Water, float Time, FBuoyantBodyData& BuoyantData, BuoyancyCore::FForces& CoreForces);
+
+	/* Compute forces from last full solve if body doesn't need new one in this update.
+	 * Sleeping bodies bob on waterplane spring and wake up when pushed or when waves change too much.
+	 *	@return							True if forces were held, false if body has to be solved
+	 */
+	static bool HoldForces(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, const BuoyancyCore::FBodyState& CoreState, const BuoyancyCore::FBodyParams& Body,
+		const BuoyancyCore::FWaterParams& Water, float Time, FBuoyantBodyData& BuoyantData, BuoyancyCore::FForces& CoreForces);
+
+	/* Remember result of full solve, put calm body to sleep and schedule next full solve */
+	static void UpdateSleepState(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, const BuoyancyCore::FBodyState& CoreState, float Time, float SubmergedVolume,
+		const BuoyancyCore::FForces& CoreForces, FBuoyantBodyData& BuoyantData);
+
+	static void WakeBody(FBuoyantBodyData& BuoyantData);
 
-	static FClippingPlane ClaculateClippingPlane(AOceanManager* OceanManager, UStaticMeshComponent* BuoyantMesh, FBuoyantBodyData& BuoyantData);
+	/* Wave height above center of mass of body */
+	static float GetSurfaceHeight(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, float Time, FBuoyantBodyData& BuoyantData);
+
+	/* Convert forces of buoyancy core */
+	static void SetForces(const BuoyancyCore::FForces& CoreForces, FBuoyancyForces& Forces);
 
 	/* Calculate clipping points for 'Best fit plane' for extends of mesh
-	*	@param OceanManager				Current ocean manager on level
-	*	@param BuoyantMesh				Mesh for calculation
+	*	@param Ocean					Water of body
+	*	@param State					Snapshot of body
 	*	@param ClippingPoints	(out)	Calculated clipping points
 	*/
-	static void GetTransformedTestPoints(AOceanManager* OceanManager, UStaticMeshComponent* BuoyantMesh, TArray<FVector>& ClippingPoints, FBuoyantBodyData& BuoyantData);
+	static void GetTransformedTestPoints(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, float Time, TArray<FVector>& ClippingPoints, FBuoyantBodyData& BuoyantData);
 
-	static FVector FindEigenVector(FMatrix Matrix);
-
-	static float FindLargestEntry(FMatrix Matrix);
-
-	// @TODO: Move to MathExtension
-	static FVector MatMulVec(FMatrix Matrix, FVector Vector);
+	/* Calculate depth of every vertex below wave surface into BuoyantData.Scratch.VertexDepths,
+	*  waves are sampled at vertices or at grid vertices interpolate from (BuoyantData.WaveGridResolution)
+	*	@param Ocean					Water of body
+	*	@param State					Snapshot of body
+	*	@param Time						Time of waves
+	*/
+	static void GetSurfaceDepths(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, float Time, FBuoyantBodyData& BuoyantData);
 };
\ No newline at end of file
@@ -0,0 +1,145 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "Components/StaticMeshComponent.h"
+#include "Misc/BuoyancyStats.h"
+#include "BuoyancyCore/BuoyancyCore.h"
+
+static_assert(sizeof(FVector) == sizeof(BuoyancyCore::FVec3), "FVector and BuoyancyCore::FVec3 must have the same layout");
+
+FORCEINLINE BuoyancyCore::FVec3 ToCoreVector(const FVector& Vector)
+{
+	return BuoyancyCore::FVec3(Vector.X, Vector.Y, Vector.Z);
+}
+
+/* View array of FVectors as core vectors without copying */
+FORCEINLINE const BuoyancyCore::FVec3* ToCoreVectors(const FVector* Vectors)
+{
+	return reinterpret_cast<const BuoyancyCore::FVec3*>(Vectors);
+}
+
+FORCEINLINE FVector FromCoreVector(const BuoyancyCore::FVec3& Vector)
+{
+	return FVector(Vector.X, Vector.Y, Vector.Z);
+}
+
+FORCEINLINE BuoyancyCore::FQuat ToCoreQuat(const FQuat& Quat)
+{
+	return BuoyancyCore::FQuat(Quat.X, Quat.Y, Quat.Z, Quat.W);
+}
+
+FORCEINLINE FQuat FromCoreQuat(const BuoyancyCore::FQuat& Quat)
+{
+	return FQuat(Quat.X, Quat.Y, Quat.Z, Quat.W);
+}
+
+/* Immutable triangle data of single static mesh prepared for buoyancy.
+ * Built once from collision TriMesh and shared by every buoyant actor using the same mesh.
+ */
+struct VOLUMETRICBUOYANCY_API FBuoyancyMesh
+{
+	/* Vertex positions in mesh space, packed as structure of arrays */
+	TArray<float> VertexX;
+	TArray<float> VertexY;
+	TArray<float> VertexZ;
+
+	/* 3 indices per triangle */
+	TArray<int32> Indices;
+
+	/* Triangles using vertex i are VertexTriangles[VertexTriangleStart[i]] to VertexTriangles[VertexTriangleStart[i + 1] - 1],
+	 * used by incremental volume update
+	 */
+	TArray<int32> VertexTriangleStart;
+	TArray<int32> VertexTriangles;
+
+	/* Total volume of mesh */
+	float Volume;
+
+	/* Center of volume in mesh space */
+	FVector LocalCentroid;
+
+	/* Bounds of vertices in mesh space, used to cull bodies far from water surface */
+	FVector LocalBoundsMin;
+	FVector LocalBoundsMax;
+
+	/* Convex hull of vertices projected on XY plane in mesh space, counter clockwise */
+	TArray<FVector> Footprint;
+
+	/* Points in mesh space where water surface is sampled for plane fit, generated from Footprint */
+	TArray<FVector> ClippingPoints;
+
+	/* Spacing and max count ClippingPoints were generated with */
+	float ClippingPointSpacing;
+	int32 MaxClippingPoints;
+
+	FBuoyancyMesh()
+		: Volume(0.0f)
+		, LocalCentroid(FVector::ZeroVector)
+		, LocalBoundsMin(FVector::ZeroVector)
+		, LocalBoundsMax(FVector::ZeroVector)
+		, ClippingPointSpacing(0.0f)
+		, MaxClippingPoints(0)
+	{
+	}
+
+	int32 NumVertices() const
+	{
+		return VertexX.Num();
+	}
+
+	int32 NumTriangles() const
+	{
+		return Indices.Num() / 3;
+	}
+
+	FVector GetVertex(int32 Index) const
+	{
+		return FVector(VertexX[Index], VertexY[Index], VertexZ[Index]);
+	}
+
+	/* View of mesh for buoyancy core functions */
+	BuoyancyCore::FMeshView GetView() const
+	{
+		BuoyancyCore::FMeshView View;
+		View.VertexX = VertexX.GetData();
+		View.VertexY = VertexY.GetData();
+		View.VertexZ = VertexZ.GetData();
+		View.Indices = Indices.GetData();
+		View.NumVertices = NumVertices();
+		View.NumTriangles = NumTriangles();
+		return View;
+	}
+
+	/* Vertex to triangle adjacency for buoyancy core functions */
+	BuoyancyCore::FVertexTriangles GetVertexTriangles() const
+	{
+		BuoyancyCore::FVertexTriangles Adjacency;
+		Adjacency.Start = VertexTriangleStart.GetData();
+		Adjacency.Triangles = VertexTriangles.GetData();
+		return Adjacency;
+	}
+
+	/* Get shared buoyancy mesh for static mesh used by component, builds it on first request.
+	 * Must be called from game thread. Returns invalid pointer if mesh has no collision TriMesh.
+	 *	@param BuoyantMesh				Component with mesh
+	 *	@param InClippingPointSpacing	Distance between clipping points, see AOceanManager::GetClippingPointSpacing.
+	 *									Negative keeps points of already cached mesh.
+	 *	@param InMaxClippingPoints		Max number of clipping points
+	 */
+	static TSharedPtr<const FBuoyancyMesh, ESPMode::ThreadSafe> Get(UStaticMeshComponent* BuoyantMesh, float InClippingPointSpacing = -1.0f, int32 InMaxClippingPoints = 32);
+
+	/* Get shared buoyancy mesh for static mesh, see above */
+	static TSharedPtr<const FBuoyancyMesh, ESPMode::ThreadSafe> Get(UStaticMesh* StaticMesh, float InClippingPointSpacing = -1.0f, int32 InMaxClippingPoints = 32);
+
+	/* Build buoyancy mesh from stored triangles, like simplified proxy. Result is not shared with other actors.
+	 *	@param Vertices					Vertices in mesh space
+	 *	@param Indices					3 indices per triangle of closed mesh
+	 */
+	static TSharedPtr<const FBuoyancyMesh, ESPMode::ThreadSafe> Build(const TArray<FVector>& Vertices, const TArray<int32>& Indices, float InClippingPointSpacing = 0.0f, int32 InMaxClippingPoints = 32);
+
+	/* Build copy of Source with vertices moved by Transform, like hull section placed on actor. Result is not shared with other actors. */
+	static TSharedPtr<const FBuoyancyMesh, ESPMode::ThreadSafe> Build(const FBuoyancyMesh& Source, const FTransform& Transform, float InClippingPointSpacing = 0.0f, int32 InMaxClippingPoints = 32);
+};
+
+typedef TSharedPtr<const FBuoyancyMesh, ESPMode::ThreadSafe> FBuoyancyMeshPtr;
@@ -0,0 +1,40 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "Misc/BuoyancyTypes.h"
+#include "BuoyancyCore/BuoyancySession.h"
+
+class AActorBuoyant;
+
+/* Records fixed step bodies of world into session file, see BuoyancyCore/BuoyancySession.h.
+ * Started and stopped by 'Buoyancy.Record', 'BuoyancyBench --replay <file>' simulates recorded bodies again
+ * without engine and reports how far they diverge and how much bandwidth corrections need.
+ */
+class VOLUMETRICBUOYANCY_API FBuoyancyRecorder
+{
+public:
+
+	FBuoyancyRecorder();
+
+	/* Start recording every fixed step body of World, FileName is relative to profiling directory */
+	bool Start(UWorld* World, const FString& FileName);
+
+	void Stop();
+
+	bool IsRecording() const { return Writer != nullptr; }
+
+	int32 GetNumBodies() const { return BodyIndices.Num(); }
+
+	/* Called by fixed step bodies after every step and whenever their state is replaced. Bodies spawned after start are not recorded. */
+	void RecordState(const AActorBuoyant* Body, BuoyancyCore::ESessionRecord Type, int32 Step, const BuoyancyCore::FBodyState& State);
+
+private:
+
+	FArchive* Writer;
+
+	/* Index of every recorded body in session */
+	TMap<const AActorBuoyant*, int32> BodyIndices;
+};
+
+extern VOLUMETRICBUOYANCY_API FBuoyancyRecorder GBuoyancyRecorder;
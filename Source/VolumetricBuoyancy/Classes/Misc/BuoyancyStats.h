@@ -0,0 +1,161 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "Stats/Stats.h"
+
+/* Stats group shared by buoyancy and ocean code, see 'stat Buoyancy' */
+DECLARE_STATS_GROUP(TEXT("Buoyancy"), STATGROUP_Buoyancy, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Plane Fit"), STAT_BuoyancyPlaneFit, STATGROUP_Buoyancy, VOLUMETRICBUOYANCY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Wave Sampling"), STAT_BuoyancyWaveSampling, STATGROUP_Buoyancy, VOLUMETRICBUOYANCY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Vertex Classification"), STAT_BuoyancyClassify, STATGROUP_Buoyancy, VOLUMETRICBUOYANCY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Triangle Clipping"), STAT_BuoyancyClip, STATGROUP_Buoyancy, VOLUMETRICBUOYANCY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Force Application"), STAT_BuoyancyApplyForces, STATGROUP_Buoyancy, VOLUMETRICBUOYANCY_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Instance Step"), STAT_BuoyancyInstances, STATGROUP_Buoyancy, VOLUMETRICBUOYANCY_API);
+
+/* Frame stats work in every build except shipping, unlike 'stat' they don't need STATS */
+#define BUOYANCY_FRAME_STATS !UE_BUILD_SHIPPING
+
+/* Timed stages of buoyancy update, every stage has cycle stat with the same name */
+enum class EBuoyancyStage : uint8
+{
+	PlaneFit,
+	WaveSampling,
+	Classify,
+	Clip,
+	ApplyForces,
+	Instances,
+	Num
+};
+
+/* Counted events of buoyancy update */
+enum class EBuoyancyCounter : uint8
+{
+	/* Updates of bodies and sections, including early outs */
+	BodiesSolved,
+
+	/* Triangles visited by volume clipping */
+	TrianglesClipped,
+
+	/* Wave heights evaluated by ocean */
+	WaveSamples,
+
+	/* Updates which skipped clipping: dry, submerged or held bodies */
+	EarlyOuts,
+
+	/* Growths of scratch buffers */
+	Allocations,
+
+	/* Floating instances stepped by AInstancedBuoyancyActor */
+	InstancesSolved,
+
+	Num
+};
+
+/* Counters and stage times of one frame. Stage times are summed over all threads, so they are CPU time, not wall time. */
+struct VOLUMETRICBUOYANCY_API FBuoyancyFrameSample
+{
+	uint64 FrameNumber;
+	float DeltaSeconds;
+	float StageMilliseconds[(int32)EBuoyancyStage::Num];
+	int32 Counters[(int32)EBuoyancyCounter::Num];
+
+	FBuoyancyFrameSample();
+
+	static const TCHAR* GetStageName(EBuoyancyStage Stage);
+	static const TCHAR* GetCounterName(EBuoyancyCounter Counter);
+};
+
+/* Per frame buoyancy counters readable with 'Buoyancy.Stats' and dumped to csv with 'Buoyancy.StatsCSV'.
+ * Counters can be added from any thread, frame is closed on game thread at end of every engine frame.
+ */
+class VOLUMETRICBUOYANCY_API FBuoyancyFrameStats
+{
+public:
+
+	FBuoyancyFrameStats();
+
+	/* Start closing frames at end of engine frame, called by module */
+	void Initialize();
+	void Shutdown();
+
+	FORCEINLINE void AddCount(EBuoyancyCounter Counter, int32 Count)
+	{
+		FPlatformAtomics::InterlockedAdd(&Counters[(int32)Counter], Count);
+	}
+
+	FORCEINLINE void AddCycles(EBuoyancyStage Stage, uint32 Cycles)
+	{
+		FPlatformAtomics::InterlockedAdd(&StageCycles[(int32)Stage], (int64)Cycles);
+	}
+
+	/* Store counters of current frame as last frame and reset them */
+	void EndFrame();
+
+	const FBuoyancyFrameSample& GetLastFrame() const { return LastFrame; }
+
+	/* Average of frames since last call of ResetAverage */
+	FBuoyancyFrameSample GetAverage() const;
+	void ResetAverage();
+
+	/* Write every following frame as row of csv file, FileName is relative to profiling directory */
+	bool StartCSV(const FString& FileName);
+	void StopCSV();
+	bool IsWritingCSV() const { return CSVWriter != nullptr; }
+
+private:
+
+	void WriteCSVRow(const FBuoyancyFrameSample& Sample);
+
+	volatile int32 Counters[(int32)EBuoyancyCounter::Num];
+	volatile int64 StageCycles[(int32)EBuoyancyStage::Num];
+
+	FBuoyancyFrameSample LastFrame;
+
+	/* Sums of frames for average */
+	FBuoyancyFrameSample Sum;
+	int32 NumSummedFrames;
+
+	double LastFrameTime;
+
+	FArchive* CSVWriter;
+	FString CSVFileName;
+
+	FDelegateHandle EndFrameHandle;
+};
+
+extern VOLUMETRICBUOYANCY_API FBuoyancyFrameStats GBuoyancyFrameStats;
+
+/* Adds cycles of its lifetime to stage of current frame */
+class FBuoyancyStageScope
+{
+public:
+
+	FORCEINLINE explicit FBuoyancyStageScope(EBuoyancyStage InStage)
+		: Stage(InStage)
+		, StartCycles(FPlatformTime::Cycles())
+	{
+	}
+
+	FORCEINLINE ~FBuoyancyStageScope()
+	{
+		GBuoyancyFrameStats.AddCycles(Stage, FPlatformTime::Cycles() - StartCycles);
+	}
+
+private:
+
+	EBuoyancyStage Stage;
+	uint32 StartCycles;
+};
+
+#if BUOYANCY_FRAME_STATS
+	#define BUOYANCY_SCOPE(Stage) SCOPE_CYCLE_COUNTER(STAT_Buoyancy##Stage); FBuoyancyStageScope BuoyancyStageScope_##Stage(EBuoyancyStage::Stage)
+	#define BUOYANCY_COUNT(Counter, Count) GBuoyancyFrameStats.AddCount(EBuoyancyCounter::Counter, Count)
+#else
+	#define BUOYANCY_SCOPE(Stage) SCOPE_CYCLE_COUNTER(STAT_Buoyancy##Stage)
+	#define BUOYANCY_COUNT(Counter, Count)
+#endif
+
+/* Profiling hook of BuoyancyCore, BuoyancyCore.h includes this header in engine builds */
+#define BUOYANCY_CORE_SCOPE(Stage) BUOYANCY_SCOPE(Stage)
@@ -2,13 +2,340 @@
 
 #pragma once
 
+#include "Misc/BuoyancyMesh.h"
+#include "Ocean/WaveSpectrum.h"
+#include "BuoyancyCore/PressureForces.h"
 #include "BuoyancyTypes.generated.h"
 
+/* When buoyancy of body is evaluated */
+UENUM(BlueprintType)
+enum class EBuoyancyUpdateMode : uint8
+{
+	/* Once per frame, before physics. Cheap, fine for debris. */
+	PerFrame,
+
+	/* Inside every physics substep using substep body state. Stable with low frame rate, requires physics substepping. */
+	PerSubstep,
+
+	/* Own integrator stepped by ocean clock instead of physics. Motion depends only on initial state, waves and clock,
+	 * so clients simulate body themselves and server sends only periodic corrections. Body doesn't collide.
+	 */
+	FixedStep
+};
+
+/* How water surface is represented when clipping body */
+UENUM(BlueprintType)
+enum class EBuoyancyClippingMode : uint8
+{
+	/* Single plane fitted through clipping points. Cheapest, fine for bodies shorter than waves. */
+	Plane,
+
+	/* Depth of every vertex against actual wave surface. Follows wave shape along long hulls. */
+	WaveSurface
+};
+
+/* How forces of body are computed from water around it */
+UENUM(BlueprintType)
+enum class EBuoyancySolverMode : uint8
+{
+	/* Buoyancy of submerged volume at its centroid with drag scaled by submerged volume. Cheap, fine for debris. */
+	Volume,
+
+	/* Pressure on every submerged triangle: buoyancy, pressure drag, skin friction and slamming.
+	 * Hulls get lift and speed dependent resistance, costs about 3 times more than Volume. Body is solved in every update and never sleeps.
+	 */
+	Pressure
+};
+
+/* Where body was relative to water surface in last update, decides how much of solve it needed */
+UENUM(BlueprintType)
+enum class EBuoyancyBodyPhase : uint8
+{
+	/* Above highest wave, solve was skipped */
+	Dry,
+
+	/* Below lowest wave, whole volume was used without clipping */
+	Submerged,
+
+	/* Crossing surface, clipped against waves */
+	Crossing
+};
+
+/* Per-body buffers reused every update, so steady state buoyancy update doesn't allocate */
+struct FBuoyancyScratch
+{
+	/* Signed distance of every mesh vertex to clipping plane */
+	TArray<float> VertexDepths;
+
+	/* Wave samples of clipping points, vertices or wave grid */
+	FWaveSampleBatch WaveSamples;
+
+	/* World vertex positions for wave surface clipping */
+	TArray<float> WorldVertexX;
+	TArray<float> WorldVertexY;
+	TArray<float> WorldVertexZ;
+
+	/* Number of updates that had to grow buffers, should stop growing after first update */
+	uint32 NumAllocations;
+
+	FBuoyancyScratch()
+		: NumAllocations(0)
+	{
+	}
+
+	/* Sum of buffer capacities, changes only when some buffer was reallocated */
+	int32 GetCapacity() const
+	{
+		return VertexDepths.Max() + WorldVertexX.Max() + WorldVertexY.Max() + WorldVertexZ.Max() + WaveSamples.GetCapacity();
+	}
+};
+
+/* Waterline state of body kept between updates by incremental volume update, see FBuoyantBodyData::bIncrementalVolume */
+struct FBuoyancyIncrementalState
+{
+	TArray<int8> VertexSigns;
+	TArray<uint8> TriangleClasses;
+	TArray<int32> CrossingTriangles;
+	TArray<int32> CrossingSlots;
+	TArray<int32> Queue;
+
+	/* Mesh state was built for, other mesh rebuilds it */
+	const FBuoyancyMesh* BoundMesh;
+
+	BuoyancyCore::FIncrementalVolume Core;
+
+	FBuoyancyIncrementalState()
+		: BoundMesh(nullptr)
+	{
+	}
+
+	/* Size buffers for Mesh and point core state at them, state is rebuilt in next update when mesh changed */
+	void Bind(const FBuoyancyMesh& Mesh)
+	{
+		if (BoundMesh != &Mesh || VertexSigns.Num() != Mesh.NumVertices() || TriangleClasses.Num() != Mesh.NumTriangles())
+		{
+			VertexSigns.SetNumUninitialized(Mesh.NumVertices());
+			TriangleClasses.SetNumUninitialized(Mesh.NumTriangles());
+			CrossingTriangles.SetNumUninitialized(Mesh.NumTriangles());
+			CrossingSlots.SetNumUninitialized(Mesh.NumTriangles());
+			Queue.SetNumUninitialized(Mesh.NumTriangles());
+
+			BoundMesh = &Mesh;
+			Core.bValid = false;
+		}
+
+		Core.Adjacency = Mesh.GetVertexTriangles();
+		Core.VertexSigns = VertexSigns.GetData();
+		Core.TriangleClasses = TriangleClasses.GetData();
+		Core.CrossingTriangles = CrossingTriangles.GetData();
+		Core.CrossingSlots = CrossingSlots.GetData();
+		Core.Queue = Queue.GetData();
+	}
+};
+
+/* Buffers and swept volume history of pressure solve, see EBuoyancySolverMode::Pressure */
+struct FBuoyancyPressureState
+{
+	/* Submerged triangles in structure of arrays, see BuoyancyCore::FPressureScratch */
+	TArray<float> Scratch;
+	TArray<int32> Sources;
+
+	/* Swept volume of every triangle in last solve */
+	TArray<float> Sweep;
+
+	/* Wave time of last solve, negative before first one */
+	float LastSolveTime;
+
+	/* Mesh buffers were sized for, other mesh resizes them and drops history */
+	const FBuoyancyMesh* BoundMesh;
+
+	BuoyancyCore::FPressureScratch CoreScratch;
+	BuoyancyCore::FPressureHistory History;
+
+	FBuoyancyPressureState()
+		: LastSolveTime(-1.0f)
+		, BoundMesh(nullptr)
+	{
+	}
+
+	/* Size buffers for Mesh and point core state at them */
+	void Bind(const FBuoyancyMesh& Mesh)
+	{
+		if (BoundMesh != &Mesh || Sweep.Num() != Mesh.NumTriangles())
+		{
+			Scratch.SetNumUninitialized(BuoyancyCore::FPressureScratch::GetNumFloats(Mesh.NumVertices(), Mesh.NumTriangles()));
+			Sources.SetNumUninitialized(2 * Mesh.NumTriangles());
+			Sweep.SetNumZeroed(Mesh.NumTriangles());
+
+			BoundMesh = &Mesh;
+			History.bValid = false;
+			LastSolveTime = -1.0f;
+		}
+
+		CoreScratch = BuoyancyCore::FPressureScratch::FromBuffer(Scratch.GetData(), Sources.GetData(), Mesh.NumVertices(), Mesh.NumTriangles());
+		History.Sweep = Sweep.GetData();
+	}
+
+	/* Time since last solve, starts new one at Time */
+	float BeginSolve(float Time)
+	{
+		const float DeltaTime = LastSolveTime >= 0.0f ? FMath::Max(Time - LastSolveTime, 0.0f) : 0.0f;
+		LastSolveTime = Time;
+
+		return DeltaTime;
+	}
+
+	/* Body out of water sweeps nothing, so it slams when it comes back */
+	void SetDry(const FBuoyancyMesh& Mesh, float Time)
+	{
+		Bind(Mesh);
+		FMemory::Memzero(Sweep.GetData(), Sweep.Num() * sizeof(float));
+
+		History.bValid = true;
+		LastSolveTime = Time;
+	}
+};
+
+/* Result of last full solve, reused by updates that skip it. See FBuoyantBodyData::bAllowSleep. */
+struct FBuoyancySleepState
+{
+	/* Body settled, it is solved only every SleepSolveInterval updates */
+	bool bSleeping;
+
+	/* Set on game thread to force full solve on next update */
+	bool bWakeRequested;
+
+	/* Updates left until next full solve */
+	int32 UpdatesUntilSolve;
+
+	/* How long body has been calm */
+	float CalmTime;
+
+	/* Wave time of last full solve, negative before first one */
+	float LastSolveTime;
+
+	/* Submerged volume of last full solve and its center relative to center of mass in mesh space */
+	float Volume;
+	FVector LocalCentroid;
+
+	/* Surface height above center of mass and depth of center of mass below it at last calm solve */
+	float RestSurfaceZ;
+	float RestDraft;
+
+	/* Change of submerged volume per depth at rest, makes held volume a spring */
+	float WaterplaneArea;
+
+	FBuoyancySleepState()
+		: bSleeping(false)
+		, bWakeRequested(false)
+		, UpdatesUntilSolve(0)
+		, CalmTime(0.0f)
+		, LastSolveTime(-1.0f)
+		, Volume(0.0f)
+		, LocalCentroid(FVector::ZeroVector)
+		, RestSurfaceZ(0.0f)
+		, RestDraft(0.0f)
+		, WaterplaneArea(0.0f)
+	{
+	}
+};
+
+/* Low poly closed mesh used for buoyancy instead of collision mesh, simplified in editor and stored with actor.
+ * See UBuoyancyHelper::BuildBuoyancyProxy.
+ */
+USTRUCT(BlueprintType)
+struct FBuoyancyProxy
+{
+	GENERATED_USTRUCT_BODY()
+
+	/* Vertices in component space */
+	UPROPERTY()
+	TArray<FVector> Vertices;
+
+	/* 3 indices per triangle */
+	UPROPERTY()
+	TArray<int32> Indices;
+
+	/* Mesh proxy was simplified from, proxy is ignored when component uses other mesh */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Buoyancy)
+	UStaticMesh* SourceMesh;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Buoyancy)
+	int32 SourceTriangles;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Buoyancy)
+	int32 NumTriangles;
+
+	/* Size of grid cell vertices were merged on, 0 -> source mesh already fit budget */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Buoyancy)
+	float CellSize;
+
+	/* Difference of total volume against source mesh, fraction of source volume */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Buoyancy)
+	float VolumeError;
+
+	/* Largest difference of submerged volume over tested depths and attitudes, fraction of source volume */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Buoyancy)
+	float MaxSubmergedVolumeError;
+
+	/* Largest distance between submerged centroids over tested depths and attitudes, fraction of size of source mesh */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Buoyancy)
+	float MaxCentroidError;
+
+	FBuoyancyProxy()
+	{
+		SourceMesh = nullptr;
+		SourceTriangles = 0;
+		NumTriangles = 0;
+		CellSize = 0.0f;
+		VolumeError = 0.0f;
+		MaxSubmergedVolumeError = 0.0f;
+		MaxCentroidError = 0.0f;
+	}
+
+	bool IsValid() const
+	{
+		return NumTriangles > 0 && Indices.Num() == NumTriangles * 3;
+	}
+};
+
+/* Hull section of buoyant actor with its own geometry and density, see AActorBuoyant::Sections */
+USTRUCT(BlueprintType)
+struct FBuoyantSection
+{
+	GENERATED_USTRUCT_BODY()
+
+	/* Closed mesh of section, its collision mesh is used like for BuoyantMesh */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Buoyancy)
+	UStaticMesh* Mesh;
+
+	/* Placement of section relative to BuoyantMesh */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Buoyancy)
+	FTransform Transform;
+
+	/* Density of section, sections share mass of body in proportion to density times volume */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Buoyancy)
+	float DensityOfBody;
+
+	FBuoyantSection()
+	{
+		Mesh = nullptr;
+		Transform = FTransform::Identity;
+		DensityOfBody = 500.0f;
+	}
+};
+
 USTRUCT(BlueprintType, Blueprintable)
 struct FBuoyantBodyData
 {
 	GENERATED_USTRUCT_BODY()
 
+	/* Shared triangle data of buoyant mesh */
+	FBuoyancyMeshPtr Mesh;
+
+	/* Reusable buffers of buoyancy update */
+	FBuoyancyScratch Scratch;
+
 	/* Total volume of buoyant mesh */
 	UPROPERTY()
 	float BodyVolume;
@@ -23,22 +350,179 @@ struct FBuoyantBodyData
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Buoyancy)
 	float DensityOfBody;
 
+	/* Share of body mass belonging to this buoyant mesh, below 1 for hull sections */
+	UPROPERTY()
+	float MassFraction;
+
+	/* Center of mass relative to component, lets substeps find center of mass from body transform */
+	UPROPERTY()
+	FVector LocalCenterOfMass;
+
 	/* Length of body along X axis */
 	UPROPERTY()
 	float BodyLengthX;
 
+	/* Volume, density and length with drag constants of core solve, see UpdateBodyParams */
+	BuoyancyCore::FBodyParams BodyParams;
+
 	UPROPERTY()
 	TArray<FVector> ClippingPointsOffsets;
 
+	/* Clipping points with wave height, updated every tick */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Buoyancy)
 	TArray<FVector> ClippingPointsTransformed;
 
+	/* How water surface is represented when clipping this body */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Buoyancy)
+	EBuoyancyClippingMode ClippingMode;
+
+	/* WaveSurface mode: cells of wave grid along longer side of body, vertices interpolate grid heights.
+	 * 0 -> sample waves at every vertex.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Buoyancy, meta = (ClampMin = "0", ClampMax = "64"))
+	int32 WaveGridResolution;
+
+	/* How forces of body are computed, Pressure is meant for few important hulls like player vessels */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Buoyancy)
+	EBuoyancySolverMode SolverMode;
+
+	/* Pressure mode: drag coefficient of faces moving into water */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Pressure", meta = (ClampMin = "0"))
+	float PressureDrag;
+
+	/* Pressure mode: drag coefficient of faces moving away from water */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Pressure", meta = (ClampMin = "0"))
+	float SuctionDrag;
+
+	/* Pressure mode: below this speed (cm/s) drag grows linearly, keeps slow bodies damped */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Pressure", meta = (ClampMin = "0"))
+	float LinearDragSpeed;
+
+	/* Pressure mode: scale of skin friction of hull, 0 -> no viscous resistance */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Pressure", meta = (ClampMin = "0"))
+	float SkinFriction;
+
+	/* Pressure mode: fraction of force stopping wetted part of hull within one update, applied when hull hits water */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Pressure", meta = (ClampMin = "0", ClampMax = "1"))
+	float Slamming;
+
+	/* Pressure mode: change of swept volume rate per hull area (cm/s^2) at which slamming reaches full strength */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Pressure", meta = (ClampMin = "1"))
+	float SlammingMaxRate;
+
+	/* Pressure mode: slamming strength grows with power of rate, higher ignores gentle entries */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Pressure", meta = (ClampMin = "0"))
+	float SlammingPower;
+
+	/* Coefficients of pressure solve with surface area of mesh, see UpdateBodyParams */
+	BuoyancyCore::FPressureParams PressureParams;
+
+	/* Buffers and history of pressure solve */
+	FBuoyancyPressureState Pressure;
+
+	/* Skip clipping when bounds of body are entirely above or below range of wave heights */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Buoyancy)
+	bool bUseBroadPhase;
+
+	/* Extra height added to both ends of wave height range, plane clipping can reach past waves on long bodies */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Buoyancy, meta = (ClampMin = "0"))
+	float BroadPhaseMargin;
+
+	/* Result of broad phase in last update */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Buoyancy)
+	EBuoyancyBodyPhase BodyPhase;
+
+	/* Sleep and update rate of body */
+	FBuoyancySleepState Sleep;
+
+	/* Waterline of body in last update */
+	FBuoyancyIncrementalState Incremental;
+
+	/* Update submerged volume from last update, only triangles next to vertices that crossed water surface are reclassified.
+	 * Pays off on large hulls moving little between updates, results match full clipping.
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Buoyancy)
+	bool bIncrementalVolume;
+
+	/* Let body settled near equilibrium skip full solve and bob on a spring model instead */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Sleep")
+	bool bAllowSleep;
+
+	/* Body is calm while its speed stays below this (cm/s), twice this wakes sleeping body */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Sleep", meta = (ClampMin = "0"))
+	float SleepLinearVelocity;
+
+	/* Body is calm while its angular speed stays below this (deg/s), twice this wakes sleeping body */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Sleep", meta = (ClampMin = "0"))
+	float SleepAngularVelocity;
+
+	/* Body is calm while submerged volume changes between solves by less than this fraction of its volume */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Sleep", meta = (ClampMin = "0"))
+	float SleepVolumeChange;
+
+	/* Seconds body has to stay calm before it falls asleep */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Sleep", meta = (ClampMin = "0"))
+	float SleepDelay;
+
+	/* Sleeping body is still fully solved once per this many updates */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Sleep", meta = (ClampMin = "1"))
+	int32 SleepSolveInterval;
+
+	/* Sleeping body wakes when water surface above it moves more than this from rest */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Buoyancy|Sleep", meta = (ClampMin = "0"))
+	float WakeWaveHeight;
+
+	/* Scale of wave LOD for this body, higher drops more small waves. 0 -> always use full wave spectrum. */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = Buoyancy)
+	float WaveLODBias;
+
 	FBuoyantBodyData()
 	{
 		BodyVolume = 0.0f;
 		LocalCentroidOfVolume = FVector::ZeroVector;
+		LocalCenterOfMass = FVector::ZeroVector;
 		DensityOfBody = 500.0f;
+		MassFraction = 1.0f;
 		BodyLengthX = 0.0f;
+		WaveLODBias = 1.0f;
+		ClippingMode = EBuoyancyClippingMode::Plane;
+		WaveGridResolution = 8;
+		bUseBroadPhase = true;
+		BroadPhaseMargin = 50.0f;
+		BodyPhase = EBuoyancyBodyPhase::Crossing;
+		bIncrementalVolume = false;
+		bAllowSleep = true;
+		SleepLinearVelocity = 10.0f;
+		SleepAngularVelocity = 5.0f;
+		SleepVolumeChange = 0.02f;
+		SleepDelay = 2.0f;
+		SleepSolveInterval = 30;
+		WakeWaveHeight = 25.0f;
+
+		const BuoyancyCore::FPressureParams DefaultPressure;
+		SolverMode = EBuoyancySolverMode::Volume;
+		PressureDrag = DefaultPressure.PressureDrag;
+		SuctionDrag = DefaultPressure.SuctionDrag;
+		LinearDragSpeed = DefaultPressure.LinearDragSpeed;
+		SkinFriction = DefaultPressure.SkinFriction;
+		Slamming = DefaultPressure.Slamming;
+		SlammingMaxRate = DefaultPressure.SlammingMaxRate;
+		SlammingPower = DefaultPressure.SlammingPower;
+	}
+
+	/* Precompute constants of core solve, call after Mesh, BodyVolume, DensityOfBody, BodyLengthX or pressure coefficients change */
+	void UpdateBodyParams()
+	{
+		BodyParams = BuoyancyCore::FBodyParams(BodyVolume, DensityOfBody, BodyLengthX);
+
+		PressureParams.PressureDrag = PressureDrag;
+		PressureParams.SuctionDrag = SuctionDrag;
+		PressureParams.LinearDragSpeed = LinearDragSpeed;
+		PressureParams.SkinFriction = SkinFriction;
+		PressureParams.Slamming = Slamming;
+		PressureParams.SlammingMaxRate = SlammingMaxRate;
+		PressureParams.SlammingPower = SlammingPower;
+		PressureParams.SurfaceArea = Mesh.IsValid() ? BuoyancyCore::ComputeSurfaceArea(Mesh->GetView()) : 0.0f;
 	}
 };
 
@@ -58,4 +542,84 @@ struct FClippingPlane
 		PlaneNormal = FVector::UpVector;
 		PlaneLocation = FVector::ZeroVector;
 	}
-};
\ No newline at end of file
+};
+
+/* Snapshot of buoyant body state, lets buoyancy be computed without touching the component */
+struct FBuoyantBodyState
+{
+	/* Component transform */
+	FTransform Transform;
+
+	FVector CenterOfMass;
+
+	FVector LinearVelocity;
+
+	/* Angular velocity in degrees */
+	FVector AngularVelocity;
+
+	float Mass;
+
+	FBuoyantBodyState()
+		: Transform(FTransform::Identity)
+		, CenterOfMass(FVector::ZeroVector)
+		, LinearVelocity(FVector::ZeroVector)
+		, AngularVelocity(FVector::ZeroVector)
+		, Mass(0.0f)
+	{
+	}
+};
+
+/* Result of buoyancy computation, applied to body afterwards */
+struct FBuoyancyForces
+{
+	/* Should forces be applied at all */
+	bool bHasForce;
+
+	FVector Force;
+
+	/* World location Force is applied at */
+	FVector ForceLocation;
+
+	FVector Torque;
+
+	FBuoyancyForces()
+		: bHasForce(false)
+		, Force(FVector::ZeroVector)
+		, ForceLocation(FVector::ZeroVector)
+		, Torque(FVector::ZeroVector)
+	{
+	}
+};
+
+/* State of fixed step body at clock step, sent by server to correct clients */
+USTRUCT()
+struct FBuoyancyCorrection
+{
+	GENERATED_USTRUCT_BODY()
+
+	/* Clock step state was taken after, INDEX_NONE before first correction */
+	UPROPERTY()
+	int32 Step;
+
+	UPROPERTY()
+	FVector Location;
+
+	UPROPERTY()
+	FQuat Rotation;
+
+	UPROPERTY()
+	FVector LinearVelocity;
+
+	/* Angular velocity in degrees */
+	UPROPERTY()
+	FVector AngularVelocity;
+
+	FBuoyancyCorrection()
+		: Step(INDEX_NONE)
+		, Location(FVector::ZeroVector)
+		, Rotation(FQuat::Identity)
+		, LinearVelocity(FVector::ZeroVector)
+		, AngularVelocity(FVector::ZeroVector)
+	{
+	}
+};
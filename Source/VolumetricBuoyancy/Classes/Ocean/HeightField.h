@@ -0,0 +1,91 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+/* Height map decoded once into tightly packed floats, with optional mip chain.
+ * Covers square world area of WorldSize centered at WorldCenter, same mapping as heightmap ocean material.
+ * Sampling is read only, so any number of threads can sample while nobody rebuilds it.
+ */
+struct VOLUMETRICBUOYANCY_API FHeightField
+{
+	FHeightField();
+
+	/* Decode red channel of 8 bit texels into heights: Height = Red / 255 * Scale + Offset
+	 *	@param Texels				InWidth * InHeight texels, row by row
+	 *	@param bBuildMips			Build half resolution mips down to 1x1 for coarse lookups
+	 */
+	void Build(const FColor* Texels, int32 InWidth, int32 InHeight, float Scale, float Offset, bool bBuildMips);
+
+	/* Build from normalized values: Height = Value * Scale + Offset */
+	void Build(const float* Values, int32 InWidth, int32 InHeight, float Scale, float Offset, bool bBuildMips);
+
+	/* Set world area covered by height field */
+	void SetWorldBounds(const FVector2D& InWorldCenter, float InWorldSize);
+
+	void Reset();
+
+	bool IsValid() const
+	{
+		return Mips.Num() > 0;
+	}
+
+	int32 GetNumMips() const
+	{
+		return Mips.Num();
+	}
+
+	/* Lowest and highest height, every sample of any mip stays within them */
+	float GetMinHeight() const
+	{
+		return MinHeight;
+	}
+
+	float GetMaxHeight() const
+	{
+		return MaxHeight;
+	}
+
+	/* Bilinear filtered height at world location, clamped to edges */
+	float Sample(float X, float Y, int32 Mip = 0) const;
+
+	/* Bilinear filtered heights at NumSamples world locations */
+	void SampleBatch(const float* X, const float* Y, int32 NumSamples, float* OutHeights, int32 Mip = 0) const;
+
+	/* Bytes allocated by height field */
+	uint32 GetAllocatedSize() const;
+
+private:
+
+	struct FMip
+	{
+		int32 Width;
+		int32 Height;
+
+		/* Index of first height of mip in Heights */
+		int32 Offset;
+	};
+
+	/* Lay out mip chain and size Heights for it, returns false for empty size */
+	bool AllocateMips(int32 InWidth, int32 InHeight, bool bBuildMips);
+
+	/* Find height range and fill mips from mip 0 */
+	void BuildMips();
+
+	float SampleMip(const FMip& MipInfo, float X, float Y) const;
+
+	/* All mips, largest first, rows along X */
+	TArray<float> Heights;
+
+	TArray<FMip> Mips;
+
+	FVector2D WorldCenter;
+
+	float InvWorldSize;
+
+	float MinHeight;
+
+	float MaxHeight;
+};
+
+/* Shared immutable height field, swapped whole when rebuilt */
+typedef TSharedPtr<const FHeightField, ESPMode::ThreadSafe> FHeightFieldPtr;
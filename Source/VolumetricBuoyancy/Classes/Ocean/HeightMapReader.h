@@ -3,8 +3,21 @@
 #pragma once
 
 #include "GameFramework/Actor.h"
+#include "Ocean/HeightField.h"
+#include "Ocean/HeightReadback.h"
 #include "HeightMapReader.generated.h"
 
+class AOceanManager;
+
+UENUM(BlueprintType)
+enum class EHeightReadbackSource : uint8
+{
+	/* Copy RenderTarget back from GPU */
+	RenderTarget,
+	/* Synthetic CPU frames, used automatically when running without rendering */
+	Synthetic
+};
+
 /**
  * 
  */
@@ -13,17 +26,91 @@ class VOLUMETRICBUOYANCY_API AHeightMapReader : public AActor
 {
 	GENERATED_BODY()
 
+	AHeightMapReader(const FObjectInitializer& ObjectInitializer);
+
 	UPROPERTY(EditAnywhere, Category = HeightMap)
 	UTextureRenderTarget2D* RenderTarget;
 
+	/* World size of area covered by render target, centered at world origin */
+	UPROPERTY(EditAnywhere, Category = HeightMap)
+	float WorldSize;
+
+	/* World height difference between red channel 0 and 255 */
+	UPROPERTY(EditAnywhere, Category = HeightMap)
+	float HeightScale;
+
+	/* World height of red channel 0 */
+	UPROPERTY(EditAnywhere, Category = HeightMap)
+	float HeightOffset;
+
+	/* Build mip chain of height field for coarse lookups */
+	UPROPERTY(EditAnywhere, Category = HeightMap)
+	bool bBuildMips;
+
+	/* Read render target back every frame without waiting for GPU, heights lag a few frames behind */
+	UPROPERTY(EditAnywhere, Category = "HeightMap|Readback")
+	bool bAsyncReadback;
+
+	UPROPERTY(EditAnywhere, Category = "HeightMap|Readback")
+	EHeightReadbackSource ReadbackSource;
+
+	/* Number of frames in flight, capture is skipped when all of them are busy */
+	UPROPERTY(EditAnywhere, Category = "HeightMap|Readback", meta = (ClampMin = 2, ClampMax = 8))
+	int32 ReadbackSlots;
+
+	/* Frames between GPU copy and its read */
+	UPROPERTY(EditAnywhere, Category = "HeightMap|Readback", meta = (ClampMin = 1, ClampMax = 4))
+	int32 ReadbackLatencyFrames;
+
+	/* Size of synthetic frames */
+	UPROPERTY(EditAnywhere, Category = "HeightMap|Readback", meta = (ClampMin = 2, ClampMax = 1024))
+	int32 SyntheticResolution;
+
+	/* Read render target back to CPU and decode it into height field. Waits for rendering, don't call every frame. */
 	UFUNCTION(BlueprintCallable, Category = "HeightMap|Update")
 	void UpdateBuffer();
 
 	UFUNCTION(BlueprintCallable, Category = "HeightMap|Texture Helper")
 	FColor GetRenderTargetValue(float x, float y);
 
+	/* Bilinear filtered height at world location */
+	UFUNCTION(BlueprintCallable, Category = "HeightMap|Texture Helper")
+	float GetHeight(float x, float y) const;
+
+public:
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void Tick(float DeltaSeconds) override;
+
+	/* Ocean wave time heights were captured at, compare with AOceanManager::GetWaveTime to compensate readback latency */
+	UFUNCTION(BlueprintCallable, Category = "HeightMap|Texture Helper")
+	float GetHeightTimestamp() const;
+
+	/* Ocean whose clock stamps captured frames, ocean sets itself when it uses this reader */
+	void SetOceanManager(AOceanManager* InOceanManager);
+
+	/* Bilinear filtered heights at NumSamples world locations */
+	void GetHeightBatch(const float* X, const float* Y, int32 NumSamples, float* OutHeights) const;
+
+	/* Latest asynchronously read frame, or height field of last UpdateBuffer */
+	FHeightFieldPtr GetHeightField() const;
+
 private:
 
+	/* Ocean clock captures are stamped with, world time without ocean */
+	UPROPERTY(Transient)
+	AOceanManager* OceanManager;
+
 	TArray<FColor> ColorBuffer;
-	
+
+	/* Height field of UpdateBuffer */
+	TSharedPtr<FHeightField, ESPMode::ThreadSafe> HeightField;
+
+	float HeightFieldTimestamp;
+
+	FHeightReadbackRing Readback;
+
+	/* Wave time of ocean, or world time when reader has no ocean */
+	float GetCaptureTime() const;
 };
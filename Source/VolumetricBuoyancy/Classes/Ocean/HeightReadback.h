@@ -0,0 +1,190 @@
+// Ocean created by Handkor
+
+#pragma once
+
+#include "Ocean/HeightField.h"
+
+class UTextureRenderTarget2D;
+
+/* Source of height frames for FHeightReadbackRing. Frames are copied into one of NumSlots slots
+ * and read back asynchronously, nothing here may wait for GPU. All functions are called on game thread.
+ */
+class VOLUMETRICBUOYANCY_API IHeightReadbackSource
+{
+public:
+	virtual ~IHeightReadbackSource() {}
+
+	/* Allocate slots, called once before any other function */
+	virtual void Initialize(int32 NumSlots) = 0;
+
+	/* Start copy of current frame into slot
+	 *	@param Slot						Slot to copy into, never in use by another copy or read
+	 *	@param Time						Time of frame, wave time of ocean in engine
+	 */
+	virtual void BeginCopy(int32 Slot, float Time) = 0;
+
+	/* Start reading copied frame of slot to CPU, called a few frames after BeginCopy */
+	virtual void BeginRead(int32 Slot) = 0;
+
+	/* True when values of slot started by BeginRead can be accessed */
+	virtual bool IsReadComplete(int32 Slot) const = 0;
+
+	/* Red channel of slot as normalized floats, rows along X. Valid only after read is complete. */
+	virtual const float* GetValues(int32 Slot, int32& OutWidth, int32& OutHeight) const = 0;
+};
+
+typedef TSharedPtr<IHeightReadbackSource, ESPMode::ThreadSafe> FHeightReadbackSourcePtr;
+
+/* Copies render target into ring of CPU readback staging textures. Copy and map run on render thread,
+ * game thread only checks render command fences.
+ */
+class VOLUMETRICBUOYANCY_API FRenderTargetReadbackSource : public IHeightReadbackSource
+{
+public:
+	FRenderTargetReadbackSource(UTextureRenderTarget2D* InRenderTarget);
+	virtual ~FRenderTargetReadbackSource();
+
+	virtual void Initialize(int32 NumSlots) override;
+	virtual void BeginCopy(int32 Slot, float Time) override;
+	virtual void BeginRead(int32 Slot) override;
+	virtual bool IsReadComplete(int32 Slot) const override;
+	virtual const float* GetValues(int32 Slot, int32& OutWidth, int32& OutHeight) const override;
+
+	struct FSlot;
+
+private:
+	TWeakObjectPtr<UTextureRenderTarget2D> RenderTarget;
+
+	/* Render commands hold pointers to slots, they are deleted on render thread */
+	TArray<FSlot*> Slots;
+};
+
+/* CPU stand-in for render target producing synthetic waves, lets readback run headless or with -nullrhi.
+ * Frame is generated at BeginCopy time and becomes readable after ReadLatency calls of IsReadComplete.
+ */
+class VOLUMETRICBUOYANCY_API FSyntheticHeightSource : public IHeightReadbackSource
+{
+public:
+	FSyntheticHeightSource(int32 InWidth, int32 InHeight, int32 InReadLatency);
+
+	virtual void Initialize(int32 NumSlots) override;
+	virtual void BeginCopy(int32 Slot, float Time) override;
+	virtual void BeginRead(int32 Slot) override;
+	virtual bool IsReadComplete(int32 Slot) const override;
+	virtual const float* GetValues(int32 Slot, int32& OutWidth, int32& OutHeight) const override;
+
+	/* Normalized value of synthetic frame at texel and time */
+	static float GetSyntheticValue(int32 X, int32 Y, int32 Width, int32 Height, float Time);
+
+private:
+	struct FSlot
+	{
+		TArray<float> Values;
+		float Time;
+		mutable int32 PendingPolls;
+	};
+
+	int32 Width;
+	int32 Height;
+	int32 ReadLatency;
+
+	TArray<FSlot> Slots;
+};
+
+/* Ring of readback slots that exposes latest complete height frame without stalling game thread.
+ * Frame captured at frame N is copied, read once it is LatencyFrames old and published when read finishes.
+ * When every slot is busy capture is skipped instead of waiting.
+ */
+class VOLUMETRICBUOYANCY_API FHeightReadbackRing
+{
+public:
+	FHeightReadbackRing();
+
+	/* Start using source, drops previously published frame
+	 *	@param InSource					Source of frames
+	 *	@param NumSlots					Number of frames in flight
+	 *	@param InLatencyFrames			Frames between copy and read of slot
+	 */
+	void Initialize(const FHeightReadbackSourcePtr& InSource, int32 NumSlots, int32 InLatencyFrames);
+
+	/* Set how values are decoded into heights */
+	void SetDecodeParams(const FVector2D& InWorldCenter, float InWorldSize, float InHeightScale, float InHeightOffset, bool bInBuildMips);
+
+	/* Advance pipeline, publishes finished reads and starts new ones. Never waits.
+	 *	@param FrameNumber				Engine frame counter
+	 *	@param Time						Time of frame captured this tick
+	 *	@param bCapture					Start copy of current frame
+	 */
+	void Tick(uint64 FrameNumber, float Time, bool bCapture);
+
+	/* Release source and drop published frame */
+	void Shutdown();
+
+	bool HasFrame() const
+	{
+		return LatestFrame.IsValid();
+	}
+
+	/* Latest complete frame, stays valid for holder while ring publishes newer ones */
+	FHeightFieldPtr GetLatestFrame() const
+	{
+		return LatestFrame;
+	}
+
+	/* Time the latest frame was captured at, subtract from current time to get its latency */
+	float GetLatestTimestamp() const
+	{
+		return LatestTimestamp;
+	}
+
+	/* Engine frame latest frame was captured at */
+	uint64 GetLatestFrameNumber() const
+	{
+		return LatestFrameNumber;
+	}
+
+	/* Captures dropped because every slot was in flight */
+	int32 GetNumSkippedCaptures() const
+	{
+		return NumSkippedCaptures;
+	}
+
+private:
+	enum class ESlotState : uint8
+	{
+		Idle,
+		Copying,
+		Reading
+	};
+
+	struct FSlot
+	{
+		ESlotState State;
+		uint64 FrameNumber;
+		float Time;
+	};
+
+	void Publish(int32 SlotIndex);
+
+	FHeightReadbackSourcePtr Source;
+
+	TArray<FSlot> Slots;
+
+	int32 LatencyFrames;
+
+	/* Frames are double buffered, one not published is rebuilt in place when nobody else holds it */
+	TSharedPtr<FHeightField, ESPMode::ThreadSafe> Frames[2];
+	int32 LatestFrameIndex;
+
+	FHeightFieldPtr LatestFrame;
+	float LatestTimestamp;
+	uint64 LatestFrameNumber;
+
+	int32 NumSkippedCaptures;
+
+	FVector2D WorldCenter;
+	float WorldSize;
+	float HeightScale;
+	float HeightOffset;
+	bool bBuildMips;
+};
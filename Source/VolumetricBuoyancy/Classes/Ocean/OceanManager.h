@@ -2,8 +2,24 @@
 #pragma once
 
 #include "GameFramework/Actor.h"
+#include "BuoyancyCore/BuoyancyCore.h"
+#include "Ocean/OceanWater.h"
+#include "Async/Future.h"
 #include "OceanManager.generated.h"
 
+class AHeightMapReader;
+
+/* Where ocean takes wave heights from */
+UENUM(BlueprintType)
+enum class EOceanWaveSource : uint8
+{
+	/* Analytic sum of Gerstner waves */
+	Gerstner,
+
+	/* Height map texture decoded into height field, baked or simulated heights */
+	HeightMap
+};
+
 /**
  * 
  */
@@ -16,17 +32,219 @@ protected:
 
 	AOceanManager(const FObjectInitializer& ObjectInitializer);
 
+	/* Texels of Mip 0 of height map texture, read from texture once */
 	TArray<FColor> ColorBuffer;
 
+	int32 ColorBufferWidth;
+
+	int32 ColorBufferHeight;
+
+	/* Decoded height map used when WaveSource is HeightMap */
+	FHeightFieldPtr HeightField;
+
+	/* Height field rebuilt on worker thread by RefreshHeightMap, swapped in on tick when ready */
+	TFuture<FHeightFieldPtr> PendingHeightField;
+
+	/* Copy texels of height map texture into ColorBuffer under single lock */
+	bool ReadTextureTexels();
+
 	FVector Center;
 
 	float Size;
 
+	/* Precomputed wave components used by batched queries, rebuilt in UpdateWaveSpectrum */
+	FWaveSpectrum WaveSpectrum;
+
+	/* Displacements cached around buoyant bodies for current frame, filled by UpdateWaveCache */
+	FWaveHeightCache WaveHeightCache;
+
+	/* Water view of ocean without body, queries of ocean itself go through it */
+	FOceanWaterView MakeWaterView() const;
+
+	/* Clock step of server, replicated to clients at NetUpdateFrequency */
+	UPROPERTY(ReplicatedUsing = OnRep_ServerClockStep)
+	int32 ServerClockStep;
+
+	UFUNCTION()
+	void OnRep_ServerClockStep();
+
+	/* Last completed step of ocean clock and fraction of the next one */
+	int32 ClockStep;
+
+	float ClockStepFraction;
+
+	/* Steps client clock is behind server, removed over ClockSlewSeconds */
+	float ClockError;
+
+	/* Advance ocean clock by frame time, clients also remove part of their error */
+	void AdvanceClock(float DeltaSeconds);
+
+	/* Water properties of core solve built from Water category by UpdateWaterProperties */
+	BuoyancyCore::FWaterParams WaterParams;
+
+	/* FlowFieldVelocities split into components for bilinear sampling */
+	TArray<float> FlowVelocityX;
+	TArray<float> FlowVelocityY;
+
+	BuoyancyCore::FFlowField FlowField;
+
 public:
 
+	virtual void PostInitializeComponents() override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	UPROPERTY(EditAnywhere, Category = HeightMap)
 	UTexture2D* Texture;
 
+	/* Source of wave heights for buoyancy */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = HeightMap)
+	EOceanWaveSource WaveSource;
+
+	/* Reader of simulated render target, when set its latest read back frame replaces Texture */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = HeightMap)
+	AHeightMapReader* HeightMapReader;
+
+	/* World height difference between red channel 0 and 255 of height map */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = HeightMap)
+	float HeightMapScale;
+
+	/* World height of red channel 0 of height map */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = HeightMap)
+	float HeightMapOffset;
+
+	/* Build mip chain of height field for coarse lookups */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = HeightMap)
+	bool bHeightMapMips;
+
+	/* Wave clusters making up the ocean surface. Should match values used by ocean material. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GerstnerWave")
+	TArray<FGerstnerWaveCluster> WaveClusters;
+
+	/* Number of waves evaluated per cluster */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GerstnerWave", meta = (ClampMin = "1", ClampMax = "8"))
+	int32 WavesPerCluster;
+
+	/* Newton iterations of surface height queries, waves displace points horizontally so plain displacement at XY
+	 * is height of some other point. Every iteration is one evaluation of waves with slopes, measured on default ocean
+	 * (BuoyancyBench --waves): 0 has max error ~14uu, 1 ~1uu at ~1.2x cost, 2 converged (<0.01uu) at ~2x cost.
+	 * Steeper waves need the second iteration sooner.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GerstnerWave", meta = (ClampMin = "0", ClampMax = "4"))
+	int32 SurfaceHeightIterations;
+
+	/* Steps per second of ocean clock. Waves of all buoyancy queries are evaluated on this clock instead of world time,
+	 * server replicates it and fixed step bodies take one step per clock step, so it has to be the same on all machines.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ocean|Clock", meta = (ClampMin = "10", ClampMax = "240"))
+	int32 ClockStepsPerSecond;
+
+	/* Client clock further than this from server clock jumps to it, smaller errors are removed gradually */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ocean|Clock", meta = (ClampMin = "0.0"))
+	float ClockSnapSeconds;
+
+	/* Time over which client removes error of its clock, clock never runs backwards while doing so */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Ocean|Clock", meta = (ClampMin = "0.1"))
+	float ClockSlewSeconds;
+
+	/* Density of water, 0.0001 kg/cm^3 is 1000 kg/m^3 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Water", meta = (ClampMin = "0.0"))
+	float WaterDensity;
+
+	/* Drag of water against movement of submerged part of bodies relative to water */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Water", meta = (ClampMin = "0.0"))
+	float WaterLinearDrag;
+
+	/* Drag of water against rotation of submerged part of bodies */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Water", meta = (ClampMin = "0.0"))
+	float WaterAngularDrag;
+
+	/* Velocity of whole ocean (cm/s), tidal currents can change it at any time */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Water|Current")
+	FVector2D CurrentVelocity;
+
+	/* Corners of flow field, velocities outside of it are clamped to its border */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Water|Current")
+	FVector2D FlowFieldMin;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Water|Current")
+	FVector2D FlowFieldMax;
+
+	/* Samples of flow field along X, at least 2 for flow field to be used */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Water|Current", meta = (ClampMin = "0"))
+	int32 FlowFieldNumX;
+
+	/* Samples of flow field along Y, at least 2 for flow field to be used */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Water|Current", meta = (ClampMin = "0"))
+	int32 FlowFieldNumY;
+
+	/* FlowFieldNumX * FlowFieldNumY horizontal velocities (cm/s) row by row along X, added to CurrentVelocity. Rivers, tidal streams. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Water|Current")
+	TArray<FVector2D> FlowFieldVelocities;
+
+	/* Bodies are dragged along by orbital motion of Gerstner waves, off by default. Velocities are evaluated in the same batch as wave heights
+	 * of body, reusing their sin and cos, and decay with depth of body like in deep water.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Water|Current")
+	bool bWaveOrbitalVelocity;
+
+	/* Components with amplitude below this are dropped for bodies using wave LOD. Off by default: 0 disables wave LOD for every body,
+	 * whatever their WaveLODBias.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GerstnerWave|LOD")
+	float WaveLODMinAmplitude;
+
+	/* Beyond this distance from closest view, min amplitude grows linearly with distance */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GerstnerWave|LOD")
+	float WaveLODDistance;
+
+	/* Bodies smaller than this get min amplitude scaled up by BodySize ratio */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GerstnerWave|LOD")
+	float WaveLODBodySize;
+
+	/* Width of distance tier of buoyancy update rate: bodies solve once per 1 + (distance to closest view / tier width) updates.
+	 * Updates in between reuse last solve. 0 solves every body every update.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Buoyancy|LOD", meta = (ClampMin = "0"))
+	float UpdateTierDistance;
+
+	/* Longest interval between full solves of distant body */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Buoyancy|LOD", meta = (ClampMin = "1", ClampMax = "16"))
+	int32 MaxUpdateInterval;
+
+	/* Clipping test points generated for buoyant meshes per dominant wave length, see GetClippingPointSpacing */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Buoyancy|LOD", meta = (ClampMin = "1.0"))
+	float ClippingPointsPerWaveLength;
+
+	/* Max number of clipping test points of single mesh, long bodies get fewer points along their length */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Buoyancy|LOD", meta = (ClampMin = "4", ClampMax = "256"))
+	int32 MaxClippingPoints;
+
+	/* Cache wave displacements on grid tiles around buoyant bodies once per frame, queries become bilinear lookups.
+	 * Tiles are requested and filled by ABuoyancyManager with full spectrum. Only batches of full spectrum at frame time
+	 * whose samples all lie in filled tiles read them, the rest (wave LOD, substeps, other areas) keep using analytic waves.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GerstnerWave|Cache")
+	bool bUseWaveHeightCache;
+
+	/* World size of cached tile */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GerstnerWave|Cache", meta = (ClampMin = "100.0"))
+	float WaveCacheTileSize;
+
+	/* Samples along tile side. Sample spacing should stay well below shortest wave length. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GerstnerWave|Cache", meta = (ClampMin = "2", ClampMax = "65"))
+	int32 WaveCacheTileResolution;
+
+	/* Max number of cached tiles, bounds cache memory (12 * Resolution^2 bytes per tile) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "GerstnerWave|Cache", meta = (ClampMin = "1"))
+	int32 WaveCacheMaxTiles;
+
 	void Initialize();
 
 	UFUNCTION(BlueprintCallable, Category = "GerstnerWave")
@@ -38,6 +256,138 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "GerstnerWave")
 	FVector GetWaveHeight(FVector Location, float Time);
 
+	/* Height of water surface exactly above Location, unlike GetWaveHeight which displaces Location */
+	UFUNCTION(BlueprintCallable, Category = "GerstnerWave")
+	float GetSurfaceHeight(FVector Location, float Time);
+
+	/* Time of waves on ocean clock, the same on server and clients. Use it instead of world time when sampling waves. */
+	UFUNCTION(BlueprintCallable, Category = "GerstnerWave")
+	float GetWaveTime() const;
+
+	/* Last completed step of ocean clock, fixed step bodies are simulated up to it */
+	int32 GetClockStep() const
+	{
+		return ClockStep;
+	}
+
+	/* Reference sum of CalculateGerstnerWave over all clusters, slow but not using precomputed spectrum */
+	FVector GetWaveHeightReference(FVector Location, float Time);
+
+	/* Rebuild precomputed wave spectrum from WaveClusters. Call it whenever wave parameters change. */
+	void UpdateWaveSpectrum();
+
+	const FWaveSpectrum& GetWaveSpectrum() const
+	{
+		return WaveSpectrum;
+	}
+
+	/* Rebuild water properties and flow field, call after changing Water category at runtime */
+	UFUNCTION(BlueprintCallable, Category = "Water")
+	void UpdateWaterProperties();
+
+	/* Density and drag of water without velocity, gravity is up to caller */
+	const BuoyancyCore::FWaterParams& GetWaterParams() const
+	{
+		return WaterParams;
+	}
+
+	/* Velocity of water at location without waves: uniform current and flow field */
+	UFUNCTION(BlueprintCallable, Category = "Water")
+	FVector GetCurrentVelocity(FVector Location) const;
+
+	/* Velocity of water around body: current at Location and orbital velocity of waves decayed by Depth.
+	 * Orbital velocity is averaged over Batch when its last query evaluated velocities, otherwise it is evaluated at Location.
+	 *	@param Depth				Depth of body below surface, orbital velocity falls off as exp(-MinWaveNumber * Depth) of longest wave
+	 *	@param Batch				Wave samples of body from GetSurfaceHeightBatch with bVelocities, may be null
+	 *	@param NumComponents		Same wave LOD as Batch
+	 */
+	FVector GetWaterVelocity(const FVector& Location, float Depth, const FWaveSampleBatch* Batch, float Time, int32 NumComponents = MAX_int32) const;
+
+	/* Orbital velocity should be evaluated together with wave heights */
+	bool WantsWaveVelocities() const
+	{
+		return bWaveOrbitalVelocity && WaveSource == EOceanWaveSource::Gerstner;
+	}
+
+	/* Number of spectrum components worth evaluating for body
+	 *	@param Location			Location of body, used for distance to closest view
+	 *	@param BodySize			Size of body
+	 *	@param LODBias			Scale of min amplitude, 0 means full spectrum
+	 */
+	int32 GetWaveLOD(const FVector& Location, float BodySize, float LODBias) const;
+
+	/* Number of updates between full buoyancy solves of body at Location, see UpdateTierDistance */
+	int32 GetUpdateInterval(const FVector& Location) const;
+
+	/* Distance between clipping test points of buoyant meshes. 0 for height maps, which have no known wave length,
+	 * meshes then get 3 x 3 points over their footprint.
+	 */
+	float GetClippingPointSpacing() const;
+
+	/* Distance to closest view rendered last frame, MAX_flt when nothing was rendered */
+	float GetDistanceToClosestView(const FVector& Location) const;
+
+	/* Batched version of GetWaveHeight, evaluates wave components for every sample with SIMD.
+	 * Results match GetWaveHeightReference within FWaveSpectrum::BatchTolerance when all components are used.
+	 *	@param Batch	(in/out)	Sample positions, receives displacements
+	 *	@param Time					Time of waves
+	 *	@param NumComponents		Number of largest components to evaluate, see GetWaveLOD
+	 *	@param bVelocities			Also evaluate orbital velocities of samples, only analytic Gerstner waves have them
+	 */
+	void GetWaveHeightBatch(FWaveSampleBatch& Batch, float Time, int32 NumComponents = MAX_int32, bool bVelocities = false) const;
+
+	/* Height of water surface exactly above every sample into Batch.DisplacementZ, horizontal displacement of Gerstner waves
+	 * is inverted with SurfaceHeightIterations Newton iterations. Height map has no horizontal displacement, same as GetWaveHeightBatch.
+	 *	@param Batch	(in/out)	Sample positions, receives surface heights
+	 *	@param Time					Time of waves
+	 *	@param NumComponents		Number of largest components to evaluate, see GetWaveLOD
+	 *	@param bVelocities			Also evaluate orbital velocities of surface points, only analytic Gerstner waves have them
+	 */
+	void GetSurfaceHeightBatch(FWaveSampleBatch& Batch, float Time, int32 NumComponents = MAX_int32, bool bVelocities = false) const;
+
+	/* Water buoyancy of body at Location reads, made on game thread. Valid until ocean changes its waves or cache. */
+	FOceanWaterView GetWaterView(const FVector& Location) const;
+
+	/* Water view of body at Location which never reads ocean again, for physics thread. Spectrum is copied into OutSpectrum,
+	 * queries skip the wave cache and current is sampled at Location once.
+	 *	@param OutSpectrum	(out)	Copy of spectrum view points to, keep it alive as long as view
+	 */
+	FOceanWaterView GetDetachedWaterView(const FVector& Location, FWaveSpectrum& OutSpectrum) const;
+
+	/* Conservative range of water surface heights anywhere on ocean, safe to call from any thread
+	 *	@param OutMinZ, OutMaxZ	(out)	Lowest and highest possible surface height
+	 */
+	void GetWaveHeightRange(float& OutMinZ, float& OutMaxZ) const;
+
+	/* Mark area as needing cached waves in this frame, game thread only. No-op when cache is disabled. */
+	void RequestWaveCacheArea(const FBox& Bounds);
+
+	/* Fill cached tiles requested in this frame for Time, game thread only. No-op when cache is disabled. */
+	void UpdateWaveCache(float Time);
+
+	/* Bytes used by wave height cache */
+	UFUNCTION(BlueprintCallable, Category = "GerstnerWave")
+	int32 GetWaveCacheMemory() const;
+
+	/* Decode Texture into height field right away */
+	void UpdateHeightMap();
+
+	/* Decode Texture into new height field on worker thread, current height field is used until new one is ready */
+	UFUNCTION(BlueprintCallable, Category = HeightMap)
+	void RefreshHeightMap();
+
+	/* Bilinear filtered height of height map at location, 0 if there is no height map
+	 *	@param Mip				Mip of height field, higher is coarser
+	 */
+	float GetHeightMapHeight(const FVector& Location, int32 Mip = 0) const;
+
+	/* Wave time heights of height map were captured at, simulated heights lag a few frames behind GetWaveTime */
+	UFUNCTION(BlueprintCallable, Category = HeightMap)
+	float GetHeightMapTimestamp() const;
+
+	/* Height field used for queries: latest frame of HeightMapReader, otherwise decoded Texture */
+	FHeightFieldPtr GetActiveHeightField() const;
+
 	UFUNCTION(BlueprintCallable, Category = "GerstnerWave")
 	FColor GetTextureColorAt(int32 x, int32 y);
 };
@@ -0,0 +1,90 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "BuoyancyCore/BuoyancyCore.h"
+#include "Ocean/WaveSpectrum.h"
+#include "Ocean/WaveHeightCache.h"
+#include "Ocean/HeightField.h"
+
+/* Everything buoyancy of single body reads from ocean: waves, height field, current and level of detail of the body.
+ * Made by AOceanManager::GetWaterView on game thread. It points to spectrum and wave cache of ocean, so it is valid until ocean
+ * changes them on game thread. Substepped bodies use AOceanManager::GetDetachedWaterView, which doesn't point into ocean at all.
+ */
+struct VOLUMETRICBUOYANCY_API FOceanWaterView
+{
+	/* Waves of Gerstner ocean */
+	const FWaveSpectrum* WaveSpectrum;
+
+	/* Frame cache of waves, null evaluates every query */
+	const FWaveHeightCache* WaveHeightCache;
+
+	/* Heights of height map ocean, it has no horizontal displacement and no velocities */
+	FHeightFieldPtr HeightField;
+
+	bool bHeightMap;
+
+	/* Newton iterations of surface height queries, see AOceanManager::SurfaceHeightIterations */
+	int32 SurfaceHeightIterations;
+
+	bool bWaveVelocities;
+
+	/* Density and drag of water without velocity */
+	BuoyancyCore::FWaterParams Params;
+
+	FVector2D CurrentVelocity;
+
+	/* Added to CurrentVelocity, invalid when there is none */
+	BuoyancyCore::FFlowField FlowField;
+
+	/* Wave LOD and update rate settings of ocean */
+	float WaveLODMinAmplitude;
+	float WaveLODDistance;
+	float WaveLODBodySize;
+	float UpdateTierDistance;
+	int32 MaxUpdateInterval;
+
+	/* Distance of body to closest view rendered last frame, MAX_flt when nothing was rendered */
+	float ViewDistance;
+
+	FOceanWaterView();
+
+	/* See AOceanManager::GetWaveHeightBatch */
+	void GetWaveHeightBatch(FWaveSampleBatch& Batch, float Time, int32 NumComponents = MAX_int32, bool bVelocities = false) const;
+
+	/* See AOceanManager::GetSurfaceHeightBatch */
+	void GetSurfaceHeightBatch(FWaveSampleBatch& Batch, float Time, int32 NumComponents = MAX_int32, bool bVelocities = false) const;
+
+	/* See AOceanManager::GetWaveHeightRange */
+	void GetWaveHeightRange(float& OutMinZ, float& OutMaxZ) const;
+
+	/* See AOceanManager::GetCurrentVelocity */
+	FVector GetCurrentVelocity(const FVector& Location) const;
+
+	/* See AOceanManager::GetWaterVelocity */
+	FVector GetWaterVelocity(const FVector& Location, float Depth, const FWaveSampleBatch* Batch, float Time, int32 NumComponents = MAX_int32) const;
+
+	/* Number of spectrum components worth evaluating for body, see AOceanManager::GetWaveLOD */
+	int32 GetWaveLOD(float BodySize, float LODBias) const;
+
+	/* Number of updates between full buoyancy solves of body, see AOceanManager::UpdateTierDistance */
+	int32 GetUpdateInterval() const;
+
+	const BuoyancyCore::FWaterParams& GetWaterParams() const
+	{
+		return Params;
+	}
+
+	/* Orbital velocity should be evaluated together with wave heights */
+	bool WantsWaveVelocities() const
+	{
+		return bWaveVelocities;
+	}
+
+private:
+
+	/* Batch can be read from WaveHeightCache: query of full spectrum without velocities at time of cache,
+	 * every sample within Padding of its position is in filled tile. Other queries keep SIMD evaluation and their wave LOD.
+	 */
+	bool CanSampleWaveCache(const FWaveSampleBatch& Batch, float Time, int32 NumComponents, bool bVelocities, float Padding) const;
+};
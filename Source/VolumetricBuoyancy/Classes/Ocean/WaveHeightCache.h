@@ -0,0 +1,107 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "Ocean/WaveSpectrum.h"
+
+/* Square tile of cached wave displacements */
+struct FWaveHeightTile
+{
+	/* Tile location in units of tile size */
+	FIntPoint Coord;
+
+	/* Last cache frame tile was requested in */
+	uint32 RequestFrame;
+
+	/* Wave time tile is filled for */
+	float Time;
+
+	bool bFilled;
+
+	FWaveHeightTile()
+		: Coord(0, 0)
+		, RequestFrame(0)
+		, Time(0.0f)
+		, bFilled(false)
+	{
+	}
+};
+
+/* Per-frame cache of wave displacements on regular grid tiles around buoyant bodies.
+ * Tiles are requested on game thread, filled once per frame in parallel and then sampled
+ * with bilinear interpolation, which is safe from any number of threads until next update.
+ * Number of tiles is bounded, queries outside of cached tiles have to fall back to analytic waves.
+ */
+class VOLUMETRICBUOYANCY_API FWaveHeightCache
+{
+public:
+
+	/* Largest supported number of samples along tile side */
+	static const int32 MaxTileResolution = 65;
+
+	FWaveHeightCache();
+
+	/* Set tile layout, drops all tiles when layout changes
+	 *	@param InTileSize			World size of tile side
+	 *	@param InTileResolution		Number of samples along tile side, neighbour tiles share border samples
+	 *	@param InMaxTiles			Max number of tiles kept in memory
+	 */
+	void Configure(float InTileSize, int32 InTileResolution, int32 InMaxTiles);
+
+	/* Drop all tiles and free memory */
+	void Reset();
+
+	/* Mark tiles overlapping area as needed in this frame. Game thread only. */
+	void RequestArea(const FBox2D& Area);
+
+	/* Fill tiles requested since last update that aren't filled for Time yet and start new frame. Game thread only. */
+	void Update(const FWaveSpectrum& Spectrum, float Time);
+
+	/* Every tile overlapping area is filled for Time, so no location in area misses the cache */
+	bool IsAreaCached(const FBox2D& Area, float Time) const;
+
+	/* Cached displacement at location, returns false if location is not cached for Time */
+	bool GetDisplacement(float X, float Y, float Time, FVector& OutDisplacement) const;
+
+	/* Cached displacement and its derivatives along world X and Y, slopes are constant along cell edges of bilinear patch */
+	bool GetDisplacement(float X, float Y, float Time, FVector& OutDisplacement, FVector& OutSlopeX, FVector& OutSlopeY) const;
+
+	int32 GetNumTiles() const
+	{
+		return Tiles.Num();
+	}
+
+	/* Bytes allocated by cache */
+	uint32 GetAllocatedSize() const;
+
+private:
+
+	/* Index of tile at Coord, reuses least recently requested tile when cache is full. INDEX_NONE if every tile is in use. */
+	int32 FindOrAddTile(const FIntPoint& Coord);
+
+	void FillTile(int32 TileIndex, const FWaveSpectrum& Spectrum, float Time);
+
+	/* Cell of filled tile containing location
+	 *	@param OutPlane		(out)	First sample of cell in X displacement plane, Y and Z planes follow after TileResolution^2 floats
+	 *	@param OutFracX, OutFracY	Location inside cell, 0..1
+	 */
+	bool FindCell(float X, float Y, float Time, const float*& OutPlane, float& OutFracX, float& OutFracY) const;
+
+	float TileSize;
+
+	int32 TileResolution;
+
+	int32 MaxTiles;
+
+	TArray<FWaveHeightTile> Tiles;
+
+	TMap<FIntPoint, int32> TileMap;
+
+	/* 3 * TileResolution^2 floats per tile: X, Y and Z displacement planes, rows along X */
+	TArray<float> Displacements;
+
+	/* Tiles filled by current update, kept to avoid allocations */
+	TArray<int32> PendingTiles;
+
+	uint32 CurrentFrame;
+};
@@ -0,0 +1,218 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "BuoyancyCore/GerstnerWaves.h"
+#include "WaveSpectrum.generated.h"
+
+/* Editable parameters of single Gerstner wave cluster, expanded into spectrum components by AOceanManager */
+USTRUCT(BlueprintType)
+struct FGerstnerWaveCluster
+{
+	GENERATED_USTRUCT_BODY()
+
+	/* Wave length of median wave in cluster, other waves are scaled from it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GerstnerWave")
+	float MedianWaveLength;
+
+	/* Amplitude of median wave in cluster, other waves are scaled from it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GerstnerWave")
+	float MedianAmplitude;
+
+	/* Direction of median wave, other waves are rotated from it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GerstnerWave")
+	FVector2D MedianDirection;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GerstnerWave")
+	float Steepness;
+
+	/* Phase speed multiplier for time. 1.0 matches ocean material. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "GerstnerWave")
+	float AngularFrequency;
+
+	FGerstnerWaveCluster()
+	{
+		MedianWaveLength = 1000.0f;
+		MedianAmplitude = 100.0f;
+		MedianDirection = FVector2D(0.0f, 1.0f);
+		Steepness = 0.5f;
+		AngularFrequency = 1.0f;
+	}
+
+	FGerstnerWaveCluster(float InWaveLength, float InAmplitude, FVector2D InDirection, float InSteepness)
+	{
+		MedianWaveLength = InWaveLength;
+		MedianAmplitude = InAmplitude;
+		MedianDirection = InDirection;
+		Steepness = InSteepness;
+		AngularFrequency = 1.0f;
+	}
+};
+
+/* Structure-of-arrays batch of wave samples. Positions go in, displacements come out. */
+struct VOLUMETRICBUOYANCY_API FWaveSampleBatch
+{
+	TArray<float> PositionX;
+	TArray<float> PositionY;
+
+	TArray<float> DisplacementX;
+	TArray<float> DisplacementY;
+	TArray<float> DisplacementZ;
+
+	/* Scratch of surface height queries: undisplaced points found above samples and slopes of displacement there */
+	TArray<float> SurfaceX;
+	TArray<float> SurfaceY;
+	TArray<float> SlopeXX;
+	TArray<float> SlopeXY;
+	TArray<float> SlopeYY;
+	TArray<float> SlopeZX;
+	TArray<float> SlopeZY;
+
+	/* Orbital velocity of water at surface above samples, filled only by queries asked for velocities */
+	TArray<float> VelocityX;
+	TArray<float> VelocityY;
+	TArray<float> VelocityZ;
+
+	/* Remove all samples but keep allocated memory */
+	void Reset();
+
+	/* Resize batch to NumSamples uninitialized samples, memory is never shrunk */
+	void SetNum(int32 NumSamples);
+
+	/* Add sample position, returns index of sample */
+	int32 Add(float X, float Y);
+
+	/* Size displacements (slopes and velocities) to number of samples, returns them as buffers of buoyancy core.
+	 * Without bVelocities velocities are emptied, so they are never left over from earlier query.
+	 */
+	BuoyancyCore::FWaveSampleBuffers SetNumOutputs(bool bSlopes, bool bVelocities = false);
+
+	int32 Num() const
+	{
+		return PositionX.Num();
+	}
+
+	/* Sum of capacities of all arrays, changes only when some array was reallocated */
+	int32 GetCapacity() const
+	{
+		return PositionX.Max() + PositionY.Max() + DisplacementX.Max() + DisplacementY.Max() + DisplacementZ.Max() + SurfaceX.Max() + SurfaceY.Max()
+			+ SlopeXX.Max() + SlopeXY.Max() + SlopeYY.Max() + SlopeZX.Max() + SlopeZY.Max() + VelocityX.Max() + VelocityY.Max() + VelocityZ.Max();
+	}
+
+	/* Velocities of last query are valid for every sample */
+	bool HasVelocities() const
+	{
+		return Num() > 0 && VelocityX.Num() == Num();
+	}
+
+	FVector GetDisplacement(int32 Index) const
+	{
+		return FVector(DisplacementX[Index], DisplacementY[Index], DisplacementZ[Index]);
+	}
+};
+
+/* Precompiled Gerstner wave spectrum stored as flat arrays, sorted by amplitude (largest first).
+ * Everything that depends only on wave parameters is computed once when the spectrum is built,
+ * so evaluation is just a dot product and a sin/cos per component.
+ * Because of sorting, using only first N components is the level of detail of the spectrum.
+ */
+USTRUCT()
+struct VOLUMETRICBUOYANCY_API FWaveSpectrum
+{
+	GENERATED_USTRUCT_BODY()
+
+	/* Max difference (in uu) between EvaluateBatch and scalar CalculateGerstnerWave sum for points within 1km of origin */
+	static const float BatchTolerance;
+
+	/* Rotated direction of component */
+	TArray<float> DirectionX;
+	TArray<float> DirectionY;
+
+	/* 2PI / WaveLength */
+	TArray<float> WaveNumber;
+
+	/* Time multiplier of component phase */
+	TArray<float> AngularFrequency;
+
+	/* Amplitude with weight applied, also vertical displacement scale */
+	TArray<float> Amplitude;
+
+	TArray<float> Steepness;
+
+	/* Constant phase offset of component */
+	TArray<float> Phase;
+
+	/* WaveNumber * Direction */
+	TArray<float> WaveVectorX;
+	TArray<float> WaveVectorY;
+
+	/* Steepness * Amplitude * Direction */
+	TArray<float> DisplacementScaleX;
+	TArray<float> DisplacementScaleY;
+
+	/* Sum of absolute amplitudes, vertical displacement never leaves -MaxVerticalDisplacement..MaxVerticalDisplacement */
+	float MaxVerticalDisplacement;
+
+	/* Sum of Steepness * Amplitude, undisplaced point of surface is never further than this from its displaced point */
+	float MaxHorizontalDisplacement;
+
+	/* Wave number of longest wave, 0 if spectrum is empty. Kept apart as components are sorted by amplitude, not length. */
+	float MinWaveNumber;
+
+	FWaveSpectrum()
+		: MaxVerticalDisplacement(0.0f)
+		, MaxHorizontalDisplacement(0.0f)
+		, MinWaveNumber(0.0f)
+	{
+	}
+
+	void Reset();
+
+	int32 Num() const
+	{
+		return Phase.Num();
+	}
+
+	/* Add single component, parameters are the same as AOceanManager::CalculateGerstnerWave
+	 *	@param ComponentFrequency	Time multiplier of phase
+	 *	@param Weight				Scale of component in final sum
+	 */
+	void AddComponent(float WaveLength, float ComponentAmplitude, FVector2D Direction, float Angle, float ComponentSteepness, float ComponentFrequency, float ComponentPhase, float Weight);
+
+	/* Sort components by amplitude so the most important ones come first. Call after adding all components. */
+	void SortByAmplitude();
+
+	/* Components as arrays of buoyancy core */
+	BuoyancyCore::FGerstnerSpectrumView GetView() const;
+
+	/* Number of components with amplitude at least MinAmplitude (never less than 1 if spectrum is not empty) */
+	int32 GetNumComponentsAbove(float MinAmplitude) const;
+
+	/* Wave length of component with largest amplitude, 0 if spectrum is empty. Valid after SortByAmplitude. */
+	float GetDominantWaveLength() const;
+
+	/* Evaluate displacement at single position using first NumComponents components */
+	FVector Evaluate(float X, float Y, float Time, int32 NumComponents = MAX_int32) const;
+
+	/* Evaluate displacement and its derivatives along world X (OutSlopeX) and Y (OutSlopeY) at single position */
+	FVector Evaluate(float X, float Y, float Time, int32 NumComponents, FVector& OutSlopeX, FVector& OutSlopeY) const;
+
+	/* Orbital velocity of surface point at single position, derivative of displacement in time */
+	FVector EvaluateVelocity(float X, float Y, float Time, int32 NumComponents = MAX_int32) const;
+
+	/* Evaluate displacements for NumSamples positions, 4 at a time with SIMD */
+	void EvaluateBatch(const float* X, const float* Y, int32 NumSamples, float Time, float* OutX, float* OutY, float* OutZ, int32 NumComponents = MAX_int32) const;
+
+	/*	@param bVelocities			Also evaluate orbital velocities into Batch, they reuse sin and cos of displacements */
+	void EvaluateBatch(FWaveSampleBatch& Batch, float Time, int32 NumComponents = MAX_int32, bool bVelocities = false) const;
+
+	/* Evaluate displacements, and slopes and velocities if Out has them, for NumSamples positions 4 at a time with SIMD */
+	void EvaluateBatch(const float* X, const float* Y, int32 NumSamples, float Time, const BuoyancyCore::FWaveSampleBuffers& Out, int32 NumComponents = MAX_int32) const;
+
+	/* Height of displaced surface exactly above every sample into Batch.DisplacementZ, see BuoyancyCore::SampleSurfaceHeights.
+	 * Displacement evaluated at sample is height of point moved away horizontally by up to Steepness * Amplitude.
+	 *	@param NumIterations		Newton iterations, 0 is plain displacement at sample, every iteration is one evaluation with slopes
+	 *	@param bVelocities			Also evaluate orbital velocities of surface points into Batch
+	 */
+	void EvaluateSurfaceHeightBatch(FWaveSampleBatch& Batch, float Time, int32 NumIterations, int32 NumComponents = MAX_int32, bool bVelocities = false) const;
+};
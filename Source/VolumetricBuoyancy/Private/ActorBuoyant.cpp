@@ -2,12 +2,26 @@
 
 #include "VolumetricBuoyancy.h"
 #include "ActorBuoyant.h"
+#include "BuoyancyManager.h"
+#include "Misc/BuoyancyRecorder.h"
+#include "UnrealNetwork.h"
 
 AActorBuoyant::AActorBuoyant(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 	PrimaryActorTick.bCanEverTick = true;
 	bDrawBuoyancyDebug = false;
+	bUseBuoyancyManager = true;
+	bAdaptiveClippingPoints = true;
+	ProxyMaxTriangles = 0;
+	BuoyancyUpdateMode = EBuoyancyUpdateMode::PerFrame;
+	SubstepWaveTime = 0.0f;
+	SubstepGravityZ = 0.0f;
+	CorrectionInterval = 2.0f;
+	MaxCatchUpSteps = 30;
+	FixedStep = 0;
+
+	OnCalculateCustomPhysics.BindUObject(this, &AActorBuoyant::SubstepTick);
 
 	/* Default setup for Buoyant Mesh */
 	BuoyantMesh = ObjectInitializer.CreateDefaultSubobject<UStaticMeshComponent>(this, TEXT("BuoyantMesh"));
@@ -15,16 +29,65 @@ AActorBuoyant::AActorBuoyant(const FObjectInitializer& ObjectInitializer)
 	BuoyantMesh->SetVisibility(false);
 	BuoyantMesh->SetSimulatePhysics(true);
 	BuoyantMesh->SetPhysicsMaxAngularVelocity(1500.0f);
+
+	// Hits wake sleeping buoyancy
+	BuoyantMesh->SetNotifyRigidBodyCollision(true);
 	
 }
 
+void AActorBuoyant::PostInitProperties()
+{
+	// Fixed step bodies are simulated by every machine, only corrections are replicated
+	if (BuoyancyUpdateMode == EBuoyancyUpdateMode::FixedStep)
+	{
+		bReplicates = true;
+		bReplicateMovement = false;
+	}
+
+	Super::PostInitProperties();
+}
+
 void AActorBuoyant::BeginPlay()
 {
 	Super::BeginPlay();
 
 	CurrentOceanManager = FindOceanManager();
 
-	BuoyancyData.BodyVolume = UBuoyancyHelper::ComputeVolume(BuoyantMesh, BuoyancyData.LocalCentroidOfVolume);
+	// Ocean clock has to advance before body samples waves
+	if (CurrentOceanManager)
+	{
+		AddTickPrerequisiteActor(CurrentOceanManager);
+	}
+
+	const float ClippingPointSpacing = CurrentOceanManager->IsValidLowLevel() ? CurrentOceanManager->GetClippingPointSpacing() : -1.0f;
+	const int32 MaxClippingPoints = CurrentOceanManager->IsValidLowLevel() ? CurrentOceanManager->MaxClippingPoints : 32;
+
+	// Sections replace BuoyantMesh, it only carries body then
+	if (Sections.Num() > 0)
+	{
+		BuoyancyData.Mesh = nullptr;
+	}
+	// Proxy was simplified in editor, only its few triangles are prepared here
+	else if (ProxyMaxTriangles > 0 && BuoyancyProxy.IsValid() && BuoyancyProxy.SourceMesh == BuoyantMesh->StaticMesh)
+	{
+		BuoyancyData.Mesh = FBuoyancyMesh::Build(BuoyancyProxy.Vertices, BuoyancyProxy.Indices, ClippingPointSpacing, MaxClippingPoints);
+	}
+	else
+	{
+		if (ProxyMaxTriangles > 0)
+		{
+			GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Buoyancy proxy is missing or out of date, using collision mesh!");
+		}
+
+		// Triangle data, volume, centroid and clipping points are shared with every other actor using the same mesh
+		BuoyancyData.Mesh = FBuoyancyMesh::Get(BuoyantMesh, ClippingPointSpacing, MaxClippingPoints);
+	}
+
+	if (BuoyancyData.Mesh.IsValid())
+	{
+		BuoyancyData.BodyVolume = BuoyancyData.Mesh->Volume;
+		BuoyancyData.LocalCentroidOfVolume = BuoyancyData.Mesh->LocalCentroid;
+	}
 	
 	SetClippingTestPoints(BuoyancyData.ClippingPointsOffsets);
 
@@ -39,7 +102,69 @@ void AActorBuoyant::BeginPlay()
 	// Set back old rotation
 	BuoyantMesh->SetWorldRotation(OldRot);
 
-	
+	BuoyancyData.LocalCenterOfMass = BuoyantMesh->GetComponentTransform().InverseTransformPosition(BuoyantMesh->GetCenterOfMass());
+	BuoyancyData.UpdateBodyParams();
+
+	BuildSections(ClippingPointSpacing, MaxClippingPoints);
+
+	if (BuoyancyUpdateMode == EBuoyancyUpdateMode::FixedStep && CanComputeBuoyancy())
+	{
+		InitFixedStep();
+	}
+
+	// Substepped bodies are evaluated by physics, not by manager
+	if (bUseBuoyancyManager && BuoyancyUpdateMode == EBuoyancyUpdateMode::PerFrame)
+	{
+		BuoyancyManager = ABuoyancyManager::Get(GetWorld());
+
+		if (BuoyancyManager)
+		{
+			BuoyancyManager->RegisterBody(this);
+		}
+	}
+}
+
+void AActorBuoyant::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AActorBuoyant, FixedStepCorrection);
+}
+
+#if WITH_EDITOR
+void AActorBuoyant::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	const FName PropertyName = PropertyChangedEvent.Property ? PropertyChangedEvent.Property->GetFName() : NAME_None;
+
+	// Simplification is slow, redo it only when budget or mesh changed
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(AActorBuoyant, ProxyMaxTriangles) || (BuoyantMesh && BuoyancyProxy.SourceMesh != BuoyantMesh->StaticMesh))
+	{
+		RebuildBuoyancyProxy();
+	}
+}
+#endif
+
+void AActorBuoyant::RebuildBuoyancyProxy()
+{
+	BuoyancyProxy = FBuoyancyProxy();
+
+	if (ProxyMaxTriangles > 0 && BuoyantMesh)
+	{
+		UBuoyancyHelper::BuildBuoyancyProxy(BuoyantMesh, ProxyMaxTriangles, BuoyancyProxy);
+	}
+}
+
+void AActorBuoyant::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (BuoyancyManager)
+	{
+		BuoyancyManager->UnregisterBody(this);
+		BuoyancyManager = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void AActorBuoyant::Tick(float DeltaSeconds)
@@ -48,21 +173,300 @@ void AActorBuoyant::Tick(float DeltaSeconds)
 
 	if (CurrentOceanManager->IsValidLowLevel())
 	{
-		UBuoyancyHelper::ComputeBuoyancy(CurrentOceanManager, BuoyantMesh, BuoyancyData);
+		if (BuoyancyUpdateMode == EBuoyancyUpdateMode::FixedStep)
+		{
+			TickFixedStep();
+		}
+		else if (BuoyancyUpdateMode == EBuoyancyUpdateMode::PerSubstep)
+		{
+			// Physics steps from previous frame time to current one, substeps advance wave time
+			SubstepWaveTime = CurrentOceanManager->GetWaveTime() - DeltaSeconds;
+			SubstepGravityZ = GetWorld()->GetGravityZ();
+
+			if (CanComputeBuoyancy() && BuoyantMesh->GetBodyInstance())
+			{
+				SubstepWater = CurrentOceanManager->GetDetachedWaterView(BuoyantMesh->GetComponentLocation(), SubstepSpectrum);
+
+				BuoyantMesh->GetBodyInstance()->AddCustomPhysics(OnCalculateCustomPhysics);
+			}
+		}
+		// Managed bodies are solved together by buoyancy manager
+		else if (!BuoyancyManager)
+		{
+			if (Sections.Num() == 0)
+			{
+				UBuoyancyHelper::ComputeBuoyancy(CurrentOceanManager, BuoyantMesh, BuoyancyData);
+			}
+			else if (CanComputeBuoyancy())
+			{
+				FBuoyantBodyState State;
+				UBuoyancyHelper::GetBodyState(BuoyantMesh, State);
+
+				FBuoyancyForces Forces;
+				ComputeSectionForces(CurrentOceanManager->GetWaterView(State.Transform.GetLocation()), State, CurrentOceanManager->GetWaveTime(), GetWorld()->GetGravityZ(), Forces);
+
+				UBuoyancyHelper::ApplyBuoyancyForces(BuoyantMesh, Forces);
+			}
+		}
 
 		DrawDebugHelpers();
 	}
 }
 
+void AActorBuoyant::SubstepTick(float DeltaTime, FBodyInstance* BodyInstance)
+{
+	SubstepWaveTime += DeltaTime;
+
+	FBuoyantBodyState State;
+	UBuoyancyHelper::GetBodyState(BodyInstance, BuoyancyData, State);
+
+	FBuoyancyForces Forces;
+	if (Sections.Num() == 0)
+	{
+		UBuoyancyHelper::ComputeBuoyancyForces(SubstepWater, State, SubstepWaveTime, SubstepGravityZ, BuoyancyData, Forces);
+	}
+	else
+	{
+		ComputeSectionForces(SubstepWater, State, SubstepWaveTime, SubstepGravityZ, Forces);
+	}
+
+	UBuoyancyHelper::ApplyBuoyancyForces(BodyInstance, Forces);
+}
+
+void AActorBuoyant::InitFixedStep()
+{
+	FixedStepHulls.Reset();
+
+	for (int32 i = 0; i < GetNumBuoyancySections(); ++i)
+	{
+		const FBuoyantBodyData& Data = GetBuoyancySection(i);
+
+		BuoyancyCore::FFixedStepHull& Hull = FixedStepHulls[FixedStepHulls.AddDefaulted()];
+		Hull.Mesh = Data.Mesh->GetView();
+		Hull.Body = Data.BodyParams;
+		Hull.MassFraction = Data.MassFraction;
+	}
+
+	const FBodyInstance* BodyInstance = BuoyantMesh->GetBodyInstance();
+	const float Mass = BuoyantMesh->GetMass();
+
+	FixedStepBody.Hulls = FixedStepHulls.GetData();
+	FixedStepBody.NumHulls = FixedStepHulls.Num();
+	FixedStepBody.Water = CurrentOceanManager->GetWaterParams();
+	FixedStepBody.Water.GravityZ = GetWorld()->GetGravityZ();
+
+	// Recorded sessions hold only constant water, so fixed step bodies drift with uniform current but not with flow field or waves
+	FixedStepBody.Water.Velocity = BuoyancyCore::FVec3(CurrentOceanManager->CurrentVelocity.X, CurrentOceanManager->CurrentVelocity.Y, 0.0f);
+	FixedStepBody.LocalCenterOfMass = ToCoreVector(BuoyancyData.LocalCenterOfMass);
+	FixedStepBody.LinearDamping = BodyInstance->LinearDamping;
+	FixedStepBody.AngularDamping = BodyInstance->AngularDamping;
+	FixedStepBody.MaxAngularVelocity = BodyInstance->MaxAngularVelocity;
+	FixedStepBody.SurfaceIterations = CurrentOceanManager->SurfaceHeightIterations;
+
+	// Principal axes of physics body are assumed to be axes of mesh
+	FVector Inertia = BodyInstance->GetBodyInertiaTensor();
+	if (Inertia.IsNearlyZero())
+	{
+		const FBoxSphereBounds LocalBounds = BuoyantMesh->CalcBounds(FTransform::Identity);
+		Inertia = FromCoreVector(BuoyancyCore::ComputeBoxInertia(Mass, ToCoreVector(LocalBounds.BoxExtent * 2.0f)));
+	}
+	FixedStepBody.LocalInertia = ToCoreVector(Inertia);
+
+	FixedStepScratch.SetNumUninitialized(BuoyancyCore::FFixedStepScratch::FloatsPerVertex * FixedStepBody.GetMaxVertices());
+
+	BuoyancyCore::FBodyState State;
+	State.Location = ToCoreVector(BuoyantMesh->GetComponentLocation());
+	State.Rotation = ToCoreQuat(BuoyantMesh->GetComponentQuat());
+	State.CenterOfMass = State.Location + State.Rotation.RotateVector(FixedStepBody.LocalCenterOfMass);
+	State.LinearVelocity = ToCoreVector(BuoyantMesh->GetPhysicsLinearVelocity());
+	State.AngularVelocity = ToCoreVector(BuoyantMesh->GetPhysicsAngularVelocity());
+	State.Mass = Mass;
+
+	// Integrator moves body from now on
+	BuoyantMesh->SetSimulatePhysics(false);
+
+	ResetFixedStep(CurrentOceanManager->GetClockStep(), State);
+
+	// Correction might have arrived with actor, before it began play
+	if (FixedStepCorrection.Step != INDEX_NONE)
+	{
+		OnRep_FixedStepCorrection();
+	}
+}
+
+void AActorBuoyant::TickFixedStep()
+{
+	if (FixedStepHulls.Num() == 0)
+	{
+		return;
+	}
+
+	const int32 TargetStep = CurrentOceanManager->GetClockStep();
+
+	// After hitch or clock jump skip steps instead of stalling the frame, next correction fixes state
+	if (TargetStep - FixedStep > MaxCatchUpSteps)
+	{
+		ResetFixedStep(TargetStep - MaxCatchUpSteps, FixedStepState);
+	}
+
+	AdvanceFixedStep(TargetStep);
+
+	const int32 CorrectionSteps = FMath::Max(1, FMath::RoundToInt(CorrectionInterval * CurrentOceanManager->ClockStepsPerSecond));
+
+	if (HasAuthority() && (FixedStepCorrection.Step == INDEX_NONE || FixedStep - FixedStepCorrection.Step >= CorrectionSteps))
+	{
+		FixedStepCorrection.Step = FixedStep;
+		FixedStepCorrection.Location = FromCoreVector(FixedStepState.Location);
+		FixedStepCorrection.Rotation = FromCoreQuat(FixedStepState.Rotation);
+		FixedStepCorrection.LinearVelocity = FromCoreVector(FixedStepState.LinearVelocity);
+		FixedStepCorrection.AngularVelocity = FromCoreVector(FixedStepState.AngularVelocity);
+	}
+
+	BuoyantMesh->SetWorldLocationAndRotation(FromCoreVector(FixedStepState.Location), FromCoreQuat(FixedStepState.Rotation), false, nullptr, ETeleportType::TeleportPhysics);
+}
+
+void AActorBuoyant::AdvanceFixedStep(int32 TargetStep)
+{
+	const BuoyancyCore::FGerstnerSpectrumView Waves = CurrentOceanManager->GetWaveSpectrum().GetView();
+	const BuoyancyCore::FFixedStepScratch Scratch = BuoyancyCore::FFixedStepScratch::FromBuffer(FixedStepScratch.GetData(), FixedStepBody.GetMaxVertices());
+	const int32 StepsPerSecond = CurrentOceanManager->ClockStepsPerSecond;
+
+	for (; FixedStep < TargetStep; ++FixedStep)
+	{
+		BUOYANCY_COUNT(BodiesSolved, FixedStepBody.NumHulls);
+
+		BuoyancyCore::StepBody(Waves, FixedStepBody, FixedStep, StepsPerSecond, Scratch, FixedStepState);
+
+		if (GBuoyancyRecorder.IsRecording())
+		{
+			GBuoyancyRecorder.RecordState(this, BuoyancyCore::ESessionRecord::Step, FixedStep + 1, FixedStepState);
+		}
+	}
+}
+
+void AActorBuoyant::ResetFixedStep(int32 Step, const BuoyancyCore::FBodyState& State)
+{
+	FixedStep = Step;
+	FixedStepState = State;
+
+	if (GBuoyancyRecorder.IsRecording())
+	{
+		GBuoyancyRecorder.RecordState(this, BuoyancyCore::ESessionRecord::Reset, FixedStep, FixedStepState);
+	}
+}
+
+void AActorBuoyant::OnRep_FixedStepCorrection()
+{
+	if (FixedStepHulls.Num() == 0 || FixedStepCorrection.Step == INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 CurrentStep = FixedStep;
+
+	BuoyancyCore::FBodyState State = FixedStepState;
+	State.Location = ToCoreVector(FixedStepCorrection.Location);
+	State.Rotation = ToCoreQuat(FixedStepCorrection.Rotation);
+	State.CenterOfMass = State.Location + State.Rotation.RotateVector(FixedStepBody.LocalCenterOfMass);
+	State.LinearVelocity = ToCoreVector(FixedStepCorrection.LinearVelocity);
+	State.AngularVelocity = ToCoreVector(FixedStepCorrection.AngularVelocity);
+
+	ResetFixedStep(FixedStepCorrection.Step, State);
+
+	// Correction is from the past, simulation is deterministic so steps since then are simply taken again
+	AdvanceFixedStep(FMath::Min(CurrentStep, FixedStep + MaxCatchUpSteps));
+}
+
+void AActorBuoyant::BuildSections(float ClippingPointSpacing, int32 MaxClippingPoints)
+{
+	SectionData.Reset();
+
+	float TotalMass = 0.0f;
+
+	for (const FBuoyantSection& Section : Sections)
+	{
+		FBuoyancyMeshPtr SourceMesh = FBuoyancyMesh::Get(Section.Mesh);
+
+		if (!SourceMesh.IsValid())
+		{
+			continue;
+		}
+
+		// Sections start with settings of BuoyancyData
+		FBuoyantBodyData& Data = SectionData[SectionData.Add(BuoyancyData)];
+
+		Data.Mesh = FBuoyancyMesh::Build(*SourceMesh, Section.Transform, ClippingPointSpacing, MaxClippingPoints);
+
+		if (!Data.Mesh.IsValid())
+		{
+			SectionData.Pop(false);
+			continue;
+		}
+
+		const FVector BoundsMin = Data.Mesh->LocalBoundsMin;
+		const FVector BoundsMax = Data.Mesh->LocalBoundsMax;
+
+		Data.BodyVolume = Data.Mesh->Volume;
+		Data.LocalCentroidOfVolume = Data.Mesh->LocalCentroid;
+		Data.DensityOfBody = Section.DensityOfBody;
+		Data.BodyLengthX = BoundsMax.X - BoundsMin.X;
+		Data.UpdateBodyParams();
+
+		Data.ClippingPointsOffsets.Reset();
+		if (bAdaptiveClippingPoints && Data.Mesh->ClippingPoints.Num() > 0)
+		{
+			Data.ClippingPointsOffsets = Data.Mesh->ClippingPoints;
+		}
+		else
+		{
+			// 3 x 3 points over bounds of section
+			for (int32 x = 0; x <= 2; ++x)
+			{
+				for (int32 y = 0; y <= 2; ++y)
+				{
+					Data.ClippingPointsOffsets.Add(FVector(FMath::Lerp(BoundsMin.X, BoundsMax.X, x * 0.5f), FMath::Lerp(BoundsMin.Y, BoundsMax.Y, y * 0.5f), 0.0f));
+				}
+			}
+		}
+
+		TotalMass += Data.DensityOfBody * Data.BodyVolume;
+	}
+
+	for (FBuoyantBodyData& Data : SectionData)
+	{
+		Data.MassFraction = TotalMass > 0.0f ? Data.DensityOfBody * Data.BodyVolume / TotalMass : 1.0f / SectionData.Num();
+	}
+
+	if (Sections.Num() > 0 && SectionData.Num() != Sections.Num())
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Some buoyancy sections have no usable mesh!");
+	}
+}
+
+void AActorBuoyant::ComputeSectionForces(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, float Time, float GravityZ, FBuoyancyForces& Forces)
+{
+	Forces = FBuoyancyForces();
+
+	for (FBuoyantBodyData& Data : SectionData)
+	{
+		FBuoyancyForces SectionForces;
+		UBuoyancyHelper::ComputeBuoyancyForces(Ocean, State, Time, GravityZ, Data, SectionForces);
+		UBuoyancyHelper::AddSectionForces(SectionForces, State.CenterOfMass, Forces);
+	}
+}
+
 void AActorBuoyant::DrawDebugHelpers()
 {
 #if !UE_BUILD_SHIPPING
 	if (bDrawBuoyancyDebug)
 	{
-		FVector WorldVolumeCentoid = BuoyantMesh->GetCenterOfMass() + BuoyantMesh->GetComponentRotation().Quaternion().RotateVector(BuoyancyData.LocalCentroidOfVolume);
+		for (int32 i = 0; i < GetNumBuoyancySections(); ++i)
+		{
+			FVector WorldVolumeCentoid = BuoyantMesh->GetCenterOfMass() + BuoyantMesh->GetComponentRotation().Quaternion().RotateVector(GetBuoyancySection(i).LocalCentroidOfVolume);
 
-		/* Volume Centroid */
-		DrawDebugSphere(BuoyantMesh->GetWorld(), WorldVolumeCentoid, 8.0f, 8, FColor::Cyan);
+			/* Volume Centroid */
+			DrawDebugSphere(BuoyantMesh->GetWorld(), WorldVolumeCentoid, 8.0f, 8, FColor::Cyan);
+		}
 	}
 #endif
 }
@@ -72,6 +476,109 @@ UStaticMeshComponent* AActorBuoyant::GetBuoyantMesh() const
 	return BuoyantMesh;
 }
 
+AOceanManager* AActorBuoyant::GetOceanManager() const
+{
+	return CurrentOceanManager;
+}
+
+FBuoyantBodyData& AActorBuoyant::GetBuoyancyData()
+{
+	return BuoyancyData;
+}
+
+int32 AActorBuoyant::GetNumBuoyancySections() const
+{
+	return Sections.Num() > 0 ? SectionData.Num() : 1;
+}
+
+FBuoyantBodyData& AActorBuoyant::GetBuoyancySection(int32 Index)
+{
+	return Sections.Num() > 0 ? SectionData[Index] : BuoyancyData;
+}
+
+FBox AActorBuoyant::GetBuoyancyBounds() const
+{
+	if (Sections.Num() == 0)
+	{
+		// Sphere bounds also cover clipping points of rotated body
+		const FBoxSphereBounds& Bounds = BuoyantMesh->Bounds;
+		return FBox::BuildAABB(Bounds.Origin, FVector(Bounds.SphereRadius));
+	}
+
+	// Section geometry ignores scale of component, like buoyancy does
+	const FTransform Transform(BuoyantMesh->GetComponentQuat(), BuoyantMesh->GetComponentLocation());
+
+	FBox Bounds(0);
+	for (const FBuoyantBodyData& Data : SectionData)
+	{
+		Bounds += FBox(Data.Mesh->LocalBoundsMin, Data.Mesh->LocalBoundsMax).TransformBy(Transform);
+	}
+
+	return Bounds;
+}
+
+bool AActorBuoyant::CanComputeBuoyancy() const
+{
+	const bool bHasMesh = Sections.Num() > 0 ? SectionData.Num() > 0 : BuoyancyData.Mesh.IsValid();
+
+	return CurrentOceanManager->IsValidLowLevel() && BuoyantMesh && bHasMesh;
+}
+
+bool AActorBuoyant::IsFixedStep() const
+{
+	return FixedStepHulls.Num() > 0;
+}
+
+const BuoyancyCore::FFixedStepBody& AActorBuoyant::GetFixedStepBody() const
+{
+	return FixedStepBody;
+}
+
+const BuoyancyCore::FBodyState& AActorBuoyant::GetFixedStepState() const
+{
+	return FixedStepState;
+}
+
+int32 AActorBuoyant::GetFixedStep() const
+{
+	return FixedStep;
+}
+
+void AActorBuoyant::NotifyHit(UPrimitiveComponent* MyComp, AActor* Other, UPrimitiveComponent* OtherComp, bool bSelfMoved, FVector HitLocation, FVector HitNormal, FVector NormalImpulse, const FHitResult& Hit)
+{
+	Super::NotifyHit(MyComp, Other, OtherComp, bSelfMoved, HitLocation, HitNormal, NormalImpulse, Hit);
+
+	WakeBuoyancy();
+}
+
+void AActorBuoyant::WakeBuoyancy()
+{
+	BuoyancyData.Sleep.bWakeRequested = true;
+
+	for (FBuoyantBodyData& Data : SectionData)
+	{
+		Data.Sleep.bWakeRequested = true;
+	}
+}
+
+bool AActorBuoyant::IsBuoyancySleeping() const
+{
+	if (Sections.Num() == 0)
+	{
+		return BuoyancyData.Sleep.bSleeping;
+	}
+
+	for (const FBuoyantBodyData& Data : SectionData)
+	{
+		if (!Data.Sleep.bSleeping)
+		{
+			return false;
+		}
+	}
+
+	return SectionData.Num() > 0;
+}
+
 AOceanManager* AActorBuoyant::FindOceanManager()
 {
 	TActorIterator<AOceanManager> ActorItr(GetWorld());
@@ -93,6 +600,13 @@ AOceanManager* AActorBuoyant::FindOceanManager()
 
 void AActorBuoyant::SetClippingTestPoints(TArray<FVector>& ClippingPoints)
 {
+	// Points generated from mesh footprint are cached with mesh
+	if (bAdaptiveClippingPoints && BuoyancyData.Mesh.IsValid() && BuoyancyData.Mesh->ClippingPoints.Num() > 0)
+	{
+		ClippingPoints = BuoyancyData.Mesh->ClippingPoints;
+		return;
+	}
+
 	// Save old rotation and zero it so we can get actual extent
 	FRotator OldRot = BuoyantMesh->GetComponentRotation();
 	BuoyantMesh->SetWorldRotation(FRotator(0.0f, 0.0f, 0.0f));
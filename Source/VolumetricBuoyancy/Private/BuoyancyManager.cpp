@@ -0,0 +1,183 @@
+// Implementation created by David 'vebski' Niemiec
+
+#include "VolumetricBuoyancy.h"
+#include "ParallelFor.h"
+#include "ActorBuoyant.h"
+#include "BuoyancyManager.h"
+
+ABuoyancyManager::ABuoyancyManager(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	bParallelSolve = true;
+	BodiesPerTask = 4;
+
+	NumDryBodies = 0;
+	NumSubmergedBodies = 0;
+	NumCrossingBodies = 0;
+	NumSleepingBodies = 0;
+}
+
+void ABuoyancyManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	const int32 NumBodies = Bodies.Num();
+
+	BodyStates.SetNum(NumBodies, false);
+	BodyForces.SetNum(NumBodies, false);
+	BodyOceans.SetNum(NumBodies, false);
+	BodyWaters.SetNum(NumBodies, false);
+	BodySectionStart.SetNum(NumBodies + 1, false);
+
+	SectionData.Reset();
+	SectionBodies.Reset();
+
+	// Gather snapshots on game thread, workers never touch components
+	for (int32 i = 0; i < NumBodies; ++i)
+	{
+		AActorBuoyant* Body = Bodies[i];
+		BodyOceans[i] = nullptr;
+		BodySectionStart[i] = SectionData.Num();
+
+		if (Body && Body->CanComputeBuoyancy())
+		{
+			UBuoyancyHelper::GetBodyState(Body->GetBuoyantMesh(), BodyStates[i]);
+			BodyOceans[i] = Body->GetOceanManager();
+			BodyWaters[i] = Body->GetOceanManager()->GetWaterView(BodyStates[i].Transform.GetLocation());
+
+			// All sections share state of body, they only differ in geometry
+			for (int32 Section = 0; Section < Body->GetNumBuoyancySections(); ++Section)
+			{
+				SectionData.Add(&Body->GetBuoyancySection(Section));
+				SectionBodies.Add(i);
+			}
+
+			Body->GetOceanManager()->RequestWaveCacheArea(Body->GetBuoyancyBounds());
+			CachedOceans.AddUnique(Body->GetOceanManager());
+		}
+	}
+	BodySectionStart[NumBodies] = SectionData.Num();
+
+	const int32 NumSections = SectionData.Num();
+	SectionForces.SetNum(NumSections, false);
+
+	const float GravityZ = GetWorld()->GetGravityZ();
+
+	// Waves around all bodies are computed once, before bodies start reading them
+	for (AOceanManager* Ocean : CachedOceans)
+	{
+		Ocean->UpdateWaveCache(Ocean->GetWaveTime());
+	}
+	CachedOceans.Reset();
+
+	// Each section writes only its own data and result, so sections can be solved in any order
+	auto SolveSections = [&](int32 FirstSection, int32 LastSection)
+	{
+		for (int32 i = FirstSection; i < LastSection; ++i)
+		{
+			const int32 Body = SectionBodies[i];
+			UBuoyancyHelper::ComputeBuoyancyForces(BodyWaters[Body], BodyStates[Body], BodyOceans[Body]->GetWaveTime(), GravityZ, *SectionData[i], SectionForces[i]);
+		}
+	};
+
+	const int32 BatchSize = FMath::Max(1, BodiesPerTask);
+	const int32 NumBatches = FMath::DivideAndRoundUp(NumSections, BatchSize);
+
+	ParallelFor(NumBatches, [&](int32 BatchIndex)
+	{
+		SolveSections(BatchIndex * BatchSize, FMath::Min(NumSections, (BatchIndex + 1) * BatchSize));
+	}, !bParallelSolve);
+
+	NumDryBodies = 0;
+	NumSubmergedBodies = 0;
+	NumCrossingBodies = 0;
+	NumSleepingBodies = 0;
+
+	// Sum sections and apply in body order on game thread
+	for (int32 i = 0; i < NumBodies; ++i)
+	{
+		if (!BodyOceans[i])
+		{
+			continue;
+		}
+
+		const int32 FirstSection = BodySectionStart[i];
+		const int32 LastSection = BodySectionStart[i + 1];
+
+		if (LastSection - FirstSection == 1)
+		{
+			BodyForces[i] = SectionForces[FirstSection];
+		}
+		else
+		{
+			BodyForces[i] = FBuoyancyForces();
+
+			for (int32 Section = FirstSection; Section < LastSection; ++Section)
+			{
+				UBuoyancyHelper::AddSectionForces(SectionForces[Section], BodyStates[i].CenterOfMass, BodyForces[i]);
+			}
+		}
+
+		UBuoyancyHelper::ApplyBuoyancyForces(Bodies[i]->GetBuoyantMesh(), BodyForces[i]);
+
+		// Sections are counted like bodies
+		for (int32 Section = FirstSection; Section < LastSection; ++Section)
+		{
+			const FBuoyantBodyData& BuoyancyData = *SectionData[Section];
+			NumSleepingBodies += BuoyancyData.Sleep.bSleeping ? 1 : 0;
+
+			switch (BuoyancyData.BodyPhase)
+			{
+			case EBuoyancyBodyPhase::Dry:
+				++NumDryBodies;
+				break;
+
+			case EBuoyancyBodyPhase::Submerged:
+				++NumSubmergedBodies;
+				break;
+
+			default:
+				++NumCrossingBodies;
+				break;
+			}
+		}
+	}
+}
+
+void ABuoyancyManager::RegisterBody(AActorBuoyant* Body)
+{
+	Bodies.AddUnique(Body);
+
+	// Ocean clock has to advance before bodies sample waves
+	if (Body->GetOceanManager())
+	{
+		AddTickPrerequisiteActor(Body->GetOceanManager());
+	}
+}
+
+void ABuoyancyManager::UnregisterBody(AActorBuoyant* Body)
+{
+	// Keep registration order of remaining bodies, forces are applied in it
+	Bodies.Remove(Body);
+}
+
+ABuoyancyManager* ABuoyancyManager::Get(UWorld* World)
+{
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	for (TActorIterator<ABuoyancyManager> ActorItr(World); ActorItr; ++ActorItr)
+	{
+		if (ActorItr->IsValidLowLevel() && !ActorItr->IsPendingKill())
+		{
+			return *ActorItr;
+		}
+	}
+
+	return World->SpawnActor<ABuoyancyManager>();
+}
@@ -0,0 +1,373 @@
+// Implementation created by David 'vebski' Niemiec
+
+#include "VolumetricBuoyancy.h"
+#include "InstancedBuoyancyActor.h"
+
+AInstancedBuoyancyActor::AInstancedBuoyancyActor(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PrimaryActorTick.bCanEverTick = true;
+	Shape = EBuoyantInstanceShape::Box;
+	ShapeExtent = FVector::ZeroVector;
+	DensityOfBody = 500.0f;
+	LinearDamping = 0.01f;
+	AngularDamping = 0.0f;
+	MaxAngularVelocity = 1500.0f;
+	MaxStepTime = 1.0f / 30.0f;
+	WaveLODBias = 1.0f;
+	bFollowWaveSlopes = true;
+	NumInstances = 0;
+	InstanceCapacity = 0;
+	InstanceBounds = FBox(0);
+	LargestInstanceSize = 0.0f;
+
+	InstancedMesh = ObjectInitializer.CreateDefaultSubobject<UInstancedStaticMeshComponent>(this, TEXT("InstancedMesh"));
+	SetRootComponent(InstancedMesh);
+	InstancedMesh->SetMobility(EComponentMobility::Movable);
+	InstancedMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
+void AInstancedBuoyancyActor::BeginPlay()
+{
+	Super::BeginPlay();
+
+	CurrentOceanManager = FindOceanManager();
+
+	// Ocean clock has to advance before instances sample waves
+	if (CurrentOceanManager)
+	{
+		AddTickPrerequisiteActor(CurrentOceanManager);
+	}
+
+	// Shape fitted to bounds of mesh, which is expected to be centered on its origin
+	if (ShapeExtent.IsNearlyZero() && InstancedMesh->StaticMesh)
+	{
+		const FVector MeshExtent = InstancedMesh->StaticMesh->GetBounds().BoxExtent;
+
+		switch (Shape)
+		{
+		case EBuoyantInstanceShape::Sphere:
+			ShapeExtent = FVector((MeshExtent.X + MeshExtent.Y + MeshExtent.Z) / 3.0f, 0.0f, 0.0f);
+			break;
+		case EBuoyantInstanceShape::Capsule:
+		{
+			const float Radius = FMath::Max(MeshExtent.Y, MeshExtent.Z);
+			ShapeExtent = FVector(FMath::Max(MeshExtent.X - Radius, 0.0f), Radius, Radius);
+			break;
+		}
+		default:
+			ShapeExtent = MeshExtent;
+			break;
+		}
+	}
+
+	if (ShapeExtent.IsNearlyZero())
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Floating instances need ShapeExtent or static mesh!");
+		return;
+	}
+
+	// Instances placed in editor start at rest
+	const int32 NumPlaced = InstancedMesh->GetInstanceCount();
+	ReserveInstances(NumPlaced);
+
+	for (int32 i = 0; i < NumPlaced; ++i)
+	{
+		FTransform WorldTransform;
+		InstancedMesh->GetInstanceTransform(i, WorldTransform, true);
+
+		AddInstanceState(WorldTransform, FVector::ZeroVector);
+	}
+}
+
+void AInstancedBuoyancyActor::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (!CurrentOceanManager->IsValidLowLevel() || NumInstances == 0 || DeltaSeconds <= 0.0f)
+	{
+		return;
+	}
+
+	SampleWaves(CurrentOceanManager->GetWaveTime());
+
+	// Water velocity is per instance, filled by SampleWaves
+	BuoyancyCore::FInstanceStepParams Params;
+	Params.Water = CurrentOceanManager->GetWaterParams();
+	Params.Water.GravityZ = GetWorld()->GetGravityZ();
+	Params.DensityOfBody = DensityOfBody;
+	Params.LinearDamping = LinearDamping;
+	Params.AngularDamping = AngularDamping;
+	Params.MaxAngularVelocity = FMath::DegreesToRadians(MaxAngularVelocity);
+
+	// Hitches are split into substeps, beyond 4 of them instances rather lag than stall the frame
+	const int32 NumSteps = FMath::Clamp(FMath::CeilToInt(DeltaSeconds / MaxStepTime), 1, 4);
+	const float StepTime = FMath::Min(DeltaSeconds / NumSteps, MaxStepTime);
+
+	for (int32 Step = 0; Step < NumSteps; ++Step)
+	{
+		BuoyancyCore::StepInstances(Instances, NumInstances, Params, StepTime);
+	}
+
+	BUOYANCY_COUNT(InstancesSolved, NumInstances * NumSteps);
+
+	UpdateInstanceTransforms();
+}
+
+AOceanManager* AInstancedBuoyancyActor::FindOceanManager()
+{
+	for (TActorIterator<AOceanManager> ActorItr(GetWorld()); ActorItr; ++ActorItr)
+	{
+		if (ActorItr->IsValidLowLevel())
+		{
+			return *ActorItr;
+		}
+	}
+
+	GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Can't find ocean manager on level!");
+
+	return nullptr;
+}
+
+void AInstancedBuoyancyActor::ReserveInstances(int32 Capacity)
+{
+	if (Capacity <= InstanceCapacity)
+	{
+		return;
+	}
+
+	const int32 NewCapacity = FMath::Max3(Capacity, 2 * InstanceCapacity, 64);
+
+	TArray<float> NewData;
+	NewData.SetNumUninitialized(BuoyancyCore::FInstanceBuffers::FloatsPerInstance * NewCapacity);
+
+	const BuoyancyCore::FInstanceBuffers NewInstances = BuoyancyCore::FInstanceBuffers::FromBuffer(NewData.GetData(), NewCapacity);
+	Instances.CopyTo(NewInstances, NumInstances);
+
+	// Moving array keeps its allocation, so new buffers stay valid
+	InstanceData = MoveTemp(NewData);
+	Instances = NewInstances;
+	InstanceCapacity = NewCapacity;
+
+	BUOYANCY_COUNT(Allocations, 1);
+}
+
+int32 AInstancedBuoyancyActor::AddInstanceState(const FTransform& WorldTransform, const FVector& Velocity)
+{
+	ReserveInstances(NumInstances + 1);
+
+	const BuoyancyCore::EInstanceShape CoreShape = Shape == EBuoyantInstanceShape::Sphere ? BuoyancyCore::EInstanceShape::Sphere
+		: (Shape == EBuoyantInstanceShape::Capsule ? BuoyancyCore::EInstanceShape::Capsule : BuoyancyCore::EInstanceShape::Box);
+
+	const float WaterDensity = CurrentOceanManager ? CurrentOceanManager->GetWaterParams().Density : BuoyancyCore::FWaterParams().Density;
+	const FVector Scale = WorldTransform.GetScale3D();
+	const FVector Extent = ShapeExtent * Scale.GetAbs();
+
+	const int32 Index = NumInstances++;
+	Instances.SetShape(Index, BuoyancyCore::MakeInstanceShape(CoreShape, ToCoreVector(Extent), DensityOfBody, WaterDensity));
+	Instances.SetState(Index, ToCoreVector(WorldTransform.GetLocation()), ToCoreQuat(WorldTransform.GetRotation()), ToCoreVector(Velocity), BuoyancyCore::FVec3());
+
+	InstanceScales.Add(Scale);
+	InstanceBounds += WorldTransform.GetLocation();
+	LargestInstanceSize = FMath::Max(LargestInstanceSize, 2.0f * Extent.GetMax());
+
+	return Index;
+}
+
+void AInstancedBuoyancyActor::SampleWaves(float Time)
+{
+	WaveSamples.SetNum(NumInstances);
+	FMemory::Memcpy(WaveSamples.PositionX.GetData(), Instances.PositionX, NumInstances * sizeof(float));
+	FMemory::Memcpy(WaveSamples.PositionY.GetData(), Instances.PositionY, NumInstances * sizeof(float));
+
+	// Instances are small and close together, whole field shares one wave LOD
+	const int32 NumWaveComponents = CurrentOceanManager->GetWaveLOD(InstanceBounds.GetCenter(), LargestInstanceSize, WaveLODBias);
+	CurrentOceanManager->GetSurfaceHeightBatch(WaveSamples, Time, NumWaveComponents, CurrentOceanManager->WantsWaveVelocities());
+
+	FMemory::Memcpy(Instances.SurfaceZ, WaveSamples.DisplacementZ.GetData(), NumInstances * sizeof(float));
+
+	// Slopes are left in batch by Newton iterations of Gerstner query only
+	const bool bHasSlopes = CurrentOceanManager->WaveSource == EOceanWaveSource::Gerstner && CurrentOceanManager->SurfaceHeightIterations > 0
+		&& WaveSamples.SlopeZX.Num() == NumInstances;
+
+	if (bFollowWaveSlopes && bHasSlopes)
+	{
+		BuoyancyCore::FWaveSampleBuffers Samples;
+		Samples.SlopeXX = WaveSamples.SlopeXX.GetData();
+		Samples.SlopeXY = WaveSamples.SlopeXY.GetData();
+		Samples.SlopeYY = WaveSamples.SlopeYY.GetData();
+		Samples.SlopeZX = WaveSamples.SlopeZX.GetData();
+		Samples.SlopeZY = WaveSamples.SlopeZY.GetData();
+
+		BuoyancyCore::ComputeSurfaceSlopes(Samples, NumInstances, Instances.SurfaceSlopeX, Instances.SurfaceSlopeY);
+	}
+	else
+	{
+		FMemory::Memzero(Instances.SurfaceSlopeX, NumInstances * sizeof(float));
+		FMemory::Memzero(Instances.SurfaceSlopeY, NumInstances * sizeof(float));
+	}
+
+	// Instances float at surface, orbital velocity is taken there without decay
+	const bool bOrbital = WaveSamples.HasVelocities();
+
+	for (int32 i = 0; i < NumInstances; ++i)
+	{
+		const FVector Current = CurrentOceanManager->GetCurrentVelocity(FVector(Instances.PositionX[i], Instances.PositionY[i], 0.0f));
+
+		Instances.WaterVelocityX[i] = bOrbital ? Current.X + WaveSamples.VelocityX[i] : Current.X;
+		Instances.WaterVelocityY[i] = bOrbital ? Current.Y + WaveSamples.VelocityY[i] : Current.Y;
+	}
+}
+
+void AInstancedBuoyancyActor::UpdateInstanceTransforms()
+{
+	FBox Bounds(0);
+
+	for (int32 i = 0; i < NumInstances; ++i)
+	{
+		const FTransform WorldTransform = GetFloatingInstanceTransform(i);
+
+		// Render state is marked dirty once for all instances
+		InstancedMesh->UpdateInstanceTransform(i, WorldTransform, true, false);
+		Bounds += WorldTransform.GetLocation();
+	}
+
+	InstanceBounds = Bounds;
+
+	InstancedMesh->UpdateBounds();
+	InstancedMesh->MarkRenderStateDirty();
+}
+
+UInstancedStaticMeshComponent* AInstancedBuoyancyActor::GetInstancedMesh() const
+{
+	return InstancedMesh;
+}
+
+int32 AInstancedBuoyancyActor::AddFloatingInstance(const FTransform& WorldTransform, FVector Velocity)
+{
+	// Before BeginPlay instance is picked up with placed ones
+	if (!HasActorBegunPlay())
+	{
+		return InstancedMesh->AddInstanceWorldSpace(WorldTransform);
+	}
+
+	// Simulation didn't start, instance without state would shift indices of mesh against states
+	if (ShapeExtent.IsNearlyZero())
+	{
+		return INDEX_NONE;
+	}
+
+	InstancedMesh->AddInstanceWorldSpace(WorldTransform);
+
+	return AddInstanceState(WorldTransform, Velocity);
+}
+
+void AInstancedBuoyancyActor::RemoveFloatingInstance(int32 Index)
+{
+	if (Index < 0 || Index >= NumInstances)
+	{
+		return;
+	}
+
+	Instances.RemoveInstance(Index, NumInstances);
+	--NumInstances;
+
+	InstanceScales.RemoveAt(Index);
+	InstancedMesh->RemoveInstance(Index);
+}
+
+int32 AInstancedBuoyancyActor::GetNumFloatingInstances() const
+{
+	return NumInstances;
+}
+
+FTransform AInstancedBuoyancyActor::GetFloatingInstanceTransform(int32 Index) const
+{
+	if (Index < 0 || Index >= NumInstances)
+	{
+		return FTransform::Identity;
+	}
+
+	const FQuat Rotation(Instances.RotationX[Index], Instances.RotationY[Index], Instances.RotationZ[Index], Instances.RotationW[Index]);
+	const FVector Location(Instances.PositionX[Index], Instances.PositionY[Index], Instances.PositionZ[Index]);
+
+	return FTransform(Rotation, Location, InstanceScales[Index]);
+}
+
+int32 AInstancedBuoyancyActor::FindClosestInstance(FVector Location, float MaxDistance) const
+{
+	int32 ClosestIndex = INDEX_NONE;
+	float ClosestDistanceSquared = MaxDistance * MaxDistance;
+
+	for (int32 i = 0; i < NumInstances; ++i)
+	{
+		const float DistanceSquared = FVector::DistSquared(Location, FVector(Instances.PositionX[i], Instances.PositionY[i], Instances.PositionZ[i]));
+
+		if (DistanceSquared <= ClosestDistanceSquared)
+		{
+			ClosestIndex = i;
+			ClosestDistanceSquared = DistanceSquared;
+		}
+	}
+
+	return ClosestIndex;
+}
+
+AActor* AInstancedBuoyancyActor::PromoteInstance(int32 Index)
+{
+	if (Index < 0 || Index >= NumInstances)
+	{
+		return nullptr;
+	}
+
+	if (!PromotedClass)
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Floating instances have no PromotedClass!");
+		return nullptr;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AActor* Promoted = GetWorld()->SpawnActor<AActor>(PromotedClass, GetFloatingInstanceTransform(Index), SpawnParameters);
+
+	if (!Promoted)
+	{
+		return nullptr;
+	}
+
+	// Promoted body keeps moving the way instance did, angular velocity of physics body is in degrees
+	UPrimitiveComponent* Root = Cast<UPrimitiveComponent>(Promoted->GetRootComponent());
+
+	if (Root && Root->IsSimulatingPhysics())
+	{
+		Root->SetPhysicsLinearVelocity(FVector(Instances.VelocityX[Index], Instances.VelocityY[Index], Instances.VelocityZ[Index]));
+		Root->SetPhysicsAngularVelocity(FMath::RadiansToDegrees(FVector(Instances.AngularVelocityX[Index], Instances.AngularVelocityY[Index], Instances.AngularVelocityZ[Index])));
+	}
+
+	RemoveFloatingInstance(Index);
+
+	return Promoted;
+}
+
+TArray<AActor*> AInstancedBuoyancyActor::PromoteInstancesInRadius(FVector Location, float Radius)
+{
+	TArray<AActor*> Promoted;
+	const float RadiusSquared = Radius * Radius;
+
+	// Backwards, removing instance moves only instances after it
+	for (int32 i = NumInstances - 1; i >= 0; --i)
+	{
+		if (FVector::DistSquared(Location, FVector(Instances.PositionX[i], Instances.PositionY[i], Instances.PositionZ[i])) <= RadiusSquared)
+		{
+			AActor* Actor = PromoteInstance(i);
+
+			if (Actor)
+			{
+				Promoted.Add(Actor);
+			}
+		}
+	}
+
+	return Promoted;
+}
@@ -1,84 +1,102 @@
 // Implementation created by David 'vebski' Niemiec
 
 #include "VolumetricBuoyancy.h"
-#include "PhysicsPublic.h"
-#include "PhysxPublic.h"
-#include "PhysicsEngine/BodySetup.h"
-#include "PhysXIncludes.h"
-#include "ThirdParty/PhysX/PhysX-3.3/include/geometry/PxTriangleMesh.h"
-#include "ThirdParty/PhysX/PhysX-3.3/include/foundation/PxSimpleTypes.h"
 #include "Misc/BuoyancyHelper.h"
+#include "Misc/BuoyancyStats.h"
+#include "BuoyancyCore/HullSimplifier.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scratch Allocations"), STAT_BuoyancyScratchAllocations, STATGROUP_Buoyancy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dry Bodies"), STAT_BuoyancyDryBodies, STATGROUP_Buoyancy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Submerged Bodies"), STAT_BuoyancySubmergedBodies, STATGROUP_Buoyancy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Crossing Bodies"), STAT_BuoyancyCrossingBodies, STATGROUP_Buoyancy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Held Updates"), STAT_BuoyancyHeldUpdates, STATGROUP_Buoyancy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Reclassified Triangles"), STAT_BuoyancyReclassifiedTriangles, STATGROUP_Buoyancy);
 
 float UBuoyancyHelper::ComputeVolume(UStaticMeshComponent* BuoyantMesh, FVector& VolumeCentroid)
 {
-	if (!BuoyantMesh || !BuoyantMesh->StaticMesh || !BuoyantMesh->StaticMesh->RenderData)
-	{
-		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Buoyant mesh data is not correct!");
+	FBuoyancyMeshPtr Mesh = FBuoyancyMesh::Get(BuoyantMesh);
 
+	if (!Mesh.IsValid())
+	{
 		return 0.0f;
 	}
 
-	PxTriangleMesh* TempTriMesh = nullptr;
-	if (BuoyantMesh->GetBodySetup()->TriMeshes.Num() > 0)
-	{
-		TempTriMesh = BuoyantMesh->GetBodySetup()->TriMeshes[0];
-	}
+	VolumeCentroid = Mesh->LocalCentroid;
 
-	if (TempTriMesh == nullptr)
-	{
-		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "No TriMesh data!");
+	return Mesh->Volume;
+}
 
-		return 0.0f;
-	}
+bool UBuoyancyHelper::BuildBuoyancyProxy(UStaticMeshComponent* BuoyantMesh, int32 MaxTriangles, FBuoyancyProxy& Proxy)
+{
+	FBuoyancyMeshPtr Mesh = FBuoyancyMesh::Get(BuoyantMesh);
 
-	if (TempTriMesh->getNbTriangles() <= 0)
+	if (!Mesh.IsValid())
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Mesh has 0 triangles!");
-
-		return 0.0f;
+		return false;
 	}
 
-	int32 TriNumber = TempTriMesh->getNbTriangles();
-	
-	
-
-	const PxVec3* PVertices = TempTriMesh->getVertices();
-	const void* Triangles = TempTriMesh->getTriangles();
-
-	// Grab triangle indices
-	int32 I0, I1, I2;
-
-	float Volume = 0.0f;
-	FVector Center = FVector::ZeroVector;
-
-	for (int32 TriIndex = 0; TriIndex < TriNumber; ++TriIndex)
+	const BuoyancyCore::FMeshView Source = Mesh->GetView();
+
+	TArray<int64> CellKeys;
+	TArray<int32> Order;
+	TArray<int32> Clusters;
+	TArray<double> Quadrics;
+	TArray<double> Sums;
+	TArray<int32> TriangleOrder;
+	CellKeys.SetNumUninitialized(Source.NumVertices);
+	Order.SetNumUninitialized(Source.NumVertices);
+	Clusters.SetNumUninitialized(Source.NumVertices);
+	Quadrics.SetNumUninitialized(Source.NumVertices * 10);
+	Sums.SetNumUninitialized(Source.NumVertices * 4);
+	TriangleOrder.SetNumUninitialized(Source.NumTriangles);
+
+	BuoyancyCore::FSimplifyScratch Scratch;
+	Scratch.CellKeys = CellKeys.GetData();
+	Scratch.Order = Order.GetData();
+	Scratch.Clusters = Clusters.GetData();
+	Scratch.Quadrics = Quadrics.GetData();
+	Scratch.Sums = Sums.GetData();
+	Scratch.TriangleOrder = TriangleOrder.GetData();
+
+	TArray<float> ProxyX;
+	TArray<float> ProxyY;
+	TArray<float> ProxyZ;
+	ProxyX.SetNumUninitialized(Source.NumVertices);
+	ProxyY.SetNumUninitialized(Source.NumVertices);
+	ProxyZ.SetNumUninitialized(Source.NumVertices);
+	Proxy.Indices.SetNumUninitialized(Source.NumTriangles * 3);
+
+	BuoyancyCore::FHullBuffers Hull;
+	Hull.VertexX = ProxyX.GetData();
+	Hull.VertexY = ProxyY.GetData();
+	Hull.VertexZ = ProxyZ.GetData();
+	Hull.Indices = Proxy.Indices.GetData();
+
+	Proxy.CellSize = BuoyancyCore::SimplifyHullToBudget(Source, MaxTriangles, Scratch, Hull);
+
+	Proxy.Indices.SetNum(Hull.NumTriangles * 3);
+	Proxy.Vertices.SetNumUninitialized(Hull.NumVertices);
+	for (int32 i = 0; i < Hull.NumVertices; ++i)
 	{
-		if (TempTriMesh->getTriangleMeshFlags() & PxTriangleMeshFlag::eHAS_16BIT_TRIANGLE_INDICES)
-		{
-			PxU16* P16BitIndices = (PxU16*)Triangles;
-			I0 = P16BitIndices[(TriIndex * 3) + 0];
-			I1 = P16BitIndices[(TriIndex * 3) + 1];
-			I2 = P16BitIndices[(TriIndex * 3) + 2];
-		}
-		else
-		{
-			PxU32* P32BitIndices = (PxU32*)Triangles;
-			I0 = P32BitIndices[(TriIndex * 3) + 0];
-			I1 = P32BitIndices[(TriIndex * 3) + 1];
-			I2 = P32BitIndices[(TriIndex * 3) + 2];
-		}
+		Proxy.Vertices[i] = FVector(ProxyX[i], ProxyY[i], ProxyZ[i]);
+	}
 
-		const FVector V0 = P2UVector(PVertices[I0]);
-		const FVector V1 = P2UVector(PVertices[I1]);
-		const FVector V2 = P2UVector(PVertices[I2]);
+	// Error over the whole range of depths, tilted up to 35 degrees
+	TArray<float> SourceDepths;
+	TArray<float> ProxyDepths;
+	SourceDepths.SetNumUninitialized(Source.NumVertices);
+	ProxyDepths.SetNumUninitialized(Hull.NumVertices);
 
-		Volume += ComputeTetrahedronVolume(Center, FVector::ZeroVector, V0, V1, V2);
-	}
+	const BuoyancyCore::FProxyError Error = BuoyancyCore::MeasureProxyError(Source, Hull.GetView(), 16, 2, FMath::DegreesToRadians(35.0f), SourceDepths.GetData(), ProxyDepths.GetData());
 
-	VolumeCentroid = Center;
-	VolumeCentroid *= 1.0f / Volume;
+	Proxy.SourceMesh = BuoyantMesh->StaticMesh;
+	Proxy.SourceTriangles = Source.NumTriangles;
+	Proxy.NumTriangles = Hull.NumTriangles;
+	Proxy.VolumeError = Error.VolumeError;
+	Proxy.MaxSubmergedVolumeError = Error.MaxSubmergedVolumeError;
+	Proxy.MaxCentroidError = Error.MaxCentroidError;
 
-	return Volume;
+	return Proxy.IsValid();
 }
 
 void UBuoyancyHelper::ComputeBuoyancy(AOceanManager* OceanManager,  UStaticMeshComponent* BuoyantMesh, FBuoyantBodyData& BuoyantData)
@@ -97,388 +115,517 @@ void UBuoyancyHelper::ComputeBuoyancy(AOceanManager* OceanManager,  UStaticMeshC
 		return;
 	}
 
-	FVector SubmergedCentroid = FVector::ZeroVector;
-	FClippingPlane ClippingPlane;
-	float SubmergedVolume = ComputeSubmergedVolume(OceanManager, BuoyantMesh, ClippingPlane, SubmergedCentroid, BuoyantData);
+	if (!BuoyantData.Mesh.IsValid())
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "No buoyancy mesh data!");
 
-	// @TODO: Move to actor tick and add local center offset to BuoyantData
-	//DrawDebugSphere(BuoyantMesh->GetWorld(), SubmergedCentroid, 8.0f, 8, FColor::Blue);
+		return;
+	}
 
-	if (SubmergedVolume > 0)
-	{
-		const float WaterDensity = 0.0001f; // 1g/cm^3 -> 1000kg/m^3
-		const float WaterLinearDrag = 50000.0f;
-		const float WaterAngularDrag = 500.0f;
-		const FVector WaterVelocity = FVector::ZeroVector;
-		const FVector PlaneNormal = FVector::UpVector;//ClippingPlane.PlaneNormal;
-		const FVector PlaneLocation = ClippingPlane.PlaneLocation;// FVector::ZeroVector;
+	FBuoyantBodyState State;
+	GetBodyState(BuoyantMesh, State);
 
-		float VolumeMass = (BuoyantData.DensityOfBody * 0.0000001f) * BuoyantMesh->GetMass();
+	FBuoyancyForces Forces;
+	ComputeBuoyancyForces(OceanManager->GetWaterView(State.Transform.GetLocation()), State, OceanManager->GetWaveTime(), BuoyantMesh->GetWorld()->GetGravityZ(), BuoyantData, Forces);
 
-		/* You can use this crazy version, but I prefer one above since it gives us 2 variables we can control (and it dosen't have 10 freaking zeros ;) ) */
-		//float VolumeMass = FMath::Abs((BuoyantData.DensityOfBody * 0.00000000001f * BuoyantData.BodyVolume) * 0.5f);
+	ApplyBuoyancyForces(BuoyantMesh, Forces);
+}
 
-		FVector BuoyantForce = (WaterDensity * SubmergedVolume * -BuoyantMesh->GetWorld()->GetGravityZ()) * PlaneNormal;
-		float PartialMass = VolumeMass * SubmergedVolume / BuoyantData.BodyVolume;
-		FVector Rc = SubmergedCentroid - BuoyantMesh->GetCenterOfMass();
-		FVector Vc = BuoyantMesh->GetPhysicsLinearVelocity() + FVector::CrossProduct((BuoyantMesh->GetPhysicsAngularVelocity() * 0.0001f), Rc);
-		FVector DragForce = (PartialMass * WaterLinearDrag) * (WaterVelocity - Vc);
+void UBuoyancyHelper::GetBodyState(UStaticMeshComponent* BuoyantMesh, FBuoyantBodyState& State)
+{
+	State.Transform = BuoyantMesh->GetComponentTransform();
+	State.CenterOfMass = BuoyantMesh->GetCenterOfMass();
+	State.LinearVelocity = BuoyantMesh->GetPhysicsLinearVelocity();
+	State.AngularVelocity = BuoyantMesh->GetPhysicsAngularVelocity();
+	State.Mass = BuoyantMesh->GetMass();
+}
 
-		FVector TotalForce = BuoyantForce + DragForce;
-		BuoyantMesh->AddForceAtLocation(TotalForce, SubmergedCentroid);
+void UBuoyancyHelper::GetBodyState(FBodyInstance* BodyInstance, const FBuoyantBodyData& BuoyantData, FBuoyantBodyState& State)
+{
+	// Scene is already locked during substep
+	State.Transform = BodyInstance->GetUnrealWorldTransform_AssumesLocked();
+	State.CenterOfMass = State.Transform.TransformPosition(BuoyantData.LocalCenterOfMass);
+	State.LinearVelocity = BodyInstance->GetUnrealWorldVelocity_AssumesLocked();
+	State.AngularVelocity = BodyInstance->GetUnrealWorldAngularVelocity_AssumesLocked();
+	State.Mass = BodyInstance->GetBodyMass();
+}
 
-		FVector TotalDrag = FVector::CrossProduct(Rc, TotalForce);
-		BuoyantMesh->AddTorque(TotalDrag);
+void UBuoyancyHelper::ComputeBuoyancyForces(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, float Time, float GravityZ, FBuoyantBodyData& BuoyantData, FBuoyancyForces& Forces)
+{
+	Forces = FBuoyancyForces();
 
-		// @FIXME: We don't need to calculate Length2 every Tick, move it to structure
-		float Length2 = BuoyantData.BodyLengthX * BuoyantData.BodyLengthX;
+	const FBuoyancyMesh* Mesh = BuoyantData.Mesh.Get();
 
-		FVector DragTorque = (-PartialMass * WaterAngularDrag * Length2) * BuoyantMesh->GetPhysicsAngularVelocity();
-		BuoyantMesh->AddTorque(DragTorque);
+	if (Mesh == nullptr)
+	{
+		return;
 	}
-}
 
-float UBuoyancyHelper::ComputeTetrahedronVolume(FVector& Center, FVector Point, FVector Vertex1, FVector Vertex2, FVector Vertex3)
-{
-	FVector A = Vertex2 - Vertex1;
-	FVector B = Vertex3 - Vertex1;
-	FVector R = Point - Vertex1;
+	BUOYANCY_COUNT(BodiesSolved, 1);
 
-	float Volume = (1.0f / 6.0f) * FVector::DotProduct(FVector::CrossProduct(B, A), R);
+	BuoyancyCore::FBodyState CoreState;
+	CoreState.Location = ToCoreVector(State.Transform.GetLocation());
+	CoreState.Rotation = ToCoreQuat(State.Transform.GetRotation());
+	CoreState.CenterOfMass = ToCoreVector(State.CenterOfMass);
+	CoreState.LinearVelocity = ToCoreVector(State.LinearVelocity);
+	CoreState.AngularVelocity = ToCoreVector(State.AngularVelocity);
+	CoreState.Mass = State.Mass * BuoyantData.MassFraction;
 
-	Center += 0.25f * Volume * (Vertex1 + Vertex2 + Vertex3 + Point);
+	const BuoyancyCore::FBodyParams& Body = BuoyantData.BodyParams;
 
-	return Volume;
-}
+	// Held forces drag against current only, waves are not sampled for them
+	BuoyancyCore::FWaterParams Water = Ocean.GetWaterParams();
+	Water.GravityZ = GravityZ;
+	Water.Velocity = ToCoreVector(Ocean.GetCurrentVelocity(State.CenterOfMass));
 
-float UBuoyancyHelper::ClipTriangle(FVector& Center, FVector Point, FVector Vertex1, FVector Vertex2, FVector Vertex3, float Depth1, float Depth2, float Depth3)
-{
-	float Volume = 0.0f;
-	FVector Vc1 = Vertex1 + (Depth1 / (Depth1 - Depth2)) * (Vertex2 - Vertex1);
+	BuoyancyCore::FForces CoreForces;
 
-	if (Depth1 < 0.0f)
+	// Pressure forces depend on velocity of every triangle and on last solve, so pressure bodies are solved in every update
+	const bool bPressure = BuoyantData.SolverMode == EBuoyancySolverMode::Pressure;
+
+	// Settled and distant bodies reuse their last solve in between full ones
+	if (!bPressure && HoldForces(Ocean, State, CoreState, Body, Water, Time, BuoyantData, CoreForces))
 	{
-		if (Depth3 < 0.0f)
-		{
-			FVector Vc2 = Vertex2 + (Depth2 / (Depth2 - Depth3)) * (Vertex3 - Vertex2);
+		BUOYANCY_COUNT(EarlyOuts, 1);
 
-			Volume += ComputeTetrahedronVolume(Center, Point, Vc1, Vc2, Vertex1);
-			Volume += ComputeTetrahedronVolume(Center, Point, Vc2, Vertex3, Vertex1);
-		}
-		else
+		SetForces(CoreForces, Forces);
+		return;
+	}
+
+	BuoyantData.BodyPhase = GetBodyPhase(Ocean, CoreState, BuoyantData);
+
+	float SubmergedVolume = 0.0f;
+
+	if (BuoyantData.BodyPhase == EBuoyancyBodyPhase::Dry)
+	{
+		INC_DWORD_STAT(STAT_BuoyancyDryBodies);
+		BUOYANCY_COUNT(EarlyOuts, 1);
+
+		BuoyantData.ClippingPointsTransformed.Reset();
+
+		if (bPressure)
 		{
-			FVector Vc2 = Vertex1 + (Depth1 / (Depth1 - Depth3)) * (Vertex3 - Vertex1);
+			BuoyantData.Pressure.SetDry(*Mesh, Time);
+		}
+	}
+	else if (BuoyantData.BodyPhase == EBuoyancyBodyPhase::Submerged && !bPressure)
+	{
+		INC_DWORD_STAT(STAT_BuoyancySubmergedBodies);
+		BUOYANCY_COUNT(EarlyOuts, 1);
+
+		BuoyantData.ClippingPointsTransformed.Reset();
 
-			Volume += ComputeTetrahedronVolume(Center, Point, Vc1, Vc2, Vertex1);
+		// Nothing was sampled for submerged body, orbital velocity comes from single point below mean surface
+		if (Ocean.WantsWaveVelocities())
+		{
+			const int32 NumWaveComponents = Ocean.GetWaveLOD(BuoyantData.BodyLengthX, BuoyantData.WaveLODBias);
+			Water.Velocity = ToCoreVector(Ocean.GetWaterVelocity(State.CenterOfMass, -State.CenterOfMass.Z, nullptr, Time, NumWaveComponents));
 		}
+
+		SubmergedVolume = BuoyancyCore::SolveBodySubmerged(CoreState, Body, Water, ToCoreVector(BuoyantData.LocalCentroidOfVolume), CoreForces);
 	}
 	else
 	{
-		if (Depth3 < 0.0f)
-		{
-			FVector Vc2 = Vertex1 + (Depth1 / (Depth1 - Depth3)) * (Vertex3 - Vertex1);
+		// Pressure acts on triangles, so submerged pressure body is clipped like crossing one
+		INC_DWORD_STAT(STAT_BuoyancyCrossingBodies);
 
-			Volume += ComputeTetrahedronVolume(Center, Point, Vc1, Vertex2, Vertex3);
-			Volume += ComputeTetrahedronVolume(Center, Point, Vc1, Vertex3, Vc2);
-		}
-		else
-		{
-			FVector Vc2 = Vertex2 + (Depth2 / (Depth2 - Depth3)) * (Vertex3 - Vertex2);
+		SubmergedVolume = SolveCrossingBody(Ocean, State, CoreState, Body, Water, Time, BuoyantData, CoreForces);
+	}
 
-			Volume += ComputeTetrahedronVolume(Center, Point, Vc1, Vertex2, Vc2);
-		}
+	if (!bPressure)
+	{
+		UpdateSleepState(Ocean, State, CoreState, Time, SubmergedVolume, CoreForces, BuoyantData);
 	}
 
-	return Volume;
+	SetForces(CoreForces, Forces);
 }
 
-float UBuoyancyHelper::ComputeSubmergedVolume(AOceanManager* OceanManager, UStaticMeshComponent* BuoyantMesh, FClippingPlane& ClippingPlane, FVector& Centroid, FBuoyantBodyData& BuoyantData)
+float UBuoyancyHelper::SolveCrossingBody(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, const BuoyancyCore::FBodyState& CoreState, const BuoyancyCore::FBodyParams& Body,
+	const BuoyancyCore::FWaterParams& Water, float Time, FBuoyantBodyData& BuoyantData, BuoyancyCore::FForces& CoreForces)
 {
-	PxTriangleMesh* TempTriMesh = nullptr;
+	const FBuoyancyMesh* Mesh = BuoyantData.Mesh.Get();
 
-	if (BuoyantMesh->GetBodySetup()->TriMeshes.Num() > 0)
-	{
-		TempTriMesh = BuoyantMesh->GetBodySetup()->TriMeshes[0];
-	}
+	// Scratch buffers should only grow during first few updates, after that update must not allocate
+	const int32 ScratchCapacity = BuoyantData.Scratch.GetCapacity() + BuoyantData.ClippingPointsTransformed.Max();
+
+	TArray<FVector>& ClippingPoints = BuoyantData.ClippingPointsTransformed;
+	TArray<float>& Depths = BuoyantData.Scratch.VertexDepths;
+	Depths.SetNumUninitialized(Mesh->NumVertices(), false);
 
+	const bool bClipByWaveSurface = BuoyantData.ClippingMode == EBuoyancyClippingMode::WaveSurface;
 
-	if (TempTriMesh == nullptr)
+	if (bClipByWaveSurface)
+	{
+		ClippingPoints.Reset();
+		GetSurfaceDepths(Ocean, State, Time, BuoyantData);
+	}
+	else
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "No TriMesh data!");
+		GetTransformedTestPoints(Ocean, State, Time, ClippingPoints, BuoyantData);
+	}
 
-		return 0.0f;
+	if (BuoyantData.Scratch.GetCapacity() + BuoyantData.ClippingPointsTransformed.Max() != ScratchCapacity)
+	{
+		++BuoyantData.Scratch.NumAllocations;
+		INC_DWORD_STAT(STAT_BuoyancyScratchAllocations);
+		BUOYANCY_COUNT(Allocations, 1);
 	}
 
-	if (TempTriMesh->getNbTriangles() <= 0)
+	// Orbital velocities came with surface heights, body is dragged by their mean at depth of its center of mass
+	BuoyancyCore::FWaterParams SampledWater = Water;
+	if (Ocean.WantsWaveVelocities())
 	{
-		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Mesh has 0 triangles!");
+		const FWaveSampleBatch& WaveSamples = BuoyantData.Scratch.WaveSamples;
 
-		return 0.0f;
-	}
+		float SurfaceZ = 0.0f;
+		for (int32 i = 0; i < WaveSamples.Num(); ++i)
+		{
+			SurfaceZ += WaveSamples.DisplacementZ[i];
+		}
+		SurfaceZ = WaveSamples.Num() > 0 ? SurfaceZ / WaveSamples.Num() : 0.0f;
 
-	
-	ClippingPlane = ClaculateClippingPlane(OceanManager, BuoyantMesh, BuoyantData); 
-	//ClippingPlane.PlaneLocation = FVector::ZeroVector;
-	//ClippingPlane.PlaneNormal = FVector::UpVector;
-	
-	//DrawDebugSphere(BuoyantMesh->GetWorld(), ClippingPlane.PlaneLocation, 32.0f, 8, FColor::Yellow);
-	//DrawDebugDirectionalArrow(BuoyantMesh->GetWorld(), ClippingPlane.PlaneLocation, ClippingPlane.PlaneLocation + (ClippingPlane.PlaneNormal * 25.0f), 8.0f, FColor::Yellow);
+		const int32 NumWaveComponents = Ocean.GetWaveLOD(BuoyantData.BodyLengthX, BuoyantData.WaveLODBias);
+		SampledWater.Velocity = ToCoreVector(Ocean.GetWaterVelocity(State.CenterOfMass, SurfaceZ - State.CenterOfMass.Z, &WaveSamples, Time, NumWaveComponents));
+	}
 
-	FQuat Qt = BuoyantMesh->GetComponentRotation().Quaternion().Inverse();
-	FVector Normal = Qt.RotateVector(ClippingPlane.PlaneNormal);
-	float Offset = ClippingPlane.PlaneLocation.Z - FVector::DotProduct(FVector::UpVector, BuoyantMesh->GetCenterOfMass());
+	// @TODO: Move to actor tick and add local center offset to BuoyantData
+	//DrawDebugSphere(BuoyantMesh->GetWorld(), SubmergedCentroid, 8.0f, 8, FColor::Blue);
 
-	float TINY_DEPTH = -1e-6f;
+	if (BuoyantData.SolverMode == EBuoyancySolverMode::Pressure)
+	{
+		FBuoyancyPressureState& Pressure = BuoyantData.Pressure;
+		Pressure.Bind(*Mesh);
 
-	TArray<float> Ds;
-	Ds.AddUninitialized(TempTriMesh->getNbVertices());
+		const float DeltaTime = Pressure.BeginSolve(Time);
 
-	uint32 NumSubmerged = 0;
-	uint32 SampleVertex = 0;
+		float SubmergedVolume;
+		if (bClipByWaveSurface)
+		{
+			SubmergedVolume = BuoyancyCore::SolveBodyPressureSurface(Mesh->GetView(), CoreState, Body, SampledWater, BuoyantData.PressureParams, Depths.GetData(), DeltaTime,
+				Pressure.CoreScratch, &Pressure.History, CoreForces);
+		}
+		else
+		{
+			SubmergedVolume = BuoyancyCore::SolveBodyPressure(Mesh->GetView(), CoreState, Body, SampledWater, BuoyantData.PressureParams, ToCoreVectors(ClippingPoints.GetData()), ClippingPoints.Num(),
+				Depths.GetData(), DeltaTime, Pressure.CoreScratch, &Pressure.History, CoreForces);
+		}
 
-	const PxVec3* PVertices = TempTriMesh->getVertices();
+		BUOYANCY_COUNT(TrianglesClipped, Mesh->NumTriangles());
 
-	const FTransform RV_Transform = BuoyantMesh->GetComponentTransform();
+		return SubmergedVolume;
+	}
 
-	int32 i = 0;
-	for (i; i < Ds.Num(); ++i)
+	BuoyancyCore::FIncrementalVolume* Incremental = nullptr;
+	if (BuoyantData.bIncrementalVolume)
 	{
-		// LLSQ is Ready (returns correct Centroid and Normal) but applying it to buoyancy gives unrealistic results for now.
-		// So instead I use offsets based on WaveHeight for each Vertex. This solution is about x3 slower then LLSQ.
-		Ds[i] = FVector::DotProduct(Normal, P2UVector(PVertices[i])) - Offset;// -(OceanManager->GetWaveHeight(RV_Transform.TransformPosition(P2UVector(PVertices[i])), OceanManager->GetWorld()->GetTimeSeconds()).Z - FVector::DotProduct(ClippingPlane.PlaneNormal, BuoyantMesh->GetCenterOfMass()));
-		
-		if (Ds[i] < TINY_DEPTH)
-		{
-			++NumSubmerged;
-			SampleVertex = i;
-		}
+		BuoyantData.Incremental.Bind(*Mesh);
+		Incremental = &BuoyantData.Incremental.Core;
 	}
 
+	float SubmergedVolume;
+	if (bClipByWaveSurface)
+	{
+		SubmergedVolume = BuoyancyCore::SolveBodySurface(Mesh->GetView(), CoreState, Body, SampledWater, Depths.GetData(), CoreForces, Incremental);
+	}
+	else
+	{
+		SubmergedVolume = BuoyancyCore::SolveBody(Mesh->GetView(), CoreState, Body, SampledWater, ToCoreVectors(ClippingPoints.GetData()), ClippingPoints.Num(), Depths.GetData(), CoreForces, Incremental);
+	}
 
-	/* Return if no vertices are submerged */
-	if (NumSubmerged <= 0)
+	if (Incremental)
 	{
-		Centroid = FVector::ZeroVector;
-		return 0.0f;
+		INC_DWORD_STAT_BY(STAT_BuoyancyReclassifiedTriangles, Incremental->NumReclassified);
+		BUOYANCY_COUNT(TrianglesClipped, Incremental->NumCrossing);
+	}
+	else
+	{
+		BUOYANCY_COUNT(TrianglesClipped, Mesh->NumTriangles());
 	}
 
-	/* Find a point on the water surface. */
-	FVector Point = P2UVector(PVertices[SampleVertex]) - Ds[SampleVertex] * Normal;
+	return SubmergedVolume;
+}
 
-	float Volume = 0.0f;
-	Centroid = FVector::ZeroVector;
+bool UBuoyancyHelper::HoldForces(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, const BuoyancyCore::FBodyState& CoreState, const BuoyancyCore::FBodyParams& Body,
+	const BuoyancyCore::FWaterParams& Water, float Time, FBuoyantBodyData& BuoyantData, BuoyancyCore::FForces& CoreForces)
+{
+	FBuoyancySleepState& Sleep = BuoyantData.Sleep;
 
-	int32 TriNumber = TempTriMesh->getNbTriangles();
-	const void* Triangles = TempTriMesh->getTriangles();
+	// Nothing to hold before first solve
+	if (Sleep.LastSolveTime < 0.0f || Sleep.bWakeRequested || Sleep.UpdatesUntilSolve <= 1)
+	{
+		return false;
+	}
 
-	// Grab triangle indices
-	int32 I0, I1, I2;
+	float DepthChange = 0.0f;
 
-	for (int32 TriIndex = 0; TriIndex < TriNumber; ++TriIndex)
+	if (Sleep.bSleeping)
 	{
-		if (TempTriMesh->getTriangleMeshFlags() & PxTriangleMeshFlag::eHAS_16BIT_TRIANGLE_INDICES)
+		// Something pushed body, collisions and applied forces show up here too
+		if (State.LinearVelocity.SizeSquared() > FMath::Square(2.0f * BuoyantData.SleepLinearVelocity)
+			|| State.AngularVelocity.SizeSquared() > FMath::Square(2.0f * BuoyantData.SleepAngularVelocity))
 		{
-			PxU16* P16BitIndices = (PxU16*)Triangles;
-			I0 = P16BitIndices[(TriIndex * 3) + 0];
-			I1 = P16BitIndices[(TriIndex * 3) + 1];
-			I2 = P16BitIndices[(TriIndex * 3) + 2];
+			WakeBody(BuoyantData);
+			return false;
 		}
-		else
-		{
-			PxU32* P32BitIndices = (PxU32*)Triangles;
-			I0 = P32BitIndices[(TriIndex * 3) + 0];
-			I1 = P32BitIndices[(TriIndex * 3) + 1];
-			I2 = P32BitIndices[(TriIndex * 3) + 2];
-		}
-
-		FVector Vertex1 = P2UVector(PVertices[I0]);
-		float Depth1 = Ds[I0];
 
-		FVector Vertex2 = P2UVector(PVertices[I1]);
-		float Depth2 = Ds[I1];
+		const float SurfaceZ = GetSurfaceHeight(Ocean, State, Time, BuoyantData);
 
-		FVector Vertex3 = P2UVector(PVertices[I2]);
-		float Depth3 = Ds[I2];
-
-		if (Depth1 * Depth2 < 0.0f)
+		if (FMath::Abs(SurfaceZ - Sleep.RestSurfaceZ) > BuoyantData.WakeWaveHeight)
 		{
-			Volume += ClipTriangle(Centroid, Point, Vertex1, Vertex2, Vertex3, Depth1, Depth2, Depth3);
-		}
-		else if (Depth1 * Depth3 < 0.0f)
-		{
-			Volume += ClipTriangle(Centroid, Point, Vertex3, Vertex1, Vertex2, Depth3, Depth1, Depth2);
-		}
-		else if (Depth2 * Depth3 < 0.0f)
-		{
-			Volume += ClipTriangle(Centroid, Point, Vertex2, Vertex3, Vertex1, Depth2, Depth3, Depth1);
-		}
-		else if (Depth1 < 0.0f || Depth2 < 0.0f || Depth3 < 0.0f)
-		{
-			Volume += ComputeTetrahedronVolume(Centroid, Point, Vertex1, Vertex2, Vertex3);
+			WakeBody(BuoyantData);
+			return false;
 		}
+
+		DepthChange = (SurfaceZ - State.CenterOfMass.Z) - Sleep.RestDraft;
 	}
 
+	--Sleep.UpdatesUntilSolve;
 
-	float TINY_VOLUME = 1e-6f;
-	if (Volume <= TINY_VOLUME)
-	{
-		Centroid = FVector::ZeroVector;
-		return 0.0f;
-	}
+	INC_DWORD_STAT(STAT_BuoyancyHeldUpdates);
 
-	Centroid *= 1.0f / Volume;
-	Centroid = BuoyantMesh->GetCenterOfMass() + BuoyantMesh->GetComponentRotation().Quaternion().RotateVector(Centroid);
+	BuoyancyCore::SolveBodyHeld(CoreState, Body, Water, Sleep.Volume, ToCoreVector(Sleep.LocalCentroid), Sleep.WaterplaneArea, DepthChange, CoreForces);
 
-	return Volume;
+	return true;
 }
 
-FClippingPlane UBuoyancyHelper::ClaculateClippingPlane(AOceanManager* OceanManager, UStaticMeshComponent* BuoyantMesh, FBuoyantBodyData& BuoyantData)
+void UBuoyancyHelper::UpdateSleepState(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, const BuoyancyCore::FBodyState& CoreState, float Time, float SubmergedVolume,
+	const BuoyancyCore::FForces& CoreForces, FBuoyantBodyData& BuoyantData)
 {
-	TArray<FVector> ClippingPoints;
-	GetTransformedTestPoints(OceanManager, BuoyantMesh, ClippingPoints, BuoyantData);
+	FBuoyancySleepState& Sleep = BuoyantData.Sleep;
 
-	FClippingPlane ClippingPlane;
+	const float DeltaTime = Sleep.LastSolveTime >= 0.0f ? FMath::Max(Time - Sleep.LastSolveTime, 0.0f) : 0.0f;
+	const float VolumeChange = FMath::Abs(SubmergedVolume - Sleep.Volume);
 
+	Sleep.LastSolveTime = Time;
+	Sleep.bWakeRequested = false;
+	Sleep.Volume = SubmergedVolume;
+	Sleep.LocalCentroid = SubmergedVolume > 0.0f ? FromCoreVector(CoreState.Rotation.Inverse().RotateVector(CoreForces.ForceLocation - CoreState.CenterOfMass)) : FVector::ZeroVector;
 
-	// Calculate LLSQ Plane - it is not implemented
-	FVector Sum = FVector::ZeroVector;
+	// Only floating bodies settle, falling or sinking ones keep changing
+	const bool bCalm = BuoyantData.bAllowSleep && SubmergedVolume > 0.0f
+		&& State.LinearVelocity.SizeSquared() <= FMath::Square(BuoyantData.SleepLinearVelocity)
+		&& State.AngularVelocity.SizeSquared() <= FMath::Square(BuoyantData.SleepAngularVelocity)
+		&& VolumeChange <= BuoyantData.SleepVolumeChange * BuoyantData.BodyVolume;
 
-	// Find Plane Centroid
-	int32 i = 0;
-	for (i; i < ClippingPoints.Num(); ++i)
+	Sleep.CalmTime = bCalm ? Sleep.CalmTime + DeltaTime : 0.0f;
+
+	if (!bCalm)
 	{
-		Sum += ClippingPoints[i];
+		Sleep.bSleeping = false;
 	}
+	else if (Sleep.bSleeping || Sleep.CalmTime >= BuoyantData.SleepDelay)
+	{
+		// Rest follows every solve of sleeping body, so spring stays centered on current equilibrium
+		Sleep.RestSurfaceZ = GetSurfaceHeight(Ocean, State, Time, BuoyantData);
+		Sleep.RestDraft = Sleep.RestSurfaceZ - State.CenterOfMass.Z;
 
-	FVector Centroid = Sum * (1.0f / ClippingPoints.Num());
+		if (!Sleep.bSleeping)
+		{
+			const FBuoyancyMesh* Mesh = BuoyantData.Mesh.Get();
+			TArray<float>& Depths = BuoyantData.Scratch.VertexDepths;
+			Depths.SetNumUninitialized(Mesh->NumVertices(), false);
 
-	// Set Plane Location
-	ClippingPlane.PlaneLocation = Centroid;
+			// Same plane convention as SolveBody, mesh origin at center of mass
+			const BuoyancyCore::FVec3 Normal = CoreState.Rotation.Inverse().RotateVector(BuoyancyCore::FVec3(0.0f, 0.0f, 1.0f));
+			const float Step = FMath::Max(1.0f, 0.01f * BuoyantData.BodyLengthX);
 
-	FVector PlaneNormal = FVector::ZeroVector;
+			Sleep.WaterplaneArea = BuoyancyCore::ComputeWaterplaneArea(Mesh->GetView(), Normal, Sleep.RestDraft, Step, Depths.GetData());
+			Sleep.bSleeping = true;
+		}
+	}
 
-	float SumXX = 0.0f, SumXY = 0.0f, SumXZ = 0.0f;
-	float SumYY = 0.0f, SumYZ = 0.0f;
-	float SumZZ = 0.0f;
+	Sleep.UpdatesUntilSolve = Sleep.bSleeping ? BuoyantData.SleepSolveInterval : Ocean.GetUpdateInterval();
+}
 
-	// Find Plane Normal
-	i = 0;
-	for (i; i < ClippingPoints.Num(); ++i)
-	{
-		float DiffX = ClippingPoints[i].X - Centroid.X;
-		float DiffY = ClippingPoints[i].Y - Centroid.Y;
-		float DiffZ = ClippingPoints[i].Z - Centroid.Z;
+void UBuoyancyHelper::WakeBody(FBuoyantBodyData& BuoyantData)
+{
+	FBuoyancySleepState& Sleep = BuoyantData.Sleep;
+
+	Sleep.bSleeping = false;
+	Sleep.CalmTime = 0.0f;
+	Sleep.WaterplaneArea = 0.0f;
+	Sleep.UpdatesUntilSolve = 0;
+}
+
+float UBuoyancyHelper::GetSurfaceHeight(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, float Time, FBuoyantBodyData& BuoyantData)
+{
+	FWaveSampleBatch& WaveSamples = BuoyantData.Scratch.WaveSamples;
+	WaveSamples.Reset();
+	WaveSamples.Add(State.CenterOfMass.X, State.CenterOfMass.Y);
 
-		SumXX += DiffX * DiffX;
-		SumXY += DiffX * DiffY;
-		SumXZ += DiffX * DiffZ;
+	const int32 NumWaveComponents = Ocean.GetWaveLOD(BuoyantData.BodyLengthX, BuoyantData.WaveLODBias);
+	Ocean.GetSurfaceHeightBatch(WaveSamples, Time, NumWaveComponents);
 
-		SumYY += DiffY * DiffY;
-		SumYZ += DiffY * DiffZ;
+	return WaveSamples.DisplacementZ[0];
+}
 
-		SumZZ += DiffZ * DiffZ;
+EBuoyancyBodyPhase UBuoyancyHelper::GetBodyPhase(const FOceanWaterView& Ocean, const BuoyancyCore::FBodyState& CoreState, const FBuoyantBodyData& BuoyantData)
+{
+	if (!BuoyantData.bUseBroadPhase)
+	{
+		return EBuoyancyBodyPhase::Crossing;
 	}
 
-	FMatrix Matrix = FMatrix(FVector(SumXX, SumXY, SumXZ),
-							 FVector(SumXY, SumYY, SumYZ),
-							 FVector(SumXZ, SumYZ, SumZZ),
-							 FVector(0, 0, 0));
+	float SurfaceMinZ, SurfaceMaxZ;
+	Ocean.GetWaveHeightRange(SurfaceMinZ, SurfaceMaxZ);
 
-	float Determinant = Matrix.Determinant();
+	// Mesh origin is placed at center of mass, same as in solve
+	float MinZ, MaxZ;
+	BuoyancyCore::ComputeVerticalExtent(ToCoreVector(BuoyantData.Mesh->LocalBoundsMin), ToCoreVector(BuoyantData.Mesh->LocalBoundsMax), CoreState.Rotation, CoreState.CenterOfMass, MinZ, MaxZ);
 
-	if (Determinant == 0.0f)
+	switch (BuoyancyCore::ClassifyBody(MinZ, MaxZ, SurfaceMinZ - BuoyantData.BroadPhaseMargin, SurfaceMaxZ + BuoyantData.BroadPhaseMargin))
 	{
-		// @TODO: Implement Matrix GetNullSpace
+	case BuoyancyCore::EBodyPhase::Dry:
+		return EBuoyancyBodyPhase::Dry;
 
-		//m.GetNullSpace(destNormal,NULL,NULL);
+	case BuoyancyCore::EBodyPhase::Submerged:
+		return EBuoyancyBodyPhase::Submerged;
 
-		return ClippingPlane;
+	default:
+		return EBuoyancyBodyPhase::Crossing;
 	}
+}
 
-
-	ClippingPlane.PlaneNormal = FindEigenVector(Matrix.Inverse());
-
-	return ClippingPlane;
+void UBuoyancyHelper::SetForces(const BuoyancyCore::FForces& CoreForces, FBuoyancyForces& Forces)
+{
+	Forces.bHasForce = CoreForces.bHasForce;
+	Forces.Force = FromCoreVector(CoreForces.Force);
+	Forces.ForceLocation = FromCoreVector(CoreForces.ForceLocation);
+	Forces.Torque = FromCoreVector(CoreForces.Torque);
 }
 
-FVector UBuoyancyHelper::FindEigenVector(FMatrix Matrix)
+void UBuoyancyHelper::AddSectionForces(const FBuoyancyForces& SectionForces, const FVector& CenterOfMass, FBuoyancyForces& BodyForces)
 {
-	float Scale = FindLargestEntry(Matrix);
+	BuoyancyCore::FForces Section;
+	Section.bHasForce = SectionForces.bHasForce;
+	Section.Force = ToCoreVector(SectionForces.Force);
+	Section.ForceLocation = ToCoreVector(SectionForces.ForceLocation);
+	Section.Torque = ToCoreVector(SectionForces.Torque);
 
-	FMatrix MatrixC = Matrix * (1.0f / Scale);
-	
-	MatrixC = MatrixC * MatrixC;
-	MatrixC = MatrixC * MatrixC;
-	MatrixC = MatrixC * MatrixC;
+	BuoyancyCore::FForces Body;
+	Body.bHasForce = BodyForces.bHasForce;
+	Body.Force = ToCoreVector(BodyForces.Force);
+	Body.ForceLocation = ToCoreVector(BodyForces.ForceLocation);
+	Body.Torque = ToCoreVector(BodyForces.Torque);
 
-	FVector V = FVector(1.0f, 1.0f, 1.0f);
-	FVector LastV = V;
+	BuoyancyCore::AddSectionForces(Section, ToCoreVector(CenterOfMass), Body);
 
-	for (int32 i = 0; i < 100; ++i)
-	{
-		V = MatMulVec(MatrixC, V).GetSafeNormal();
-		
-		if (FVector::DistSquared(V, LastV) < 1e-16f)
-		{
-			break;
-		}
+	SetForces(Body, BodyForces);
+}
 
-		LastV = V;
-	}
+void UBuoyancyHelper::ApplyBuoyancyForces(UStaticMeshComponent* BuoyantMesh, const FBuoyancyForces& Forces)
+{
+	BUOYANCY_SCOPE(ApplyForces);
 
-	return V;
+	if (Forces.bHasForce)
+	{
+		BuoyantMesh->AddForceAtLocation(Forces.Force, Forces.ForceLocation);
+		BuoyantMesh->AddTorque(Forces.Torque);
+	}
 }
 
-float UBuoyancyHelper::FindLargestEntry(FMatrix Matrix)
+void UBuoyancyHelper::ApplyBuoyancyForces(FBodyInstance* BodyInstance, const FBuoyancyForces& Forces)
 {
-	float LargestValue = 0.0f;
+	BUOYANCY_SCOPE(ApplyForces);
 
-	for (int32 i = 0; i < 3; ++i)
+	if (Forces.bHasForce)
 	{
-		for (int32 j = 0; j < 3; ++j)
-		{
-			float Entry = FMath::Abs(Matrix.M[i][j]);
-
-			LargestValue = FMath::Max(Entry, LargestValue);
-		}
+		// We are already inside substep, so don't let forces be spread over substeps again
+		BodyInstance->AddForceAtPosition(Forces.Force, Forces.ForceLocation, false);
+		BodyInstance->AddTorque(Forces.Torque, false);
 	}
-
-	return LargestValue;
 }
 
-void UBuoyancyHelper::GetTransformedTestPoints(AOceanManager* OceanManager, UStaticMeshComponent* BuoyantMesh, TArray<FVector>& ClippingPoints, FBuoyantBodyData& BuoyantData)
+void UBuoyancyHelper::GetTransformedTestPoints(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, float Time, TArray<FVector>& ClippingPoints, FBuoyantBodyData& BuoyantData)
 {
+	FWaveSampleBatch& WaveSamples = BuoyantData.Scratch.WaveSamples;
+	WaveSamples.Reset();
+	ClippingPoints.Reset();
+
 	int32 i = 0;
 	for (i; i < BuoyantData.ClippingPointsOffsets.Num(); ++i)
 	{
-		FVector ClippingPoint = BuoyantMesh->GetComponentLocation() + BuoyantData.ClippingPointsOffsets[i];
-
-		ClippingPoint = BuoyantMesh->GetComponentRotation().RotateVector(ClippingPoint - BuoyantMesh->GetComponentLocation()) + BuoyantMesh->GetComponentLocation();
-		ClippingPoint.Z = OceanManager->GetWaveHeight(ClippingPoint, OceanManager->GetWorld()->GetTimeSeconds()).Z;
+		FVector ClippingPoint = State.Transform.GetRotation().RotateVector(BuoyantData.ClippingPointsOffsets[i]) + State.Transform.GetLocation();
 
 		//@FIXME: There is still a problem when Mesh is rotated 90* on X or Y axis
 		ClippingPoints.Add(ClippingPoint);
+		WaveSamples.Add(ClippingPoint.X, ClippingPoint.Y);
+	}
+
+	// Evaluate waves for all points at once, skipping small waves if body doesn't need them
+	const int32 NumWaveComponents = Ocean.GetWaveLOD(BuoyantData.BodyLengthX, BuoyantData.WaveLODBias);
+	Ocean.GetSurfaceHeightBatch(WaveSamples, Time, NumWaveComponents, Ocean.WantsWaveVelocities());
 
-		//DrawDebugSphere(BuoyantMesh->GetWorld(), ClippingPoint, 16.0f, 8, FColor::Red);
+	for (i = 0; i < ClippingPoints.Num(); ++i)
+	{
+		ClippingPoints[i].Z = WaveSamples.DisplacementZ[i];
+
+		//DrawDebugSphere(BuoyantMesh->GetWorld(), ClippingPoints[i], 16.0f, 8, FColor::Red);
 	}
 }
 
-FVector UBuoyancyHelper::MatMulVec(FMatrix Matrix, FVector Vector)
+void UBuoyancyHelper::GetSurfaceDepths(const FOceanWaterView& Ocean, const FBuoyantBodyState& State, float Time, FBuoyantBodyData& BuoyantData)
 {
-	FVector Result = FVector::ZeroVector;
+	const BuoyancyCore::FMeshView Mesh = BuoyantData.Mesh->GetView();
+	const int32 NumVertices = Mesh.NumVertices;
+
+	FBuoyancyScratch& Scratch = BuoyantData.Scratch;
+	FWaveSampleBatch& WaveSamples = Scratch.WaveSamples;
+
+	// Vertices are placed the same way as for plane clipping, with mesh origin at center of mass
+	const BuoyancyCore::FQuat Rotation = ToCoreQuat(State.Transform.GetRotation());
+	const BuoyancyCore::FVec3 Origin = ToCoreVector(State.CenterOfMass);
+
+	const int32 NumWaveComponents = Ocean.GetWaveLOD(BuoyantData.BodyLengthX, BuoyantData.WaveLODBias);
+
+	Scratch.WorldVertexZ.SetNumUninitialized(NumVertices, false);
 
-	for (int32 i = 0; i < 3; ++i)
+	if (BuoyantData.WaveGridResolution <= 0)
 	{
-		for (int32 j = 0; j < 3; ++j)
-		{
-			
-			Result[i] += (Matrix.M[i][j] * Vector[j]);
-		}
+		// Every vertex is one wave sample, shared by all triangles using it
+		WaveSamples.SetNum(NumVertices);
+		BuoyancyCore::TransformVertices(Mesh, Rotation, Origin, WaveSamples.PositionX.GetData(), WaveSamples.PositionY.GetData(), Scratch.WorldVertexZ.GetData());
+
+		Ocean.GetSurfaceHeightBatch(WaveSamples, Time, NumWaveComponents, Ocean.WantsWaveVelocities());
+
+		BuoyancyCore::ComputeSurfaceDepths(Scratch.WorldVertexZ.GetData(), WaveSamples.DisplacementZ.GetData(), NumVertices, Scratch.VertexDepths.GetData());
+		return;
 	}
 
-	return Result;
-}
+	Scratch.WorldVertexX.SetNumUninitialized(NumVertices, false);
+	Scratch.WorldVertexY.SetNumUninitialized(NumVertices, false);
+	BuoyancyCore::TransformVertices(Mesh, Rotation, Origin, Scratch.WorldVertexX.GetData(), Scratch.WorldVertexY.GetData(), Scratch.WorldVertexZ.GetData());
+
+	float MinX = MAX_flt, MinY = MAX_flt;
+	float MaxX = -MAX_flt, MaxY = -MAX_flt;
+
+	for (int32 i = 0; i < NumVertices; ++i)
+	{
+		MinX = FMath::Min(MinX, Scratch.WorldVertexX[i]);
+		MaxX = FMath::Max(MaxX, Scratch.WorldVertexX[i]);
+		MinY = FMath::Min(MinY, Scratch.WorldVertexY[i]);
+		MaxY = FMath::Max(MaxY, Scratch.WorldVertexY[i]);
+	}
+
+	// Longer side of body gets WaveGridResolution cells, shorter one keeps cells roughly square
+	const float GridSize = FMath::Max3(MaxX - MinX, MaxY - MinY, KINDA_SMALL_NUMBER);
+	const int32 NumX = FMath::Max(1, FMath::CeilToInt(BuoyantData.WaveGridResolution * (MaxX - MinX) / GridSize)) + 1;
+	const int32 NumY = FMath::Max(1, FMath::CeilToInt(BuoyantData.WaveGridResolution * (MaxY - MinY) / GridSize)) + 1;
 
+	BuoyancyCore::FHeightGrid Grid = BuoyancyCore::FHeightGrid::FromBounds(MinX, MinY, MaxX, MaxY, NumX, NumY, nullptr);
 
+	WaveSamples.SetNum(NumX * NumY);
+
+	for (int32 y = 0; y < NumY; ++y)
+	{
+		for (int32 x = 0; x < NumX; ++x)
+		{
+			Grid.GetSampleLocation(x, y, WaveSamples.PositionX[y * NumX + x], WaveSamples.PositionY[y * NumX + x]);
+		}
+	}
 
+	Ocean.GetSurfaceHeightBatch(WaveSamples, Time, NumWaveComponents, Ocean.WantsWaveVelocities());
 
+	Grid.Heights = WaveSamples.DisplacementZ.GetData();
+	BuoyancyCore::ComputeSurfaceDepths(Scratch.WorldVertexX.GetData(), Scratch.WorldVertexY.GetData(), Scratch.WorldVertexZ.GetData(), NumVertices, Grid, Scratch.VertexDepths.GetData());
+}
\ No newline at end of file
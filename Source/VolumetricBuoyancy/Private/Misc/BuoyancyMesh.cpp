@@ -0,0 +1,251 @@
+// Implementation created by David 'vebski' Niemiec
+
+#include "VolumetricBuoyancy.h"
+#include "PhysicsPublic.h"
+#include "PhysxPublic.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "PhysXIncludes.h"
+#include "ThirdParty/PhysX/PhysX-3.3/include/geometry/PxTriangleMesh.h"
+#include "ThirdParty/PhysX/PhysX-3.3/include/foundation/PxSimpleTypes.h"
+#include "Misc/BuoyancyMesh.h"
+
+struct FBuoyancyMeshCacheEntry
+{
+	/* TriMesh mesh was built from, so reimported meshes get rebuilt */
+	PxTriangleMesh* SourceTriMesh;
+
+	TWeakPtr<const FBuoyancyMesh, ESPMode::ThreadSafe> Mesh;
+
+	FBuoyancyMeshCacheEntry()
+		: SourceTriMesh(nullptr)
+	{
+	}
+};
+
+/* Meshes are only referenced weakly, data is freed when last actor using it is gone */
+static TMap<TWeakObjectPtr<UStaticMesh>, FBuoyancyMeshCacheEntry> BuoyancyMeshCache;
+
+/* Regenerate clipping points of mesh from its footprint */
+static void BuildClippingPoints(FBuoyancyMesh& Mesh, float Spacing, int32 MaxPoints)
+{
+	Mesh.ClippingPointSpacing = Spacing;
+	Mesh.MaxClippingPoints = FMath::Max(MaxPoints, 4);
+
+	Mesh.ClippingPoints.SetNumUninitialized(Mesh.MaxClippingPoints);
+
+	const int32 NumPoints = BuoyancyCore::GenerateClippingPoints(reinterpret_cast<const BuoyancyCore::FVec3*>(Mesh.Footprint.GetData()), Mesh.Footprint.Num(),
+		Spacing, Mesh.MaxClippingPoints, reinterpret_cast<BuoyancyCore::FVec3*>(Mesh.ClippingPoints.GetData()));
+
+	Mesh.ClippingPoints.SetNum(NumPoints);
+	Mesh.ClippingPoints.Shrink();
+}
+
+/* Compute derived data of mesh whose vertices and indices are filled */
+static void FinishBuoyancyMesh(FBuoyancyMesh& Mesh, float ClippingPointSpacing, int32 MaxClippingPoints)
+{
+	const int32 NumVertices = Mesh.NumVertices();
+
+	FBox Bounds(0);
+	for (int32 i = 0; i < NumVertices; ++i)
+	{
+		Bounds += Mesh.GetVertex(i);
+	}
+
+	Mesh.LocalBoundsMin = Bounds.Min;
+	Mesh.LocalBoundsMax = Bounds.Max;
+
+	Mesh.VertexTriangleStart.SetNumUninitialized(NumVertices + 1);
+	Mesh.VertexTriangles.SetNumUninitialized(Mesh.Indices.Num());
+	BuoyancyCore::BuildVertexTriangles(Mesh.GetView(), Mesh.VertexTriangleStart.GetData(), Mesh.VertexTriangles.GetData());
+
+	BuoyancyCore::FVec3 Centroid;
+	Mesh.Volume = BuoyancyCore::ComputeVolume(Mesh.GetView(), Centroid);
+	Mesh.LocalCentroid = FromCoreVector(Centroid);
+
+	TArray<int32> Order;
+	Order.SetNumUninitialized(NumVertices);
+	Mesh.Footprint.SetNumUninitialized(NumVertices * 2);
+
+	const int32 NumFootprint = BuoyancyCore::ComputeFootprint(Mesh.GetView(), Order.GetData(), reinterpret_cast<BuoyancyCore::FVec3*>(Mesh.Footprint.GetData()));
+	Mesh.Footprint.SetNum(NumFootprint);
+	Mesh.Footprint.Shrink();
+
+	BuildClippingPoints(Mesh, ClippingPointSpacing, MaxClippingPoints);
+}
+
+static FBuoyancyMeshPtr BuildBuoyancyMesh(PxTriangleMesh* TriMesh, float ClippingPointSpacing, int32 MaxClippingPoints)
+{
+	TSharedPtr<FBuoyancyMesh, ESPMode::ThreadSafe> Mesh = MakeShareable(new FBuoyancyMesh());
+
+	const int32 NumVertices = TriMesh->getNbVertices();
+	const int32 NumTriangles = TriMesh->getNbTriangles();
+	const PxVec3* PVertices = TriMesh->getVertices();
+	const void* Triangles = TriMesh->getTriangles();
+
+	Mesh->VertexX.SetNumUninitialized(NumVertices);
+	Mesh->VertexY.SetNumUninitialized(NumVertices);
+	Mesh->VertexZ.SetNumUninitialized(NumVertices);
+
+	for (int32 i = 0; i < NumVertices; ++i)
+	{
+		const FVector Vertex = P2UVector(PVertices[i]);
+
+		Mesh->VertexX[i] = Vertex.X;
+		Mesh->VertexY[i] = Vertex.Y;
+		Mesh->VertexZ[i] = Vertex.Z;
+	}
+
+	// Always store 32bit indices so hot loop doesn't have to check index format
+	Mesh->Indices.SetNumUninitialized(NumTriangles * 3);
+
+	if (TriMesh->getTriangleMeshFlags() & PxTriangleMeshFlag::eHAS_16BIT_TRIANGLE_INDICES)
+	{
+		const PxU16* P16BitIndices = (const PxU16*)Triangles;
+
+		for (int32 i = 0; i < NumTriangles * 3; ++i)
+		{
+			Mesh->Indices[i] = P16BitIndices[i];
+		}
+	}
+	else
+	{
+		const PxU32* P32BitIndices = (const PxU32*)Triangles;
+
+		for (int32 i = 0; i < NumTriangles * 3; ++i)
+		{
+			Mesh->Indices[i] = P32BitIndices[i];
+		}
+	}
+
+	FinishBuoyancyMesh(*Mesh, ClippingPointSpacing, MaxClippingPoints);
+
+	return Mesh;
+}
+
+FBuoyancyMeshPtr FBuoyancyMesh::Build(const FBuoyancyMesh& Source, const FTransform& Transform, float InClippingPointSpacing, int32 InMaxClippingPoints)
+{
+	TArray<FVector> Vertices;
+	Vertices.SetNumUninitialized(Source.NumVertices());
+	for (int32 i = 0; i < Vertices.Num(); ++i)
+	{
+		Vertices[i] = Transform.TransformPosition(Source.GetVertex(i));
+	}
+
+	TArray<int32> Indices = Source.Indices;
+
+	// Mirroring turns mesh inside out, winding is flipped back so volume stays positive
+	if (Transform.GetDeterminant() < 0.0f)
+	{
+		for (int32 i = 0; i < Indices.Num(); i += 3)
+		{
+			Swap(Indices[i + 1], Indices[i + 2]);
+		}
+	}
+
+	return Build(Vertices, Indices, InClippingPointSpacing, InMaxClippingPoints);
+}
+
+FBuoyancyMeshPtr FBuoyancyMesh::Build(const TArray<FVector>& Vertices, const TArray<int32>& Indices, float InClippingPointSpacing, int32 InMaxClippingPoints)
+{
+	if (Vertices.Num() < 4 || Indices.Num() < 12 || Indices.Num() % 3 != 0)
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Buoyancy proxy is not a closed mesh!");
+
+		return nullptr;
+	}
+
+	TSharedPtr<FBuoyancyMesh, ESPMode::ThreadSafe> Mesh = MakeShareable(new FBuoyancyMesh());
+
+	Mesh->VertexX.SetNumUninitialized(Vertices.Num());
+	Mesh->VertexY.SetNumUninitialized(Vertices.Num());
+	Mesh->VertexZ.SetNumUninitialized(Vertices.Num());
+
+	for (int32 i = 0; i < Vertices.Num(); ++i)
+	{
+		Mesh->VertexX[i] = Vertices[i].X;
+		Mesh->VertexY[i] = Vertices[i].Y;
+		Mesh->VertexZ[i] = Vertices[i].Z;
+	}
+
+	Mesh->Indices = Indices;
+
+	FinishBuoyancyMesh(*Mesh, FMath::Max(InClippingPointSpacing, 0.0f), InMaxClippingPoints);
+
+	return Mesh;
+}
+
+FBuoyancyMeshPtr FBuoyancyMesh::Get(UStaticMeshComponent* BuoyantMesh, float InClippingPointSpacing, int32 InMaxClippingPoints)
+{
+	if (!BuoyantMesh || !BuoyantMesh->StaticMesh || !BuoyantMesh->GetBodySetup())
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Buoyant mesh data is not correct!");
+
+		return nullptr;
+	}
+
+	return Get(BuoyantMesh->StaticMesh, InClippingPointSpacing, InMaxClippingPoints);
+}
+
+FBuoyancyMeshPtr FBuoyancyMesh::Get(UStaticMesh* StaticMesh, float InClippingPointSpacing, int32 InMaxClippingPoints)
+{
+	check(IsInGameThread());
+
+	if (!StaticMesh || !StaticMesh->BodySetup)
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Buoyant mesh data is not correct!");
+
+		return nullptr;
+	}
+
+	PxTriangleMesh* TriMesh = nullptr;
+	if (StaticMesh->BodySetup->TriMeshes.Num() > 0)
+	{
+		TriMesh = StaticMesh->BodySetup->TriMeshes[0];
+	}
+
+	if (TriMesh == nullptr)
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "No TriMesh data!");
+
+		return nullptr;
+	}
+
+	if (TriMesh->getNbTriangles() <= 0)
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Mesh has 0 triangles!");
+
+		return nullptr;
+	}
+
+	FBuoyancyMeshCacheEntry& Entry = BuoyancyMeshCache.FindOrAdd(StaticMesh);
+
+	FBuoyancyMeshPtr Mesh = Entry.Mesh.Pin();
+	if (Mesh.IsValid() && Entry.SourceTriMesh == TriMesh && InClippingPointSpacing >= 0.0f
+		&& (Mesh->ClippingPointSpacing != InClippingPointSpacing || Mesh->MaxClippingPoints != FMath::Max(InMaxClippingPoints, 4)))
+	{
+		// Other ocean wants different points, triangle data is copied but that happens only when oceans change
+		TSharedPtr<FBuoyancyMesh, ESPMode::ThreadSafe> Rebuilt = MakeShareable(new FBuoyancyMesh(*Mesh));
+		BuildClippingPoints(*Rebuilt, InClippingPointSpacing, InMaxClippingPoints);
+
+		Mesh = Rebuilt;
+		Entry.Mesh = Mesh;
+	}
+	else if (!Mesh.IsValid() || Entry.SourceTriMesh != TriMesh)
+	{
+		Mesh = BuildBuoyancyMesh(TriMesh, FMath::Max(InClippingPointSpacing, 0.0f), InMaxClippingPoints);
+
+		Entry.SourceTriMesh = TriMesh;
+		Entry.Mesh = Mesh;
+
+		// Drop entries of meshes that no longer exist
+		for (auto It = BuoyancyMeshCache.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().IsValid() || !It.Value().Mesh.IsValid())
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	return Mesh;
+}
@@ -0,0 +1,116 @@
+// Implementation created by David 'vebski' Niemiec
+
+#include "VolumetricBuoyancy.h"
+#include "Misc/BuoyancyRecorder.h"
+#include "ActorBuoyant.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBuoyancyRecorder, Log, All);
+
+FBuoyancyRecorder GBuoyancyRecorder;
+
+FBuoyancyRecorder::FBuoyancyRecorder()
+	: Writer(nullptr)
+{
+}
+
+bool FBuoyancyRecorder::Start(UWorld* World, const FString& FileName)
+{
+	Stop();
+
+	if (!World)
+	{
+		return false;
+	}
+
+	// Session has single wave spectrum, bodies of other oceans are left out
+	TArray<AActorBuoyant*> Bodies;
+	AOceanManager* OceanManager = nullptr;
+
+	for (TActorIterator<AActorBuoyant> ActorItr(World); ActorItr; ++ActorItr)
+	{
+		AActorBuoyant* Body = *ActorItr;
+
+		if (Body->IsFixedStep() && (!OceanManager || Body->GetOceanManager() == OceanManager))
+		{
+			OceanManager = Body->GetOceanManager();
+			Bodies.Add(Body);
+		}
+	}
+
+	if (Bodies.Num() == 0)
+	{
+		UE_LOG(LogBuoyancyRecorder, Warning, TEXT("There are no fixed step buoyant bodies to record"));
+		return false;
+	}
+
+	const FString Path = FPaths::ProfilingDir() / TEXT("Buoyancy") / FileName;
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Path), true);
+
+	Writer = IFileManager::Get().CreateFileWriter(*Path);
+	if (Writer == nullptr)
+	{
+		return false;
+	}
+
+	BuoyancyCore::WriteSessionHeader(*Writer, OceanManager->GetWaveSpectrum().GetView(), OceanManager->ClockStepsPerSecond, Bodies.Num());
+
+	for (const AActorBuoyant* Body : Bodies)
+	{
+		BuoyancyCore::WriteSessionBody(*Writer, Body->GetFixedStepBody());
+	}
+
+	// Current states are where replay starts
+	for (int32 i = 0; i < Bodies.Num(); ++i)
+	{
+		BodyIndices.Add(Bodies[i], i);
+		RecordState(Bodies[i], BuoyancyCore::ESessionRecord::Reset, Bodies[i]->GetFixedStep(), Bodies[i]->GetFixedStepState());
+	}
+
+	UE_LOG(LogBuoyancyRecorder, Display, TEXT("Recording %d fixed step bodies to %s"), Bodies.Num(), *Path);
+
+	return true;
+}
+
+void FBuoyancyRecorder::Stop()
+{
+	if (Writer)
+	{
+		Writer->Close();
+		delete Writer;
+		Writer = nullptr;
+	}
+
+	BodyIndices.Reset();
+}
+
+void FBuoyancyRecorder::RecordState(const AActorBuoyant* Body, BuoyancyCore::ESessionRecord Type, int32 Step, const BuoyancyCore::FBodyState& State)
+{
+	const int32* Index = BodyIndices.Find(Body);
+
+	if (Writer && Index)
+	{
+		BuoyancyCore::WriteSessionRecord(*Writer, Type, *Index, Step, State);
+	}
+}
+
+static void BuoyancyRecordCommand(const TArray<FString>& Args, UWorld* World)
+{
+	if (GBuoyancyRecorder.IsRecording() && (Args.Num() == 0 || Args[0] == TEXT("stop")))
+	{
+		GBuoyancyRecorder.Stop();
+		UE_LOG(LogBuoyancyRecorder, Display, TEXT("Stopped recording buoyancy session"));
+		return;
+	}
+
+	const FString FileName = Args.Num() > 0 ? Args[0] : FString::Printf(TEXT("Buoyancy-%s.bys"), *FDateTime::Now().ToString());
+
+	if (!GBuoyancyRecorder.Start(World, FileName))
+	{
+		UE_LOG(LogBuoyancyRecorder, Error, TEXT("Can't record buoyancy session to %s"), *FileName);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BuoyancyRecordCmd(
+	TEXT("Buoyancy.Record"),
+	TEXT("Record fixed step buoyant bodies to Saved/Profiling/Buoyancy/<FileName>.bys for BuoyancyBench --replay, run again or with 'stop' to close the file."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&BuoyancyRecordCommand));
@@ -0,0 +1,270 @@
+// Implementation created by David 'vebski' Niemiec
+
+#include "VolumetricBuoyancy.h"
+#include "Misc/BuoyancyStats.h"
+
+DEFINE_STAT(STAT_BuoyancyPlaneFit);
+DEFINE_STAT(STAT_BuoyancyWaveSampling);
+DEFINE_STAT(STAT_BuoyancyClassify);
+DEFINE_STAT(STAT_BuoyancyClip);
+DEFINE_STAT(STAT_BuoyancyApplyForces);
+DEFINE_STAT(STAT_BuoyancyInstances);
+
+DEFINE_LOG_CATEGORY_STATIC(LogBuoyancyStats, Log, All);
+
+FBuoyancyFrameStats GBuoyancyFrameStats;
+
+FBuoyancyFrameSample::FBuoyancyFrameSample()
+	: FrameNumber(0)
+	, DeltaSeconds(0.0f)
+{
+	FMemory::Memzero(StageMilliseconds);
+	FMemory::Memzero(Counters);
+}
+
+const TCHAR* FBuoyancyFrameSample::GetStageName(EBuoyancyStage Stage)
+{
+	switch (Stage)
+	{
+	case EBuoyancyStage::PlaneFit:			return TEXT("PlaneFit");
+	case EBuoyancyStage::WaveSampling:		return TEXT("WaveSampling");
+	case EBuoyancyStage::Classify:			return TEXT("Classify");
+	case EBuoyancyStage::Clip:				return TEXT("Clip");
+	case EBuoyancyStage::ApplyForces:		return TEXT("ApplyForces");
+	case EBuoyancyStage::Instances:			return TEXT("Instances");
+	default:								return TEXT("Unknown");
+	}
+}
+
+const TCHAR* FBuoyancyFrameSample::GetCounterName(EBuoyancyCounter Counter)
+{
+	switch (Counter)
+	{
+	case EBuoyancyCounter::BodiesSolved:		return TEXT("BodiesSolved");
+	case EBuoyancyCounter::TrianglesClipped:	return TEXT("TrianglesClipped");
+	case EBuoyancyCounter::WaveSamples:			return TEXT("WaveSamples");
+	case EBuoyancyCounter::EarlyOuts:			return TEXT("EarlyOuts");
+	case EBuoyancyCounter::Allocations:			return TEXT("Allocations");
+	case EBuoyancyCounter::InstancesSolved:		return TEXT("InstancesSolved");
+	default:									return TEXT("Unknown");
+	}
+}
+
+FBuoyancyFrameStats::FBuoyancyFrameStats()
+	: NumSummedFrames(0)
+	, LastFrameTime(0.0)
+	, CSVWriter(nullptr)
+{
+	FMemory::Memzero((void*)Counters, sizeof(Counters));
+	FMemory::Memzero((void*)StageCycles, sizeof(StageCycles));
+}
+
+void FBuoyancyFrameStats::Initialize()
+{
+#if BUOYANCY_FRAME_STATS
+	if (!EndFrameHandle.IsValid())
+	{
+		EndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FBuoyancyFrameStats::EndFrame);
+	}
+#endif
+}
+
+void FBuoyancyFrameStats::Shutdown()
+{
+	StopCSV();
+
+	if (EndFrameHandle.IsValid())
+	{
+		FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+		EndFrameHandle.Reset();
+	}
+}
+
+void FBuoyancyFrameStats::EndFrame()
+{
+	const double Now = FPlatformTime::Seconds();
+
+	FBuoyancyFrameSample Sample;
+	Sample.FrameNumber = GFrameCounter;
+	Sample.DeltaSeconds = LastFrameTime > 0.0 ? (float)(Now - LastFrameTime) : 0.0f;
+	LastFrameTime = Now;
+
+	for (int32 i = 0; i < (int32)EBuoyancyCounter::Num; ++i)
+	{
+		Sample.Counters[i] = FPlatformAtomics::InterlockedExchange(&Counters[i], 0);
+		Sum.Counters[i] += Sample.Counters[i];
+	}
+
+	for (int32 i = 0; i < (int32)EBuoyancyStage::Num; ++i)
+	{
+		const int64 Cycles = FPlatformAtomics::InterlockedExchange(&StageCycles[i], 0);
+		Sample.StageMilliseconds[i] = (float)(Cycles * FPlatformTime::GetSecondsPerCycle() * 1000.0);
+		Sum.StageMilliseconds[i] += Sample.StageMilliseconds[i];
+	}
+
+	Sum.DeltaSeconds += Sample.DeltaSeconds;
+	++NumSummedFrames;
+
+	LastFrame = Sample;
+
+	if (CSVWriter)
+	{
+		WriteCSVRow(Sample);
+	}
+}
+
+FBuoyancyFrameSample FBuoyancyFrameStats::GetAverage() const
+{
+	FBuoyancyFrameSample Average;
+	Average.FrameNumber = LastFrame.FrameNumber;
+
+	if (NumSummedFrames == 0)
+	{
+		return Average;
+	}
+
+	Average.DeltaSeconds = Sum.DeltaSeconds / NumSummedFrames;
+
+	for (int32 i = 0; i < (int32)EBuoyancyCounter::Num; ++i)
+	{
+		Average.Counters[i] = Sum.Counters[i] / NumSummedFrames;
+	}
+
+	for (int32 i = 0; i < (int32)EBuoyancyStage::Num; ++i)
+	{
+		Average.StageMilliseconds[i] = Sum.StageMilliseconds[i] / NumSummedFrames;
+	}
+
+	return Average;
+}
+
+void FBuoyancyFrameStats::ResetAverage()
+{
+	Sum = FBuoyancyFrameSample();
+	NumSummedFrames = 0;
+}
+
+bool FBuoyancyFrameStats::StartCSV(const FString& FileName)
+{
+	StopCSV();
+
+	const FString Path = FPaths::ProfilingDir() / TEXT("Buoyancy") / FileName;
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Path), true);
+
+	CSVWriter = IFileManager::Get().CreateFileWriter(*Path);
+	if (CSVWriter == nullptr)
+	{
+		return false;
+	}
+
+	CSVFileName = Path;
+
+	FString Header = TEXT("Frame,DeltaMs");
+	for (int32 i = 0; i < (int32)EBuoyancyStage::Num; ++i)
+	{
+		Header += FString::Printf(TEXT(",%sMs"), FBuoyancyFrameSample::GetStageName((EBuoyancyStage)i));
+	}
+	for (int32 i = 0; i < (int32)EBuoyancyCounter::Num; ++i)
+	{
+		Header += FString::Printf(TEXT(",%s"), FBuoyancyFrameSample::GetCounterName((EBuoyancyCounter)i));
+	}
+	Header += LINE_TERMINATOR;
+
+	FTCHARToUTF8 Converted(*Header);
+	CSVWriter->Serialize((void*)Converted.Get(), Converted.Length());
+
+	return true;
+}
+
+void FBuoyancyFrameStats::StopCSV()
+{
+	if (CSVWriter)
+	{
+		CSVWriter->Close();
+		delete CSVWriter;
+		CSVWriter = nullptr;
+	}
+}
+
+void FBuoyancyFrameStats::WriteCSVRow(const FBuoyancyFrameSample& Sample)
+{
+	FString Row = FString::Printf(TEXT("%llu,%.3f"), Sample.FrameNumber, Sample.DeltaSeconds * 1000.0f);
+	for (int32 i = 0; i < (int32)EBuoyancyStage::Num; ++i)
+	{
+		Row += FString::Printf(TEXT(",%.4f"), Sample.StageMilliseconds[i]);
+	}
+	for (int32 i = 0; i < (int32)EBuoyancyCounter::Num; ++i)
+	{
+		Row += FString::Printf(TEXT(",%d"), Sample.Counters[i]);
+	}
+	Row += LINE_TERMINATOR;
+
+	FTCHARToUTF8 Converted(*Row);
+	CSVWriter->Serialize((void*)Converted.Get(), Converted.Length());
+}
+
+static void LogFrameSample(const TCHAR* Title, const FBuoyancyFrameSample& Sample)
+{
+	UE_LOG(LogBuoyancyStats, Display, TEXT("%s (frame %llu, %.2f ms):"), Title, Sample.FrameNumber, Sample.DeltaSeconds * 1000.0f);
+
+	for (int32 i = 0; i < (int32)EBuoyancyStage::Num; ++i)
+	{
+		UE_LOG(LogBuoyancyStats, Display, TEXT("  %-18s %8.3f ms"), FBuoyancyFrameSample::GetStageName((EBuoyancyStage)i), Sample.StageMilliseconds[i]);
+	}
+
+	for (int32 i = 0; i < (int32)EBuoyancyCounter::Num; ++i)
+	{
+		UE_LOG(LogBuoyancyStats, Display, TEXT("  %-18s %8d"), FBuoyancyFrameSample::GetCounterName((EBuoyancyCounter)i), Sample.Counters[i]);
+	}
+}
+
+static void BuoyancyStatsCommand(const TArray<FString>& Args)
+{
+#if BUOYANCY_FRAME_STATS
+	if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+	{
+		GBuoyancyFrameStats.ResetAverage();
+		return;
+	}
+
+	LogFrameSample(TEXT("Buoyancy last frame"), GBuoyancyFrameStats.GetLastFrame());
+	LogFrameSample(TEXT("Buoyancy average since reset"), GBuoyancyFrameStats.GetAverage());
+#else
+	UE_LOG(LogBuoyancyStats, Warning, TEXT("Buoyancy frame stats are disabled in shipping builds"));
+#endif
+}
+
+static void BuoyancyStatsCSVCommand(const TArray<FString>& Args)
+{
+#if BUOYANCY_FRAME_STATS
+	if (GBuoyancyFrameStats.IsWritingCSV() && (Args.Num() == 0 || Args[0] == TEXT("stop")))
+	{
+		GBuoyancyFrameStats.StopCSV();
+		UE_LOG(LogBuoyancyStats, Display, TEXT("Stopped writing buoyancy stats"));
+		return;
+	}
+
+	const FString FileName = Args.Num() > 0 ? Args[0] : FString::Printf(TEXT("Buoyancy-%s.csv"), *FDateTime::Now().ToString());
+
+	if (GBuoyancyFrameStats.StartCSV(FileName))
+	{
+		UE_LOG(LogBuoyancyStats, Display, TEXT("Writing buoyancy stats of every frame to %s"), *(FPaths::ProfilingDir() / TEXT("Buoyancy") / FileName));
+	}
+	else
+	{
+		UE_LOG(LogBuoyancyStats, Error, TEXT("Can't open %s for buoyancy stats"), *FileName);
+	}
+#else
+	UE_LOG(LogBuoyancyStats, Warning, TEXT("Buoyancy frame stats are disabled in shipping builds"));
+#endif
+}
+
+static FAutoConsoleCommand BuoyancyStatsCmd(
+	TEXT("Buoyancy.Stats"),
+	TEXT("Log buoyancy stage times and counters of last frame and their average. 'Buoyancy.Stats reset' restarts the average."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BuoyancyStatsCommand));
+
+static FAutoConsoleCommand BuoyancyStatsCSVCmd(
+	TEXT("Buoyancy.StatsCSV"),
+	TEXT("Start writing buoyancy stats of every frame to Saved/Profiling/Buoyancy/<FileName>.csv, run again or with 'stop' to close the file."),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BuoyancyStatsCSVCommand));
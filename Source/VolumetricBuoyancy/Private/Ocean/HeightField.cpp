@@ -0,0 +1,188 @@
+// Implementation created by David 'vebski' Niemiec
+
+#include "VolumetricBuoyancy.h"
+#include "Ocean/HeightField.h"
+
+FHeightField::FHeightField()
+	: WorldCenter(FVector2D::ZeroVector)
+	, InvWorldSize(1.0f / 10000.0f)
+	, MinHeight(0.0f)
+	, MaxHeight(0.0f)
+{
+}
+
+void FHeightField::Build(const FColor* Texels, int32 InWidth, int32 InHeight, float Scale, float Offset, bool bBuildMips)
+{
+	if (Texels == nullptr || !AllocateMips(InWidth, InHeight, bBuildMips))
+	{
+		return;
+	}
+
+	const float TexelScale = Scale / 255.0f;
+	for (int32 i = 0; i < InWidth * InHeight; ++i)
+	{
+		Heights[i] = Texels[i].R * TexelScale + Offset;
+	}
+
+	BuildMips();
+}
+
+void FHeightField::Build(const float* Values, int32 InWidth, int32 InHeight, float Scale, float Offset, bool bBuildMips)
+{
+	if (Values == nullptr || !AllocateMips(InWidth, InHeight, bBuildMips))
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < InWidth * InHeight; ++i)
+	{
+		Heights[i] = Values[i] * Scale + Offset;
+	}
+
+	BuildMips();
+}
+
+bool FHeightField::AllocateMips(int32 InWidth, int32 InHeight, bool bBuildMips)
+{
+	// Reset keeps memory, rebuilding field of the same size doesn't allocate
+	Reset();
+
+	if (InWidth <= 0 || InHeight <= 0)
+	{
+		return false;
+	}
+
+	// Size whole chain up front so it is allocated only once
+	int32 NumHeights = 0;
+	int32 MipWidth = InWidth;
+	int32 MipHeight = InHeight;
+
+	while (true)
+	{
+		FMip Mip;
+		Mip.Width = MipWidth;
+		Mip.Height = MipHeight;
+		Mip.Offset = NumHeights;
+		Mips.Add(Mip);
+
+		NumHeights += MipWidth * MipHeight;
+
+		if (!bBuildMips || (MipWidth == 1 && MipHeight == 1))
+		{
+			break;
+		}
+
+		MipWidth = FMath::Max(1, MipWidth / 2);
+		MipHeight = FMath::Max(1, MipHeight / 2);
+	}
+
+	Heights.SetNumUninitialized(NumHeights, false);
+
+	return true;
+}
+
+void FHeightField::BuildMips()
+{
+	MinHeight = MAX_flt;
+	MaxHeight = -MAX_flt;
+
+	for (int32 i = 0; i < Mips[0].Width * Mips[0].Height; ++i)
+	{
+		MinHeight = FMath::Min(MinHeight, Heights[i]);
+		MaxHeight = FMath::Max(MaxHeight, Heights[i]);
+	}
+
+	// Every mip averages 2x2 heights of previous one, odd edges are clamped
+	for (int32 MipIndex = 1; MipIndex < Mips.Num(); ++MipIndex)
+	{
+		const FMip& Source = Mips[MipIndex - 1];
+		const FMip& Target = Mips[MipIndex];
+
+		const float* SourceHeights = Heights.GetData() + Source.Offset;
+		float* TargetHeights = Heights.GetData() + Target.Offset;
+
+		for (int32 y = 0; y < Target.Height; ++y)
+		{
+			const int32 Y0 = FMath::Min(y * 2, Source.Height - 1);
+			const int32 Y1 = FMath::Min(y * 2 + 1, Source.Height - 1);
+
+			for (int32 x = 0; x < Target.Width; ++x)
+			{
+				const int32 X0 = FMath::Min(x * 2, Source.Width - 1);
+				const int32 X1 = FMath::Min(x * 2 + 1, Source.Width - 1);
+
+				TargetHeights[y * Target.Width + x] = 0.25f * (SourceHeights[Y0 * Source.Width + X0] + SourceHeights[Y0 * Source.Width + X1]
+					+ SourceHeights[Y1 * Source.Width + X0] + SourceHeights[Y1 * Source.Width + X1]);
+			}
+		}
+	}
+}
+
+void FHeightField::SetWorldBounds(const FVector2D& InWorldCenter, float InWorldSize)
+{
+	WorldCenter = InWorldCenter;
+	InvWorldSize = 1.0f / FMath::Max(InWorldSize, KINDA_SMALL_NUMBER);
+}
+
+void FHeightField::Reset()
+{
+	Heights.Reset();
+	Mips.Reset();
+	MinHeight = 0.0f;
+	MaxHeight = 0.0f;
+}
+
+float FHeightField::SampleMip(const FMip& MipInfo, float X, float Y) const
+{
+	// Texel centers are at half texel offsets
+	const float U = FMath::Clamp(((X - WorldCenter.X) * InvWorldSize + 0.5f) * MipInfo.Width - 0.5f, 0.0f, MipInfo.Width - 1.0f);
+	const float V = FMath::Clamp(((Y - WorldCenter.Y) * InvWorldSize + 0.5f) * MipInfo.Height - 0.5f, 0.0f, MipInfo.Height - 1.0f);
+
+	const int32 X0 = FMath::FloorToInt(U);
+	const int32 Y0 = FMath::FloorToInt(V);
+	const int32 X1 = FMath::Min(X0 + 1, MipInfo.Width - 1);
+	const int32 Y1 = FMath::Min(Y0 + 1, MipInfo.Height - 1);
+
+	const float FracX = U - X0;
+	const float FracY = V - Y0;
+
+	const float* MipHeights = Heights.GetData() + MipInfo.Offset;
+	const float* Row0 = MipHeights + Y0 * MipInfo.Width;
+	const float* Row1 = MipHeights + Y1 * MipInfo.Width;
+
+	const float H0 = FMath::Lerp(Row0[X0], Row0[X1], FracX);
+	const float H1 = FMath::Lerp(Row1[X0], Row1[X1], FracX);
+
+	return FMath::Lerp(H0, H1, FracY);
+}
+
+float FHeightField::Sample(float X, float Y, int32 Mip) const
+{
+	if (!IsValid())
+	{
+		return 0.0f;
+	}
+
+	return SampleMip(Mips[FMath::Clamp(Mip, 0, Mips.Num() - 1)], X, Y);
+}
+
+void FHeightField::SampleBatch(const float* X, const float* Y, int32 NumSamples, float* OutHeights, int32 Mip) const
+{
+	if (!IsValid())
+	{
+		FMemory::Memzero(OutHeights, NumSamples * sizeof(float));
+		return;
+	}
+
+	const FMip& MipInfo = Mips[FMath::Clamp(Mip, 0, Mips.Num() - 1)];
+
+	for (int32 i = 0; i < NumSamples; ++i)
+	{
+		OutHeights[i] = SampleMip(MipInfo, X[i], Y[i]);
+	}
+}
+
+uint32 FHeightField::GetAllocatedSize() const
+{
+	return Heights.GetAllocatedSize() + Mips.GetAllocatedSize();
+}
@@ -2,22 +2,100 @@
 
 #include "VolumetricBuoyancy.h"
 #include "Ocean/HeightMapReader.h"
+#include "Ocean/OceanManager.h"
 
+AHeightMapReader::AHeightMapReader(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	WorldSize = 10000.0f;
+	HeightScale = 200.0f;
+	HeightOffset = -100.0f;
+	bBuildMips = false;
+
+	bAsyncReadback = true;
+	ReadbackSource = EHeightReadbackSource::RenderTarget;
+	ReadbackSlots = 4;
+	ReadbackLatencyFrames = 2;
+	SyntheticResolution = 128;
+
+	HeightField = MakeShareable(new FHeightField());
+	HeightFieldTimestamp = 0.0f;
+	OceanManager = NULL;
+
+	// Tick before physics so bodies see frame published this frame
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+}
+
+void AHeightMapReader::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!bAsyncReadback)
+	{
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	FHeightReadbackSourcePtr Source;
+	if (ReadbackSource == EHeightReadbackSource::Synthetic || !FApp::CanEverRender())
+	{
+		Source = MakeShareable(new FSyntheticHeightSource(SyntheticResolution, SyntheticResolution, 1));
+	}
+	else if (RenderTarget != NULL)
+	{
+		Source = MakeShareable(new FRenderTargetReadbackSource(RenderTarget));
+	}
+	else
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Height map reader has no render target!");
+	}
+
+	Readback.Initialize(Source, ReadbackSlots, ReadbackLatencyFrames);
+	Readback.SetDecodeParams(FVector2D::ZeroVector, WorldSize, HeightScale, HeightOffset, bBuildMips);
+}
+
+void AHeightMapReader::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Readback.Shutdown();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AHeightMapReader::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	Readback.Tick(GFrameCounter, GetCaptureTime(), true);
+}
 
 void AHeightMapReader::UpdateBuffer()
 {
 	ColorBuffer.Reset();
 
+	// Callers may still hold previous field
+	if (!HeightField.IsUnique())
+	{
+		HeightField = MakeShareable(new FHeightField());
+	}
+
+	HeightField->Reset();
+	HeightFieldTimestamp = GetCaptureTime();
+
 	if (RenderTarget != NULL)
 	{
-		FTextureRenderTarget2DResource* textureResource = (FTextureRenderTarget2DResource*)RenderTarget->Resource;
+		FTextureRenderTargetResource* TextureResource = RenderTarget->GameThread_GetRenderTargetResource();
+
+		if (TextureResource && TextureResource->ReadPixels(ColorBuffer) && ColorBuffer.Num() == RenderTarget->SizeX * RenderTarget->SizeY)
+		{
+			HeightField->SetWorldBounds(FVector2D::ZeroVector, WorldSize);
+			HeightField->Build(ColorBuffer.GetData(), RenderTarget->SizeX, RenderTarget->SizeY, HeightScale, HeightOffset, bBuildMips);
+		}
 	}
 }
 
 FColor AHeightMapReader::GetRenderTargetValue(float x, float y)
 {
-	float Size = 10000.0f;
-
 	if (RenderTarget == NULL || ColorBuffer.Num() == 0)
 	{
 		return FColor(0);
@@ -26,8 +104,8 @@ FColor AHeightMapReader::GetRenderTargetValue(float x, float y)
 	float Width = RenderTarget->GetSurfaceWidth();
 	float Height = RenderTarget->GetSurfaceHeight();
 
-	float NormalizedX = (x / Size) + 0.5f;
-	float NormalizedY = (y / Size) + 0.5f;
+	float NormalizedX = (x / WorldSize) + 0.5f;
+	float NormalizedY = (y / WorldSize) + 0.5f;
 
 	int i = (int)(NormalizedX * Width);
 	int j = (int)(NormalizedY * Height);
@@ -60,11 +138,50 @@ FColor AHeightMapReader::GetRenderTargetValue(float x, float y)
 
 	if (Index >= ColorBuffer.Num())
 	{
-		Index = ColorBuffer.Num();
+		Index = ColorBuffer.Num() - 1;
 	}
 
 
 	return ColorBuffer[Index];
 }
 
+float AHeightMapReader::GetHeight(float x, float y) const
+{
+	return GetHeightField()->Sample(x, y);
+}
+
+float AHeightMapReader::GetHeightTimestamp() const
+{
+	return Readback.HasFrame() ? Readback.GetLatestTimestamp() : HeightFieldTimestamp;
+}
+
+void AHeightMapReader::GetHeightBatch(const float* X, const float* Y, int32 NumSamples, float* OutHeights) const
+{
+	GetHeightField()->SampleBatch(X, Y, NumSamples, OutHeights);
+}
+
+void AHeightMapReader::SetOceanManager(AOceanManager* InOceanManager)
+{
+	OceanManager = InOceanManager;
 
+	// Ocean clock has to advance before frame is stamped with it
+	if (OceanManager)
+	{
+		AddTickPrerequisiteActor(OceanManager);
+	}
+}
+
+float AHeightMapReader::GetCaptureTime() const
+{
+	if (OceanManager)
+	{
+		return OceanManager->GetWaveTime();
+	}
+
+	return GetWorld() ? GetWorld()->GetTimeSeconds() : 0.0f;
+}
+
+FHeightFieldPtr AHeightMapReader::GetHeightField() const
+{
+	return Readback.HasFrame() ? Readback.GetLatestFrame() : FHeightFieldPtr(HeightField);
+}
@@ -0,0 +1,390 @@
+// Ocean created by Handkor
+
+#include "VolumetricBuoyancy.h"
+#include "RenderingThread.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "Ocean/HeightReadback.h"
+
+struct FRenderTargetReadbackSource::FSlot
+{
+	/* Render thread only */
+	FTexture2DRHIRef StagingTexture;
+
+	/* Written on render thread between BeginRead and completion of ReadFence */
+	TArray<float> Values;
+	int32 Width;
+	int32 Height;
+
+	FRenderCommandFence ReadFence;
+
+	FSlot()
+		: Width(0)
+		, Height(0)
+	{
+	}
+};
+
+/* Convert mapped staging surface to normalized red channel, returns false for unsupported formats */
+static bool DecodeStagingSurface(const void* Data, EPixelFormat Format, int32 RowPitch, int32 Width, int32 Height, float* OutValues)
+{
+	switch (Format)
+	{
+	case PF_B8G8R8A8:
+		for (int32 y = 0; y < Height; ++y)
+		{
+			const FColor* Row = (const FColor*)Data + y * RowPitch;
+			for (int32 x = 0; x < Width; ++x)
+			{
+				OutValues[y * Width + x] = Row[x].R / 255.0f;
+			}
+		}
+		return true;
+
+	case PF_FloatRGBA:
+		for (int32 y = 0; y < Height; ++y)
+		{
+			const FFloat16Color* Row = (const FFloat16Color*)Data + y * RowPitch;
+			for (int32 x = 0; x < Width; ++x)
+			{
+				OutValues[y * Width + x] = Row[x].R.GetFloat();
+			}
+		}
+		return true;
+
+	case PF_R32_FLOAT:
+		for (int32 y = 0; y < Height; ++y)
+		{
+			FMemory::Memcpy(OutValues + y * Width, (const float*)Data + y * RowPitch, Width * sizeof(float));
+		}
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+FRenderTargetReadbackSource::FRenderTargetReadbackSource(UTextureRenderTarget2D* InRenderTarget)
+	: RenderTarget(InRenderTarget)
+{
+}
+
+FRenderTargetReadbackSource::~FRenderTargetReadbackSource()
+{
+	// Commands already in flight still use slots, delete them after those
+	ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
+		DeleteHeightReadbackSlots,
+		TArray<FSlot*>, SlotsToDelete, Slots,
+		{
+			for (FSlot* SlotData : SlotsToDelete)
+			{
+				delete SlotData;
+			}
+		});
+}
+
+void FRenderTargetReadbackSource::Initialize(int32 NumSlots)
+{
+	check(Slots.Num() == 0);
+
+	for (int32 i = 0; i < NumSlots; ++i)
+	{
+		Slots.Add(new FSlot());
+	}
+}
+
+void FRenderTargetReadbackSource::BeginCopy(int32 Slot, float Time)
+{
+	FTextureRenderTargetResource* Resource = RenderTarget.IsValid() ? RenderTarget->GameThread_GetRenderTargetResource() : nullptr;
+	if (Resource == nullptr)
+	{
+		return;
+	}
+
+	ENQUEUE_UNIQUE_RENDER_COMMAND_TWOPARAMETER(
+		CopyHeightReadbackSlot,
+		FTextureRenderTargetResource*, Resource, Resource,
+		FSlot*, SlotData, Slots[Slot],
+		{
+			const FTexture2DRHIRef& SourceTexture = Resource->GetRenderTargetTexture();
+			if (!SourceTexture.IsValid())
+			{
+				return;
+			}
+
+			// Staging texture is created once per slot and reused while render target keeps its size
+			FTexture2DRHIRef& StagingTexture = SlotData->StagingTexture;
+			if (!StagingTexture.IsValid() || StagingTexture->GetSizeX() != SourceTexture->GetSizeX() || StagingTexture->GetSizeY() != SourceTexture->GetSizeY()
+				|| StagingTexture->GetFormat() != SourceTexture->GetFormat())
+			{
+				FRHIResourceCreateInfo CreateInfo;
+				StagingTexture = RHICreateTexture2D(SourceTexture->GetSizeX(), SourceTexture->GetSizeY(), SourceTexture->GetFormat(), 1, 1, TexCreate_CPUReadback, CreateInfo);
+			}
+
+			RHICmdList.CopyToResolveTarget(SourceTexture, StagingTexture, false, FResolveParams());
+		});
+}
+
+void FRenderTargetReadbackSource::BeginRead(int32 Slot)
+{
+	FSlot* Target = Slots[Slot];
+
+	// Copy was issued frames ago, so mapping doesn't wait for GPU
+	ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
+		ReadHeightReadbackSlot,
+		FSlot*, SlotData, Target,
+		{
+			SlotData->Width = 0;
+			SlotData->Height = 0;
+
+			FTexture2DRHIRef& StagingTexture = SlotData->StagingTexture;
+			if (!StagingTexture.IsValid())
+			{
+				return;
+			}
+
+			void* Data = nullptr;
+			int32 RowPitch = 0;
+			int32 MappedHeight = 0;
+			RHICmdList.MapStagingSurface(StagingTexture, Data, RowPitch, MappedHeight);
+
+			if (Data != nullptr)
+			{
+				const int32 Width = StagingTexture->GetSizeX();
+				const int32 Height = StagingTexture->GetSizeY();
+
+				SlotData->Values.SetNumUninitialized(Width * Height, false);
+
+				if (DecodeStagingSurface(Data, StagingTexture->GetFormat(), RowPitch, Width, Height, SlotData->Values.GetData()))
+				{
+					SlotData->Width = Width;
+					SlotData->Height = Height;
+				}
+			}
+
+			RHICmdList.UnmapStagingSurface(StagingTexture);
+		});
+
+	Target->ReadFence.BeginFence();
+}
+
+bool FRenderTargetReadbackSource::IsReadComplete(int32 Slot) const
+{
+	return Slots[Slot]->ReadFence.IsFenceComplete();
+}
+
+const float* FRenderTargetReadbackSource::GetValues(int32 Slot, int32& OutWidth, int32& OutHeight) const
+{
+	const FSlot* SlotData = Slots[Slot];
+
+	OutWidth = SlotData->Width;
+	OutHeight = SlotData->Height;
+
+	return SlotData->Values.GetData();
+}
+
+FSyntheticHeightSource::FSyntheticHeightSource(int32 InWidth, int32 InHeight, int32 InReadLatency)
+	: Width(FMath::Max(InWidth, 1))
+	, Height(FMath::Max(InHeight, 1))
+	, ReadLatency(FMath::Max(InReadLatency, 0))
+{
+}
+
+void FSyntheticHeightSource::Initialize(int32 NumSlots)
+{
+	Slots.SetNum(NumSlots);
+
+	for (FSlot& Slot : Slots)
+	{
+		Slot.Values.SetNumUninitialized(Width * Height);
+		Slot.Time = 0.0f;
+		Slot.PendingPolls = 0;
+	}
+}
+
+void FSyntheticHeightSource::BeginCopy(int32 Slot, float Time)
+{
+	Slots[Slot].Time = Time;
+}
+
+void FSyntheticHeightSource::BeginRead(int32 Slot)
+{
+	FSlot& Target = Slots[Slot];
+
+	for (int32 y = 0; y < Height; ++y)
+	{
+		for (int32 x = 0; x < Width; ++x)
+		{
+			Target.Values[y * Width + x] = GetSyntheticValue(x, y, Width, Height, Target.Time);
+		}
+	}
+
+	Target.PendingPolls = ReadLatency;
+}
+
+bool FSyntheticHeightSource::IsReadComplete(int32 Slot) const
+{
+	const FSlot& Target = Slots[Slot];
+
+	if (Target.PendingPolls > 0)
+	{
+		--Target.PendingPolls;
+		return false;
+	}
+
+	return true;
+}
+
+const float* FSyntheticHeightSource::GetValues(int32 Slot, int32& OutWidth, int32& OutHeight) const
+{
+	OutWidth = Width;
+	OutHeight = Height;
+
+	return Slots[Slot].Values.GetData();
+}
+
+float FSyntheticHeightSource::GetSyntheticValue(int32 X, int32 Y, int32 Width, int32 Height, float Time)
+{
+	// Two crossing swells, stays within 0..1
+	const float U = 2.0f * PI * X / Width;
+	const float V = 2.0f * PI * Y / Height;
+
+	return 0.5f + 0.25f * FMath::Sin(2.0f * U + Time) + 0.25f * FMath::Sin(3.0f * V - 0.7f * Time);
+}
+
+FHeightReadbackRing::FHeightReadbackRing()
+	: LatencyFrames(2)
+	, LatestFrameIndex(0)
+	, LatestTimestamp(0.0f)
+	, LatestFrameNumber(0)
+	, NumSkippedCaptures(0)
+	, WorldCenter(FVector2D::ZeroVector)
+	, WorldSize(10000.0f)
+	, HeightScale(200.0f)
+	, HeightOffset(-100.0f)
+	, bBuildMips(false)
+{
+}
+
+void FHeightReadbackRing::Initialize(const FHeightReadbackSourcePtr& InSource, int32 NumSlots, int32 InLatencyFrames)
+{
+	Shutdown();
+
+	if (!InSource.IsValid() || NumSlots <= 0)
+	{
+		return;
+	}
+
+	Source = InSource;
+	Source->Initialize(NumSlots);
+
+	FSlot IdleSlot;
+	IdleSlot.State = ESlotState::Idle;
+	IdleSlot.FrameNumber = 0;
+	IdleSlot.Time = 0.0f;
+	Slots.Init(IdleSlot, NumSlots);
+
+	LatencyFrames = FMath::Max(InLatencyFrames, 0);
+}
+
+void FHeightReadbackRing::SetDecodeParams(const FVector2D& InWorldCenter, float InWorldSize, float InHeightScale, float InHeightOffset, bool bInBuildMips)
+{
+	WorldCenter = InWorldCenter;
+	WorldSize = InWorldSize;
+	HeightScale = InHeightScale;
+	HeightOffset = InHeightOffset;
+	bBuildMips = bInBuildMips;
+}
+
+void FHeightReadbackRing::Tick(uint64 FrameNumber, float Time, bool bCapture)
+{
+	if (!Source.IsValid())
+	{
+		return;
+	}
+
+	// Publish finished reads first so their slots can take this frame's capture
+	for (int32 i = 0; i < Slots.Num(); ++i)
+	{
+		if (Slots[i].State == ESlotState::Reading && Source->IsReadComplete(i))
+		{
+			Publish(i);
+			Slots[i].State = ESlotState::Idle;
+		}
+	}
+
+	for (int32 i = 0; i < Slots.Num(); ++i)
+	{
+		if (Slots[i].State == ESlotState::Copying && FrameNumber - Slots[i].FrameNumber >= (uint64)LatencyFrames)
+		{
+			Source->BeginRead(i);
+			Slots[i].State = ESlotState::Reading;
+		}
+	}
+
+	if (!bCapture)
+	{
+		return;
+	}
+
+	for (int32 i = 0; i < Slots.Num(); ++i)
+	{
+		if (Slots[i].State == ESlotState::Idle)
+		{
+			Source->BeginCopy(i, Time);
+
+			Slots[i].State = ESlotState::Copying;
+			Slots[i].FrameNumber = FrameNumber;
+			Slots[i].Time = Time;
+			return;
+		}
+	}
+
+	++NumSkippedCaptures;
+}
+
+void FHeightReadbackRing::Shutdown()
+{
+	Source.Reset();
+	Slots.Reset();
+
+	LatestFrame.Reset();
+	LatestTimestamp = 0.0f;
+	LatestFrameNumber = 0;
+	NumSkippedCaptures = 0;
+}
+
+void FHeightReadbackRing::Publish(int32 SlotIndex)
+{
+	const FSlot& Slot = Slots[SlotIndex];
+
+	// Reads finish in order, but never go back to older frame
+	if (LatestFrame.IsValid() && Slot.FrameNumber <= LatestFrameNumber)
+	{
+		return;
+	}
+
+	int32 Width = 0;
+	int32 Height = 0;
+	const float* Values = Source->GetValues(SlotIndex, Width, Height);
+
+	// Copy failed or render target format can't be decoded
+	if (Values == nullptr || Width <= 0 || Height <= 0)
+	{
+		return;
+	}
+
+	// Reuse spare frame unless some caller still holds it
+	const int32 FrameIndex = 1 - LatestFrameIndex;
+	if (!Frames[FrameIndex].IsValid() || !Frames[FrameIndex].IsUnique())
+	{
+		Frames[FrameIndex] = MakeShareable(new FHeightField());
+	}
+
+	Frames[FrameIndex]->SetWorldBounds(WorldCenter, WorldSize);
+	Frames[FrameIndex]->Build(Values, Width, Height, HeightScale, HeightOffset, bBuildMips);
+
+	LatestFrameIndex = FrameIndex;
+	LatestFrame = Frames[FrameIndex];
+	LatestTimestamp = Slot.Time;
+	LatestFrameNumber = Slot.FrameNumber;
+}
@@ -2,14 +2,115 @@
 
 #include "VolumetricBuoyancy.h"
 #include "Ocean/OceanManager.h"
+#include "Ocean/HeightMapReader.h"
+#include "Async/Async.h"
+#include "Misc/BuoyancyStats.h"
+#include "UnrealNetwork.h"
+#include "GameFramework/PlayerState.h"
 
 AOceanManager::AOceanManager(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
+	// Tick advances ocean clock and swaps in asynchronously rebuilt height field, before bodies sample waves
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	// Only clock is replicated, clients correct their own clock once per second
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	NetUpdateFrequency = 1.0f;
+
 	Center = FVector(0, 0, 0);
 	Size = 10000.0f;
+	ColorBufferWidth = 0;
+	ColorBufferHeight = 0;
+
+	WaveSource = EOceanWaveSource::Gerstner;
+	HeightMapScale = 200.0f;
+	HeightMapOffset = -100.0f;
+	bHeightMapMips = false;
+
+	WaveClusters.Add(FGerstnerWaveCluster(2500.0f, 200.0f, FVector2D(0, 1), 0.5f));
+	WaveClusters.Add(FGerstnerWaveCluster(1000.0f, 115.0f, FVector2D(0, 1), 0.5f));
+	WavesPerCluster = 8;
+
+	SurfaceHeightIterations = 1;
+
+	WaterDensity = 0.0001f;
+	WaterLinearDrag = 50000.0f;
+	WaterAngularDrag = 500.0f;
+	CurrentVelocity = FVector2D::ZeroVector;
+	FlowFieldMin = FVector2D(-10000.0f, -10000.0f);
+	FlowFieldMax = FVector2D(10000.0f, 10000.0f);
+	FlowFieldNumX = 0;
+	FlowFieldNumY = 0;
+	bWaveOrbitalVelocity = false;
+
+	ClockStepsPerSecond = 60;
+	ClockSnapSeconds = 0.5f;
+	ClockSlewSeconds = 2.0f;
+	ServerClockStep = 0;
+	ClockStep = 0;
+	ClockStepFraction = 0.0f;
+	ClockError = 0.0f;
+
+	WaveLODMinAmplitude = 0.0f;
+	WaveLODDistance = 20000.0f;
+	WaveLODBodySize = 200.0f;
+
+	UpdateTierDistance = 0.0f;
+	MaxUpdateInterval = 4;
+
+	ClippingPointsPerWaveLength = 4.0f;
+	MaxClippingPoints = 32;
+
+	bUseWaveHeightCache = false;
+	WaveCacheTileSize = 2000.0f;
+	WaveCacheTileResolution = 33;
+	WaveCacheMaxTiles = 64;
+}
+
+/* Wave length / amplitude multiplier and direction angle of every wave in a cluster */
+static const float ClusterWaveMultipliers[] = { 1.0f, 0.5f, 2.0f, 1.25f, 0.75f, 1.5f, 0.825f, 0.65f };
+static const float ClusterWaveAngles[] = { 0.0f, -0.1f, 0.1f, 0.05f, 0.075f, -0.125f, 0.063f, -0.11f };
+static const int32 ClusterNumWaves = ARRAY_COUNT(ClusterWaveMultipliers);
+
+void AOceanManager::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	UpdateWaveSpectrum();
+	UpdateWaterProperties();
+
+	if (WaveSource == EOceanWaveSource::HeightMap)
+	{
+		UpdateHeightMap();
+	}
+
+	// Captures of reader are compared with wave time, so they are stamped with it
+	if (HeightMapReader != NULL)
+	{
+		HeightMapReader->SetOceanManager(this);
+	}
 }
 
+#if WITH_EDITOR
+void AOceanManager::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	UpdateWaveSpectrum();
+	UpdateWaterProperties();
+
+	if (WaveSource == EOceanWaveSource::HeightMap)
+	{
+		// Texture might have changed
+		ColorBuffer.Reset();
+		UpdateHeightMap();
+	}
+}
+#endif
+
 void AOceanManager::Initialize()
 {
 	ColorBuffer.Reset();
@@ -38,46 +139,467 @@ FVector AOceanManager::CalculateGerstnerWaveCluser(float MedianaWaveLength, floa
 {
 	FVector Sum = FVector(0, 0, 0);
 
-	Sum += CalculateGerstnerWave(MedianaWaveLength, MedianaAmplitude, Position, MedianaDirection, 0, Steepness, Time, 0);
-	Sum += CalculateGerstnerWave(MedianaWaveLength * 0.5f, MedianaAmplitude * 0.5f, Position, MedianaDirection, -0.1f, Steepness, Time, 0);
-	Sum += CalculateGerstnerWave(MedianaWaveLength * 2.0f, MedianaAmplitude * 2.0f, Position, MedianaDirection, 0.1f, Steepness, Time, 0);
-	Sum += CalculateGerstnerWave(MedianaWaveLength * 1.25f, MedianaAmplitude * 1.25f, Position, MedianaDirection, 0.05f, Steepness, Time, 0);
-	Sum += CalculateGerstnerWave(MedianaWaveLength * 0.75f, MedianaAmplitude * 0.75f, Position, MedianaDirection, 0.075f, Steepness, Time, 0);
-	Sum += CalculateGerstnerWave(MedianaWaveLength * 1.5f, MedianaAmplitude * 1.5f, Position, MedianaDirection, -0.125f, Steepness, Time, 0);
-	Sum += CalculateGerstnerWave(MedianaWaveLength * 0.825f, MedianaAmplitude * 0.825f, Position, MedianaDirection, 0.063f, Steepness, Time, 0);
-	Sum += CalculateGerstnerWave(MedianaWaveLength * 0.65f, MedianaAmplitude * 0.65f, Position, MedianaDirection, -0.11f, Steepness, Time, 0);
+	for (int32 i = 0; i < ClusterNumWaves; ++i)
+	{
+		Sum += CalculateGerstnerWave(MedianaWaveLength * ClusterWaveMultipliers[i], MedianaAmplitude * ClusterWaveMultipliers[i], Position, MedianaDirection, ClusterWaveAngles[i], Steepness, Time, 0);
+	}
+
+	return Sum / ClusterNumWaves;
+}
+
+
+void AOceanManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	AdvanceClock(DeltaSeconds);
+
+	if (PendingHeightField.IsValid() && PendingHeightField.IsReady())
+	{
+		HeightField = PendingHeightField.Get();
+		PendingHeightField = TFuture<FHeightFieldPtr>();
+	}
+}
+
+void AOceanManager::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AOceanManager, ServerClockStep);
+}
+
+void AOceanManager::AdvanceClock(float DeltaSeconds)
+{
+	float Steps = DeltaSeconds * ClockStepsPerSecond;
+
+	if (Role < ROLE_Authority && ClockError != 0.0f)
+	{
+		if (FMath::Abs(ClockError) > ClockSnapSeconds * ClockStepsPerSecond)
+		{
+			Steps += ClockError;
+			ClockError = 0.0f;
+		}
+		else
+		{
+			// Clock may slow down to half speed, but never stops
+			const float Correction = FMath::Max(ClockError * FMath::Min(1.0f, DeltaSeconds / ClockSlewSeconds), -0.5f * Steps);
+			Steps += Correction;
+			ClockError -= Correction;
+		}
+	}
+
+	const float TotalSteps = ClockStepFraction + Steps;
+	const int32 WholeSteps = FMath::FloorToInt(TotalSteps);
 
-	return Sum / 8;
+	ClockStep += WholeSteps;
+	ClockStepFraction = TotalSteps - WholeSteps;
+
+	if (Role == ROLE_Authority)
+	{
+		ServerClockStep = ClockStep;
+	}
 }
 
+void AOceanManager::OnRep_ServerClockStep()
+{
+	// Server step is half of round trip old when it arrives
+	float Latency = 0.0f;
+
+	APlayerController* PlayerController = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+	if (PlayerController && PlayerController->PlayerState)
+	{
+		Latency = 0.0005f * PlayerController->PlayerState->ExactPing;
+	}
+
+	ClockError = (ServerClockStep - ClockStep) + Latency * ClockStepsPerSecond - ClockStepFraction;
+}
+
+float AOceanManager::GetWaveTime() const
+{
+	return (float)((ClockStep + (double)ClockStepFraction) / ClockStepsPerSecond);
+}
 
 FVector AOceanManager::GetWaveHeight(FVector Location, float Time)
+{
+	BUOYANCY_SCOPE(WaveSampling);
+	BUOYANCY_COUNT(WaveSamples, 1);
+
+	if (WaveSource == EOceanWaveSource::HeightMap)
+	{
+		return FVector(0.0f, 0.0f, GetHeightMapHeight(Location));
+	}
+
+	return WaveSpectrum.Evaluate(Location.X, Location.Y, Time);
+}
+
+float AOceanManager::GetSurfaceHeight(FVector Location, float Time)
+{
+	FWaveSampleBatch Batch;
+	Batch.Add(Location.X, Location.Y);
+
+	GetSurfaceHeightBatch(Batch, Time);
+
+	return Batch.DisplacementZ[0];
+}
+
+FVector AOceanManager::GetWaveHeightReference(FVector Location, float Time)
 {
 	FVector Sum = FVector(0, 0, 0);
-	// 50 / 20
-	// @FIXME: First 2 values for waveLength and Amplitude should be Read from Material in BP
-	Sum += CalculateGerstnerWaveCluser(2500, 200, FVector2D(Location.X, Location.Y), FVector2D(0, 1), 0.5f, Time);
-	Sum += CalculateGerstnerWaveCluser(1000, 115, FVector2D(Location.X, Location.Y), FVector2D(0, 1), 0.5f, Time);
 
-	return Sum / 2;
+	const int32 NumWaves = FMath::Clamp(WavesPerCluster, 1, ClusterNumWaves);
+
+	for (const FGerstnerWaveCluster& Cluster : WaveClusters)
+	{
+		FVector ClusterSum = FVector(0, 0, 0);
+
+		for (int32 i = 0; i < NumWaves; ++i)
+		{
+			ClusterSum += CalculateGerstnerWave(Cluster.MedianWaveLength * ClusterWaveMultipliers[i], Cluster.MedianAmplitude * ClusterWaveMultipliers[i], FVector2D(Location.X, Location.Y), Cluster.MedianDirection, ClusterWaveAngles[i], Cluster.Steepness, Time * Cluster.AngularFrequency, 0);
+		}
+
+		Sum += ClusterSum / NumWaves;
+	}
+
+	return WaveClusters.Num() > 0 ? Sum / WaveClusters.Num() : Sum;
 }
 
-FColor AOceanManager::GetTextureColorAt(int32 x, int32 y)
+void AOceanManager::UpdateWaveSpectrum()
 {
-	if (Texture == NULL)
+	WaveSpectrum.Reset();
+
+	// Cached displacements are no longer valid
+	WaveHeightCache.Configure(WaveCacheTileSize, WaveCacheTileResolution, WaveCacheMaxTiles);
+	WaveHeightCache.Reset();
+
+	if (WaveClusters.Num() == 0)
 	{
-		return FColor();
+		return;
+	}
+
+	// Averaging of waves in cluster and of all clusters is folded into weight
+	const int32 NumWaves = FMath::Clamp(WavesPerCluster, 1, ClusterNumWaves);
+	const float Weight = 1.0f / (NumWaves * WaveClusters.Num());
+
+	for (const FGerstnerWaveCluster& Cluster : WaveClusters)
+	{
+		for (int32 i = 0; i < NumWaves; ++i)
+		{
+			WaveSpectrum.AddComponent(Cluster.MedianWaveLength * ClusterWaveMultipliers[i], Cluster.MedianAmplitude * ClusterWaveMultipliers[i], Cluster.MedianDirection, ClusterWaveAngles[i], Cluster.Steepness, Cluster.AngularFrequency, 0, Weight);
+		}
+	}
+
+	WaveSpectrum.SortByAmplitude();
+
+#if !UE_BUILD_SHIPPING
+	// Make sure precomputed batched path still matches reference one
+	FWaveSampleBatch TestBatch;
+	for (int32 i = 0; i < 9; ++i)
+	{
+		TestBatch.Add(i * 7919.0f - 30000.0f, i * 3571.0f - 15000.0f);
+	}
+
+	const float TestTime = 12.345f;
+	WaveSpectrum.EvaluateBatch(TestBatch, TestTime);
+
+	for (int32 i = 0; i < TestBatch.Num(); ++i)
+	{
+		const FVector Reference = GetWaveHeightReference(FVector(TestBatch.PositionX[i], TestBatch.PositionY[i], 0.0f), TestTime);
+		const FVector Error = TestBatch.GetDisplacement(i) - Reference;
+
+		ensureMsgf(Error.GetAbsMax() <= FWaveSpectrum::BatchTolerance, TEXT("Batched wave height differs from reference by %f"), Error.GetAbsMax());
+	}
+#endif
+}
+
+void AOceanManager::UpdateWaterProperties()
+{
+	WaterParams = BuoyancyCore::FWaterParams();
+	WaterParams.Density = WaterDensity;
+	WaterParams.LinearDrag = WaterLinearDrag;
+	WaterParams.AngularDrag = WaterAngularDrag;
+
+	FlowField = BuoyancyCore::FFlowField();
+	FlowVelocityX.Reset();
+	FlowVelocityY.Reset();
+
+	if (FlowFieldNumX < 2 || FlowFieldNumY < 2)
+	{
+		return;
+	}
+
+	if (FlowFieldVelocities.Num() != FlowFieldNumX * FlowFieldNumY)
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Flow field needs FlowFieldNumX * FlowFieldNumY velocities!");
+		return;
+	}
+
+	// Components are sampled separately, so they are stored as two grids of the same layout
+	FlowVelocityX.SetNumUninitialized(FlowFieldVelocities.Num());
+	FlowVelocityY.SetNumUninitialized(FlowFieldVelocities.Num());
+
+	for (int32 i = 0; i < FlowFieldVelocities.Num(); ++i)
+	{
+		FlowVelocityX[i] = FlowFieldVelocities[i].X;
+		FlowVelocityY[i] = FlowFieldVelocities[i].Y;
+	}
+
+	FlowField.VelocityX = BuoyancyCore::FHeightGrid::FromBounds(FlowFieldMin.X, FlowFieldMin.Y, FlowFieldMax.X, FlowFieldMax.Y, FlowFieldNumX, FlowFieldNumY, FlowVelocityX.GetData());
+	FlowField.VelocityY = BuoyancyCore::FHeightGrid::FromBounds(FlowFieldMin.X, FlowFieldMin.Y, FlowFieldMax.X, FlowFieldMax.Y, FlowFieldNumX, FlowFieldNumY, FlowVelocityY.GetData());
+}
+
+FVector AOceanManager::GetCurrentVelocity(FVector Location) const
+{
+	return MakeWaterView().GetCurrentVelocity(Location);
+}
+
+FVector AOceanManager::GetWaterVelocity(const FVector& Location, float Depth, const FWaveSampleBatch* Batch, float Time, int32 NumComponents) const
+{
+	return MakeWaterView().GetWaterVelocity(Location, Depth, Batch, Time, NumComponents);
+}
+
+void AOceanManager::GetWaveHeightRange(float& OutMinZ, float& OutMaxZ) const
+{
+	MakeWaterView().GetWaveHeightRange(OutMinZ, OutMaxZ);
+}
+
+int32 AOceanManager::GetWaveLOD(const FVector& Location, float BodySize, float LODBias) const
+{
+	return GetWaterView(Location).GetWaveLOD(BodySize, LODBias);
+}
+
+int32 AOceanManager::GetUpdateInterval(const FVector& Location) const
+{
+	return GetWaterView(Location).GetUpdateInterval();
+}
+
+float AOceanManager::GetClippingPointSpacing() const
+{
+	if (WaveSource == EOceanWaveSource::HeightMap)
+	{
+		return 0.0f;
+	}
+
+	return WaveSpectrum.GetDominantWaveLength() / FMath::Max(ClippingPointsPerWaveLength, 1.0f);
+}
+
+float AOceanManager::GetDistanceToClosestView(const FVector& Location) const
+{
+	const UWorld* World = GetWorld();
+	if (!World || World->ViewLocationsRenderedLastFrame.Num() == 0)
+	{
+		return MAX_flt;
+	}
+
+	float MinDistanceSquared = MAX_flt;
+
+	for (const FVector& ViewLocation : World->ViewLocationsRenderedLastFrame)
+	{
+		MinDistanceSquared = FMath::Min(MinDistanceSquared, FVector::DistSquared(ViewLocation, Location));
+	}
+
+	return FMath::Sqrt(MinDistanceSquared);
+}
+
+void AOceanManager::GetWaveHeightBatch(FWaveSampleBatch& Batch, float Time, int32 NumComponents, bool bVelocities) const
+{
+	MakeWaterView().GetWaveHeightBatch(Batch, Time, NumComponents, bVelocities);
+}
+
+void AOceanManager::GetSurfaceHeightBatch(FWaveSampleBatch& Batch, float Time, int32 NumComponents, bool bVelocities) const
+{
+	MakeWaterView().GetSurfaceHeightBatch(Batch, Time, NumComponents, bVelocities);
+}
+
+FOceanWaterView AOceanManager::GetWaterView(const FVector& Location) const
+{
+	FOceanWaterView View = MakeWaterView();
+	View.ViewDistance = GetDistanceToClosestView(Location);
+
+	return View;
+}
+
+FOceanWaterView AOceanManager::MakeWaterView() const
+{
+	FOceanWaterView View;
+	View.WaveSpectrum = &WaveSpectrum;
+	View.WaveHeightCache = bUseWaveHeightCache ? &WaveHeightCache : nullptr;
+	View.bHeightMap = WaveSource == EOceanWaveSource::HeightMap;
+	View.SurfaceHeightIterations = SurfaceHeightIterations;
+	View.bWaveVelocities = WantsWaveVelocities();
+	View.Params = WaterParams;
+	View.CurrentVelocity = CurrentVelocity;
+	View.FlowField = FlowField;
+	View.WaveLODMinAmplitude = WaveLODMinAmplitude;
+	View.WaveLODDistance = WaveLODDistance;
+	View.WaveLODBodySize = WaveLODBodySize;
+	View.UpdateTierDistance = UpdateTierDistance;
+	View.MaxUpdateInterval = MaxUpdateInterval;
+
+	if (View.bHeightMap)
+	{
+		View.HeightField = GetActiveHeightField();
 	}
 
-	float Width = Texture->GetSurfaceWidth();
-	float Height = Texture->GetSurfaceHeight();
+	return View;
+}
+
+FOceanWaterView AOceanManager::GetDetachedWaterView(const FVector& Location, FWaveSpectrum& OutSpectrum) const
+{
+	OutSpectrum = WaveSpectrum;
+
+	FOceanWaterView View = GetWaterView(Location);
+	View.WaveSpectrum = &OutSpectrum;
 
-	uint8* MipMap = (uint8*)Texture->PlatformData->Mips[0].BulkData.Lock(LOCK_READ_ONLY);
+	// Cache is refilled on game thread, flow field arrays are rebuilt with water properties
+	View.WaveHeightCache = nullptr;
+	View.CurrentVelocity = FVector2D(GetCurrentVelocity(Location));
+	View.FlowField = BuoyancyCore::FFlowField();
 
-	FColor* data = (FColor*)&MipMap[(x + (int)Width * y) * sizeof(FColor)];
+	return View;
+}
 
-	Texture->PlatformData->Mips[0].BulkData.Unlock();
+void AOceanManager::RequestWaveCacheArea(const FBox& Bounds)
+{
+	if (bUseWaveHeightCache && WaveSource == EOceanWaveSource::Gerstner)
+	{
+		WaveHeightCache.RequestArea(FBox2D(FVector2D(Bounds.Min), FVector2D(Bounds.Max)));
+	}
+}
 
-	
-	return *data;
-}
\ No newline at end of file
+void AOceanManager::UpdateWaveCache(float Time)
+{
+	if (bUseWaveHeightCache && WaveSource == EOceanWaveSource::Gerstner)
+	{
+		WaveHeightCache.Update(WaveSpectrum, Time);
+	}
+}
+
+int32 AOceanManager::GetWaveCacheMemory() const
+{
+	return WaveHeightCache.GetAllocatedSize();
+}
+
+bool AOceanManager::ReadTextureTexels()
+{
+	if (Texture == NULL || Texture->PlatformData == NULL || Texture->PlatformData->Mips.Num() == 0)
+	{
+		return false;
+	}
+
+	if (Texture->GetPixelFormat() != PF_B8G8R8A8)
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Height map texture must be B8G8R8A8!");
+
+		return false;
+	}
+
+	FTexture2DMipMap& Mip = Texture->PlatformData->Mips[0];
+	const int32 NumTexels = Mip.SizeX * Mip.SizeY;
+
+	if (Mip.BulkData.GetBulkDataSize() < NumTexels * (int32)sizeof(FColor))
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 15.0f, FColor::Red, "Height map texture has no CPU data!");
+
+		return false;
+	}
+
+	// Lock once for whole texture instead of once per texel
+	const FColor* Texels = (const FColor*)Mip.BulkData.Lock(LOCK_READ_ONLY);
+
+	ColorBuffer.SetNumUninitialized(NumTexels);
+	FMemory::Memcpy(ColorBuffer.GetData(), Texels, NumTexels * sizeof(FColor));
+
+	Mip.BulkData.Unlock();
+
+	ColorBufferWidth = Mip.SizeX;
+	ColorBufferHeight = Mip.SizeY;
+
+	return true;
+}
+
+void AOceanManager::UpdateHeightMap()
+{
+	if (ColorBuffer.Num() == 0 && !ReadTextureTexels())
+	{
+		return;
+	}
+
+	TSharedPtr<FHeightField, ESPMode::ThreadSafe> NewHeightField = MakeShareable(new FHeightField());
+	NewHeightField->SetWorldBounds(FVector2D(Center), Size);
+	NewHeightField->Build(ColorBuffer.GetData(), ColorBufferWidth, ColorBufferHeight, HeightMapScale, HeightMapOffset, bHeightMapMips);
+
+	HeightField = NewHeightField;
+}
+
+void AOceanManager::RefreshHeightMap()
+{
+	// Previous rebuild is still running
+	if (PendingHeightField.IsValid())
+	{
+		return;
+	}
+
+	if (!ReadTextureTexels())
+	{
+		return;
+	}
+
+	// Worker gets its own copy of everything it needs
+	const TArray<FColor> Texels = ColorBuffer;
+	const int32 Width = ColorBufferWidth;
+	const int32 Height = ColorBufferHeight;
+	const float Scale = HeightMapScale;
+	const float Offset = HeightMapOffset;
+	const bool bMips = bHeightMapMips;
+	const FVector2D WorldCenter = FVector2D(Center);
+	const float WorldSize = Size;
+
+	PendingHeightField = Async<FHeightFieldPtr>(EAsyncExecution::ThreadPool, [Texels, Width, Height, Scale, Offset, bMips, WorldCenter, WorldSize]()
+	{
+		TSharedPtr<FHeightField, ESPMode::ThreadSafe> NewHeightField = MakeShareable(new FHeightField());
+		NewHeightField->SetWorldBounds(WorldCenter, WorldSize);
+		NewHeightField->Build(Texels.GetData(), Width, Height, Scale, Offset, bMips);
+
+		return FHeightFieldPtr(NewHeightField);
+	});
+}
+
+float AOceanManager::GetHeightMapHeight(const FVector& Location, int32 Mip) const
+{
+	const FHeightFieldPtr ActiveHeightField = GetActiveHeightField();
+	return ActiveHeightField.IsValid() ? ActiveHeightField->Sample(Location.X, Location.Y, Mip) : 0.0f;
+}
+
+float AOceanManager::GetHeightMapTimestamp() const
+{
+	// Texture is static, its heights are always current
+	if (HeightMapReader != NULL)
+	{
+		return HeightMapReader->GetHeightTimestamp();
+	}
+
+	return GetWaveTime();
+}
+
+FHeightFieldPtr AOceanManager::GetActiveHeightField() const
+{
+	if (HeightMapReader != NULL)
+	{
+		return HeightMapReader->GetHeightField();
+	}
+
+	return HeightField;
+}
+
+FColor AOceanManager::GetTextureColorAt(int32 x, int32 y)
+{
+	if (ColorBuffer.Num() == 0 && !ReadTextureTexels())
+	{
+		return FColor();
+	}
+
+	x = FMath::Clamp(x, 0, ColorBufferWidth - 1);
+	y = FMath::Clamp(y, 0, ColorBufferHeight - 1);
+
+	return ColorBuffer[x + ColorBufferWidth * y];
+}
@@ -0,0 +1,233 @@
+// Implementation created by David 'vebski' Niemiec
+
+#include "VolumetricBuoyancy.h"
+#include "Misc/BuoyancyStats.h"
+#include "Ocean/OceanWater.h"
+
+FOceanWaterView::FOceanWaterView()
+	: WaveSpectrum(nullptr)
+	, WaveHeightCache(nullptr)
+	, bHeightMap(false)
+	, SurfaceHeightIterations(0)
+	, bWaveVelocities(false)
+	, CurrentVelocity(FVector2D::ZeroVector)
+	, WaveLODMinAmplitude(0.0f)
+	, WaveLODDistance(0.0f)
+	, WaveLODBodySize(0.0f)
+	, UpdateTierDistance(0.0f)
+	, MaxUpdateInterval(1)
+	, ViewDistance(MAX_flt)
+{
+}
+
+void FOceanWaterView::GetWaveHeightBatch(FWaveSampleBatch& Batch, float Time, int32 NumComponents, bool bVelocities) const
+{
+	BUOYANCY_SCOPE(WaveSampling);
+	BUOYANCY_COUNT(WaveSamples, Batch.Num());
+
+	if (bHeightMap)
+	{
+		const int32 NumSamples = Batch.Num();
+
+		// Height map has neither horizontal displacement nor velocities
+		Batch.SetNumOutputs(false);
+
+		FMemory::Memzero(Batch.DisplacementX.GetData(), NumSamples * sizeof(float));
+		FMemory::Memzero(Batch.DisplacementY.GetData(), NumSamples * sizeof(float));
+
+		if (HeightField.IsValid())
+		{
+			HeightField->SampleBatch(Batch.PositionX.GetData(), Batch.PositionY.GetData(), NumSamples, Batch.DisplacementZ.GetData());
+		}
+		else
+		{
+			FMemory::Memzero(Batch.DisplacementZ.GetData(), NumSamples * sizeof(float));
+		}
+
+		return;
+	}
+
+	if (!CanSampleWaveCache(Batch, Time, NumComponents, bVelocities, 0.0f))
+	{
+		WaveSpectrum->EvaluateBatch(Batch, Time, NumComponents, bVelocities);
+		return;
+	}
+
+	Batch.SetNumOutputs(false);
+
+	const int32 NumSamples = Batch.Num();
+
+	for (int32 i = 0; i < NumSamples; ++i)
+	{
+		FVector Displacement;
+		verify(WaveHeightCache->GetDisplacement(Batch.PositionX[i], Batch.PositionY[i], Time, Displacement));
+
+		Batch.DisplacementX[i] = Displacement.X;
+		Batch.DisplacementY[i] = Displacement.Y;
+		Batch.DisplacementZ[i] = Displacement.Z;
+	}
+}
+
+void FOceanWaterView::GetSurfaceHeightBatch(FWaveSampleBatch& Batch, float Time, int32 NumComponents, bool bVelocities) const
+{
+	// Height map stores heights, there is nothing to invert
+	if (bHeightMap || SurfaceHeightIterations <= 0)
+	{
+		GetWaveHeightBatch(Batch, Time, NumComponents, bVelocities);
+		return;
+	}
+
+	BUOYANCY_SCOPE(WaveSampling);
+	BUOYANCY_COUNT(WaveSamples, Batch.Num() * SurfaceHeightIterations);
+
+	// Undisplaced points above samples are never further than MaxHorizontalDisplacement from them
+	if (!CanSampleWaveCache(Batch, Time, NumComponents, bVelocities, WaveSpectrum->MaxHorizontalDisplacement))
+	{
+		WaveSpectrum->EvaluateSurfaceHeightBatch(Batch, Time, SurfaceHeightIterations, NumComponents, bVelocities);
+		return;
+	}
+
+	const int32 NumSamples = Batch.Num();
+
+	Batch.SurfaceX.SetNumUninitialized(NumSamples, false);
+	Batch.SurfaceY.SetNumUninitialized(NumSamples, false);
+
+	const BuoyancyCore::FWaveSampleBuffers Samples = Batch.SetNumOutputs(true);
+
+	auto Evaluate = [this, Time](const float* X, const float* Y, int32 Num, const BuoyancyCore::FWaveSampleBuffers& Out)
+	{
+		for (int32 i = 0; i < Num; ++i)
+		{
+			FVector Displacement, SlopeX, SlopeY;
+
+			// Newton step of folding surface may overshoot padding of area, query is of full spectrum like the cache
+			if (!WaveHeightCache->GetDisplacement(X[i], Y[i], Time, Displacement, SlopeX, SlopeY))
+			{
+				Displacement = WaveSpectrum->Evaluate(X[i], Y[i], Time, MAX_int32, SlopeX, SlopeY);
+			}
+
+			Out.DisplacementX[i] = Displacement.X;
+			Out.DisplacementY[i] = Displacement.Y;
+			Out.DisplacementZ[i] = Displacement.Z;
+
+			// Interpolated slopes are not exactly symmetric
+			Out.SlopeXX[i] = SlopeX.X;
+			Out.SlopeXY[i] = 0.5f * (SlopeX.Y + SlopeY.X);
+			Out.SlopeYY[i] = SlopeY.Y;
+			Out.SlopeZX[i] = SlopeX.Z;
+			Out.SlopeZY[i] = SlopeY.Z;
+		}
+	};
+
+	BuoyancyCore::SampleSurfaceHeights(Evaluate, Batch.PositionX.GetData(), Batch.PositionY.GetData(), NumSamples, SurfaceHeightIterations,
+		Batch.SurfaceX.GetData(), Batch.SurfaceY.GetData(), Samples, Batch.DisplacementZ.GetData());
+}
+
+bool FOceanWaterView::CanSampleWaveCache(const FWaveSampleBatch& Batch, float Time, int32 NumComponents, bool bVelocities, float Padding) const
+{
+	// Cache holds displacements of full spectrum only
+	if (!WaveHeightCache || WaveHeightCache->GetNumTiles() == 0 || bVelocities || NumComponents < WaveSpectrum->Num() || Batch.Num() == 0)
+	{
+		return false;
+	}
+
+	const int32 NumSamples = Batch.Num();
+
+	FBox2D Area(FVector2D(Batch.PositionX[0], Batch.PositionY[0]), FVector2D(Batch.PositionX[0], Batch.PositionY[0]));
+
+	for (int32 i = 1; i < NumSamples; ++i)
+	{
+		Area.Min.X = FMath::Min(Area.Min.X, Batch.PositionX[i]);
+		Area.Min.Y = FMath::Min(Area.Min.Y, Batch.PositionY[i]);
+		Area.Max.X = FMath::Max(Area.Max.X, Batch.PositionX[i]);
+		Area.Max.Y = FMath::Max(Area.Max.Y, Batch.PositionY[i]);
+	}
+
+	return WaveHeightCache->IsAreaCached(Area.ExpandBy(Padding), Time);
+}
+
+void FOceanWaterView::GetWaveHeightRange(float& OutMinZ, float& OutMaxZ) const
+{
+	if (bHeightMap)
+	{
+		// Missing height map reads as flat water at 0
+		OutMinZ = HeightField.IsValid() ? HeightField->GetMinHeight() : 0.0f;
+		OutMaxZ = HeightField.IsValid() ? HeightField->GetMaxHeight() : 0.0f;
+		return;
+	}
+
+	// Cached and LOD heights are sums of fewer components or blends of full ones, so they stay inside too
+	OutMinZ = -WaveSpectrum->MaxVerticalDisplacement;
+	OutMaxZ = WaveSpectrum->MaxVerticalDisplacement;
+}
+
+FVector FOceanWaterView::GetCurrentVelocity(const FVector& Location) const
+{
+	const BuoyancyCore::FVec3 Flow = FlowField.Sample(Location.X, Location.Y);
+
+	return FVector(CurrentVelocity.X + Flow.X, CurrentVelocity.Y + Flow.Y, 0.0f);
+}
+
+FVector FOceanWaterView::GetWaterVelocity(const FVector& Location, float Depth, const FWaveSampleBatch* Batch, float Time, int32 NumComponents) const
+{
+	FVector Velocity = GetCurrentVelocity(Location);
+
+	if (!bWaveVelocities || WaveSpectrum->Num() == 0)
+	{
+		return Velocity;
+	}
+
+	FVector OrbitalVelocity = FVector::ZeroVector;
+
+	if (Batch && Batch->HasVelocities())
+	{
+		// Samples cover body, their mean is the flow body sits in
+		for (int32 i = 0; i < Batch->Num(); ++i)
+		{
+			OrbitalVelocity += FVector(Batch->VelocityX[i], Batch->VelocityY[i], Batch->VelocityZ[i]);
+		}
+		OrbitalVelocity /= Batch->Num();
+	}
+	else
+	{
+		OrbitalVelocity = WaveSpectrum->EvaluateVelocity(Location.X, Location.Y, Time, NumComponents);
+	}
+
+	// Orbits of deep water waves shrink with depth, longest wave reaches deepest
+	return Velocity + OrbitalVelocity * FMath::Exp(-WaveSpectrum->MinWaveNumber * FMath::Max(Depth, 0.0f));
+}
+
+int32 FOceanWaterView::GetWaveLOD(float BodySize, float LODBias) const
+{
+	if (WaveLODMinAmplitude <= 0.0f || LODBias <= 0.0f)
+	{
+		return WaveSpectrum->Num();
+	}
+
+	float MinAmplitude = WaveLODMinAmplitude * LODBias;
+
+	// Small bodies get coarser waves
+	if (BodySize > 0.0f && BodySize < WaveLODBodySize)
+	{
+		MinAmplitude *= WaveLODBodySize / BodySize;
+	}
+
+	// Bodies far from every view get coarser waves
+	if (WaveLODDistance > 0.0f && ViewDistance < MAX_flt)
+	{
+		MinAmplitude *= FMath::Max(1.0f, ViewDistance / WaveLODDistance);
+	}
+
+	return WaveSpectrum->GetNumComponentsAbove(MinAmplitude);
+}
+
+int32 FOceanWaterView::GetUpdateInterval() const
+{
+	// No views on servers, keep full rate there
+	if (UpdateTierDistance <= 0.0f || ViewDistance == MAX_flt)
+	{
+		return 1;
+	}
+
+	return FMath::Clamp(1 + FMath::FloorToInt(ViewDistance / UpdateTierDistance), 1, MaxUpdateInterval);
+}
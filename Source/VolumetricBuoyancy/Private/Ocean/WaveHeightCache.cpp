@@ -0,0 +1,315 @@
+// Implementation created by David 'vebski' Niemiec
+
+#include "VolumetricBuoyancy.h"
+#include "ParallelFor.h"
+#include "Misc/BuoyancyStats.h"
+#include "Ocean/WaveHeightCache.h"
+
+DECLARE_MEMORY_STAT(TEXT("Wave Cache Memory"), STAT_WaveCacheMemory, STATGROUP_Buoyancy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Wave Cache Tiles"), STAT_WaveCacheTiles, STATGROUP_Buoyancy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Wave Cache Tiles Filled"), STAT_WaveCacheTilesFilled, STATGROUP_Buoyancy);
+
+FWaveHeightCache::FWaveHeightCache()
+	: TileSize(2000.0f)
+	, TileResolution(33)
+	, MaxTiles(64)
+	, CurrentFrame(1)
+{
+}
+
+void FWaveHeightCache::Configure(float InTileSize, int32 InTileResolution, int32 InMaxTiles)
+{
+	InTileSize = FMath::Max(InTileSize, 1.0f);
+	InTileResolution = FMath::Clamp(InTileResolution, 2, MaxTileResolution);
+	InMaxTiles = FMath::Max(InMaxTiles, 1);
+
+	if (InTileSize != TileSize || InTileResolution != TileResolution || InMaxTiles != MaxTiles)
+	{
+		TileSize = InTileSize;
+		TileResolution = InTileResolution;
+		MaxTiles = InMaxTiles;
+
+		Reset();
+	}
+}
+
+void FWaveHeightCache::Reset()
+{
+	Tiles.Empty();
+	TileMap.Empty();
+	Displacements.Empty();
+	PendingTiles.Empty();
+
+	SET_MEMORY_STAT(STAT_WaveCacheMemory, GetAllocatedSize());
+	SET_DWORD_STAT(STAT_WaveCacheTiles, 0);
+}
+
+void FWaveHeightCache::RequestArea(const FBox2D& Area)
+{
+	check(IsInGameThread());
+
+	const int32 MinX = FMath::FloorToInt(Area.Min.X / TileSize);
+	const int32 MinY = FMath::FloorToInt(Area.Min.Y / TileSize);
+	const int32 MaxX = FMath::FloorToInt(Area.Max.X / TileSize);
+	const int32 MaxY = FMath::FloorToInt(Area.Max.Y / TileSize);
+
+	for (int32 y = MinY; y <= MaxY; ++y)
+	{
+		for (int32 x = MinX; x <= MaxX; ++x)
+		{
+			const int32 TileIndex = FindOrAddTile(FIntPoint(x, y));
+
+			if (TileIndex != INDEX_NONE)
+			{
+				Tiles[TileIndex].RequestFrame = CurrentFrame;
+			}
+		}
+	}
+}
+
+int32 FWaveHeightCache::FindOrAddTile(const FIntPoint& Coord)
+{
+	if (const int32* ExistingIndex = TileMap.Find(Coord))
+	{
+		return *ExistingIndex;
+	}
+
+	int32 TileIndex = INDEX_NONE;
+
+	if (Tiles.Num() < MaxTiles)
+	{
+		TileIndex = Tiles.AddDefaulted();
+		Displacements.AddUninitialized(3 * TileResolution * TileResolution);
+
+		SET_MEMORY_STAT(STAT_WaveCacheMemory, GetAllocatedSize());
+		SET_DWORD_STAT(STAT_WaveCacheTiles, Tiles.Num());
+	}
+	else
+	{
+		// Reuse least recently requested tile, tiles needed in this frame are never evicted
+		uint32 OldestFrame = CurrentFrame;
+
+		for (int32 i = 0; i < Tiles.Num(); ++i)
+		{
+			if (Tiles[i].RequestFrame < OldestFrame)
+			{
+				OldestFrame = Tiles[i].RequestFrame;
+				TileIndex = i;
+			}
+		}
+
+		if (TileIndex == INDEX_NONE)
+		{
+			return INDEX_NONE;
+		}
+
+		TileMap.Remove(Tiles[TileIndex].Coord);
+	}
+
+	FWaveHeightTile& Tile = Tiles[TileIndex];
+	Tile.Coord = Coord;
+	Tile.bFilled = false;
+
+	TileMap.Add(Coord, TileIndex);
+
+	return TileIndex;
+}
+
+void FWaveHeightCache::Update(const FWaveSpectrum& Spectrum, float Time)
+{
+	check(IsInGameThread());
+
+	PendingTiles.Reset();
+
+	for (int32 i = 0; i < Tiles.Num(); ++i)
+	{
+		const FWaveHeightTile& Tile = Tiles[i];
+
+		if (Tile.RequestFrame == CurrentFrame && (!Tile.bFilled || Tile.Time != Time))
+		{
+			PendingTiles.Add(i);
+		}
+	}
+
+	// Tiles write to separate parts of Displacements, which isn't resized until next request
+	ParallelFor(PendingTiles.Num(), [&](int32 PendingIndex)
+	{
+		FillTile(PendingTiles[PendingIndex], Spectrum, Time);
+	});
+
+	INC_DWORD_STAT_BY(STAT_WaveCacheTilesFilled, PendingTiles.Num());
+
+	++CurrentFrame;
+}
+
+void FWaveHeightCache::FillTile(int32 TileIndex, const FWaveSpectrum& Spectrum, float Time)
+{
+	FWaveHeightTile& Tile = Tiles[TileIndex];
+
+	const int32 NumSamples = TileResolution * TileResolution;
+	const float CellSize = TileSize / (TileResolution - 1);
+	const float OriginX = Tile.Coord.X * TileSize;
+	const float OriginY = Tile.Coord.Y * TileSize;
+
+	float* PlaneX = Displacements.GetData() + TileIndex * 3 * NumSamples;
+	float* PlaneY = PlaneX + NumSamples;
+	float* PlaneZ = PlaneY + NumSamples;
+
+	float RowX[MaxTileResolution];
+	float RowY[MaxTileResolution];
+
+	for (int32 x = 0; x < TileResolution; ++x)
+	{
+		RowX[x] = OriginX + x * CellSize;
+	}
+
+	// Whole row goes through batched evaluation at once
+	for (int32 y = 0; y < TileResolution; ++y)
+	{
+		const float SampleY = OriginY + y * CellSize;
+
+		for (int32 x = 0; x < TileResolution; ++x)
+		{
+			RowY[x] = SampleY;
+		}
+
+		const int32 RowOffset = y * TileResolution;
+		Spectrum.EvaluateBatch(RowX, RowY, TileResolution, Time, PlaneX + RowOffset, PlaneY + RowOffset, PlaneZ + RowOffset);
+	}
+
+	Tile.Time = Time;
+	Tile.bFilled = true;
+}
+
+bool FWaveHeightCache::IsAreaCached(const FBox2D& Area, float Time) const
+{
+	const int32 MinX = FMath::FloorToInt(Area.Min.X / TileSize);
+	const int32 MinY = FMath::FloorToInt(Area.Min.Y / TileSize);
+	const int32 MaxX = FMath::FloorToInt(Area.Max.X / TileSize);
+	const int32 MaxY = FMath::FloorToInt(Area.Max.Y / TileSize);
+
+	// Cache never holds more tiles than this, larger areas can't be covered
+	if ((int64)(MaxX - MinX + 1) * (MaxY - MinY + 1) > Tiles.Num())
+	{
+		return false;
+	}
+
+	for (int32 y = MinY; y <= MaxY; ++y)
+	{
+		for (int32 x = MinX; x <= MaxX; ++x)
+		{
+			const int32* TileIndex = TileMap.Find(FIntPoint(x, y));
+
+			if (TileIndex == nullptr || !Tiles[*TileIndex].bFilled || Tiles[*TileIndex].Time != Time)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool FWaveHeightCache::FindCell(float X, float Y, float Time, const float*& OutPlane, float& OutFracX, float& OutFracY) const
+{
+	const float TileX = X / TileSize;
+	const float TileY = Y / TileSize;
+	const FIntPoint Coord(FMath::FloorToInt(TileX), FMath::FloorToInt(TileY));
+
+	const int32* TileIndex = TileMap.Find(Coord);
+
+	if (TileIndex == nullptr)
+	{
+		return false;
+	}
+
+	const FWaveHeightTile& Tile = Tiles[*TileIndex];
+
+	if (!Tile.bFilled || Tile.Time != Time)
+	{
+		return false;
+	}
+
+	// Location inside tile in cells
+	const float U = FMath::Clamp((TileX - Coord.X) * (TileResolution - 1), 0.0f, TileResolution - 1.0f);
+	const float V = FMath::Clamp((TileY - Coord.Y) * (TileResolution - 1), 0.0f, TileResolution - 1.0f);
+
+	const int32 CellX = FMath::Min(FMath::FloorToInt(U), TileResolution - 2);
+	const int32 CellY = FMath::Min(FMath::FloorToInt(V), TileResolution - 2);
+
+	OutFracX = U - CellX;
+	OutFracY = V - CellY;
+
+	const int32 NumSamples = TileResolution * TileResolution;
+	OutPlane = Displacements.GetData() + *TileIndex * 3 * NumSamples + CellY * TileResolution + CellX;
+
+	return true;
+}
+
+bool FWaveHeightCache::GetDisplacement(float X, float Y, float Time, FVector& OutDisplacement) const
+{
+	const float* Plane;
+	float FracX, FracY;
+
+	if (!FindCell(X, Y, Time, Plane, FracX, FracY))
+	{
+		return false;
+	}
+
+	const int32 NumSamples = TileResolution * TileResolution;
+
+	float Result[3];
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const float* Row0 = Plane + Axis * NumSamples;
+		const float* Row1 = Row0 + TileResolution;
+
+		const float H0 = FMath::Lerp(Row0[0], Row0[1], FracX);
+		const float H1 = FMath::Lerp(Row1[0], Row1[1], FracX);
+
+		Result[Axis] = FMath::Lerp(H0, H1, FracY);
+	}
+
+	OutDisplacement = FVector(Result[0], Result[1], Result[2]);
+
+	return true;
+}
+
+bool FWaveHeightCache::GetDisplacement(float X, float Y, float Time, FVector& OutDisplacement, FVector& OutSlopeX, FVector& OutSlopeY) const
+{
+	const float* Plane;
+	float FracX, FracY;
+
+	if (!FindCell(X, Y, Time, Plane, FracX, FracY))
+	{
+		return false;
+	}
+
+	const int32 NumSamples = TileResolution * TileResolution;
+	const float InvCellSize = (TileResolution - 1) / TileSize;
+
+	float Result[3], SlopeX[3], SlopeY[3];
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const float* Row0 = Plane + Axis * NumSamples;
+		const float* Row1 = Row0 + TileResolution;
+
+		const float H0 = FMath::Lerp(Row0[0], Row0[1], FracX);
+		const float H1 = FMath::Lerp(Row1[0], Row1[1], FracX);
+
+		Result[Axis] = FMath::Lerp(H0, H1, FracY);
+		SlopeX[Axis] = FMath::Lerp(Row0[1] - Row0[0], Row1[1] - Row1[0], FracY) * InvCellSize;
+		SlopeY[Axis] = (H1 - H0) * InvCellSize;
+	}
+
+	OutDisplacement = FVector(Result[0], Result[1], Result[2]);
+	OutSlopeX = FVector(SlopeX[0], SlopeX[1], SlopeX[2]);
+	OutSlopeY = FVector(SlopeY[0], SlopeY[1], SlopeY[2]);
+
+	return true;
+}
+
+uint32 FWaveHeightCache::GetAllocatedSize() const
+{
+	return Tiles.GetAllocatedSize() + TileMap.GetAllocatedSize() + Displacements.GetAllocatedSize() + PendingTiles.GetAllocatedSize();
+}
@@ -0,0 +1,495 @@
+// Implementation created by David 'vebski' Niemiec
+
+#include "VolumetricBuoyancy.h"
+#include "Ocean/WaveSpectrum.h"
+
+const float FWaveSpectrum::BatchTolerance = 0.1f;
+
+/* Vector version of FMath::SinCos, same range reduction and minimax polynomials so SIMD and scalar paths agree */
+static FORCEINLINE void WaveVectorSinCos(const VectorRegister& Angle, VectorRegister& OutSin, VectorRegister& OutCos)
+{
+	const VectorRegister Pi = VectorSetFloat1(PI);
+	const VectorRegister HalfPi = VectorSetFloat1(HALF_PI);
+
+	// There is no vector round, adding and subtracting 1.5 * 2^23 rounds to nearest integer
+	const VectorRegister RoundMagic = VectorSetFloat1(12582912.0f);
+
+	// Map Angle to [-PI, PI]
+	VectorRegister Quotient = VectorMultiply(Angle, VectorSetFloat1(0.5f * INV_PI));
+	Quotient = VectorSubtract(VectorAdd(Quotient, RoundMagic), RoundMagic);
+	VectorRegister Y = VectorSubtract(Angle, VectorMultiply(Quotient, VectorSetFloat1(2.0f * PI)));
+
+	// Map Y to [-PI/2, PI/2] with Sin(Y) = Sin(PI - Y), Cos changes sign
+	const VectorRegister AboveHalfPi = VectorCompareGT(Y, HalfPi);
+	const VectorRegister BelowHalfPi = VectorCompareGT(VectorNegate(HalfPi), Y);
+	Y = VectorSelect(AboveHalfPi, VectorSubtract(Pi, Y), Y);
+	Y = VectorSelect(BelowHalfPi, VectorSubtract(VectorNegate(Pi), Y), Y);
+	const VectorRegister Sign = VectorSelect(VectorBitwiseOr(AboveHalfPi, BelowHalfPi), VectorSetFloat1(-1.0f), VectorOne());
+
+	const VectorRegister Y2 = VectorMultiply(Y, Y);
+
+	// 11-degree minimax approximation
+	VectorRegister Sin = VectorMultiplyAdd(VectorSetFloat1(-2.3889859e-08f), Y2, VectorSetFloat1(2.7525562e-06f));
+	Sin = VectorMultiplyAdd(Sin, Y2, VectorSetFloat1(-0.00019840874f));
+	Sin = VectorMultiplyAdd(Sin, Y2, VectorSetFloat1(0.0083333310f));
+	Sin = VectorMultiplyAdd(Sin, Y2, VectorSetFloat1(-0.16666667f));
+	Sin = VectorMultiplyAdd(Sin, Y2, VectorOne());
+	OutSin = VectorMultiply(Sin, Y);
+
+	// 10-degree minimax approximation
+	VectorRegister Cos = VectorMultiplyAdd(VectorSetFloat1(-2.6051615e-07f), Y2, VectorSetFloat1(2.4760495e-05f));
+	Cos = VectorMultiplyAdd(Cos, Y2, VectorSetFloat1(-0.0013888378f));
+	Cos = VectorMultiplyAdd(Cos, Y2, VectorSetFloat1(0.041666638f));
+	Cos = VectorMultiplyAdd(Cos, Y2, VectorSetFloat1(-0.5f));
+	Cos = VectorMultiplyAdd(Cos, Y2, VectorOne());
+	OutCos = VectorMultiply(Cos, Sign);
+}
+
+void FWaveSampleBatch::Reset()
+{
+	PositionX.Reset();
+	PositionY.Reset();
+	DisplacementX.Reset();
+	DisplacementY.Reset();
+	DisplacementZ.Reset();
+	SurfaceX.Reset();
+	SurfaceY.Reset();
+	SlopeXX.Reset();
+	SlopeXY.Reset();
+	SlopeYY.Reset();
+	SlopeZX.Reset();
+	SlopeZY.Reset();
+	VelocityX.Reset();
+	VelocityY.Reset();
+	VelocityZ.Reset();
+}
+
+void FWaveSampleBatch::SetNum(int32 NumSamples)
+{
+	PositionX.SetNumUninitialized(NumSamples, false);
+	PositionY.SetNumUninitialized(NumSamples, false);
+}
+
+int32 FWaveSampleBatch::Add(float X, float Y)
+{
+	PositionY.Add(Y);
+	return PositionX.Add(X);
+}
+
+BuoyancyCore::FWaveSampleBuffers FWaveSampleBatch::SetNumOutputs(bool bSlopes, bool bVelocities)
+{
+	const int32 NumSamples = Num();
+
+	DisplacementX.SetNumUninitialized(NumSamples, false);
+	DisplacementY.SetNumUninitialized(NumSamples, false);
+	DisplacementZ.SetNumUninitialized(NumSamples, false);
+
+	BuoyancyCore::FWaveSampleBuffers Buffers;
+	Buffers.DisplacementX = DisplacementX.GetData();
+	Buffers.DisplacementY = DisplacementY.GetData();
+	Buffers.DisplacementZ = DisplacementZ.GetData();
+
+	if (bSlopes)
+	{
+		SlopeXX.SetNumUninitialized(NumSamples, false);
+		SlopeXY.SetNumUninitialized(NumSamples, false);
+		SlopeYY.SetNumUninitialized(NumSamples, false);
+		SlopeZX.SetNumUninitialized(NumSamples, false);
+		SlopeZY.SetNumUninitialized(NumSamples, false);
+
+		Buffers.SlopeXX = SlopeXX.GetData();
+		Buffers.SlopeXY = SlopeXY.GetData();
+		Buffers.SlopeYY = SlopeYY.GetData();
+		Buffers.SlopeZX = SlopeZX.GetData();
+		Buffers.SlopeZY = SlopeZY.GetData();
+	}
+
+	const int32 NumVelocities = bVelocities ? NumSamples : 0;
+	VelocityX.SetNumUninitialized(NumVelocities, false);
+	VelocityY.SetNumUninitialized(NumVelocities, false);
+	VelocityZ.SetNumUninitialized(NumVelocities, false);
+
+	if (bVelocities)
+	{
+		Buffers.VelocityX = VelocityX.GetData();
+		Buffers.VelocityY = VelocityY.GetData();
+		Buffers.VelocityZ = VelocityZ.GetData();
+	}
+
+	return Buffers;
+}
+
+void FWaveSpectrum::Reset()
+{
+	DirectionX.Reset();
+	DirectionY.Reset();
+	WaveNumber.Reset();
+	AngularFrequency.Reset();
+	Amplitude.Reset();
+	Steepness.Reset();
+	Phase.Reset();
+	WaveVectorX.Reset();
+	WaveVectorY.Reset();
+	DisplacementScaleX.Reset();
+	DisplacementScaleY.Reset();
+	MaxVerticalDisplacement = 0.0f;
+	MaxHorizontalDisplacement = 0.0f;
+	MinWaveNumber = 0.0f;
+}
+
+void FWaveSpectrum::AddComponent(float WaveLength, float ComponentAmplitude, FVector2D Direction, float Angle, float ComponentSteepness, float ComponentFrequency, float ComponentPhase, float Weight)
+{
+	const float Lambda = (2 * PI) / WaveLength;
+
+	// Same rotation as AOceanManager::CalculateGerstnerWave, but done once instead of per sample
+	FVector Dir = FVector(Direction.X, Direction.Y, 0.0f);
+	Dir = Dir.RotateAngleAxis(Angle * 360, FVector(0, 0, 1));
+
+	const float WeightedAmplitude = ComponentAmplitude * Weight;
+	const float QA = ComponentSteepness * WeightedAmplitude;
+
+	MinWaveNumber = WaveNumber.Num() == 0 ? Lambda : FMath::Min(MinWaveNumber, Lambda);
+
+	DirectionX.Add(Dir.X);
+	DirectionY.Add(Dir.Y);
+	WaveNumber.Add(Lambda);
+	AngularFrequency.Add(ComponentFrequency);
+	Amplitude.Add(WeightedAmplitude);
+	MaxVerticalDisplacement += FMath::Abs(WeightedAmplitude);
+	MaxHorizontalDisplacement += FMath::Abs(QA);
+	Steepness.Add(ComponentSteepness);
+	Phase.Add(ComponentPhase);
+
+	WaveVectorX.Add(Lambda * Dir.X);
+	WaveVectorY.Add(Lambda * Dir.Y);
+	DisplacementScaleX.Add(QA * Dir.X);
+	DisplacementScaleY.Add(QA * Dir.Y);
+}
+
+/* Reorder Array so that Array[i] = OldArray[Order[i]] */
+static void PermuteComponents(TArray<float>& Array, const TArray<int32>& Order)
+{
+	const TArray<float> OldArray = Array;
+
+	for (int32 i = 0; i < Order.Num(); ++i)
+	{
+		Array[i] = OldArray[Order[i]];
+	}
+}
+
+void FWaveSpectrum::SortByAmplitude()
+{
+	TArray<int32> Order;
+	Order.SetNumUninitialized(Num());
+
+	for (int32 i = 0; i < Order.Num(); ++i)
+	{
+		Order[i] = i;
+	}
+
+	// Stable so components with equal amplitude keep their order and results stay deterministic
+	const TArray<float>& Amplitudes = Amplitude;
+	Order.StableSort([&Amplitudes](int32 A, int32 B) { return FMath::Abs(Amplitudes[A]) > FMath::Abs(Amplitudes[B]); });
+
+	PermuteComponents(DirectionX, Order);
+	PermuteComponents(DirectionY, Order);
+	PermuteComponents(WaveNumber, Order);
+	PermuteComponents(AngularFrequency, Order);
+	PermuteComponents(Amplitude, Order);
+	PermuteComponents(Steepness, Order);
+	PermuteComponents(Phase, Order);
+	PermuteComponents(WaveVectorX, Order);
+	PermuteComponents(WaveVectorY, Order);
+	PermuteComponents(DisplacementScaleX, Order);
+	PermuteComponents(DisplacementScaleY, Order);
+}
+
+int32 FWaveSpectrum::GetNumComponentsAbove(float MinAmplitude) const
+{
+	int32 NumComponents = FMath::Min(1, Num());
+
+	while (NumComponents < Num() && FMath::Abs(Amplitude[NumComponents]) >= MinAmplitude)
+	{
+		++NumComponents;
+	}
+
+	return NumComponents;
+}
+
+float FWaveSpectrum::GetDominantWaveLength() const
+{
+	return Num() > 0 ? (2 * PI) / WaveNumber[0] : 0.0f;
+}
+
+BuoyancyCore::FGerstnerSpectrumView FWaveSpectrum::GetView() const
+{
+	BuoyancyCore::FGerstnerSpectrumView View;
+	View.WaveVectorX = WaveVectorX.GetData();
+	View.WaveVectorY = WaveVectorY.GetData();
+	View.AngularFrequency = AngularFrequency.GetData();
+	View.Phase = Phase.GetData();
+	View.DisplacementScaleX = DisplacementScaleX.GetData();
+	View.DisplacementScaleY = DisplacementScaleY.GetData();
+	View.Amplitude = Amplitude.GetData();
+	View.NumComponents = Num();
+	return View;
+}
+
+FVector FWaveSpectrum::Evaluate(float X, float Y, float Time, int32 NumComponents) const
+{
+	FVector Sum = FVector::ZeroVector;
+
+	NumComponents = FMath::Min(NumComponents, Num());
+
+	for (int32 i = 0; i < NumComponents; ++i)
+	{
+		const float WavePhase = WaveVectorX[i] * X + (WaveVectorY[i] * Y + (Time * AngularFrequency[i] + Phase[i]));
+
+		float Sin, Cos;
+		FMath::SinCos(&Sin, &Cos, WavePhase);
+
+		Sum.X += DisplacementScaleX[i] * Cos;
+		Sum.Y += DisplacementScaleY[i] * Cos;
+		Sum.Z += Amplitude[i] * Sin;
+	}
+
+	return Sum;
+}
+
+FVector FWaveSpectrum::Evaluate(float X, float Y, float Time, int32 NumComponents, FVector& OutSlopeX, FVector& OutSlopeY) const
+{
+	FVector Sum = FVector::ZeroVector;
+	OutSlopeX = FVector::ZeroVector;
+	OutSlopeY = FVector::ZeroVector;
+
+	NumComponents = FMath::Min(NumComponents, Num());
+
+	for (int32 i = 0; i < NumComponents; ++i)
+	{
+		const float WavePhase = WaveVectorX[i] * X + (WaveVectorY[i] * Y + (Time * AngularFrequency[i] + Phase[i]));
+
+		float Sin, Cos;
+		FMath::SinCos(&Sin, &Cos, WavePhase);
+
+		Sum.X += DisplacementScaleX[i] * Cos;
+		Sum.Y += DisplacementScaleY[i] * Cos;
+		Sum.Z += Amplitude[i] * Sin;
+
+		// Derivative of phase along X is WaveVectorX, along Y WaveVectorY
+		const FVector Derivative(-DisplacementScaleX[i] * Sin, -DisplacementScaleY[i] * Sin, Amplitude[i] * Cos);
+		OutSlopeX += Derivative * WaveVectorX[i];
+		OutSlopeY += Derivative * WaveVectorY[i];
+	}
+
+	return Sum;
+}
+
+FVector FWaveSpectrum::EvaluateVelocity(float X, float Y, float Time, int32 NumComponents) const
+{
+	FVector Sum = FVector::ZeroVector;
+
+	NumComponents = FMath::Min(NumComponents, Num());
+
+	for (int32 i = 0; i < NumComponents; ++i)
+	{
+		const float WavePhase = WaveVectorX[i] * X + (WaveVectorY[i] * Y + (Time * AngularFrequency[i] + Phase[i]));
+
+		float Sin, Cos;
+		FMath::SinCos(&Sin, &Cos, WavePhase);
+
+		// Derivative of phase in time is AngularFrequency
+		Sum.X -= DisplacementScaleX[i] * AngularFrequency[i] * Sin;
+		Sum.Y -= DisplacementScaleY[i] * AngularFrequency[i] * Sin;
+		Sum.Z += Amplitude[i] * AngularFrequency[i] * Cos;
+	}
+
+	return Sum;
+}
+
+/* SIMD part of FWaveSpectrum::EvaluateBatch for first NumVectorSamples samples, slopes and velocities are template parameters so plain evaluation doesn't pay for them */
+template <bool bSlopes, bool bVelocities>
+static void EvaluateSpectrumVectors(const FWaveSpectrum& Spectrum, const float* X, const float* Y, int32 NumVectorSamples, float Time, const BuoyancyCore::FWaveSampleBuffers& Out, int32 NumComponents)
+{
+	const float* RESTRICT KX = Spectrum.WaveVectorX.GetData();
+	const float* RESTRICT KY = Spectrum.WaveVectorY.GetData();
+	const float* RESTRICT W = Spectrum.AngularFrequency.GetData();
+	const float* RESTRICT P = Spectrum.Phase.GetData();
+	const float* RESTRICT SX = Spectrum.DisplacementScaleX.GetData();
+	const float* RESTRICT SY = Spectrum.DisplacementScaleY.GetData();
+	const float* RESTRICT SZ = Spectrum.Amplitude.GetData();
+
+	const VectorRegister VTime = VectorSetFloat1(Time);
+
+	for (int32 SampleIndex = 0; SampleIndex < NumVectorSamples; SampleIndex += 4)
+	{
+		const VectorRegister PosX = VectorLoad(X + SampleIndex);
+		const VectorRegister PosY = VectorLoad(Y + SampleIndex);
+
+		VectorRegister SumX = VectorZero();
+		VectorRegister SumY = VectorZero();
+		VectorRegister SumZ = VectorZero();
+
+		VectorRegister SumXX = VectorZero();
+		VectorRegister SumXY = VectorZero();
+		VectorRegister SumYY = VectorZero();
+		VectorRegister SumZX = VectorZero();
+		VectorRegister SumZY = VectorZero();
+
+		VectorRegister SumVX = VectorZero();
+		VectorRegister SumVY = VectorZero();
+		VectorRegister SumVZ = VectorZero();
+
+		for (int32 i = 0; i < NumComponents; ++i)
+		{
+			const VectorRegister VKX = VectorLoadFloat1(KX + i);
+			const VectorRegister VKY = VectorLoadFloat1(KY + i);
+			const VectorRegister VW = VectorLoadFloat1(W + i);
+
+			VectorRegister WavePhase = VectorMultiplyAdd(VTime, VW, VectorLoadFloat1(P + i));
+			WavePhase = VectorMultiplyAdd(VKY, PosY, WavePhase);
+			WavePhase = VectorMultiplyAdd(VKX, PosX, WavePhase);
+
+			VectorRegister Sin, Cos;
+			WaveVectorSinCos(WavePhase, Sin, Cos);
+
+			const VectorRegister VSX = VectorLoadFloat1(SX + i);
+			const VectorRegister VSY = VectorLoadFloat1(SY + i);
+			const VectorRegister VSZ = VectorLoadFloat1(SZ + i);
+
+			SumX = VectorMultiplyAdd(VSX, Cos, SumX);
+			SumY = VectorMultiplyAdd(VSY, Cos, SumY);
+			SumZ = VectorMultiplyAdd(VSZ, Sin, SumZ);
+
+			if (bSlopes)
+			{
+				const VectorRegister HorizontalX = VectorMultiply(VSX, Sin);
+				const VectorRegister Vertical = VectorMultiply(VSZ, Cos);
+
+				SumXX = VectorSubtract(SumXX, VectorMultiply(HorizontalX, VKX));
+				SumXY = VectorSubtract(SumXY, VectorMultiply(HorizontalX, VKY));
+				SumYY = VectorSubtract(SumYY, VectorMultiply(VectorMultiply(VSY, Sin), VKY));
+				SumZX = VectorMultiplyAdd(Vertical, VKX, SumZX);
+				SumZY = VectorMultiplyAdd(Vertical, VKY, SumZY);
+			}
+
+			if (bVelocities)
+			{
+				// Same terms as slopes with AngularFrequency in place of wave vector
+				SumVX = VectorSubtract(SumVX, VectorMultiply(VectorMultiply(VSX, Sin), VW));
+				SumVY = VectorSubtract(SumVY, VectorMultiply(VectorMultiply(VSY, Sin), VW));
+				SumVZ = VectorMultiplyAdd(VectorMultiply(VSZ, Cos), VW, SumVZ);
+			}
+		}
+
+		VectorStore(SumX, Out.DisplacementX + SampleIndex);
+		VectorStore(SumY, Out.DisplacementY + SampleIndex);
+		VectorStore(SumZ, Out.DisplacementZ + SampleIndex);
+
+		if (bSlopes)
+		{
+			VectorStore(SumXX, Out.SlopeXX + SampleIndex);
+			VectorStore(SumXY, Out.SlopeXY + SampleIndex);
+			VectorStore(SumYY, Out.SlopeYY + SampleIndex);
+			VectorStore(SumZX, Out.SlopeZX + SampleIndex);
+			VectorStore(SumZY, Out.SlopeZY + SampleIndex);
+		}
+
+		if (bVelocities)
+		{
+			VectorStore(SumVX, Out.VelocityX + SampleIndex);
+			VectorStore(SumVY, Out.VelocityY + SampleIndex);
+			VectorStore(SumVZ, Out.VelocityZ + SampleIndex);
+		}
+	}
+}
+
+void FWaveSpectrum::EvaluateBatch(const float* X, const float* Y, int32 NumSamples, float Time, float* OutX, float* OutY, float* OutZ, int32 NumComponents) const
+{
+	BuoyancyCore::FWaveSampleBuffers Out;
+	Out.DisplacementX = OutX;
+	Out.DisplacementY = OutY;
+	Out.DisplacementZ = OutZ;
+
+	EvaluateBatch(X, Y, NumSamples, Time, Out, NumComponents);
+}
+
+void FWaveSpectrum::EvaluateBatch(const float* X, const float* Y, int32 NumSamples, float Time, const BuoyancyCore::FWaveSampleBuffers& Out, int32 NumComponents) const
+{
+	NumComponents = FMath::Min(NumComponents, Num());
+
+	const int32 NumVectorSamples = NumSamples & ~3;
+
+	if (Out.HasSlopes())
+	{
+		if (Out.HasVelocities())
+		{
+			EvaluateSpectrumVectors<true, true>(*this, X, Y, NumVectorSamples, Time, Out, NumComponents);
+		}
+		else
+		{
+			EvaluateSpectrumVectors<true, false>(*this, X, Y, NumVectorSamples, Time, Out, NumComponents);
+		}
+	}
+	else if (Out.HasVelocities())
+	{
+		EvaluateSpectrumVectors<false, true>(*this, X, Y, NumVectorSamples, Time, Out, NumComponents);
+	}
+	else
+	{
+		EvaluateSpectrumVectors<false, false>(*this, X, Y, NumVectorSamples, Time, Out, NumComponents);
+	}
+
+	// Remaining samples that don't fill whole vector
+	for (int32 SampleIndex = NumVectorSamples; SampleIndex < NumSamples; ++SampleIndex)
+	{
+		FVector SlopeX, SlopeY;
+		const FVector Displacement = Out.HasSlopes() ? Evaluate(X[SampleIndex], Y[SampleIndex], Time, NumComponents, SlopeX, SlopeY)
+			: Evaluate(X[SampleIndex], Y[SampleIndex], Time, NumComponents);
+
+		Out.DisplacementX[SampleIndex] = Displacement.X;
+		Out.DisplacementY[SampleIndex] = Displacement.Y;
+		Out.DisplacementZ[SampleIndex] = Displacement.Z;
+
+		if (Out.HasSlopes())
+		{
+			Out.SlopeXX[SampleIndex] = SlopeX.X;
+			Out.SlopeXY[SampleIndex] = SlopeX.Y;
+			Out.SlopeYY[SampleIndex] = SlopeY.Y;
+			Out.SlopeZX[SampleIndex] = SlopeX.Z;
+			Out.SlopeZY[SampleIndex] = SlopeY.Z;
+		}
+
+		if (Out.HasVelocities())
+		{
+			const FVector Velocity = EvaluateVelocity(X[SampleIndex], Y[SampleIndex], Time, NumComponents);
+
+			Out.VelocityX[SampleIndex] = Velocity.X;
+			Out.VelocityY[SampleIndex] = Velocity.Y;
+			Out.VelocityZ[SampleIndex] = Velocity.Z;
+		}
+	}
+}
+
+void FWaveSpectrum::EvaluateBatch(FWaveSampleBatch& Batch, float Time, int32 NumComponents, bool bVelocities) const
+{
+	EvaluateBatch(Batch.PositionX.GetData(), Batch.PositionY.GetData(), Batch.Num(), Time, Batch.SetNumOutputs(false, bVelocities), NumComponents);
+}
+
+void FWaveSpectrum::EvaluateSurfaceHeightBatch(FWaveSampleBatch& Batch, float Time, int32 NumIterations, int32 NumComponents, bool bVelocities) const
+{
+	const int32 NumSamples = Batch.Num();
+
+	Batch.SurfaceX.SetNumUninitialized(NumSamples, false);
+	Batch.SurfaceY.SetNumUninitialized(NumSamples, false);
+
+	// Velocities come from last evaluation, at surface point of last iteration
+	const BuoyancyCore::FWaveSampleBuffers Samples = Batch.SetNumOutputs(NumIterations > 0, bVelocities);
+
+	auto Evaluate = [this, Time, NumComponents](const float* X, const float* Y, int32 Num, const BuoyancyCore::FWaveSampleBuffers& Out)
+	{
+		EvaluateBatch(X, Y, Num, Time, Out, NumComponents);
+	};
+
+	BuoyancyCore::SampleSurfaceHeights(Evaluate, Batch.PositionX.GetData(), Batch.PositionY.GetData(), NumSamples, NumIterations,
+		Batch.SurfaceX.GetData(), Batch.SurfaceY.GetData(), Samples, Batch.DisplacementZ.GetData());
+}
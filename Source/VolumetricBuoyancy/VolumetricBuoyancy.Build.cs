@@ -8,7 +8,10 @@ public VolumetricBuoyancy(TargetInfo Target)
 	{
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "PhysX", "APEX" });
 
-		PrivateDependencyModuleNames.AddRange(new string[] {  });
+		PrivateDependencyModuleNames.AddRange(new string[] { "RenderCore", "RHI" });
+
+		// Buoyancy core takes its profiling hook from buoyancy stats, whatever order headers are included in
+		Definitions.Add("BUOYANCY_CORE_ENGINE=1");
 
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
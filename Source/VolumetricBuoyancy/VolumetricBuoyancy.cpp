@@ -1,5 +1,23 @@
 // Implementation created by David 'vebski' Niemiec
 
 #include "VolumetricBuoyancy.h"
+#include "Misc/BuoyancyStats.h"
+#include "Misc/BuoyancyRecorder.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, VolumetricBuoyancy, "VolumetricBuoyancy" );
+class FVolumetricBuoyancyModule : public FDefaultGameModuleImpl
+{
+public:
+
+	virtual void StartupModule() override
+	{
+		GBuoyancyFrameStats.Initialize();
+	}
+
+	virtual void ShutdownModule() override
+	{
+		GBuoyancyRecorder.Stop();
+		GBuoyancyFrameStats.Shutdown();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FVolumetricBuoyancyModule, VolumetricBuoyancy, "VolumetricBuoyancy" );
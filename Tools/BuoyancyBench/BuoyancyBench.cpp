@@ -0,0 +1,594 @@
+// Implementation created by David 'vebski' Niemiec
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "BuoyancyCore/BuoyancyCore.h"
+#include "BuoyancyCore/GerstnerWaves.h"
+#include "BuoyancyCore/InstancedBuoyancy.h"
+#include "BuoyancyCore/PressureForces.h"
+#include "BuoyancyValidation.h"
+#include "SessionReplay.h"
+#include "SyntheticHulls.h"
+#include "SyntheticWaves.h"
+
+using namespace BuoyancyCore;
+
+namespace
+{
+	const int32_t NumBodies = 64;
+	const int32_t NumSurfacePoints = 9;
+
+	/* Body posed in water with surface points already sampled, same as what UBuoyancyHelper feeds to SolveBody */
+	struct FBenchBody
+	{
+		FBodyState State;
+		FVec3 SurfacePoints[NumSurfacePoints];
+	};
+
+	struct FBenchHull
+	{
+		const char* Name;
+		SyntheticHulls::FHullMesh Mesh;
+		FBodyParams Params;
+		FVec3 Extent;
+	};
+
+	float WaveHeight(float X, float Y)
+	{
+		return 40.0f * std::sin(X * 0.004f) + 25.0f * std::cos(Y * 0.007f + 1.3f);
+	}
+
+	std::vector<FBenchBody> MakeBodies(const FBenchHull& Hull)
+	{
+		std::vector<FBenchBody> Bodies(NumBodies);
+
+		// Fixed seed so every run measures the same poses
+		srand(1234);
+
+		for (int32_t b = 0; b < NumBodies; ++b)
+		{
+			FBenchBody& Body = Bodies[b];
+
+			const float Roll = (rand() / static_cast<float>(RAND_MAX) - 0.5f) * 0.6f;
+			const float Pitch = (rand() / static_cast<float>(RAND_MAX) - 0.5f) * 0.4f;
+			const float Yaw = (rand() / static_cast<float>(RAND_MAX)) * 6.28f;
+
+			Body.State.Rotation = FQuat::FromAxisAngle(FVec3(0.0f, 0.0f, 1.0f), Yaw)
+				* FQuat::FromAxisAngle(FVec3(0.0f, 1.0f, 0.0f), Pitch)
+				* FQuat::FromAxisAngle(FVec3(1.0f, 0.0f, 0.0f), Roll);
+
+			// Bodies float with center of mass somewhere around water level so they are partially submerged
+			Body.State.Location = FVec3(b * 1500.0f, (b % 8) * 1500.0f, (rand() / static_cast<float>(RAND_MAX) - 0.5f) * Hull.Extent.Z);
+			Body.State.CenterOfMass = Body.State.Location;
+			Body.State.LinearVelocity = FVec3(100.0f, 0.0f, -20.0f);
+			Body.State.AngularVelocity = FVec3(5.0f, 2.0f, 0.0f);
+			Body.State.Mass = Hull.Params.BodyVolume * Hull.Params.DensityOfBody * 0.000001f;
+
+			// 3x3 grid over extent of body like BuoyantData.ClippingPointsOffsets
+			int32_t Point = 0;
+			for (int32_t i = -1; i <= 1; ++i)
+			{
+				for (int32_t j = -1; j <= 1; ++j)
+				{
+					FVec3 Location = Body.State.Location + Body.State.Rotation.RotateVector(FVec3(i * Hull.Extent.X, j * Hull.Extent.Y, 0.0f));
+					Location.Z = WaveHeight(Location.X, Location.Y);
+					Body.SurfacePoints[Point++] = Location;
+				}
+			}
+		}
+
+		return Bodies;
+	}
+
+	/* Solve all bodies Iterations times split over NumThreads threads, returns wall time in ns */
+	double RunSolve(const FBenchHull& Hull, const std::vector<FBenchBody>& Bodies, int32_t Iterations, int32_t NumThreads, float& OutVolumeSum)
+	{
+		const FMeshView Mesh = Hull.Mesh.GetView();
+		const FWaterParams Water;
+
+		std::vector<std::vector<float> > Depths(NumThreads, std::vector<float>(Mesh.NumVertices));
+		std::vector<float> VolumeSums(NumThreads, 0.0f);
+		std::vector<std::thread> Threads;
+
+		const auto Start = std::chrono::steady_clock::now();
+
+		for (int32_t t = 0; t < NumThreads; ++t)
+		{
+			Threads.push_back(std::thread([&, t]()
+			{
+				float* ThreadDepths = Depths[t].data();
+				float VolumeSum = 0.0f;
+
+				for (int32_t Iteration = 0; Iteration < Iterations; ++Iteration)
+				{
+					for (int32_t b = t; b < NumBodies; b += NumThreads)
+					{
+						FForces Forces;
+						VolumeSum += SolveBody(Mesh, Bodies[b].State, Hull.Params, Water, Bodies[b].SurfacePoints, NumSurfacePoints, ThreadDepths, Forces);
+					}
+				}
+
+				VolumeSums[t] = VolumeSum;
+			}));
+		}
+
+		for (std::thread& Thread : Threads)
+		{
+			Thread.join();
+		}
+
+		const auto End = std::chrono::steady_clock::now();
+
+		OutVolumeSum = 0.0f;
+		for (float Sum : VolumeSums)
+		{
+			OutVolumeSum += Sum;
+		}
+
+		return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(End - Start).count());
+	}
+
+	void AddHull(std::vector<FBenchHull>& Hulls, const char* Name, const SyntheticHulls::FHullMesh& Mesh, const FVec3& Extent)
+	{
+		FBenchHull Hull;
+		Hull.Name = Name;
+		Hull.Mesh = Mesh;
+		Hull.Extent = Extent;
+
+		FVec3 Centroid;
+		Hull.Params = FBodyParams(ComputeVolume(Mesh.GetView(), Centroid), 500.0f, 2.0f * Extent.X);
+
+		Hulls.push_back(Hull);
+	}
+
+	/* Fixed point inversion P = XY - D(P).XY for comparison, one evaluation per iteration plus one for height */
+	template <typename EvaluatorType>
+	void SampleSurfaceHeightsFixedPoint(const EvaluatorType& Evaluate, const float* X, const float* Y, int32_t NumSamples, int32_t NumIterations,
+		float* SurfaceX, float* SurfaceY, const FWaveSampleBuffers& Samples)
+	{
+		std::copy(X, X + NumSamples, SurfaceX);
+		std::copy(Y, Y + NumSamples, SurfaceY);
+
+		for (int32_t Iteration = 0; Iteration < NumIterations; ++Iteration)
+		{
+			Evaluate(SurfaceX, SurfaceY, NumSamples, Samples);
+
+			for (int32_t i = 0; i < NumSamples; ++i)
+			{
+				SurfaceX[i] = X[i] - Samples.DisplacementX[i];
+				SurfaceY[i] = Y[i] - Samples.DisplacementY[i];
+			}
+		}
+
+		Evaluate(SurfaceX, SurfaceY, NumSamples, Samples);
+	}
+
+	/* Accuracy and cost of height at XY for every number of wave evaluations, errors are against converged inversion.
+	 * Cost is relative to plain displacement at XY, evaluation here is scalar so engine SIMD path has the same ratios.
+	 */
+	void RunWaveInversion(int32_t Repeats)
+	{
+		const int32_t NumSamples = 1024;
+		const float Time = 12.345f;
+
+		srand(4321);
+
+		std::vector<float> X(NumSamples), Y(NumSamples);
+		for (int32_t i = 0; i < NumSamples; ++i)
+		{
+			X[i] = (rand() / static_cast<float>(RAND_MAX) - 0.5f) * 40000.0f;
+			Y[i] = (rand() / static_cast<float>(RAND_MAX) - 0.5f) * 40000.0f;
+		}
+
+		std::vector<float> SurfaceX(NumSamples), SurfaceY(NumSamples), Heights(NumSamples), Converged(NumSamples);
+		std::vector<float> Buffers(8 * NumSamples);
+
+		FWaveSampleBuffers Samples;
+		Samples.DisplacementX = Buffers.data();
+		Samples.DisplacementY = Samples.DisplacementX + NumSamples;
+		Samples.DisplacementZ = Samples.DisplacementY + NumSamples;
+		Samples.SlopeXX = Samples.DisplacementZ + NumSamples;
+		Samples.SlopeXY = Samples.SlopeXX + NumSamples;
+		Samples.SlopeYY = Samples.SlopeXY + NumSamples;
+		Samples.SlopeZX = Samples.SlopeYY + NumSamples;
+		Samples.SlopeZY = Samples.SlopeZX + NumSamples;
+
+		FWaveSampleBuffers Displacements = Samples;
+		Displacements.SlopeXX = Displacements.SlopeXY = Displacements.SlopeYY = Displacements.SlopeZX = Displacements.SlopeZY = nullptr;
+
+		printf("%-9s %6s %-11s %11s %10s %10s %12s %6s\n", "steepness", "slope", "method", "evaluations", "max err", "rms err", "ns/sample", "cost");
+
+		const float Steepnesses[] = { 0.5f, 1.0f };
+		for (float Steepness : Steepnesses)
+		{
+			const SyntheticWaves::FSpectrum Spectrum = SyntheticWaves::MakeDefaultOcean(Steepness);
+			const FGerstnerSpectrumView View = Spectrum.GetView();
+
+			auto Evaluate = [&View, &Spectrum, Time](const float* InX, const float* InY, int32_t Num, const FWaveSampleBuffers& Out)
+			{
+				EvaluateGerstner(View, InX, InY, Num, Time, Out, Spectrum.Num());
+			};
+
+			SampleSurfaceHeights(Evaluate, X.data(), Y.data(), NumSamples, 8, SurfaceX.data(), SurfaceY.data(), Samples, Converged.data());
+
+			double PlainNs = 0.0;
+
+			for (int32_t bNewton = 0; bNewton < 2; ++bNewton)
+			{
+				for (int32_t Evaluations = 1; Evaluations <= 4; ++Evaluations)
+				{
+					const auto Start = std::chrono::steady_clock::now();
+					for (int32_t r = 0; r < Repeats; ++r)
+					{
+						if (bNewton)
+						{
+							SampleSurfaceHeights(Evaluate, X.data(), Y.data(), NumSamples, Evaluations, SurfaceX.data(), SurfaceY.data(), Samples, Heights.data());
+						}
+						else
+						{
+							SampleSurfaceHeightsFixedPoint(Evaluate, X.data(), Y.data(), NumSamples, Evaluations - 1, SurfaceX.data(), SurfaceY.data(), Displacements);
+							std::copy(Displacements.DisplacementZ, Displacements.DisplacementZ + NumSamples, Heights.begin());
+						}
+					}
+					const auto End = std::chrono::steady_clock::now();
+
+					const double Ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(End - Start).count()) / (static_cast<double>(Repeats) * NumSamples);
+					PlainNs = (!bNewton && Evaluations == 1) ? Ns : PlainNs;
+
+					double MaxError = 0.0;
+					double SumSquares = 0.0;
+					for (int32_t i = 0; i < NumSamples; ++i)
+					{
+						const double Error = std::fabs(Heights[i] - Converged[i]);
+						MaxError = std::max(MaxError, Error);
+						SumSquares += Error * Error;
+					}
+
+					printf("%-9.2f %6.3f %-11s %11d %10.4f %10.4f %12.1f %5.2fx\n", Steepness, Spectrum.GetHorizontalSlope(), bNewton ? "newton" : "fixed point", Evaluations,
+						MaxError, std::sqrt(SumSquares / NumSamples), Ns, Ns / PlainNs);
+				}
+			}
+		}
+	}
+
+	/* Replay recorded fixed step session, or synthetic one without FileName.
+	 * Reports divergence of exact replay, how long one float ulp of difference stays within tolerance
+	 * and bandwidth of correcting bodies against replicating their movement.
+	 */
+	int RunReplay(const char* FileName)
+	{
+		// Same as defaults of AActorBuoyant and net update rate of replicated movement
+		const double Tolerance = 1.0;
+		const double CorrectionInterval = 2.0;
+		const double MovementRate = 30.0;
+
+		// FBuoyancyCorrection: step, location, rotation, linear and angular velocity
+		const double CorrectionBytes = 4 + 12 + 16 + 12 + 12;
+
+		SessionReplay::FSession Session;
+		const bool bRead = FileName ? SessionReplay::LoadSession(FileName, Session)
+			: SessionReplay::ReadSession(SessionReplay::RecordSyntheticSession(30.0f, 60), Session);
+
+		if (!bRead)
+		{
+			printf("Can't read session %s\n", FileName ? FileName : "(synthetic)");
+			return 1;
+		}
+
+		printf("%s: %d bodies, %d wave components, %d steps per second, %d records\n", FileName ? FileName : "synthetic session",
+			static_cast<int32_t>(Session.Bodies.size()), Session.Waves.Num(), Session.StepsPerSecond, static_cast<int32_t>(Session.Records.size()));
+
+		const std::vector<SessionReplay::FBodyReplay> Exact = SessionReplay::ReplaySession(Session, false, Tolerance);
+		const std::vector<SessionReplay::FBodyReplay> Perturbed = SessionReplay::ReplaySession(Session, true, Tolerance);
+
+		printf("%-5s %9s %7s %7s %12s %12s %14s %12s %12s\n", "body", "triangles", "steps", "resets", "ns/step", "max err cm", "max err deg", "1 ulp drift s", "B/s correct");
+
+		int32_t NumDiverged = 0;
+		for (size_t b = 0; b < Exact.size(); ++b)
+		{
+			const SessionReplay::FBodyReplay& Result = Exact[b];
+
+			int32_t NumTriangles = 0;
+			for (const FFixedStepHull& Hull : Session.Bodies[b].Hulls)
+			{
+				NumTriangles += Hull.Mesh.NumTriangles;
+			}
+
+			// Perturbed body which never left tolerance drifts slower than session is long
+			const double DriftSeconds = Perturbed[b].StepsWithinTolerance >= 0 ? static_cast<double>(Perturbed[b].StepsWithinTolerance) / Session.StepsPerSecond
+				: static_cast<double>(Perturbed[b].LastStep - Perturbed[b].FirstStep) / Session.StepsPerSecond;
+
+			// Corrections are needed at least as often as bodies drift out of tolerance on other machines
+			const double Interval = std::min(CorrectionInterval, std::max(DriftSeconds, 1.0 / MovementRate));
+
+			printf("%-5d %9d %7d %7d %12.1f %12.3e %14.3e %12.2f%s %12.1f\n", static_cast<int32_t>(b), NumTriangles, Result.NumSteps, Result.NumResets,
+				Result.NumSteps > 0 ? Result.TotalNs / Result.NumSteps : 0.0, Result.MaxPositionError, Result.MaxRotationError,
+				DriftSeconds, Perturbed[b].StepsWithinTolerance >= 0 ? "" : "+", CorrectionBytes / Interval);
+
+			if (Result.MaxPositionError > 0.0 || Result.MaxRotationError > 0.0)
+			{
+				++NumDiverged;
+			}
+		}
+
+		printf("Replicated movement: %.1f B/s per body at %.0f Hz, corrections every %.1f s: %.1f B/s per body\n",
+			CorrectionBytes * MovementRate, MovementRate, CorrectionInterval, CorrectionBytes / CorrectionInterval);
+		printf("%d of %d bodies diverged from recording\n", NumDiverged, static_cast<int32_t>(Exact.size()));
+
+		return NumDiverged > 0 ? 1 : 0;
+	}
+
+	/* Cost of pressure solve against volume solve on the same poses, single thread.
+	 * Bodies move and rotate, so drag, friction and slamming paths all run, cost per triangle is per mesh triangle.
+	 */
+	void RunPressure(const std::vector<FBenchHull>& Hulls, double TriangleBudget)
+	{
+		const FWaterParams Water;
+		const float DeltaTime = 1.0f / 60.0f;
+
+		printf("%-8s %9s %9s %12s %12s %10s %7s\n", "hull", "triangles", "submerged", "volume ns", "pressure ns", "ns/tri", "cost");
+
+		for (const FBenchHull& Hull : Hulls)
+		{
+			const std::vector<FBenchBody> Bodies = MakeBodies(Hull);
+			const FMeshView Mesh = Hull.Mesh.GetView();
+			const int32_t Iterations = std::max(1, static_cast<int32_t>(0.25 * TriangleBudget / (static_cast<double>(Mesh.NumTriangles) * NumBodies)));
+
+			FPressureParams Pressure;
+			Pressure.SurfaceArea = ComputeSurfaceArea(Mesh);
+
+			std::vector<float> Depths(Mesh.NumVertices);
+			std::vector<float> Buffer(FPressureScratch::GetNumFloats(Mesh.NumVertices, Mesh.NumTriangles));
+			std::vector<int32_t> Sources(2 * Mesh.NumTriangles);
+			const FPressureScratch Scratch = FPressureScratch::FromBuffer(Buffer.data(), Sources.data(), Mesh.NumVertices, Mesh.NumTriangles);
+
+			// Every body keeps its own sweep history like FBuoyantBodyData does
+			std::vector<float> Sweeps(static_cast<size_t>(NumBodies) * Mesh.NumTriangles);
+			std::vector<FPressureHistory> Histories(NumBodies);
+			for (int32_t b = 0; b < NumBodies; ++b)
+			{
+				Histories[b].Sweep = Sweeps.data() + static_cast<size_t>(b) * Mesh.NumTriangles;
+			}
+
+			float VolumeSum = 0.0f;
+			const auto VolumeStart = std::chrono::steady_clock::now();
+			for (int32_t Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				for (int32_t b = 0; b < NumBodies; ++b)
+				{
+					FForces Forces;
+					VolumeSum += SolveBody(Mesh, Bodies[b].State, Hull.Params, Water, Bodies[b].SurfacePoints, NumSurfacePoints, Depths.data(), Forces);
+				}
+			}
+			const auto VolumeEnd = std::chrono::steady_clock::now();
+
+			float PressureSum = 0.0f;
+			const auto PressureStart = std::chrono::steady_clock::now();
+			for (int32_t Iteration = 0; Iteration < Iterations; ++Iteration)
+			{
+				for (int32_t b = 0; b < NumBodies; ++b)
+				{
+					FForces Forces;
+					PressureSum += SolveBodyPressure(Mesh, Bodies[b].State, Hull.Params, Water, Pressure, Bodies[b].SurfacePoints, NumSurfacePoints, Depths.data(), DeltaTime,
+						Scratch, &Histories[b], Forces);
+				}
+			}
+			const auto PressureEnd = std::chrono::steady_clock::now();
+
+			// Submerged triangles of last pose, clipping splits crossing triangles in two
+			int32_t NumSubmerged = 0;
+			for (int32_t b = 0; b < NumBodies; ++b)
+			{
+				FForces Forces;
+				SolveBodyPressure(Mesh, Bodies[b].State, Hull.Params, Water, Pressure, Bodies[b].SurfacePoints, NumSurfacePoints, Depths.data(), DeltaTime, Scratch, nullptr, Forces);
+				NumSubmerged += ClipSubmergedTriangles(Mesh, Depths.data(), Scratch);
+			}
+
+			const double NumSolves = static_cast<double>(Iterations) * NumBodies;
+			const double VolumeNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(VolumeEnd - VolumeStart).count()) / NumSolves;
+			const double PressureNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(PressureEnd - PressureStart).count()) / NumSolves;
+
+			printf("%-8s %9d %9d %12.1f %12.1f %10.2f %6.2fx%s\n", Hull.Name, Mesh.NumTriangles, NumSubmerged / NumBodies, VolumeNs, PressureNs,
+				PressureNs / Mesh.NumTriangles, PressureNs / VolumeNs, VolumeSum > 0.0f && PressureSum > 0.0f ? "" : "  (no submerged volume!)");
+		}
+	}
+
+	/* Frame cost of instanced buoyancy, single thread: surface heights of all instances with one Newton iteration
+	 * (scalar EvaluateGerstner, engine batch is SIMD) with full spectrum and with wave LOD, and one step of all instances.
+	 * Instances are mixed spheres, boxes and capsules dropped over default ocean, mean submerged part shows they float.
+	 */
+	void RunInstances(int32_t NumFrames)
+	{
+		const SyntheticWaves::FSpectrum Spectrum = SyntheticWaves::MakeDefaultOcean(0.5f);
+		const FGerstnerSpectrumView View = Spectrum.GetView();
+		const float DeltaTime = 1.0f / 60.0f;
+
+		printf("%-9s %10s %10s %10s %10s %12s %9s\n", "instances", "components", "waves ms", "step ms", "frame ms", "step ns/inst", "submerged");
+
+		// Small instances are what wave LOD drops components for
+		const int32_t InstanceCounts[] = { 1000, 10000, 50000 };
+		const int32_t ComponentCounts[] = { View.NumComponents, 4 };
+
+		for (int32_t Run = 0; Run < 6; ++Run)
+		{
+			const int32_t NumInstances = InstanceCounts[Run / 2];
+			const int32_t NumComponents = ComponentCounts[Run % 2];
+
+			srand(1234);
+
+			FInstanceStepParams Params;
+
+			std::vector<float> Buffer(static_cast<size_t>(FInstanceBuffers::FloatsPerInstance) * NumInstances);
+			const FInstanceBuffers Instances = FInstanceBuffers::FromBuffer(Buffer.data(), NumInstances);
+
+			for (int32_t i = 0; i < NumInstances; ++i)
+			{
+				const EInstanceShape Shape = static_cast<EInstanceShape>(i % 3);
+				const FVec3 Extent(10.0f + 50.0f * (rand() / (float)RAND_MAX), 10.0f + 20.0f * (rand() / (float)RAND_MAX), 5.0f + 20.0f * (rand() / (float)RAND_MAX));
+				const float Density = 200.0f + 600.0f * (rand() / (float)RAND_MAX);
+
+				Instances.SetShape(i, MakeInstanceShape(Shape, Extent, Density, Params.Water.Density));
+
+				const FVec3 Position((rand() / (float)RAND_MAX - 0.5f) * 20000.0f, (rand() / (float)RAND_MAX - 0.5f) * 20000.0f, 300.0f * (rand() / (float)RAND_MAX));
+				const FQuat Rotation = FQuat::FromAxisAngle(FVec3(rand() / (float)RAND_MAX - 0.5f, rand() / (float)RAND_MAX - 0.5f, 1.0f).GetSafeNormal(), 3.0f * (rand() / (float)RAND_MAX));
+				Instances.SetState(i, Position, Rotation, FVec3(), FVec3());
+			}
+
+			std::vector<float> SurfaceX(NumInstances), SurfaceY(NumInstances), SampleBuffer(8 * static_cast<size_t>(NumInstances));
+
+			FWaveSampleBuffers Samples;
+			Samples.DisplacementX = SampleBuffer.data();
+			Samples.DisplacementY = Samples.DisplacementX + NumInstances;
+			Samples.DisplacementZ = Samples.DisplacementY + NumInstances;
+			Samples.SlopeXX = Samples.DisplacementZ + NumInstances;
+			Samples.SlopeXY = Samples.SlopeXX + NumInstances;
+			Samples.SlopeYY = Samples.SlopeXY + NumInstances;
+			Samples.SlopeZX = Samples.SlopeYY + NumInstances;
+			Samples.SlopeZY = Samples.SlopeZX + NumInstances;
+
+			double WavesNs = 0.0;
+			double StepNs = 0.0;
+
+			for (int32_t Frame = 0; Frame < NumFrames; ++Frame)
+			{
+				const float Time = Frame * DeltaTime;
+
+				auto Evaluate = [&View, Time, NumComponents](const float* X, const float* Y, int32_t Num, const FWaveSampleBuffers& Out)
+				{
+					EvaluateGerstner(View, X, Y, Num, Time, Out, NumComponents);
+				};
+
+				const auto WavesStart = std::chrono::steady_clock::now();
+				SampleSurfaceHeights(Evaluate, Instances.PositionX, Instances.PositionY, NumInstances, 1, SurfaceX.data(), SurfaceY.data(), Samples, Instances.SurfaceZ);
+				ComputeSurfaceSlopes(Samples, NumInstances, Instances.SurfaceSlopeX, Instances.SurfaceSlopeY);
+				const auto StepStart = std::chrono::steady_clock::now();
+				StepInstances(Instances, NumInstances, Params, DeltaTime);
+				const auto StepEnd = std::chrono::steady_clock::now();
+
+				WavesNs += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(StepStart - WavesStart).count());
+				StepNs += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(StepEnd - StepStart).count());
+			}
+
+			double Submerged = 0.0;
+			for (int32_t i = 0; i < NumInstances; ++i)
+			{
+				Submerged += Instances.Submerged[i];
+			}
+
+			const double WavesMs = WavesNs / NumFrames * 1e-6;
+			const double StepMs = StepNs / NumFrames * 1e-6;
+
+			printf("%-9d %10d %10.3f %10.3f %10.3f %12.1f %9.2f\n", NumInstances, NumComponents, WavesMs, StepMs, WavesMs + StepMs,
+				StepNs / NumFrames / NumInstances, Submerged / NumInstances);
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	// Total triangles solved per measurement, iterations are scaled so every mesh size takes similar time
+	double TriangleBudget = 2.0e8;
+	int32_t WaveRepeats = 200;
+	int32_t MaxThreads = static_cast<int32_t>(std::thread::hardware_concurrency());
+	bool bPressure = false;
+
+	for (int32_t i = 1; i < argc; ++i)
+	{
+		if (std::strcmp(argv[i], "--quick") == 0)
+		{
+			TriangleBudget = 1.0e7;
+			WaveRepeats = 10;
+		}
+		else if (std::strcmp(argv[i], "--validate") == 0)
+		{
+			return RunValidation() > 0 ? 1 : 0;
+		}
+		else if (std::strcmp(argv[i], "--waves") == 0)
+		{
+			RunWaveInversion(WaveRepeats);
+			return 0;
+		}
+		else if (std::strcmp(argv[i], "--replay") == 0)
+		{
+			return RunReplay(i + 1 < argc ? argv[i + 1] : nullptr);
+		}
+		else if (std::strcmp(argv[i], "--instances") == 0)
+		{
+			RunInstances(TriangleBudget < 1.0e8 ? 60 : 600);
+			return 0;
+		}
+		else if (std::strcmp(argv[i], "--pressure") == 0)
+		{
+			bPressure = true;
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+		{
+			MaxThreads = std::atoi(argv[++i]);
+		}
+	}
+
+	MaxThreads = std::max(MaxThreads, 1);
+
+	const int32_t TargetTriangles[] = { 100, 1000, 10000, 50000 };
+
+	std::vector<FBenchHull> Hulls;
+	for (int32_t Target : TargetTriangles)
+	{
+		const int32_t BoxSubdivisions = std::max(1, static_cast<int32_t>(std::sqrt(Target / 12.0f) + 0.5f));
+
+		AddHull(Hulls, "box", SyntheticHulls::MakeBox(FVec3(200.0f, 100.0f, 50.0f), BoxSubdivisions), FVec3(200.0f, 100.0f, 50.0f));
+		AddHull(Hulls, "capsule", SyntheticHulls::MakeCapsule(50.0f, 100.0f, Target), FVec3(150.0f, 50.0f, 50.0f));
+		AddHull(Hulls, "ship", SyntheticHulls::MakeShip(1200.0f, 300.0f, 150.0f, Target), FVec3(600.0f, 150.0f, 150.0f));
+	}
+
+	if (bPressure)
+	{
+		RunPressure(Hulls, TriangleBudget);
+		return 0;
+	}
+
+	std::vector<int32_t> ThreadCounts;
+	for (int32_t Threads = 1; Threads < MaxThreads; Threads *= 2)
+	{
+		ThreadCounts.push_back(Threads);
+	}
+	ThreadCounts.push_back(MaxThreads);
+
+	printf("%-8s %9s %8s %12s %14s %9s\n", "hull", "triangles", "threads", "ns/body", "triangles/s", "scaling");
+
+	for (const FBenchHull& Hull : Hulls)
+	{
+		const std::vector<FBenchBody> Bodies = MakeBodies(Hull);
+		const int32_t NumTriangles = Hull.Mesh.NumTriangles();
+		const int32_t Iterations = std::max(1, static_cast<int32_t>(TriangleBudget / (static_cast<double>(NumTriangles) * NumBodies)));
+
+		double SingleThreadNs = 0.0;
+
+		for (int32_t Threads : ThreadCounts)
+		{
+			// Warm up caches and thread creation before measuring
+			float VolumeSum = 0.0f;
+			RunSolve(Hull, Bodies, 1, Threads, VolumeSum);
+
+			const double ElapsedNs = RunSolve(Hull, Bodies, Iterations, Threads, VolumeSum);
+			const double NumSolves = static_cast<double>(Iterations) * NumBodies;
+			const double NsPerBody = ElapsedNs / NumSolves;
+
+			if (Threads == 1)
+			{
+				SingleThreadNs = ElapsedNs;
+			}
+
+			printf("%-8s %9d %8d %12.1f %14.3e %8.2fx%s\n", Hull.Name, NumTriangles, Threads, NsPerBody,
+				NumSolves * NumTriangles / (ElapsedNs * 1e-9), SingleThreadNs / ElapsedNs, VolumeSum > 0.0f ? "" : "  (no submerged volume!)");
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,2034 @@
+// Implementation created by David 'vebski' Niemiec
+
+#include "BuoyancyValidation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "BuoyancyCore/BuoyancyCore.h"
+#include "BuoyancyCore/FixedStep.h"
+#include "BuoyancyCore/GerstnerWaves.h"
+#include "BuoyancyCore/HullSimplifier.h"
+#include "BuoyancyCore/InstancedBuoyancy.h"
+#include "BuoyancyCore/PressureForces.h"
+#include "ReferenceBuoyancy.h"
+#include "SessionReplay.h"
+#include "SyntheticHulls.h"
+#include "SyntheticWaves.h"
+
+using namespace BuoyancyCore;
+
+namespace
+{
+	const double Pi = 3.14159265358979;
+
+	/* Exact volume and centroid of part of some body below plane */
+	struct FAnalyticResult
+	{
+		double Volume;
+		double Centroid[3];
+	};
+
+	struct FCaseStats
+	{
+		const char* Name;
+		int32_t NumChecks;
+		double MaxVolumeError;
+		double MaxCentroidError;
+		double TotalNs;
+		int32_t NumCalls;
+		bool bKnownIssue;
+		bool bPassed;
+	};
+
+	/* Part of box [-Extent, Extent] below plane Dot(Normal, X) = Offset.
+	 * Box is mapped to unit cube and cut into corner simplices by inclusion-exclusion.
+	 */
+	FAnalyticResult AnalyticBox(const FVec3& Extent, const FVec3& Normal, float Offset)
+	{
+		// Dot(Normal, X) = Sum(M * U) - Sum(Normal * Extent) for U in unit cube
+		double M[3];
+		double D = Offset;
+		double MaxM = 0.0;
+		for (int32_t i = 0; i < 3; ++i)
+		{
+			M[i] = 2.0 * Normal[i] * Extent[i];
+			D += static_cast<double>(Normal[i]) * Extent[i];
+			MaxM = std::max(MaxM, std::fabs(M[i]));
+		}
+
+		// Flip axes with negative slope, drop axes plane (almost) doesn't depend on.
+		// Tiny slopes left by float rotations would blow up inclusion-exclusion terms.
+		const double MinM = 1e-5 * MaxM;
+		bool bFlipped[3];
+		int32_t Axes[3];
+		int32_t NumAxes = 0;
+		for (int32_t i = 0; i < 3; ++i)
+		{
+			bFlipped[i] = M[i] < 0.0;
+			if (bFlipped[i])
+			{
+				D -= M[i];
+				M[i] = -M[i];
+			}
+
+			if (M[i] > MinM)
+			{
+				Axes[NumAxes++] = i;
+			}
+		}
+
+		double Factorial = 1.0;
+		double Product = 1.0;
+		for (int32_t k = 0; k < NumAxes; ++k)
+		{
+			Factorial *= (k + 1);
+			Product *= M[Axes[k]];
+		}
+
+		double Volume = 0.0;
+		double Moment[3] = { 0.0, 0.0, 0.0 };
+
+		for (int32_t Corner = 0; Corner < (1 << NumAxes); ++Corner)
+		{
+			double T = D;
+			int32_t Sign = 1;
+			for (int32_t k = 0; k < NumAxes; ++k)
+			{
+				if (Corner & (1 << k))
+				{
+					T -= M[Axes[k]];
+					Sign = -Sign;
+				}
+			}
+
+			if (T <= 0.0)
+			{
+				continue;
+			}
+
+			// Simplex from corner, its centroid is corner + T / ((k + 1) * M) along every axis
+			const double SimplexVolume = Sign * std::pow(T, NumAxes) / (Factorial * Product);
+			Volume += SimplexVolume;
+
+			for (int32_t k = 0; k < NumAxes; ++k)
+			{
+				const double CornerU = (Corner & (1 << k)) ? 1.0 : 0.0;
+				Moment[Axes[k]] += SimplexVolume * (CornerU + T / ((NumAxes + 1) * M[Axes[k]]));
+			}
+		}
+
+		FAnalyticResult Result;
+		Result.Volume = Volume * 8.0 * Extent.X * Extent.Y * Extent.Z;
+
+		for (int32_t i = 0; i < 3; ++i)
+		{
+			// Axes plane doesn't depend on are cut in half by symmetry
+			double U = 0.5;
+			if (Volume > 0.0 && M[i] > MinM)
+			{
+				U = Moment[i] / Volume;
+			}
+
+			U = bFlipped[i] ? 1.0 - U : U;
+			Result.Centroid[i] = Volume > 0.0 ? (2.0 * U - 1.0) * Extent[i] : 0.0;
+		}
+
+		return Result;
+	}
+
+	/* Spherical cap of sphere centered at origin below plane Dot(Normal, X) = Offset, Normal must be normalized */
+	FAnalyticResult AnalyticSphere(double Radius, const FVec3& Normal, float Offset)
+	{
+		const double Height = std::min(std::max(Radius + Offset, 0.0), 2.0 * Radius);
+
+		FAnalyticResult Result;
+		Result.Volume = Pi * Height * Height * (3.0 * Radius - Height) / 3.0;
+
+		const double Distance = Height > 0.0 ? -3.0 * (2.0 * Radius - Height) * (2.0 * Radius - Height) / (4.0 * (3.0 * Radius - Height)) : 0.0;
+		for (int32_t i = 0; i < 3; ++i)
+		{
+			Result.Centroid[i] = Distance * Normal[i];
+		}
+
+		return Result;
+	}
+
+	FVec3 RandomNormal()
+	{
+		FVec3 Normal;
+		do
+		{
+			Normal = FVec3(rand() / (float)RAND_MAX - 0.5f, rand() / (float)RAND_MAX - 0.5f, rand() / (float)RAND_MAX - 0.5f);
+		}
+		while (Normal.SizeSquared() < 0.01f);
+
+		return Normal.GetSafeNormal();
+	}
+
+	float RandomRange(float Min, float Max)
+	{
+		return Min + (Max - Min) * (rand() / (float)RAND_MAX);
+	}
+
+	class FValidation
+	{
+	public:
+
+		FValidation()
+			: NumFailed(0)
+		{
+		}
+
+		void BeginCase(const char* Name, bool bKnownIssue = false)
+		{
+			FCaseStats Stats;
+			Stats.Name = Name;
+			Stats.NumChecks = 0;
+			Stats.MaxVolumeError = 0.0;
+			Stats.MaxCentroidError = 0.0;
+			Stats.TotalNs = 0.0;
+			Stats.NumCalls = 0;
+			Stats.bKnownIssue = bKnownIssue;
+			Stats.bPassed = true;
+			Cases.push_back(Stats);
+		}
+
+		/* Submerged volume of mesh under plane in mesh space, timed */
+		float Submerged(const FMeshView& Mesh, const FVec3& Normal, float Offset, FVec3& Centroid)
+		{
+			Depths.resize(Mesh.NumVertices);
+
+			return Timed(Mesh.NumTriangles, [&]() { return ComputeSubmergedVolume(Mesh, Normal, Offset, Depths.data(), Centroid); });
+		}
+
+		/* Run Function repeatedly and record its time, returns its result */
+		template <typename FunctionType>
+		float Timed(int32_t NumTriangles, FunctionType Function)
+		{
+			const int32_t Repeats = std::max(1, 200000 / std::max(NumTriangles, 1));
+			float Result = 0.0f;
+
+			const auto Start = std::chrono::steady_clock::now();
+			for (int32_t i = 0; i < Repeats; ++i)
+			{
+				// Result goes through volatile sink, callers ignoring it would let inlined kernel be optimized away
+				Result = Function();
+				Sink = Result;
+			}
+			const auto End = std::chrono::steady_clock::now();
+
+			Cases.back().TotalNs += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(End - Start).count());
+			Cases.back().NumCalls += Repeats;
+
+			return Result;
+		}
+
+		/* Whole body solve, timed */
+		float Solve(const FMeshView& Mesh, const FBodyState& State, const FBodyParams& Body, const FVec3* SurfacePoints, int32_t NumSurfacePoints, FForces& Forces)
+		{
+			Depths.resize(Mesh.NumVertices);
+
+			return Timed(Mesh.NumTriangles, [&]() { return SolveBody(Mesh, State, Body, FWaterParams(), SurfacePoints, NumSurfacePoints, Depths.data(), Forces); });
+		}
+
+		/* Compare result with expected one, errors are relative to VolumeScale and LengthScale */
+		void Check(float Volume, const FVec3& Centroid, const FAnalyticResult& Expected, double VolumeScale, double LengthScale, double VolumeTolerance, double CentroidTolerance)
+		{
+			FCaseStats& Stats = Cases.back();
+			++Stats.NumChecks;
+
+			const double VolumeError = std::fabs(Volume - Expected.Volume) / VolumeScale;
+
+			// Centroid means nothing for (almost) dry body
+			double CentroidError = 0.0;
+			if (Expected.Volume > 1e-3 * VolumeScale)
+			{
+				for (int32_t i = 0; i < 3; ++i)
+				{
+					CentroidError = std::max(CentroidError, std::fabs(Centroid[i] - Expected.Centroid[i]) / LengthScale);
+				}
+			}
+
+			Stats.MaxVolumeError = std::max(Stats.MaxVolumeError, VolumeError);
+			Stats.MaxCentroidError = std::max(Stats.MaxCentroidError, CentroidError);
+
+			if (VolumeError > VolumeTolerance || CentroidError > CentroidTolerance || Volume != Volume)
+			{
+				Stats.bPassed = false;
+			}
+		}
+
+		int32_t Report()
+		{
+			printf("%-28s %6s %12s %12s %12s  %s\n", "case", "checks", "volume err", "centroid err", "ns/call", "result");
+
+			for (const FCaseStats& Stats : Cases)
+			{
+				const char* Result = Stats.bPassed ? "ok" : (Stats.bKnownIssue ? "KNOWN ISSUE" : "FAILED");
+				printf("%-28s %6d %12.3e %12.3e %12.1f  %s\n", Stats.Name, Stats.NumChecks, Stats.MaxVolumeError, Stats.MaxCentroidError,
+					Stats.NumCalls > 0 ? Stats.TotalNs / Stats.NumCalls : 0.0, Result);
+
+				if (!Stats.bPassed && !Stats.bKnownIssue)
+				{
+					++NumFailed;
+				}
+			}
+
+			printf("%d of %d cases failed\n", NumFailed, static_cast<int32_t>(Cases.size()));
+
+			return NumFailed;
+		}
+
+	private:
+
+		std::vector<FCaseStats> Cases;
+		std::vector<float> Depths;
+		int32_t NumFailed;
+		volatile float Sink;
+	};
+
+	const double BoxTolerance = 1e-4;
+	const double SphereTolerance = 5e-3;
+
+	void ValidateBox(FValidation& Validation)
+	{
+		const FVec3 Extent(200.0f, 100.0f, 50.0f);
+		const SyntheticHulls::FHullMesh Box = SyntheticHulls::MakeBox(Extent, 4);
+		const FMeshView Mesh = Box.GetView();
+		const double BoxVolume = 8.0 * Extent.X * Extent.Y * Extent.Z;
+		const FVec3 Up(0.0f, 0.0f, 1.0f);
+
+		FVec3 Centroid;
+		float Volume;
+
+		Validation.BeginCase("box fully above");
+		for (float Offset = -300.0f; Offset < -50.0f; Offset += 25.0f)
+		{
+			Volume = Validation.Submerged(Mesh, Up, Offset, Centroid);
+			Validation.Check(Volume, Centroid, AnalyticBox(Extent, Up, Offset), BoxVolume, Extent.X, BoxTolerance, BoxTolerance);
+		}
+
+		Validation.BeginCase("box fully below");
+		for (float Offset = 50.5f; Offset < 300.0f; Offset += 25.0f)
+		{
+			Volume = Validation.Submerged(Mesh, Up, Offset, Centroid);
+			Validation.Check(Volume, Centroid, AnalyticBox(Extent, Up, Offset), BoxVolume, Extent.X, BoxTolerance, BoxTolerance);
+		}
+
+		Validation.BeginCase("box partial");
+		for (float Offset = -45.0f; Offset < 50.0f; Offset += 7.3f)
+		{
+			Volume = Validation.Submerged(Mesh, Up, Offset, Centroid);
+			Validation.Check(Volume, Centroid, AnalyticBox(Extent, Up, Offset), BoxVolume, Extent.X, BoxTolerance, BoxTolerance);
+		}
+
+		// Plane exactly through a row of vertices
+		Validation.BeginCase("box plane on vertices");
+		for (float Offset = -50.0f; Offset <= 50.0f; Offset += 25.0f)
+		{
+			Volume = Validation.Submerged(Mesh, Up, Offset, Centroid);
+			Validation.Check(Volume, Centroid, AnalyticBox(Extent, Up, Offset), BoxVolume, Extent.X, BoxTolerance, BoxTolerance);
+		}
+	}
+
+	void ValidateTiltedCube(FValidation& Validation)
+	{
+		const FVec3 Extent(100.0f, 100.0f, 100.0f);
+		const SyntheticHulls::FHullMesh Cube = SyntheticHulls::MakeBox(Extent, 2);
+		const FMeshView Mesh = Cube.GetView();
+		const double CubeVolume = 8.0 * Extent.X * Extent.Y * Extent.Z;
+
+		srand(42);
+
+		// Arbitrary plane orientations relative to cube are the same as tilted cube in flat water
+		Validation.BeginCase("tilted cube");
+		for (int32_t i = 0; i < 256; ++i)
+		{
+			const FVec3 Normal = RandomNormal();
+			const float Offset = RandomRange(-180.0f, 180.0f);
+
+			FVec3 Centroid;
+			const float Volume = Validation.Submerged(Mesh, Normal, Offset, Centroid);
+			Validation.Check(Volume, Centroid, AnalyticBox(Extent, Normal, Offset), CubeVolume, Extent.X, BoxTolerance, BoxTolerance);
+		}
+
+		// Whole solve with rotated body and flat water, checks rotation and offset conventions of SolveBody
+		Validation.BeginCase("tilted cube solve");
+		for (int32_t i = 0; i < 64; ++i)
+		{
+			FBodyState State;
+			State.Rotation = FQuat::FromAxisAngle(RandomNormal(), RandomRange(0.0f, 6.28f));
+			State.Location = FVec3(RandomRange(-1000.0f, 1000.0f), RandomRange(-1000.0f, 1000.0f), RandomRange(-150.0f, 150.0f));
+			State.CenterOfMass = State.Location;
+			State.Mass = 100.0f;
+
+			const FBodyParams Body(static_cast<float>(CubeVolume), 500.0f, 2.0f * Extent.X);
+
+			const float WaterZ = RandomRange(-50.0f, 50.0f);
+			FVec3 SurfacePoints[4];
+			for (int32_t p = 0; p < 4; ++p)
+			{
+				SurfacePoints[p] = FVec3(State.Location.X + ((p & 1) ? 100.0f : -100.0f), State.Location.Y + ((p & 2) ? 100.0f : -100.0f), WaterZ);
+			}
+
+			FForces Forces;
+			const float Volume = Validation.Solve(Mesh, State, Body, SurfacePoints, 4, Forces);
+
+			const FVec3 LocalNormal = State.Rotation.Inverse().RotateVector(FVec3(0.0f, 0.0f, 1.0f));
+			FAnalyticResult Expected = AnalyticBox(Extent, LocalNormal, WaterZ - State.Location.Z);
+
+			// Expected world centroid is where force is applied
+			const FVec3 WorldCentroid = State.Location + State.Rotation.RotateVector(FVec3((float)Expected.Centroid[0], (float)Expected.Centroid[1], (float)Expected.Centroid[2]));
+			Expected.Centroid[0] = WorldCentroid.X;
+			Expected.Centroid[1] = WorldCentroid.Y;
+			Expected.Centroid[2] = WorldCentroid.Z;
+
+			Validation.Check(Volume, Volume > 0.0f ? Forces.ForceLocation : FVec3(), Expected, CubeVolume, Extent.X, BoxTolerance, BoxTolerance);
+		}
+	}
+
+	void ValidateSphere(FValidation& Validation)
+	{
+		const float Radius = 100.0f;
+		const SyntheticHulls::FHullMesh Sphere = SyntheticHulls::MakeSphere(Radius, 20000);
+		const FMeshView Mesh = Sphere.GetView();
+
+		// Tessellated sphere is smaller than real one, compare fractions of volume
+		FVec3 MeshCentroid;
+		const double MeshVolume = ComputeVolume(Mesh, MeshCentroid);
+		const double SphereVolume = 4.0 / 3.0 * Pi * Radius * Radius * Radius;
+
+		srand(7);
+
+		Validation.BeginCase("sphere");
+		for (int32_t i = 0; i < 64; ++i)
+		{
+			const FVec3 Normal = RandomNormal();
+			const float Offset = RandomRange(-120.0f, 120.0f);
+
+			FVec3 Centroid;
+			const float Volume = Validation.Submerged(Mesh, Normal, Offset, Centroid);
+
+			FAnalyticResult Expected = AnalyticSphere(Radius, Normal, Offset);
+			Expected.Volume *= MeshVolume / SphereVolume;
+
+			Validation.Check(Volume, Centroid, Expected, MeshVolume, Radius, SphereTolerance, SphereTolerance);
+		}
+	}
+
+	void ValidateDegenerateTriangles(FValidation& Validation)
+	{
+		const FVec3 Extent(100.0f, 100.0f, 100.0f);
+		SyntheticHulls::FHullMesh Cube = SyntheticHulls::MakeBox(Extent, 2);
+		const double CubeVolume = 8.0 * Extent.X * Extent.Y * Extent.Z;
+
+		// Zero area triangles: repeated index, collinear vertices and duplicated vertex at same location
+		const int32_t NumTriangles = Cube.NumTriangles();
+		for (int32_t i = 0; i < NumTriangles; ++i)
+		{
+			const int32_t I0 = Cube.Indices[i * 3 + 0];
+			const int32_t I1 = Cube.Indices[i * 3 + 1];
+			Cube.AddTriangle(I0, I0, I1);
+
+			const int32_t Duplicate = Cube.AddVertex(FVec3(Cube.VertexX[I1], Cube.VertexY[I1], Cube.VertexZ[I1]));
+			Cube.AddTriangle(I0, I1, Duplicate);
+		}
+
+		const int32_t Start = Cube.AddVertex(FVec3(-100.0f, -100.0f, -100.0f));
+		const int32_t Middle = Cube.AddVertex(FVec3(0.0f, 0.0f, 0.0f));
+		const int32_t End = Cube.AddVertex(FVec3(100.0f, 100.0f, 100.0f));
+		Cube.AddTriangle(Start, Middle, End);
+
+		const FMeshView Mesh = Cube.GetView();
+
+		srand(3);
+
+		Validation.BeginCase("degenerate triangles");
+		for (int32_t i = 0; i < 64; ++i)
+		{
+			const FVec3 Normal = RandomNormal();
+			const float Offset = RandomRange(-180.0f, 180.0f);
+
+			FVec3 Centroid;
+			const float Volume = Validation.Submerged(Mesh, Normal, Offset, Centroid);
+			Validation.Check(Volume, Centroid, AnalyticBox(Extent, Normal, Offset), CubeVolume, Extent.X, BoxTolerance, BoxTolerance);
+		}
+	}
+
+	/* Body rotated 90 degrees around X or Y, surface points are made the same way as GetTransformedTestPoints does it.
+	 * Rotated test points collapse into a line, so slope of sloped water across the line can't be observed
+	 * and expected water is the most horizontal plane containing the sampled line.
+	 */
+	void ValidateRotated90(FValidation& Validation, bool bSlopedWater)
+	{
+		const FVec3 Extent(200.0f, 100.0f, 50.0f);
+		const SyntheticHulls::FHullMesh Box = SyntheticHulls::MakeBox(Extent, 2);
+		const FMeshView Mesh = Box.GetView();
+		const double BoxVolume = 8.0 * Extent.X * Extent.Y * Extent.Z;
+
+		const FVec3 Offsets[9] =
+		{
+			FVec3(Extent.X, -Extent.Y, 0.0f), FVec3(Extent.X, 0.0f, 0.0f), FVec3(Extent.X, Extent.Y, 0.0f),
+			FVec3(0.0f, -Extent.Y, 0.0f), FVec3(0.0f, 0.0f, 0.0f), FVec3(0.0f, Extent.Y, 0.0f),
+			FVec3(-Extent.X, -Extent.Y, 0.0f), FVec3(-Extent.X, 0.0f, 0.0f), FVec3(-Extent.X, Extent.Y, 0.0f)
+		};
+
+		// Gentle slope of water surface along X and Y
+		const FVec3 WaterNormal = bSlopedWater ? FVec3(-0.1f, 0.05f, 1.0f).GetSafeNormal() : FVec3(0.0f, 0.0f, 1.0f);
+
+		Validation.BeginCase(bSlopedWater ? "rotated 90 sloped water" : "rotated 90 flat water");
+
+		const FVec3 Axes[2] = { FVec3(1.0f, 0.0f, 0.0f), FVec3(0.0f, 1.0f, 0.0f) };
+		for (int32_t Axis = 0; Axis < 2; ++Axis)
+		{
+			// Test points along rotation axis stay horizontal, the rest end up above each other
+			const FVec3 SlopeAlongLine = Axes[Axis] * FVec3::Dot(Axes[Axis], FVec3(-WaterNormal.X / WaterNormal.Z, -WaterNormal.Y / WaterNormal.Z, 0.0f));
+			const FVec3 FittedNormal = FVec3(-SlopeAlongLine.X, -SlopeAlongLine.Y, 1.0f).GetSafeNormal();
+
+			for (float Angle = -90.0f; Angle <= 90.0f; Angle += 180.0f)
+			{
+				for (float Height = -80.0f; Height <= 80.0f; Height += 40.0f)
+				{
+					FBodyState State;
+					State.Rotation = FQuat::FromAxisAngle(Axes[Axis], Angle * 3.14159265f / 180.0f);
+					State.Location = FVec3(0.0f, 0.0f, Height);
+					State.CenterOfMass = State.Location;
+					State.Mass = 100.0f;
+
+					const FBodyParams Body(static_cast<float>(BoxVolume), 500.0f, 2.0f * Extent.X);
+
+					FVec3 SurfacePoints[9];
+					for (int32_t p = 0; p < 9; ++p)
+					{
+						SurfacePoints[p] = State.Location + State.Rotation.RotateVector(Offsets[p]);
+						SurfacePoints[p].Z = -(WaterNormal.X * SurfacePoints[p].X + WaterNormal.Y * SurfacePoints[p].Y) / WaterNormal.Z;
+					}
+
+					FForces Forces;
+					const float Volume = Validation.Solve(Mesh, State, Body, SurfacePoints, 9, Forces);
+
+					// Water plane goes through world origin, in mesh space it is offset by body location
+					const FVec3 LocalNormal = State.Rotation.Inverse().RotateVector(FittedNormal);
+					const FAnalyticResult Expected = AnalyticBox(Extent, LocalNormal, -FVec3::Dot(FittedNormal, State.Location));
+
+					FAnalyticResult ExpectedWorld = Expected;
+					const FVec3 WorldCentroid = State.Location + State.Rotation.RotateVector(FVec3((float)Expected.Centroid[0], (float)Expected.Centroid[1], (float)Expected.Centroid[2]));
+					ExpectedWorld.Centroid[0] = WorldCentroid.X;
+					ExpectedWorld.Centroid[1] = WorldCentroid.Y;
+					ExpectedWorld.Centroid[2] = WorldCentroid.Z;
+
+					Validation.Check(Volume, Volume > 0.0f ? Forces.ForceLocation : FVec3(), ExpectedWorld, BoxVolume, Extent.X, BoxTolerance, BoxTolerance);
+				}
+			}
+		}
+	}
+
+	/* Wave surface clipping with flat water must match plane clipping, both with heights per vertex and from grid */
+	void ValidateWaveSurface(FValidation& Validation)
+	{
+		const FVec3 Extent(100.0f, 100.0f, 100.0f);
+		const SyntheticHulls::FHullMesh Cube = SyntheticHulls::MakeBox(Extent, 2);
+		const FMeshView Mesh = Cube.GetView();
+		const double CubeVolume = 8.0 * Extent.X * Extent.Y * Extent.Z;
+
+		std::vector<float> WorldX(Mesh.NumVertices), WorldY(Mesh.NumVertices), WorldZ(Mesh.NumVertices);
+		std::vector<float> Surface(Mesh.NumVertices);
+		std::vector<float> Depths(Mesh.NumVertices);
+		std::vector<float> GridHeights(5 * 5);
+
+		srand(5);
+
+		Validation.BeginCase("wave surface flat");
+		for (int32_t i = 0; i < 64; ++i)
+		{
+			FBodyState State;
+			State.Rotation = FQuat::FromAxisAngle(RandomNormal(), RandomRange(0.0f, 6.28f));
+			State.Location = FVec3(RandomRange(-1000.0f, 1000.0f), RandomRange(-1000.0f, 1000.0f), RandomRange(-150.0f, 150.0f));
+			State.CenterOfMass = State.Location;
+			State.Mass = 100.0f;
+
+			const FBodyParams Body(static_cast<float>(CubeVolume), 500.0f, 2.0f * Extent.X);
+
+			const float WaterZ = RandomRange(-50.0f, 50.0f);
+
+			TransformVertices(Mesh, State.Rotation, State.CenterOfMass, WorldX.data(), WorldY.data(), WorldZ.data());
+
+			const bool bUseGrid = (i & 1) != 0;
+			if (bUseGrid)
+			{
+				std::fill(GridHeights.begin(), GridHeights.end(), WaterZ);
+				const FHeightGrid Grid = FHeightGrid::FromBounds(State.Location.X - 200.0f, State.Location.Y - 200.0f, State.Location.X + 200.0f, State.Location.Y + 200.0f, 5, 5, GridHeights.data());
+				ComputeSurfaceDepths(WorldX.data(), WorldY.data(), WorldZ.data(), Mesh.NumVertices, Grid, Depths.data());
+			}
+			else
+			{
+				std::fill(Surface.begin(), Surface.end(), WaterZ);
+				ComputeSurfaceDepths(WorldZ.data(), Surface.data(), Mesh.NumVertices, Depths.data());
+			}
+
+			FForces Forces;
+			const float Volume = Validation.Timed(Mesh.NumTriangles, [&]() { return SolveBodySurface(Mesh, State, Body, FWaterParams(), Depths.data(), Forces); });
+
+			const FVec3 LocalNormal = State.Rotation.Inverse().RotateVector(FVec3(0.0f, 0.0f, 1.0f));
+			FAnalyticResult Expected = AnalyticBox(Extent, LocalNormal, WaterZ - State.Location.Z);
+
+			const FVec3 WorldCentroid = State.Location + State.Rotation.RotateVector(FVec3((float)Expected.Centroid[0], (float)Expected.Centroid[1], (float)Expected.Centroid[2]));
+			Expected.Centroid[0] = WorldCentroid.X;
+			Expected.Centroid[1] = WorldCentroid.Y;
+			Expected.Centroid[2] = WorldCentroid.Z;
+
+			Validation.Check(Volume, Volume > 0.0f ? Forces.ForceLocation : FVec3(), Expected, CubeVolume, Extent.X, BoxTolerance, BoxTolerance);
+		}
+	}
+
+	/* Bodies culled by broad phase must get the same result as full solve: nothing when dry, whole volume when submerged */
+	void ValidateBroadPhase(FValidation& Validation)
+	{
+		const SyntheticHulls::FHullMesh Ship = SyntheticHulls::MakeShip(1200.0f, 300.0f, 150.0f, 4000);
+		const FMeshView Mesh = Ship.GetView();
+
+		FVec3 MeshCentroid;
+		const float ShipVolume = ComputeVolume(Mesh, MeshCentroid);
+
+		FVec3 BoundsMin(1e30f, 1e30f, 1e30f);
+		FVec3 BoundsMax(-1e30f, -1e30f, -1e30f);
+		for (int32_t i = 0; i < Mesh.NumVertices; ++i)
+		{
+			for (int32_t Axis = 0; Axis < 3; ++Axis)
+			{
+				BoundsMin[Axis] = std::min(BoundsMin[Axis], Mesh.GetVertex(i)[Axis]);
+				BoundsMax[Axis] = std::max(BoundsMax[Axis], Mesh.GetVertex(i)[Axis]);
+			}
+		}
+
+		std::vector<float> Depths(Mesh.NumVertices);
+		int32_t NumPhases[3] = { 0, 0, 0 };
+
+		srand(13);
+
+		Validation.BeginCase("broad phase");
+		for (int32_t i = 0; i < 256; ++i)
+		{
+			FBodyState State;
+			State.Rotation = FQuat::FromAxisAngle(RandomNormal(), RandomRange(0.0f, 6.28f));
+			State.Location = FVec3(RandomRange(-1000.0f, 1000.0f), RandomRange(-1000.0f, 1000.0f), RandomRange(-1200.0f, 1200.0f));
+			State.CenterOfMass = State.Location;
+			State.Mass = 100.0f;
+
+			const FBodyParams Body(ShipVolume, 500.0f, 1200.0f);
+
+			const float WaterZ = RandomRange(-100.0f, 100.0f);
+			FVec3 SurfacePoints[4];
+			for (int32_t p = 0; p < 4; ++p)
+			{
+				SurfacePoints[p] = FVec3(State.Location.X + ((p & 1) ? 600.0f : -600.0f), State.Location.Y + ((p & 2) ? 150.0f : -150.0f), WaterZ);
+			}
+
+			FForces Forces;
+			const float Volume = SolveBody(Mesh, State, Body, FWaterParams(), SurfacePoints, 4, Depths.data(), Forces);
+
+			FAnalyticResult Expected;
+			Expected.Volume = Volume;
+			Expected.Centroid[0] = Forces.ForceLocation.X;
+			Expected.Centroid[1] = Forces.ForceLocation.Y;
+			Expected.Centroid[2] = Forces.ForceLocation.Z;
+
+			float MinZ, MaxZ;
+			ComputeVerticalExtent(BoundsMin, BoundsMax, State.Rotation, State.CenterOfMass, MinZ, MaxZ);
+			const EBodyPhase Phase = ClassifyBody(MinZ, MaxZ, WaterZ, WaterZ);
+
+			++NumPhases[static_cast<int32_t>(Phase)];
+
+			// Time is what body pays with broad phase in front of solve
+			FForces CulledForces;
+			const float CulledVolume = Validation.Timed(Mesh.NumTriangles, [&]()
+			{
+				float BodyMinZ, BodyMaxZ;
+				ComputeVerticalExtent(BoundsMin, BoundsMax, State.Rotation, State.CenterOfMass, BodyMinZ, BodyMaxZ);
+
+				switch (ClassifyBody(BodyMinZ, BodyMaxZ, WaterZ, WaterZ))
+				{
+				case EBodyPhase::Dry:
+					CulledForces = FForces();
+					return 0.0f;
+
+				case EBodyPhase::Submerged:
+					return SolveBodySubmerged(State, Body, FWaterParams(), MeshCentroid, CulledForces);
+
+				default:
+					return SolveBody(Mesh, State, Body, FWaterParams(), SurfacePoints, 4, Depths.data(), CulledForces);
+				}
+			});
+
+			Validation.Check(CulledVolume, CulledVolume > 0.0f ? CulledForces.ForceLocation : FVec3(), Expected, ShipVolume, 600.0f, BoxTolerance, BoxTolerance);
+		}
+
+		printf("broad phase: %d dry, %d submerged, %d crossing\n", NumPhases[0], NumPhases[1], NumPhases[2]);
+	}
+
+	/* Held volume with waterplane spring must follow full solve of wall sided box, where volume is linear in depth */
+	void ValidateHeldSpring(FValidation& Validation)
+	{
+		const FVec3 Extent(200.0f, 100.0f, 50.0f);
+		const SyntheticHulls::FHullMesh Box = SyntheticHulls::MakeBox(Extent, 2);
+		const FMeshView Mesh = Box.GetView();
+		const double BoxVolume = 8.0 * Extent.X * Extent.Y * Extent.Z;
+
+		std::vector<float> Depths(Mesh.NumVertices);
+
+		srand(17);
+
+		Validation.BeginCase("held spring");
+		for (int32_t i = 0; i < 64; ++i)
+		{
+			FBodyState State;
+			State.Rotation = FQuat::FromAxisAngle(FVec3(0.0f, 0.0f, 1.0f), RandomRange(0.0f, 6.28f));
+			State.Location = FVec3(RandomRange(-1000.0f, 1000.0f), RandomRange(-1000.0f, 1000.0f), 0.0f);
+			State.CenterOfMass = State.Location;
+			State.Mass = 100.0f;
+
+			const FBodyParams Body(static_cast<float>(BoxVolume), 500.0f, 2.0f * Extent.X);
+
+			// Rest with water line between 10 and 90 percent of height
+			const float RestDraft = RandomRange(-0.8f, 0.8f) * Extent.Z;
+			FVec3 SurfacePoints[4];
+			for (int32_t p = 0; p < 4; ++p)
+			{
+				SurfacePoints[p] = FVec3(State.Location.X + ((p & 1) ? 200.0f : -200.0f), State.Location.Y + ((p & 2) ? 100.0f : -100.0f), RestDraft);
+			}
+
+			FForces RestForces;
+			const float RestVolume = SolveBody(Mesh, State, Body, FWaterParams(), SurfacePoints, 4, Depths.data(), RestForces);
+			const FVec3 LocalCentroid = State.Rotation.Inverse().RotateVector(RestForces.ForceLocation - State.CenterOfMass);
+
+			const float WaterplaneArea = Validation.Timed(Mesh.NumTriangles, [&]() { return ComputeWaterplaneArea(Mesh, FVec3(0.0f, 0.0f, 1.0f), RestDraft, 2.0f, Depths.data()); });
+
+			// Move body by up to 10 percent of height and compare volume, centroid is held so it isn't checked
+			const float DepthChange = RandomRange(-0.1f, 0.1f) * Extent.Z;
+			State.CenterOfMass.Z -= DepthChange;
+			State.Location.Z -= DepthChange;
+
+			FForces Forces;
+			FAnalyticResult Expected;
+			Expected.Volume = SolveBody(Mesh, State, Body, FWaterParams(), SurfacePoints, 4, Depths.data(), Forces);
+			Expected.Centroid[0] = Expected.Centroid[1] = Expected.Centroid[2] = 0.0;
+
+			FForces HeldForces;
+			const float HeldVolume = SolveBodyHeld(State, Body, FWaterParams(), RestVolume, LocalCentroid, WaterplaneArea, DepthChange, HeldForces);
+
+			Validation.Check(HeldVolume, FVec3(), Expected, BoxVolume, Extent.X, BoxTolerance, BoxTolerance);
+		}
+	}
+
+	/* Points sampled from known water plane for plane fit cases */
+	struct FPlaneSamples
+	{
+		std::vector<FVec3> Points;
+
+		/* Plane fit is expected to find, most horizontal one when points can't tell the slope */
+		FVec3 Normal;
+
+		/* Height of expected plane at world origin */
+		float Height;
+
+		/* Height of expected plane at X, Y */
+		float GetHeight(float X, float Y) const
+		{
+			return Height - (Normal.X * X + Normal.Y * Y) / Normal.Z;
+		}
+	};
+
+	/* Random planes sampled at NumPoints random points around random center
+	 *	@param Noise					Max random height error added to every point
+	 */
+	std::vector<FPlaneSamples> MakePlaneSamples(int32_t NumSets, float Noise)
+	{
+		std::vector<FPlaneSamples> Sets(NumSets);
+
+		for (FPlaneSamples& Set : Sets)
+		{
+			do
+			{
+				Set.Normal = RandomNormal();
+			}
+			while (std::fabs(Set.Normal.Z) < 0.3f);
+
+			Set.Normal = Set.Normal.Z < 0.0f ? Set.Normal * -1.0f : Set.Normal;
+			Set.Height = RandomRange(-200.0f, 200.0f);
+
+			const float CenterX = RandomRange(-2000.0f, 2000.0f);
+			const float CenterY = RandomRange(-2000.0f, 2000.0f);
+
+			const int32_t NumPoints = 4 + rand() % 61;
+			for (int32_t p = 0; p < NumPoints; ++p)
+			{
+				const float X = CenterX + RandomRange(-1000.0f, 1000.0f);
+				const float Y = CenterY + RandomRange(-1000.0f, 1000.0f);
+				const float Z = Set.GetHeight(X, Y) + RandomRange(-Noise, Noise);
+				Set.Points.push_back(FVec3(X, Y, Z));
+			}
+		}
+
+		return Sets;
+	}
+
+	/* Points on a horizontal line and coincident points, where only slope along the line can be found */
+	std::vector<FPlaneSamples> MakeDegeneratePlaneSamples(int32_t NumSets)
+	{
+		std::vector<FPlaneSamples> Sets(NumSets);
+
+		for (int32_t i = 0; i < NumSets; ++i)
+		{
+			FPlaneSamples& Set = Sets[i];
+
+			const float Angle = RandomRange(0.0f, 2.0f * (float)Pi);
+			const float DirX = std::cos(Angle);
+			const float DirY = std::sin(Angle);
+
+			const int32_t NumPoints = 1 + rand() % 9;
+
+			// Every fourth set has all points at the same XY, single point can't give any slope either
+			const bool bSinglePoint = (i % 4 == 0) || NumPoints == 1;
+			const float Spacing = bSinglePoint ? 0.0f : RandomRange(10.0f, 300.0f);
+			const float Slope = bSinglePoint ? 0.0f : RandomRange(-0.5f, 0.5f);
+			const float CenterX = RandomRange(-2000.0f, 2000.0f);
+			const float CenterY = RandomRange(-2000.0f, 2000.0f);
+			const float CenterZ = RandomRange(-200.0f, 200.0f);
+
+			for (int32_t p = 0; p < NumPoints; ++p)
+			{
+				const float Along = (p - 0.5f * (NumPoints - 1)) * Spacing;
+				Set.Points.push_back(FVec3(CenterX + DirX * Along, CenterY + DirY * Along, CenterZ + Slope * Along));
+			}
+
+			Set.Normal = FVec3(-Slope * DirX, -Slope * DirY, 1.0f).GetSafeNormal();
+			Set.Height = CenterZ - Slope * (DirX * CenterX + DirY * CenterY);
+		}
+
+		return Sets;
+	}
+
+	/* Fit plane to every set and compare with expected one. Height at fitted plane location is recorded
+	 * as volume error (relative to size of sampled area) and normal as centroid error.
+	 */
+	template <typename FitFunctionType>
+	void CheckPlaneFit(FValidation& Validation, const std::vector<FPlaneSamples>& Sets, double Tolerance, FitFunctionType FitFunction)
+	{
+		for (const FPlaneSamples& Set : Sets)
+		{
+			const int32_t NumPoints = static_cast<int32_t>(Set.Points.size());
+
+			FWaterPlane Plane;
+			Validation.Timed(NumPoints, [&]() { Plane = FitFunction(Set.Points.data(), NumPoints); return Plane.Normal.Z; });
+
+			FAnalyticResult Expected;
+			Expected.Volume = Set.GetHeight(Plane.Location.X, Plane.Location.Y);
+			Expected.Centroid[0] = Set.Normal.X;
+			Expected.Centroid[1] = Set.Normal.Y;
+			Expected.Centroid[2] = Set.Normal.Z;
+
+			Validation.Check(Plane.Location.Z, Plane.Normal, Expected, 1000.0, 1.0, Tolerance, Tolerance);
+		}
+	}
+
+	/* Closed form plane fit on exact, noisy and degenerate samples, and original fit on the same samples for comparison */
+	void ValidatePlaneFit(FValidation& Validation)
+	{
+		srand(13);
+
+		const std::vector<FPlaneSamples> ExactSets = MakePlaneSamples(64, 0.0f);
+		const std::vector<FPlaneSamples> NoisySets = MakePlaneSamples(64, 2.0f);
+		const std::vector<FPlaneSamples> DegenerateSets = MakeDegeneratePlaneSamples(64);
+
+		// Original normal isn't oriented, flip it up so only fit itself is compared
+		auto ReferenceFit = [](const FVec3* Points, int32_t NumPoints)
+		{
+			FWaterPlane Plane = ReferenceBuoyancy::FitPlane(Points, NumPoints);
+			Plane.Normal = Plane.Normal.Z < 0.0f ? Plane.Normal * -1.0f : Plane.Normal;
+			return Plane;
+		};
+
+		Validation.BeginCase("plane fit exact");
+		CheckPlaneFit(Validation, ExactSets, 1e-4, FitPlane);
+
+		Validation.BeginCase("plane fit noisy");
+		CheckPlaneFit(Validation, NoisySets, 5e-3, FitPlane);
+
+		Validation.BeginCase("plane fit degenerate");
+		CheckPlaneFit(Validation, DegenerateSets, 1e-4, FitPlane);
+
+		// Covariance of exact plane is singular, original fit returns default plane or inverts rounding noise
+		Validation.BeginCase("reference fit exact", true);
+		CheckPlaneFit(Validation, ExactSets, 1e-4, ReferenceFit);
+
+		Validation.BeginCase("reference fit noisy");
+		CheckPlaneFit(Validation, NoisySets, 5e-3, ReferenceFit);
+
+		// Original fit returns horizontal plane for collinear points
+		Validation.BeginCase("reference fit degenerate", true);
+		CheckPlaneFit(Validation, DegenerateSets, 1e-4, ReferenceFit);
+	}
+
+	/* Footprint of mesh and clipping points generated from it
+	 *	@param OutPoints	(out)		Generated points
+	 */
+	void MakeClippingPoints(const FMeshView& Mesh, float Spacing, int32_t MaxPoints, std::vector<FVec3>& OutFootprint, std::vector<FVec3>& OutPoints)
+	{
+		std::vector<int32_t> Order(Mesh.NumVertices);
+		OutFootprint.resize(2 * Mesh.NumVertices);
+		OutFootprint.resize(ComputeFootprint(Mesh, Order.data(), OutFootprint.data()));
+
+		OutPoints.resize(MaxPoints);
+		OutPoints.resize(GenerateClippingPoints(OutFootprint.data(), static_cast<int32_t>(OutFootprint.size()), Spacing, MaxPoints, OutPoints.data()));
+	}
+
+	/* Height of single long crested wave */
+	float GetWaveHeight(const FVec3& Point, float WaveLength, float Amplitude)
+	{
+		return Amplitude * std::sin(2.0f * (float)Pi * (0.8f * Point.X + 0.6f * Point.Y) / WaveLength + 0.3f);
+	}
+
+	/* Generated clipping points: box with no wave length must get the original 3 x 3 layout, ship and debris
+	 * must fit waves close to dense sampling of whole footprint with far fewer points
+	 */
+	void ValidateClippingPoints(FValidation& Validation)
+	{
+		std::vector<FVec3> Footprint;
+		std::vector<FVec3> Points;
+
+		{
+			const FVec3 Extent(200.0f, 100.0f, 50.0f);
+			const SyntheticHulls::FHullMesh Box = SyntheticHulls::MakeBox(Extent, 2);
+			const FMeshView Mesh = Box.GetView();
+
+			Validation.BeginCase("clipping points box");
+			Validation.Timed(Mesh.NumTriangles, [&]() { MakeClippingPoints(Mesh, 0.0f, 32, Footprint, Points); return (float)Points.size(); });
+
+			// Every original point must be generated, volume error is number of missing points
+			int32_t NumMissing = static_cast<int32_t>(Footprint.size()) == 4 && Points.size() == 9 ? 0 : 9;
+			for (int32_t x = -1; x <= 1; ++x)
+			{
+				for (int32_t y = -1; y <= 1; ++y)
+				{
+					const FVec3 Original(x * Extent.X, y * Extent.Y, 0.0f);
+
+					bool bFound = false;
+					for (const FVec3& Point : Points)
+					{
+						bFound = bFound || FVec3::DistSquared(Point, Original) < 1e-6f;
+					}
+
+					NumMissing += bFound ? 0 : 1;
+				}
+			}
+
+			FAnalyticResult Expected;
+			Expected.Volume = 0.0;
+			Expected.Centroid[0] = Expected.Centroid[1] = Expected.Centroid[2] = 0.0;
+			Validation.Check((float)NumMissing, FVec3(), Expected, 1.0, 1.0, 0.0, 0.0);
+		}
+
+		struct FHullCase
+		{
+			const char* Name;
+			SyntheticHulls::FHullMesh Hull;
+			float Length;
+		};
+
+		const FHullCase Hulls[2] =
+		{
+			{ "clipping points ship", SyntheticHulls::MakeShip(6000.0f, 1000.0f, 400.0f, 4000), 6000.0f },
+			{ "clipping points debris", SyntheticHulls::MakeBox(FVec3(20.0f, 10.0f, 10.0f), 1), 40.0f }
+		};
+
+		const float WaveLengths[4] = { 800.0f, 2000.0f, 5000.0f, 20000.0f };
+		const float Amplitude = 100.0f;
+		const int32_t MaxPoints = 32;
+
+		for (const FHullCase& HullCase : Hulls)
+		{
+			const FMeshView Mesh = HullCase.Hull.GetView();
+
+			Validation.BeginCase(HullCase.Name);
+
+			for (float WaveLength : WaveLengths)
+			{
+				Validation.Timed(Mesh.NumTriangles, [&]() { MakeClippingPoints(Mesh, WaveLength / 4.0f, MaxPoints, Footprint, Points); return (float)Points.size(); });
+
+				// Dense sampling of footprint is what few generated points should come close to
+				std::vector<FVec3> Dense;
+				const std::vector<FVec3> DenseFootprint = Footprint;
+				Dense.resize(1024);
+				Dense.resize(GenerateClippingPoints(DenseFootprint.data(), static_cast<int32_t>(DenseFootprint.size()), HullCase.Length / 40.0f, 1024, Dense.data()));
+
+				for (FVec3& Point : Dense)
+				{
+					Point.Z = GetWaveHeight(Point, WaveLength, Amplitude);
+				}
+
+				float MaxOutside = 0.0f;
+				for (FVec3& Point : Points)
+				{
+					MaxOutside = std::max(MaxOutside, std::sqrt(FVec3::DistSquared(Point, ClampToFootprint(DenseFootprint.data(), static_cast<int32_t>(DenseFootprint.size()), Point))));
+					Point.Z = GetWaveHeight(Point, WaveLength, Amplitude);
+				}
+
+				const FWaterPlane DensePlane = FitPlane(Dense.data(), static_cast<int32_t>(Dense.size()));
+				const FWaterPlane Plane = FitPlane(Points.data(), static_cast<int32_t>(Points.size()));
+
+				// Heights of both planes at mesh origin, relative to amplitude, and their normals
+				FAnalyticResult Expected;
+				Expected.Volume = DensePlane.Location.Z + (DensePlane.Normal.X * DensePlane.Location.X + DensePlane.Normal.Y * DensePlane.Location.Y) / DensePlane.Normal.Z;
+				Expected.Centroid[0] = DensePlane.Normal.X;
+				Expected.Centroid[1] = DensePlane.Normal.Y;
+				Expected.Centroid[2] = DensePlane.Normal.Z;
+
+				const float Height = Plane.Location.Z + (Plane.Normal.X * Plane.Location.X + Plane.Normal.Y * Plane.Location.Y) / Plane.Normal.Z;
+
+				const bool bValidCount = Points.size() >= 4 && Points.size() <= (size_t)MaxPoints;
+				Validation.Check(bValidCount && MaxOutside < 1e-3f ? Height : NAN, Plane.Normal, Expected, Amplitude, 1.0, 0.1, 0.02);
+
+				printf("%s: wave length %.0f, %d points\n", HullCase.Name, WaveLength, static_cast<int32_t>(Points.size()));
+			}
+		}
+	}
+
+	/* Buffers of incremental volume state for single mesh */
+	struct FIncrementalBuffers
+	{
+		std::vector<int32_t> AdjacencyStart;
+		std::vector<int32_t> AdjacencyTriangles;
+		std::vector<int8_t> VertexSigns;
+		std::vector<uint8_t> TriangleClasses;
+		std::vector<int32_t> CrossingTriangles;
+		std::vector<int32_t> CrossingSlots;
+		std::vector<int32_t> Queue;
+
+		explicit FIncrementalBuffers(const FMeshView& Mesh)
+			: AdjacencyStart(Mesh.NumVertices + 1), AdjacencyTriangles(Mesh.NumTriangles * 3), VertexSigns(Mesh.NumVertices), TriangleClasses(Mesh.NumTriangles)
+			, CrossingTriangles(Mesh.NumTriangles), CrossingSlots(Mesh.NumTriangles), Queue(Mesh.NumTriangles)
+		{
+			BuildVertexTriangles(Mesh, AdjacencyStart.data(), AdjacencyTriangles.data());
+		}
+
+		void Bind(FIncrementalVolume& State)
+		{
+			State.Adjacency.Start = AdjacencyStart.data();
+			State.Adjacency.Triangles = AdjacencyTriangles.data();
+			State.VertexSigns = VertexSigns.data();
+			State.TriangleClasses = TriangleClasses.data();
+			State.CrossingTriangles = CrossingTriangles.data();
+			State.CrossingSlots = CrossingSlots.data();
+			State.Queue = Queue.data();
+		}
+	};
+
+	/* Plane of ship bobbing in waves at tick, changes a little between ticks */
+	void GetBobbingPlane(int32_t Tick, FVec3& OutNormal, float& OutOffset)
+	{
+		const float Time = Tick / 60.0f;
+
+		OutNormal = FVec3(0.05f * std::sin(0.7f * Time), 0.08f * std::cos(1.3f * Time), 1.0f).GetSafeNormal();
+		OutOffset = 60.0f * std::sin(2.1f * Time) + 15.0f * std::sin(5.3f * Time);
+	}
+
+	/* Incremental volume must follow full kernel on ship bobbing over many ticks and after random jumps.
+	 * Timing of whole bobbing sequence is compared with full kernel.
+	 */
+	void ValidateIncrementalVolume(FValidation& Validation)
+	{
+		const SyntheticHulls::FHullMesh Ship = SyntheticHulls::MakeShip(1200.0f, 300.0f, 150.0f, 20000);
+		const FMeshView Mesh = Ship.GetView();
+
+		FVec3 MeshCentroid;
+		const double ShipVolume = ComputeVolume(Mesh, MeshCentroid);
+
+		const int32_t NumTicks = 240;
+
+		FIncrementalBuffers Buffers(Mesh);
+		FIncrementalVolume State;
+		Buffers.Bind(State);
+
+		std::vector<float> Depths(Mesh.NumVertices);
+		std::vector<float> FullDepths(Mesh.NumVertices);
+
+		Validation.BeginCase("incremental volume");
+
+		int64_t NumReclassified = 0;
+		for (int32_t Tick = 0; Tick < NumTicks; ++Tick)
+		{
+			FVec3 Normal;
+			float Offset;
+			GetBobbingPlane(Tick, Normal, Offset);
+
+			ComputePlaneDepths(Mesh, Normal, Offset, Depths.data());
+			FVec3 Centroid;
+			const float Volume = ComputeSubmergedVolumeIncremental(Mesh, Depths.data(), Normal, State, Centroid);
+			NumReclassified += Tick > 0 ? State.NumReclassified : 0;
+
+			FVec3 FullCentroid;
+			FAnalyticResult Expected;
+			Expected.Volume = ComputeSubmergedVolume(Mesh, Normal, Offset, FullDepths.data(), FullCentroid);
+			Expected.Centroid[0] = FullCentroid.X;
+			Expected.Centroid[1] = FullCentroid.Y;
+			Expected.Centroid[2] = FullCentroid.Z;
+
+			Validation.Check(Volume, Centroid, Expected, ShipVolume, 600.0f, BoxTolerance, BoxTolerance);
+		}
+
+		printf("incremental volume: %d triangles, %.1f reclassified and %d crossing per tick\n", Mesh.NumTriangles,
+			static_cast<double>(NumReclassified) / (NumTicks - 1), State.NumCrossing);
+
+		// Random jumps reclassify most of mesh, result must still match
+		srand(17);
+		for (int32_t i = 0; i < 32; ++i)
+		{
+			const FVec3 Normal = RandomNormal();
+			const float Offset = RandomRange(-200.0f, 200.0f);
+
+			ComputePlaneDepths(Mesh, Normal, Offset, Depths.data());
+			FVec3 Centroid;
+			const float Volume = ComputeSubmergedVolumeIncremental(Mesh, Depths.data(), Normal, State, Centroid);
+
+			FVec3 FullCentroid;
+			FAnalyticResult Expected;
+			Expected.Volume = ComputeSubmergedVolume(Mesh, Normal, Offset, FullDepths.data(), FullCentroid);
+			Expected.Centroid[0] = FullCentroid.X;
+			Expected.Centroid[1] = FullCentroid.Y;
+			Expected.Centroid[2] = FullCentroid.Z;
+
+			Validation.Check(Volume, Centroid, Expected, ShipVolume, 600.0f, BoxTolerance, BoxTolerance);
+		}
+
+		// Whole sequence per call, ns/call of both cases is time of NumTicks updates
+		Validation.BeginCase("incremental volume timing");
+		State.bValid = false;
+		Validation.Timed(Mesh.NumTriangles, [&]()
+		{
+			float Volume = 0.0f;
+			for (int32_t Tick = 0; Tick < NumTicks; ++Tick)
+			{
+				FVec3 Normal, Centroid;
+				float Offset;
+				GetBobbingPlane(Tick, Normal, Offset);
+
+				ComputePlaneDepths(Mesh, Normal, Offset, Depths.data());
+				Volume += ComputeSubmergedVolumeIncremental(Mesh, Depths.data(), Normal, State, Centroid);
+			}
+			return Volume;
+		});
+
+		Validation.BeginCase("full volume timing");
+		Validation.Timed(Mesh.NumTriangles, [&]()
+		{
+			float Volume = 0.0f;
+			for (int32_t Tick = 0; Tick < NumTicks; ++Tick)
+			{
+				FVec3 Normal, Centroid;
+				float Offset;
+				GetBobbingPlane(Tick, Normal, Offset);
+
+				Volume += ComputeSubmergedVolume(Mesh, Normal, Offset, FullDepths.data(), Centroid);
+			}
+			return Volume;
+		});
+	}
+
+	/* Buffers of hull simplification of single mesh and its proxy */
+	struct FSimplifyBuffers
+	{
+		std::vector<int64_t> CellKeys;
+		std::vector<int32_t> Order;
+		std::vector<int32_t> Clusters;
+		std::vector<double> Quadrics;
+		std::vector<double> Sums;
+		std::vector<int32_t> TriangleOrder;
+
+		std::vector<float> ProxyX;
+		std::vector<float> ProxyY;
+		std::vector<float> ProxyZ;
+		std::vector<int32_t> ProxyIndices;
+
+		FSimplifyScratch Scratch;
+		FHullBuffers Proxy;
+
+		explicit FSimplifyBuffers(const FMeshView& Mesh)
+			: CellKeys(Mesh.NumVertices), Order(Mesh.NumVertices), Clusters(Mesh.NumVertices), Quadrics(Mesh.NumVertices * 10), Sums(Mesh.NumVertices * 4)
+			, TriangleOrder(Mesh.NumTriangles), ProxyX(Mesh.NumVertices), ProxyY(Mesh.NumVertices), ProxyZ(Mesh.NumVertices), ProxyIndices(Mesh.NumTriangles * 3)
+		{
+			Scratch.CellKeys = CellKeys.data();
+			Scratch.Order = Order.data();
+			Scratch.Clusters = Clusters.data();
+			Scratch.Quadrics = Quadrics.data();
+			Scratch.Sums = Sums.data();
+			Scratch.TriangleOrder = TriangleOrder.data();
+
+			Proxy.VertexX = ProxyX.data();
+			Proxy.VertexY = ProxyY.data();
+			Proxy.VertexZ = ProxyZ.data();
+			Proxy.Indices = ProxyIndices.data();
+		}
+	};
+
+	/* Every directed edge of closed mesh has opposite one */
+	bool IsClosed(const FMeshView& Mesh)
+	{
+		std::vector<std::pair<int32_t, int32_t>> Edges;
+		std::vector<std::pair<int32_t, int32_t>> Opposite;
+
+		for (int32_t TriIndex = 0; TriIndex < Mesh.NumTriangles; ++TriIndex)
+		{
+			for (int32_t Corner = 0; Corner < 3; ++Corner)
+			{
+				const int32_t From = Mesh.Indices[TriIndex * 3 + Corner];
+				const int32_t To = Mesh.Indices[TriIndex * 3 + (Corner + 1) % 3];
+				Edges.push_back(std::make_pair(From, To));
+				Opposite.push_back(std::make_pair(To, From));
+			}
+		}
+
+		std::sort(Edges.begin(), Edges.end());
+		std::sort(Opposite.begin(), Opposite.end());
+
+		return Edges == Opposite;
+	}
+
+	/* Proxies simplified to triangle budget must stay closed and follow submerged volume and centroid of source
+	 * over whole range of depths and attitudes
+	 */
+	void ValidateHullSimplifier(FValidation& Validation)
+	{
+		struct FProxyCase
+		{
+			const char* Name;
+			SyntheticHulls::FHullMesh Hull;
+			int32_t MaxTriangles;
+			double VolumeTolerance;
+			double CentroidTolerance;
+		};
+
+		const FProxyCase Cases[4] =
+		{
+			{ "proxy ship 2000", SyntheticHulls::MakeShip(1200.0f, 300.0f, 150.0f, 20000), 2000, 0.01, 0.005 },
+			{ "proxy ship 500", SyntheticHulls::MakeShip(1200.0f, 300.0f, 150.0f, 20000), 500, 0.03, 0.01 },
+			{ "proxy sphere 300", SyntheticHulls::MakeSphere(100.0f, 5000), 300, 0.03, 0.01 },
+			{ "proxy box", SyntheticHulls::MakeBox(FVec3(200.0f, 100.0f, 50.0f), 16), 200, 2e-3, 2e-3 }
+		};
+
+		for (const FProxyCase& ProxyCase : Cases)
+		{
+			const FMeshView Mesh = ProxyCase.Hull.GetView();
+			FSimplifyBuffers Buffers(Mesh);
+
+			Validation.BeginCase(ProxyCase.Name);
+
+			float CellSize = 0.0f;
+			Validation.Timed(Mesh.NumTriangles, [&]() { CellSize = SimplifyHullToBudget(Mesh, ProxyCase.MaxTriangles, Buffers.Scratch, Buffers.Proxy); return CellSize; });
+
+			const FMeshView Proxy = Buffers.Proxy.GetView();
+
+			std::vector<float> SourceDepths(Mesh.NumVertices);
+			std::vector<float> ProxyDepths(Proxy.NumVertices);
+			const FProxyError Error = MeasureProxyError(Mesh, Proxy, 16, 2, 0.6f, SourceDepths.data(), ProxyDepths.data());
+
+			const bool bValid = Proxy.NumTriangles > 0 && Proxy.NumTriangles <= ProxyCase.MaxTriangles && IsClosed(Proxy);
+
+			// Errors are already relative, expected result is exact match. Expected volume is 1 so centroid is checked too.
+			FAnalyticResult Expected;
+			Expected.Volume = 1.0;
+			Expected.Centroid[0] = Expected.Centroid[1] = Expected.Centroid[2] = 0.0;
+			Validation.Check(bValid ? static_cast<float>(1.0 + Error.MaxSubmergedVolumeError) : NAN, FVec3(static_cast<float>(Error.MaxCentroidError), 0.0f, 0.0f), Expected,
+				1.0, 1.0, ProxyCase.VolumeTolerance, ProxyCase.CentroidTolerance);
+
+			printf("%s: %d -> %d triangles, cell %.1f, total volume error %.2e\n", ProxyCase.Name, Mesh.NumTriangles, Proxy.NumTriangles, CellSize, Error.VolumeError);
+		}
+	}
+
+	/* Copy of hull moved by Offset */
+	SyntheticHulls::FHullMesh MakeMoved(const SyntheticHulls::FHullMesh& Hull, const FVec3& Offset)
+	{
+		SyntheticHulls::FHullMesh Moved = Hull;
+		for (size_t i = 0; i < Moved.VertexX.size(); ++i)
+		{
+			Moved.VertexX[i] += Offset.X;
+			Moved.VertexY[i] += Offset.Y;
+			Moved.VertexZ[i] += Offset.Z;
+		}
+		return Moved;
+	}
+
+	/* Undisplaced point whose displaced point lies above X, Y and surface height there.
+	 * Plain fixed point iteration in double, slow but independent of SampleSurfaceHeights.
+	 */
+	double ReferenceSurfaceHeight(const SyntheticWaves::FSpectrum& Spectrum, double X, double Y, double Time, double& OutSurfaceX, double& OutSurfaceY)
+	{
+		double SurfaceX = X;
+		double SurfaceY = Y;
+		double Height = 0.0;
+
+		for (int32_t Iteration = 0; Iteration < 200; ++Iteration)
+		{
+			double SumX = 0.0, SumY = 0.0;
+			Height = 0.0;
+
+			for (int32_t i = 0; i < Spectrum.Num(); ++i)
+			{
+				const double WavePhase = Spectrum.WaveVectorX[i] * SurfaceX + Spectrum.WaveVectorY[i] * SurfaceY + Time * Spectrum.AngularFrequency[i] + Spectrum.Phase[i];
+				SumX += Spectrum.DisplacementScaleX[i] * std::cos(WavePhase);
+				SumY += Spectrum.DisplacementScaleY[i] * std::cos(WavePhase);
+				Height += Spectrum.Amplitude[i] * std::sin(WavePhase);
+			}
+
+			SurfaceX = X - SumX;
+			SurfaceY = Y - SumY;
+		}
+
+		OutSurfaceX = SurfaceX;
+		OutSurfaceY = SurfaceY;
+		return Height;
+	}
+
+	void CheckSurfaceHeights(FValidation& Validation, float Steepness, int32_t NumIterations, double Tolerance)
+	{
+		const int32_t NumSamples = 256;
+		const float Time = 12.345f;
+
+		const SyntheticWaves::FSpectrum Spectrum = SyntheticWaves::MakeDefaultOcean(Steepness);
+		const FGerstnerSpectrumView View = Spectrum.GetView();
+
+		double MaxHeight = 0.0;
+		for (float Amplitude : Spectrum.Amplitude)
+		{
+			MaxHeight += std::fabs(Amplitude);
+		}
+
+		std::vector<float> X(NumSamples), Y(NumSamples), SurfaceX(NumSamples), SurfaceY(NumSamples), Heights(NumSamples);
+		std::vector<float> Buffers(8 * NumSamples);
+
+		FWaveSampleBuffers Samples;
+		Samples.DisplacementX = Buffers.data();
+		Samples.DisplacementY = Samples.DisplacementX + NumSamples;
+		Samples.DisplacementZ = Samples.DisplacementY + NumSamples;
+		Samples.SlopeXX = Samples.DisplacementZ + NumSamples;
+		Samples.SlopeXY = Samples.SlopeXX + NumSamples;
+		Samples.SlopeYY = Samples.SlopeXY + NumSamples;
+		Samples.SlopeZX = Samples.SlopeYY + NumSamples;
+		Samples.SlopeZY = Samples.SlopeZX + NumSamples;
+
+		for (int32_t i = 0; i < NumSamples; ++i)
+		{
+			X[i] = RandomRange(-20000.0f, 20000.0f);
+			Y[i] = RandomRange(-20000.0f, 20000.0f);
+		}
+
+		auto Evaluate = [&View, &Spectrum, Time](const float* InX, const float* InY, int32_t Num, const FWaveSampleBuffers& Out)
+		{
+			EvaluateGerstner(View, InX, InY, Num, Time, Out, Spectrum.Num());
+		};
+
+		Validation.Timed(NumSamples, [&]()
+		{
+			SampleSurfaceHeights(Evaluate, X.data(), Y.data(), NumSamples, NumIterations, SurfaceX.data(), SurfaceY.data(), Samples, Heights.data());
+			return Heights[0];
+		});
+
+		// Heights are shifted up so they count as submerged volume and surface point is checked as centroid
+		for (int32_t i = 0; i < NumSamples; ++i)
+		{
+			FAnalyticResult Expected;
+			Expected.Volume = ReferenceSurfaceHeight(Spectrum, X[i], Y[i], Time, Expected.Centroid[0], Expected.Centroid[1]) + 2.0 * MaxHeight;
+			Expected.Centroid[2] = 0.0;
+
+			const FVec3 SurfacePoint = NumIterations > 0 ? FVec3(SurfaceX[i], SurfaceY[i], 0.0f) : FVec3(X[i], Y[i], 0.0f);
+
+			Validation.Check(Heights[i] + 2.0f * static_cast<float>(MaxHeight), SurfacePoint, Expected, MaxHeight, MaxHeight, Tolerance, Tolerance);
+		}
+	}
+
+	/* Height of Gerstner surface above XY against converged double precision inversion, errors relative to max wave height */
+	void ValidateSurfaceHeight(FValidation& Validation)
+	{
+		srand(17);
+
+		// Displacement at XY is height of some other point, error grows with steepness
+		Validation.BeginCase("wave height at xy plain", true);
+		CheckSurfaceHeights(Validation, 0.5f, 0, 2e-4);
+
+		Validation.BeginCase("wave height newton 1");
+		CheckSurfaceHeights(Validation, 0.5f, 1, 1e-2);
+
+		Validation.BeginCase("wave height newton 2");
+		CheckSurfaceHeights(Validation, 0.5f, 2, 2e-4);
+
+		Validation.BeginCase("steep wave height newton 2");
+		CheckSurfaceHeights(Validation, 1.0f, 2, 2e-4);
+	}
+
+	/* Displacement of wave at XY in double precision, time derivative of it is orbital velocity */
+	void ReferenceDisplacement(const SyntheticWaves::FSpectrum& Spectrum, double X, double Y, double Time, double OutDisplacement[3])
+	{
+		OutDisplacement[0] = OutDisplacement[1] = OutDisplacement[2] = 0.0;
+
+		for (int32_t i = 0; i < Spectrum.Num(); ++i)
+		{
+			const double WavePhase = Spectrum.WaveVectorX[i] * X + Spectrum.WaveVectorY[i] * Y + Time * Spectrum.AngularFrequency[i] + Spectrum.Phase[i];
+			OutDisplacement[0] += Spectrum.DisplacementScaleX[i] * std::cos(WavePhase);
+			OutDisplacement[1] += Spectrum.DisplacementScaleY[i] * std::cos(WavePhase);
+			OutDisplacement[2] += Spectrum.Amplitude[i] * std::sin(WavePhase);
+		}
+	}
+
+	/* Orbital velocity of waves against central difference of displacement in time, drag of body in current */
+	void ValidateWaterVelocity(FValidation& Validation)
+	{
+		const int32_t NumSamples = 256;
+		const float Time = 12.345f;
+		const double TimeStep = 1e-4;
+
+		const SyntheticWaves::FSpectrum Spectrum = SyntheticWaves::MakeDefaultOcean(0.5f);
+		const FGerstnerSpectrumView View = Spectrum.GetView();
+
+		double MaxSpeed = 0.0;
+		for (int32_t i = 0; i < Spectrum.Num(); ++i)
+		{
+			MaxSpeed += std::fabs(Spectrum.Amplitude[i] * Spectrum.AngularFrequency[i]);
+		}
+
+		std::vector<float> X(NumSamples), Y(NumSamples);
+		std::vector<float> DisplacementX(NumSamples), DisplacementY(NumSamples), DisplacementZ(NumSamples);
+		std::vector<float> VelocityX(NumSamples), VelocityY(NumSamples), VelocityZ(NumSamples);
+
+		srand(23);
+		for (int32_t i = 0; i < NumSamples; ++i)
+		{
+			X[i] = RandomRange(-5000.0f, 5000.0f);
+			Y[i] = RandomRange(-5000.0f, 5000.0f);
+		}
+
+		FWaveSampleBuffers Buffers;
+		Buffers.DisplacementX = DisplacementX.data();
+		Buffers.DisplacementY = DisplacementY.data();
+		Buffers.DisplacementZ = DisplacementZ.data();
+		Buffers.VelocityX = VelocityX.data();
+		Buffers.VelocityY = VelocityY.data();
+		Buffers.VelocityZ = VelocityZ.data();
+
+		Validation.BeginCase("wave orbital velocity");
+		Validation.Timed(NumSamples * View.NumComponents, [&]() { EvaluateGerstner(View, X.data(), Y.data(), NumSamples, Time, Buffers, View.NumComponents); return VelocityZ[0]; });
+
+		for (int32_t i = 0; i < NumSamples; ++i)
+		{
+			double After[3], Before[3];
+			ReferenceDisplacement(Spectrum, X[i], Y[i], Time + TimeStep, After);
+			ReferenceDisplacement(Spectrum, X[i], Y[i], Time - TimeStep, Before);
+
+			// Vertical velocity is offset to stay positive, so horizontal one is always compared
+			FAnalyticResult Expected;
+			Expected.Volume = (After[2] - Before[2]) / (2.0 * TimeStep) + 2.0 * MaxSpeed;
+			Expected.Centroid[0] = (After[0] - Before[0]) / (2.0 * TimeStep);
+			Expected.Centroid[1] = (After[1] - Before[1]) / (2.0 * TimeStep);
+			Expected.Centroid[2] = 0.0;
+
+			Validation.Check(VelocityZ[i] + 2.0f * static_cast<float>(MaxSpeed), FVec3(VelocityX[i], VelocityY[i], 0.0f), Expected, MaxSpeed, MaxSpeed, 1e-3, 1e-3);
+		}
+
+		const FBodyParams Body(1000000.0f, 500.0f, 200.0f);
+
+		FWaterParams Water;
+		Water.Velocity = FVec3(120.0f, -80.0f, 0.0f);
+		const FVec3 CurrentDirection = Water.Velocity * (1.0f / std::sqrt(Water.Velocity.X * Water.Velocity.X + Water.Velocity.Y * Water.Velocity.Y));
+
+		srand(29);
+
+		// Buoyancy and gravity are vertical, so horizontal force is only drag: none for body carried by water, along current for body at rest
+		Validation.BeginCase("drift with current");
+		for (int32_t i = 0; i < 16; ++i)
+		{
+			FBodyState State;
+			State.Rotation = FQuat::FromAxisAngle(RandomNormal(), RandomRange(0.0f, 6.28f));
+			State.Location = FVec3(RandomRange(-1000.0f, 1000.0f), RandomRange(-1000.0f, 1000.0f), -500.0f);
+			State.CenterOfMass = State.Location;
+			State.Mass = 500.0f;
+
+			FForces AtRest;
+			SolveBodySubmerged(State, Body, Water, FVec3(0.0f, 0.0f, 0.0f), AtRest);
+
+			State.LinearVelocity = Water.Velocity;
+
+			FForces Carried;
+			SolveBodySubmerged(State, Body, Water, FVec3(0.0f, 0.0f, 0.0f), Carried);
+
+			const double DragScale = std::sqrt(static_cast<double>(AtRest.Force.X) * AtRest.Force.X + static_cast<double>(AtRest.Force.Y) * AtRest.Force.Y);
+
+			FAnalyticResult Expected;
+			Expected.Volume = DragScale;
+			Expected.Centroid[0] = Expected.Centroid[1] = Expected.Centroid[2] = 0.0;
+
+			// Volume is drag along current, centroid is horizontal drag left on carried body
+			const float DragAlongCurrent = AtRest.Force.X * CurrentDirection.X + AtRest.Force.Y * CurrentDirection.Y;
+			Validation.Check(DragAlongCurrent, FVec3(Carried.Force.X, Carried.Force.Y, 0.0f), Expected, DragScale, DragScale, 1e-5, 1e-5);
+		}
+	}
+
+	/* Hull sections solved separately and summed must give the same force and torque as one mesh holding all of them */
+	void ValidateSections(FValidation& Validation)
+	{
+		// Catamaran: two hulls of different size off to both sides of center of mass
+		const SyntheticHulls::FHullMesh Hulls[2] =
+		{
+			MakeMoved(SyntheticHulls::MakeBox(FVec3(300.0f, 40.0f, 50.0f), 4), FVec3(20.0f, -200.0f, 0.0f)),
+			MakeMoved(SyntheticHulls::MakeBox(FVec3(250.0f, 60.0f, 50.0f), 4), FVec3(-30.0f, 180.0f, 10.0f))
+		};
+
+		SyntheticHulls::FHullMesh Combined = Hulls[0];
+		const int32_t BaseVertex = static_cast<int32_t>(Combined.VertexX.size());
+		for (size_t i = 0; i < Hulls[1].VertexX.size(); ++i)
+		{
+			Combined.AddVertex(FVec3(Hulls[1].VertexX[i], Hulls[1].VertexY[i], Hulls[1].VertexZ[i]));
+		}
+		for (int32_t Index : Hulls[1].Indices)
+		{
+			Combined.Indices.push_back(Index + BaseVertex);
+		}
+
+		FVec3 Centroid;
+		const float Volumes[2] = { ComputeVolume(Hulls[0].GetView(), Centroid), ComputeVolume(Hulls[1].GetView(), Centroid) };
+		const float TotalVolume = Volumes[0] + Volumes[1];
+
+		std::vector<float> Depths(Combined.VertexX.size());
+
+		srand(5);
+
+		Validation.BeginCase("sections vs one mesh");
+		for (int32_t i = 0; i < 32; ++i)
+		{
+			FBodyState State;
+			State.Location = FVec3(RandomRange(-100.0f, 100.0f), RandomRange(-100.0f, 100.0f), RandomRange(-40.0f, 40.0f));
+			State.Rotation = FQuat::FromAxisAngle(RandomNormal(), RandomRange(0.0f, 0.3f));
+			State.CenterOfMass = State.Location;
+			State.LinearVelocity = FVec3(RandomRange(-50.0f, 50.0f), RandomRange(-50.0f, 50.0f), RandomRange(-50.0f, 50.0f));
+			State.Mass = 2000.0f;
+
+			const float SurfaceZ = RandomRange(-30.0f, 30.0f);
+			const FVec3 SurfacePoints[4] = { FVec3(-500.0f, -500.0f, SurfaceZ), FVec3(500.0f, -500.0f, SurfaceZ), FVec3(-500.0f, 500.0f, SurfaceZ), FVec3(500.0f, 500.0f, SurfaceZ) };
+
+			const FBodyParams Body(TotalVolume, 500.0f, 0.0f);
+
+			FForces Single;
+			SolveBody(Combined.GetView(), State, Body, FWaterParams(), SurfacePoints, 4, Depths.data(), Single);
+
+			FForces Expected;
+			AddSectionForces(Single, State.CenterOfMass, Expected);
+
+			// Sections of equal density share mass by volume
+			FForces Summed;
+			Validation.Timed(Combined.NumTriangles(), [&]()
+			{
+				Summed = FForces();
+				for (int32_t Section = 0; Section < 2; ++Section)
+				{
+					FBodyState SectionState = State;
+					SectionState.Mass = State.Mass * Volumes[Section] / TotalVolume;
+
+					const FBodyParams SectionBody(Volumes[Section], 500.0f, 0.0f);
+
+					FForces SectionForces;
+					SolveBody(Hulls[Section].GetView(), SectionState, SectionBody, FWaterParams(), SurfacePoints, 4, Depths.data(), SectionForces);
+					AddSectionForces(SectionForces, State.CenterOfMass, Summed);
+				}
+				return Summed.Force.Z;
+			});
+
+			// Force is compared as volume and torque as centroid, both relative to largest buoyant force and its lever
+			const double ForceScale = FWaterParams().Density * TotalVolume * 980.0;
+
+			FAnalyticResult Result;
+			Result.Volume = Expected.Force.Z;
+			for (int32_t Axis = 0; Axis < 3; ++Axis)
+			{
+				Result.Centroid[Axis] = Expected.Torque[Axis] / ForceScale;
+			}
+
+			const float Force = Expected.bHasForce == Summed.bHasForce ? Summed.Force.Z : NAN;
+			Validation.Check(Force, Summed.Torque * static_cast<float>(1.0 / ForceScale), Result, ForceScale, 300.0, BoxTolerance, BoxTolerance);
+		}
+	}
+
+	/* Core kernel against frozen reference on random planes through ship hull */
+	void ValidateAgainstReference(FValidation& Validation)
+	{
+		const SyntheticHulls::FHullMesh Ship = SyntheticHulls::MakeShip(1200.0f, 300.0f, 150.0f, 10000);
+		const FMeshView Mesh = Ship.GetView();
+
+		FVec3 MeshCentroid;
+		const double ShipVolume = ComputeVolume(Mesh, MeshCentroid);
+
+		std::vector<float> Depths(Mesh.NumVertices);
+
+		srand(11);
+
+		Validation.BeginCase("ship vs reference");
+		for (int32_t i = 0; i < 64; ++i)
+		{
+			const FVec3 Normal = RandomNormal();
+			const float Offset = RandomRange(-200.0f, 200.0f);
+
+			FAnalyticResult Expected;
+			FVec3 ReferenceCentroid;
+			Expected.Volume = ReferenceBuoyancy::ComputeSubmergedVolume(Mesh, Normal, Offset, Depths.data(), ReferenceCentroid);
+			Expected.Centroid[0] = ReferenceCentroid.X;
+			Expected.Centroid[1] = ReferenceCentroid.Y;
+			Expected.Centroid[2] = ReferenceCentroid.Z;
+
+			FVec3 Centroid;
+			const float Volume = Validation.Submerged(Mesh, Normal, Offset, Centroid);
+			Validation.Check(Volume, Centroid, Expected, ShipVolume, 600.0f, BoxTolerance, BoxTolerance);
+		}
+	}
+
+	/* Fixed step body must float on its own, and recorded session must replay without any divergence */
+	void ValidateFixedStep(FValidation& Validation)
+	{
+		const int32_t StepsPerSecond = 60;
+
+		// Box of half density of water dropped tilted into calm water settles upright at half of its height.
+		// Draft is checked as volume and center of mass with tilt in degrees as centroid.
+		{
+			const FVec3 Extent(100.0f, 50.0f, 25.0f);
+			const SyntheticHulls::FHullMesh Box = SyntheticHulls::MakeBox(Extent, 2);
+			const SyntheticWaves::FSpectrum Calm;
+
+			FFixedStepHull Hull;
+			Hull.Mesh = Box.GetView();
+			Hull.Body = FBodyParams(8.0f * Extent.X * Extent.Y * Extent.Z, 500.0f, 2.0f * Extent.X);
+
+			FBodyState State;
+			State.Location = FVec3(0.0f, 0.0f, 100.0f);
+			State.Rotation = FQuat::FromAxisAngle(FVec3(1.0f, 0.0f, 0.0f), 0.3f);
+			State.CenterOfMass = State.Location;
+			State.Mass = 0.5f * FWaterParams().Density * Hull.Body.BodyVolume;
+
+			FFixedStepBody Body;
+			Body.Hulls = &Hull;
+			Body.NumHulls = 1;
+			Body.LocalInertia = ComputeBoxInertia(State.Mass, Extent * 2.0f);
+
+			std::vector<float> Buffer(FFixedStepScratch::FloatsPerVertex * Body.GetMaxVertices());
+			const FFixedStepScratch Scratch = FFixedStepScratch::FromBuffer(Buffer.data(), Body.GetMaxVertices());
+
+			Validation.BeginCase("fixed step floats");
+			for (int32_t Step = 0; Step < 30 * StepsPerSecond; ++Step)
+			{
+				// One call per step, repeating it would advance the body again
+				Validation.Timed(200000, [&]()
+				{
+					StepBody(Calm.GetView(), Body, Step, StepsPerSecond, Scratch, State);
+					return State.CenterOfMass.Z;
+				});
+			}
+
+			const double Tilt = SessionReplay::GetRotationError(State.Rotation, FQuat());
+
+			FAnalyticResult Expected;
+			Expected.Volume = Extent.Z;
+			Expected.Centroid[0] = Expected.Centroid[1] = Expected.Centroid[2] = 0.0;
+
+			Validation.Check(Extent.Z - State.CenterOfMass.Z, FVec3(State.CenterOfMass.X, State.CenterOfMass.Y, static_cast<float>(Tilt)), Expected, Extent.Z, Extent.Z, 2e-2, 2e-2);
+		}
+
+		// Session goes through the same writers as FBuoyancyRecorder and back, replay must reproduce every recorded state exactly
+		{
+			Validation.BeginCase("fixed step replay");
+
+			SessionReplay::FSession Session;
+			const bool bRead = SessionReplay::ReadSession(SessionReplay::RecordSyntheticSession(10.0f, StepsPerSecond), Session);
+
+			std::vector<SessionReplay::FBodyReplay> Results;
+			Validation.Timed(200000, [&]()
+			{
+				Results = SessionReplay::ReplaySession(Session, false, 0.0);
+				return 0.0f;
+			});
+
+			for (const SessionReplay::FBodyReplay& Result : Results)
+			{
+				FAnalyticResult Expected;
+				Expected.Volume = 0.0;
+				Expected.Centroid[0] = Expected.Centroid[1] = Expected.Centroid[2] = 0.0;
+
+				const bool bComplete = bRead && Result.NumSteps == 10 * StepsPerSecond && Result.NumResets == 1;
+				const float Error = bComplete ? static_cast<float>(Result.MaxPositionError + Result.MaxRotationError) : NAN;
+				Validation.Check(Error, FVec3(), Expected, 1.0, 1.0, 0.0, 0.0);
+			}
+
+			if (!bRead || Results.size() != 3)
+			{
+				Validation.Check(NAN, FVec3(), FAnalyticResult(), 1.0, 1.0, 0.0, 0.0);
+			}
+		}
+	}
+
+	/* Pressure solve: hydrostatic part against exact box, drag and slamming against closed forms for axis aligned box */
+	void ValidatePressure(FValidation& Validation)
+	{
+		const FVec3 Extent(100.0f, 50.0f, 25.0f);
+		const SyntheticHulls::FHullMesh Box = SyntheticHulls::MakeBox(Extent, 4);
+		const FMeshView Mesh = Box.GetView();
+		const double BoxVolume = 8.0 * Extent.X * Extent.Y * Extent.Z;
+
+		FPressureParams Pressure;
+		Pressure.SurfaceArea = ComputeSurfaceArea(Mesh);
+
+		const FBodyParams Body(static_cast<float>(BoxVolume), 500.0f, 2.0f * Extent.X);
+		const FWaterParams Water;
+		const float HydrostaticScale = Water.Density * -Water.GravityZ;
+
+		std::vector<float> Buffer(FPressureScratch::GetNumFloats(Mesh.NumVertices, Mesh.NumTriangles));
+		std::vector<int32_t> Sources(2 * Mesh.NumTriangles);
+		const FPressureScratch Scratch = FPressureScratch::FromBuffer(Buffer.data(), Sources.data(), Mesh.NumVertices, Mesh.NumTriangles);
+
+		std::vector<float> WorldX(Mesh.NumVertices), WorldY(Mesh.NumVertices), WorldZ(Mesh.NumVertices);
+		std::vector<float> Depths(Mesh.NumVertices);
+		std::vector<float> Sweep(Mesh.NumTriangles);
+
+		srand(31);
+
+		// Body at rest has only hydrostatic pressure, its sum must be buoyancy of submerged volume acting at its centroid
+		Validation.BeginCase("pressure hydrostatic");
+		for (int32_t i = 0; i < 64; ++i)
+		{
+			FBodyState State;
+			State.Rotation = FQuat::FromAxisAngle(RandomNormal(), RandomRange(0.0f, 6.28f));
+			State.Location = FVec3(RandomRange(-1000.0f, 1000.0f), RandomRange(-1000.0f, 1000.0f), RandomRange(-80.0f, 80.0f));
+			State.CenterOfMass = State.Location;
+			State.Mass = 100.0f;
+
+			const float WaterZ = RandomRange(-20.0f, 20.0f);
+
+			TransformVertices(Mesh, State.Rotation, State.CenterOfMass, WorldX.data(), WorldY.data(), WorldZ.data());
+			for (int32_t v = 0; v < Mesh.NumVertices; ++v)
+			{
+				Depths[v] = WorldZ[v] - WaterZ;
+			}
+
+			FForces Forces;
+			const float Volume = Validation.Timed(Mesh.NumTriangles, [&]() { return SolveBodyPressureSurface(Mesh, State, Body, Water, Pressure, Depths.data(), 0.0f, Scratch, nullptr, Forces); });
+
+			const FVec3 LocalNormal = State.Rotation.Inverse().RotateVector(FVec3(0.0f, 0.0f, 1.0f));
+			FAnalyticResult Expected = AnalyticBox(Extent, LocalNormal, WaterZ - State.Location.Z);
+
+			const FVec3 WorldCentroid = State.Location + State.Rotation.RotateVector(FVec3((float)Expected.Centroid[0], (float)Expected.Centroid[1], (float)Expected.Centroid[2]));
+			Expected.Centroid[0] = WorldCentroid.X;
+			Expected.Centroid[1] = WorldCentroid.Y;
+			Expected.Centroid[2] = WorldCentroid.Z;
+
+			// Vertical force at centroid has torque (y * F, -x * F, 0) around center of mass, height of centroid can't be seen in it
+			FVec3 Centroid;
+			if (Forces.Force.Z > 0.0f)
+			{
+				Centroid = FVec3(State.CenterOfMass.X - Forces.Torque.Y / Forces.Force.Z, State.CenterOfMass.Y + Forces.Torque.X / Forces.Force.Z, WorldCentroid.Z);
+			}
+
+			Validation.Check(Volume, Centroid, Expected, BoxVolume, Extent.X, BoxTolerance, BoxTolerance);
+
+			FAnalyticResult ExpectedForce = Expected;
+			ExpectedForce.Volume *= HydrostaticScale;
+			Validation.Check(Forces.Force.Z, Centroid, ExpectedForce, BoxVolume * HydrostaticScale, Extent.X, BoxTolerance, BoxTolerance);
+		}
+
+		// Submerged box moving along X: front face pushed and back face pulled by dynamic pressure, four sides rubbed by friction
+		Validation.BeginCase("pressure drag");
+		for (int32_t i = 0; i < 16; ++i)
+		{
+			FBodyState State;
+			State.Location = FVec3(0.0f, 0.0f, -500.0f);
+			State.CenterOfMass = State.Location;
+			State.LinearVelocity = FVec3(RandomRange(10.0f, 1000.0f), 0.0f, 0.0f);
+			State.Mass = 100.0f;
+
+			for (int32_t v = 0; v < Mesh.NumVertices; ++v)
+			{
+				Depths[v] = Mesh.VertexZ[v] + State.Location.Z;
+			}
+
+			FForces Forces;
+			SolveBodyPressureSurface(Mesh, State, Body, Water, Pressure, Depths.data(), 0.0f, Scratch, nullptr, Forces);
+
+			const double Speed = State.LinearVelocity.X;
+			const double FrontArea = 4.0 * Extent.Y * Extent.Z;
+			const double SideArea = 2.0 * (4.0 * Extent.X * Extent.Y + 4.0 * Extent.X * Extent.Z);
+			const double Friction = ComputeSkinFriction(static_cast<float>(Speed), Body.BodyLengthX, Pressure.KinematicViscosity) * Pressure.SkinFriction;
+
+			FAnalyticResult Expected;
+			Expected.Volume = 0.5 * Water.Density * (Speed * std::max(Speed, static_cast<double>(Pressure.LinearDragSpeed)) * (Pressure.PressureDrag + Pressure.SuctionDrag) * FrontArea
+				+ Friction * Speed * Speed * SideArea);
+			Expected.Centroid[0] = Expected.Centroid[1] = Expected.Centroid[2] = 0.0;
+
+			// Centroid holds lateral force and torque, symmetric box gets none
+			Validation.Check(-Forces.Force.X, FVec3(Forces.Force.Y, Forces.Torque.Y / Extent.X, Forces.Torque.Z / Extent.X), Expected, Expected.Volume, Expected.Volume, 1e-4, 1e-4);
+		}
+
+		// Level box falls with its bottom already under water: first solve only records sweep, second one slams
+		// bottom with stopping force of its share of mass, third one at the same speed doesn't slam any more
+		Validation.BeginCase("pressure slamming");
+		for (int32_t i = 0; i < 16; ++i)
+		{
+			FBodyState State;
+			State.Location = FVec3(0.0f, 0.0f, Extent.Z - RandomRange(1.0f, 10.0f));
+			State.CenterOfMass = State.Location;
+			State.Mass = 500.0f;
+
+			for (int32_t v = 0; v < Mesh.NumVertices; ++v)
+			{
+				Depths[v] = Mesh.VertexZ[v] + State.Location.Z;
+			}
+
+			const float DeltaTime = 1.0f / 60.0f;
+			FPressureHistory History;
+			History.Sweep = Sweep.data();
+
+			FForces First, Second, Third, NoSlamming;
+			SolveBodyPressureSurface(Mesh, State, Body, Water, Pressure, Depths.data(), DeltaTime, Scratch, &History, First);
+
+			State.LinearVelocity = FVec3(0.0f, 0.0f, -RandomRange(50.0f, 1000.0f));
+			SolveBodyPressureSurface(Mesh, State, Body, Water, Pressure, Depths.data(), DeltaTime, Scratch, &History, Second);
+			SolveBodyPressureSurface(Mesh, State, Body, Water, Pressure, Depths.data(), DeltaTime, Scratch, &History, Third);
+			SolveBodyPressureSurface(Mesh, State, Body, Water, Pressure, Depths.data(), DeltaTime, Scratch, nullptr, NoSlamming);
+
+			// Every bottom triangle has the same area and sweep, so every one of them ramps the same
+			const double BottomArea = 4.0 * Extent.X * Extent.Y;
+			const double TriangleArea = BottomArea / (2 * 4 * 4);
+			const double Speed = -State.LinearVelocity.Z;
+			const double Rate = std::min(1.0, TriangleArea * Speed / (Pressure.SurfaceArea * DeltaTime * Pressure.SlammingMaxRate));
+
+			FAnalyticResult Expected;
+			Expected.Volume = Pressure.Slamming * std::pow(Rate, static_cast<double>(Pressure.SlammingPower)) * State.Mass * BottomArea * Speed / (Pressure.SurfaceArea * DeltaTime);
+			Expected.Centroid[0] = Expected.Centroid[1] = Expected.Centroid[2] = 0.0;
+
+			// Centroid holds what third solve has more than solve without slamming.
+			// Slamming is found as difference of two much larger float sums of hydrostatic force.
+			const FVec3 Steady = Third.Force - NoSlamming.Force;
+			Validation.Check(Second.Force.Z - NoSlamming.Force.Z, Steady, Expected, Expected.Volume, Expected.Volume, 1e-3, 1e-3);
+		}
+	}
+	/* Submerged part of instances: spheres and axis aligned boxes are exact, tilted boxes and capsules approximate the exact volumes.
+	 * Instances have to float at draft of their density, upright, and slopes of surface have to match its finite difference.
+	 */
+	void ValidateInstances(FValidation& Validation)
+	{
+		const FWaterParams Water;
+		const int32_t NumPoses = 256;
+
+		std::vector<float> Buffer(FInstanceBuffers::FloatsPerInstance * NumPoses);
+		const FInstanceBuffers Instances = FInstanceBuffers::FromBuffer(Buffer.data(), NumPoses);
+
+		FInstanceStepParams Params;
+
+		// Step of zero length only writes submerged part of every instance
+		auto CheckVolumes = [&](EInstanceShape Shape, const FVec3& Extent, bool bTilted, const FMeshView* Mesh, double Tolerance)
+		{
+			const FInstanceShape InstanceShape = MakeInstanceShape(Shape, Extent, 500.0f, Water.Density);
+			const float Size = std::max(Extent.X + Extent.Y, Extent.Z);
+
+			std::vector<FVec3> Normals(NumPoses);
+			std::vector<float> Offsets(NumPoses);
+
+			for (int32_t i = 0; i < NumPoses; ++i)
+			{
+				const FQuat Rotation = bTilted ? FQuat::FromAxisAngle(RandomNormal(), RandomRange(0.0f, 3.14159265f)) : FQuat();
+				const FVec3 Position(RandomRange(-1000.0f, 1000.0f), RandomRange(-1000.0f, 1000.0f), RandomRange(-Size, Size));
+
+				Instances.SetShape(i, InstanceShape);
+				Instances.SetState(i, Position, Rotation, FVec3(), FVec3());
+
+				// Water at 0 in space of instance
+				Normals[i] = Rotation.Inverse().RotateVector(FVec3(0.0f, 0.0f, 1.0f));
+				Offsets[i] = -Position.Z;
+			}
+
+			Validation.Timed(NumPoses, [&]()
+			{
+				StepInstances(Instances, NumPoses, Params, 0.0f);
+				return Instances.Submerged[0];
+			});
+
+			std::vector<float> Depths(Mesh ? Mesh->NumVertices : 0);
+
+			for (int32_t i = 0; i < NumPoses; ++i)
+			{
+				FAnalyticResult Expected;
+				if (Shape == EInstanceShape::Sphere)
+				{
+					Expected = AnalyticSphere(Extent.X, Normals[i], Offsets[i]);
+				}
+				else if (Shape == EInstanceShape::Box)
+				{
+					Expected = AnalyticBox(Extent, Normals[i], Offsets[i]);
+				}
+				else
+				{
+					FVec3 Centroid;
+					Expected.Volume = ComputeSubmergedVolume(*Mesh, Normals[i], Offsets[i], Depths.data(), Centroid);
+				}
+
+				// Lobes have no centroid of their own, only volume is checked
+				Expected.Centroid[0] = Expected.Centroid[1] = Expected.Centroid[2] = 0.0;
+				Validation.Check(Instances.Submerged[i] * InstanceShape.Volume, FVec3(), Expected, InstanceShape.Volume, Size, Tolerance, 0.0);
+			}
+		};
+
+		const FVec3 BoxExtent(100.0f, 50.0f, 25.0f);
+		const FVec3 CapsuleExtent(60.0f, 20.0f, 20.0f);
+		const SyntheticHulls::FHullMesh Capsule = SyntheticHulls::MakeCapsule(CapsuleExtent.Y, CapsuleExtent.X, 20000);
+		const FMeshView CapsuleMesh = Capsule.GetView();
+
+		srand(2468);
+
+		Validation.BeginCase("instance sphere");
+		CheckVolumes(EInstanceShape::Sphere, FVec3(30.0f, 0.0f, 0.0f), true, nullptr, 1e-5);
+
+		Validation.BeginCase("instance box");
+		CheckVolumes(EInstanceShape::Box, BoxExtent, false, nullptr, BoxTolerance);
+
+		// Approximations, measured max error of volume: tilted box 8.5%, capsule 5% (tilted half way out of water)
+		Validation.BeginCase("instance tilted box");
+		CheckVolumes(EInstanceShape::Box, BoxExtent, true, nullptr, 0.1);
+
+		Validation.BeginCase("instance capsule");
+		CheckVolumes(EInstanceShape::Capsule, CapsuleExtent, true, &CapsuleMesh, 0.06);
+
+		// Every shape of half density of water dropped tilted into calm water settles at half of its volume.
+		// Submerged part is checked as volume, height of center and tilt in radians as centroid.
+		Validation.BeginCase("instances float");
+		{
+			const EInstanceShape Shapes[] = { EInstanceShape::Sphere, EInstanceShape::Box, EInstanceShape::Capsule };
+			const FVec3 Extents[] = { FVec3(30.0f, 0.0f, 0.0f), FVec3(100.0f, 50.0f, 10.0f), CapsuleExtent };
+
+			for (int32_t i = 0; i < 3; ++i)
+			{
+				Instances.SetShape(i, MakeInstanceShape(Shapes[i], Extents[i], 500.0f, Water.Density));
+				Instances.SetState(i, FVec3(0.0f, 0.0f, 50.0f), FQuat::FromAxisAngle(FVec3(1.0f, 1.0f, 0.0f).GetSafeNormal(), 0.3f), FVec3(), FVec3());
+			}
+
+			for (int32_t Step = 0; Step < 30 * 60; ++Step)
+			{
+				// One call per step, repeating it would advance instances again
+				Validation.Timed(200000, [&]()
+				{
+					StepInstances(Instances, 3, Params, 1.0f / 60.0f);
+					return Instances.PositionZ[0];
+				});
+			}
+
+			for (int32_t i = 0; i < 3; ++i)
+			{
+				const FQuat Rotation(Instances.RotationX[i], Instances.RotationY[i], Instances.RotationZ[i], Instances.RotationW[i]);
+
+				// Box floats flat, capsule with its axis level, sphere in any orientation
+				const FVec3 Up = Rotation.RotateVector(FVec3(0.0f, 0.0f, 1.0f));
+				const FVec3 Axis = Rotation.RotateVector(FVec3(1.0f, 0.0f, 0.0f));
+				const float Tilt = Shapes[i] == EInstanceShape::Box ? std::acos(std::min(std::fabs(Up.Z), 1.0f)) : (Shapes[i] == EInstanceShape::Capsule ? std::asin(std::min(std::fabs(Axis.Z), 1.0f)) : 0.0f);
+
+				FAnalyticResult Expected;
+				Expected.Volume = 0.5;
+				Expected.Centroid[0] = Expected.Centroid[1] = Expected.Centroid[2] = 0.0;
+
+				Validation.Check(Instances.Submerged[i], FVec3(0.0f, Instances.PositionZ[i] / Extents[i].X, Tilt), Expected, 1.0, 1.0, 1e-3, 1e-2);
+			}
+		}
+
+		// Slopes from displacement slopes against central difference of converged surface heights
+		Validation.BeginCase("instance surface slopes");
+		{
+			const SyntheticWaves::FSpectrum Spectrum = SyntheticWaves::MakeDefaultOcean(0.5f);
+			const FGerstnerSpectrumView View = Spectrum.GetView();
+			const float Time = 7.5f;
+			const float Step = 1.0f;
+			const int32_t NumSamples = 5 * NumPoses;
+
+			std::vector<float> X(NumSamples), Y(NumSamples), SurfaceX(NumSamples), SurfaceY(NumSamples), Heights(NumSamples), SampleBuffer(8 * NumSamples);
+			for (int32_t i = 0; i < NumPoses; ++i)
+			{
+				const float CenterX = RandomRange(-20000.0f, 20000.0f);
+				const float CenterY = RandomRange(-20000.0f, 20000.0f);
+				const float OffsetsX[] = { 0.0f, Step, -Step, 0.0f, 0.0f };
+				const float OffsetsY[] = { 0.0f, 0.0f, 0.0f, Step, -Step };
+
+				for (int32_t j = 0; j < 5; ++j)
+				{
+					X[j * NumPoses + i] = CenterX + OffsetsX[j];
+					Y[j * NumPoses + i] = CenterY + OffsetsY[j];
+				}
+			}
+
+			FWaveSampleBuffers Samples;
+			Samples.DisplacementX = SampleBuffer.data();
+			Samples.DisplacementY = Samples.DisplacementX + NumSamples;
+			Samples.DisplacementZ = Samples.DisplacementY + NumSamples;
+			Samples.SlopeXX = Samples.DisplacementZ + NumSamples;
+			Samples.SlopeXY = Samples.SlopeXX + NumSamples;
+			Samples.SlopeYY = Samples.SlopeXY + NumSamples;
+			Samples.SlopeZX = Samples.SlopeYY + NumSamples;
+			Samples.SlopeZY = Samples.SlopeZX + NumSamples;
+
+			auto Evaluate = [&View, Time](const float* InX, const float* InY, int32_t Num, const FWaveSampleBuffers& Out)
+			{
+				EvaluateGerstner(View, InX, InY, Num, Time, Out, View.NumComponents);
+			};
+
+			SampleSurfaceHeights(Evaluate, X.data(), Y.data(), NumSamples, 4, SurfaceX.data(), SurfaceY.data(), Samples, Heights.data());
+
+			std::vector<float> SlopeX(NumSamples), SlopeY(NumSamples);
+			Validation.Timed(NumSamples, [&]()
+			{
+				ComputeSurfaceSlopes(Samples, NumSamples, SlopeX.data(), SlopeY.data());
+				return SlopeX[0];
+			});
+
+			for (int32_t i = 0; i < NumPoses; ++i)
+			{
+				FAnalyticResult Expected;
+				Expected.Volume = 1.0;
+				Expected.Centroid[0] = (Heights[NumPoses + i] - Heights[2 * NumPoses + i]) / (2.0 * Step);
+				Expected.Centroid[1] = (Heights[3 * NumPoses + i] - Heights[4 * NumPoses + i]) / (2.0 * Step);
+				Expected.Centroid[2] = 0.0;
+
+				// Volume of check is unused, slopes are dimensionless so errors are absolute
+				Validation.Check(1.0f, FVec3(SlopeX[i], SlopeY[i], 0.0f), Expected, 1.0, 1.0, 0.0, 1e-2);
+			}
+		}
+	}
+}
+
+int RunValidation()
+{
+	FValidation Validation;
+
+	ValidateBox(Validation);
+	ValidateTiltedCube(Validation);
+	ValidateSphere(Validation);
+	ValidateDegenerateTriangles(Validation);
+	ValidateRotated90(Validation, false);
+	ValidateRotated90(Validation, true);
+	ValidateWaveSurface(Validation);
+	ValidateBroadPhase(Validation);
+	ValidateHeldSpring(Validation);
+	ValidatePlaneFit(Validation);
+	ValidateClippingPoints(Validation);
+	ValidateIncrementalVolume(Validation);
+	ValidateHullSimplifier(Validation);
+	ValidateSections(Validation);
+	ValidateSurfaceHeight(Validation);
+	ValidateWaterVelocity(Validation);
+	ValidateAgainstReference(Validation);
+	ValidateFixedStep(Validation);
+	ValidatePressure(Validation);
+	ValidateInstances(Validation);
+
+	return Validation.Report();
+}
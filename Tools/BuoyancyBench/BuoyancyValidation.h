@@ -0,0 +1,9 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+/* Accuracy suite of buoyancy core: submerged volume and centroid are compared with analytic results
+ * and with frozen reference implementation, every case also records its time per call.
+ * Returns number of failed cases, cases marked as known issues are reported but don't fail.
+ */
+int RunValidation();
@@ -0,0 +1,251 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include "BuoyancyCore/BuoyancyCore.h"
+
+/* Frozen copy of original submerged volume calculation and plane fit (as they were in UBuoyancyHelper).
+ * Optimized kernels in BuoyancyCore are validated against it, so don't change it.
+ */
+namespace ReferenceBuoyancy
+{
+	using BuoyancyCore::FVec3;
+	using BuoyancyCore::FMeshView;
+	using BuoyancyCore::FMat3;
+	using BuoyancyCore::FWaterPlane;
+
+	inline float ComputeTetrahedronVolume(FVec3& Center, const FVec3& Point, const FVec3& Vertex1, const FVec3& Vertex2, const FVec3& Vertex3)
+	{
+		const FVec3 A = Vertex2 - Vertex1;
+		const FVec3 B = Vertex3 - Vertex1;
+		const FVec3 R = Point - Vertex1;
+
+		const float Volume = (1.0f / 6.0f) * FVec3::Dot(FVec3::Cross(B, A), R);
+
+		Center += (0.25f * Volume) * (Vertex1 + Vertex2 + Vertex3 + Point);
+
+		return Volume;
+	}
+
+	inline float ClipTriangle(FVec3& Center, const FVec3& Point, const FVec3& Vertex1, const FVec3& Vertex2, const FVec3& Vertex3, float Depth1, float Depth2, float Depth3)
+	{
+		float Volume = 0.0f;
+		const FVec3 Vc1 = Vertex1 + (Depth1 / (Depth1 - Depth2)) * (Vertex2 - Vertex1);
+
+		if (Depth1 < 0.0f)
+		{
+			if (Depth3 < 0.0f)
+			{
+				const FVec3 Vc2 = Vertex2 + (Depth2 / (Depth2 - Depth3)) * (Vertex3 - Vertex2);
+
+				Volume += ReferenceBuoyancy::ComputeTetrahedronVolume(Center, Point, Vc1, Vc2, Vertex1);
+				Volume += ReferenceBuoyancy::ComputeTetrahedronVolume(Center, Point, Vc2, Vertex3, Vertex1);
+			}
+			else
+			{
+				const FVec3 Vc2 = Vertex1 + (Depth1 / (Depth1 - Depth3)) * (Vertex3 - Vertex1);
+
+				Volume += ReferenceBuoyancy::ComputeTetrahedronVolume(Center, Point, Vc1, Vc2, Vertex1);
+			}
+		}
+		else
+		{
+			if (Depth3 < 0.0f)
+			{
+				const FVec3 Vc2 = Vertex1 + (Depth1 / (Depth1 - Depth3)) * (Vertex3 - Vertex1);
+
+				Volume += ReferenceBuoyancy::ComputeTetrahedronVolume(Center, Point, Vc1, Vertex2, Vertex3);
+				Volume += ReferenceBuoyancy::ComputeTetrahedronVolume(Center, Point, Vc1, Vertex3, Vc2);
+			}
+			else
+			{
+				const FVec3 Vc2 = Vertex2 + (Depth2 / (Depth2 - Depth3)) * (Vertex3 - Vertex2);
+
+				Volume += ReferenceBuoyancy::ComputeTetrahedronVolume(Center, Point, Vc1, Vertex2, Vc2);
+			}
+		}
+
+		return Volume;
+	}
+
+	/* Same contract as BuoyancyCore::ComputeSubmergedVolume */
+	inline float ComputeSubmergedVolume(const FMeshView& Mesh, const FVec3& Normal, float Offset, float* Depths, FVec3& Centroid)
+	{
+		const float TINY_DEPTH = -1e-6f;
+
+		int32_t NumSubmerged = 0;
+		int32_t SampleVertex = 0;
+
+		for (int32_t i = 0; i < Mesh.NumVertices; ++i)
+		{
+			Depths[i] = FVec3::Dot(Normal, Mesh.GetVertex(i)) - Offset;
+
+			if (Depths[i] < TINY_DEPTH)
+			{
+				++NumSubmerged;
+				SampleVertex = i;
+			}
+		}
+
+		Centroid = FVec3();
+
+		if (NumSubmerged <= 0)
+		{
+			return 0.0f;
+		}
+
+		const FVec3 Point = Mesh.GetVertex(SampleVertex) - Depths[SampleVertex] * Normal;
+
+		float Volume = 0.0f;
+
+		for (int32_t TriIndex = 0; TriIndex < Mesh.NumTriangles; ++TriIndex)
+		{
+			const int32_t I0 = Mesh.Indices[(TriIndex * 3) + 0];
+			const int32_t I1 = Mesh.Indices[(TriIndex * 3) + 1];
+			const int32_t I2 = Mesh.Indices[(TriIndex * 3) + 2];
+
+			const FVec3 Vertex1 = Mesh.GetVertex(I0);
+			const FVec3 Vertex2 = Mesh.GetVertex(I1);
+			const FVec3 Vertex3 = Mesh.GetVertex(I2);
+
+			const float Depth1 = Depths[I0];
+			const float Depth2 = Depths[I1];
+			const float Depth3 = Depths[I2];
+
+			if (Depth1 * Depth2 < 0.0f)
+			{
+				Volume += ReferenceBuoyancy::ClipTriangle(Centroid, Point, Vertex1, Vertex2, Vertex3, Depth1, Depth2, Depth3);
+			}
+			else if (Depth1 * Depth3 < 0.0f)
+			{
+				Volume += ReferenceBuoyancy::ClipTriangle(Centroid, Point, Vertex3, Vertex1, Vertex2, Depth3, Depth1, Depth2);
+			}
+			else if (Depth2 * Depth3 < 0.0f)
+			{
+				Volume += ReferenceBuoyancy::ClipTriangle(Centroid, Point, Vertex2, Vertex3, Vertex1, Depth2, Depth3, Depth1);
+			}
+			else if (Depth1 < 0.0f || Depth2 < 0.0f || Depth3 < 0.0f)
+			{
+				Volume += ReferenceBuoyancy::ComputeTetrahedronVolume(Centroid, Point, Vertex1, Vertex2, Vertex3);
+			}
+		}
+
+		const float TINY_VOLUME = 1e-6f;
+		if (Volume <= TINY_VOLUME)
+		{
+			Centroid = FVec3();
+			return 0.0f;
+		}
+
+		Centroid *= 1.0f / Volume;
+
+		return Volume;
+	}
+
+	inline float FindLargestEntry(const FMat3& Matrix)
+	{
+		float LargestValue = 0.0f;
+
+		for (int32_t i = 0; i < 3; ++i)
+		{
+			for (int32_t j = 0; j < 3; ++j)
+			{
+				const float Entry = std::fabs(Matrix.M[i][j]);
+
+				LargestValue = (Entry > LargestValue) ? Entry : LargestValue;
+			}
+		}
+
+		return LargestValue;
+	}
+
+	/* Eigenvector of largest eigenvalue by power iteration */
+	inline FVec3 FindEigenVector(const FMat3& Matrix)
+	{
+		const float Scale = ReferenceBuoyancy::FindLargestEntry(Matrix);
+
+		FMat3 MatrixC = Matrix * (1.0f / Scale);
+
+		MatrixC = MatrixC * MatrixC;
+		MatrixC = MatrixC * MatrixC;
+		MatrixC = MatrixC * MatrixC;
+
+		FVec3 V = FVec3(1.0f, 1.0f, 1.0f);
+		FVec3 LastV = V;
+
+		for (int32_t i = 0; i < 100; ++i)
+		{
+			V = (MatrixC * V).GetSafeNormal();
+
+			if (FVec3::DistSquared(V, LastV) < 1e-16f)
+			{
+				break;
+			}
+
+			LastV = V;
+		}
+
+		return V;
+	}
+
+	/* Original plane fit: inverse of covariance and power iteration, default plane when determinant is zero.
+	 * Normal is not oriented, it may point down.
+	 */
+	inline FWaterPlane FitPlane(const FVec3* Points, int32_t NumPoints)
+	{
+		FWaterPlane Plane;
+
+		if (NumPoints <= 0)
+		{
+			return Plane;
+		}
+
+		// Find Plane Centroid
+		FVec3 Sum;
+		for (int32_t i = 0; i < NumPoints; ++i)
+		{
+			Sum += Points[i];
+		}
+
+		const FVec3 Centroid = Sum * (1.0f / NumPoints);
+
+		// Set Plane Location
+		Plane.Location = Centroid;
+
+		float SumXX = 0.0f, SumXY = 0.0f, SumXZ = 0.0f;
+		float SumYY = 0.0f, SumYZ = 0.0f;
+		float SumZZ = 0.0f;
+
+		// Find Plane Normal
+		for (int32_t i = 0; i < NumPoints; ++i)
+		{
+			const float DiffX = Points[i].X - Centroid.X;
+			const float DiffY = Points[i].Y - Centroid.Y;
+			const float DiffZ = Points[i].Z - Centroid.Z;
+
+			SumXX += DiffX * DiffX;
+			SumXY += DiffX * DiffY;
+			SumXZ += DiffX * DiffZ;
+
+			SumYY += DiffY * DiffY;
+			SumYZ += DiffY * DiffZ;
+
+			SumZZ += DiffZ * DiffZ;
+		}
+
+		const FMat3 Matrix = FMat3(FVec3(SumXX, SumXY, SumXZ),
+								   FVec3(SumXY, SumYY, SumYZ),
+								   FVec3(SumXZ, SumYZ, SumZZ));
+
+		if (Matrix.Determinant() == 0.0f)
+		{
+			// @TODO: Implement Matrix GetNullSpace
+			return Plane;
+		}
+
+		// Smallest eigenvalue of covariance is largest of its inverse
+		Plane.Normal = ReferenceBuoyancy::FindEigenVector(Matrix.Inverse());
+
+		return Plane;
+	}
+}
@@ -0,0 +1,409 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "BuoyancyCore/BuoyancySession.h"
+#include "SyntheticHulls.h"
+#include "SyntheticWaves.h"
+
+/* Reading, recording and replaying fixed step sessions outside of engine, see BuoyancyCore/BuoyancySession.h */
+namespace SessionReplay
+{
+	using namespace BuoyancyCore;
+
+	/* Archive writing into memory, same Serialize as FArchive so core session writers work with it */
+	struct FMemoryWriter
+	{
+		std::vector<uint8_t> Bytes;
+
+		void Serialize(void* Data, int64_t Size)
+		{
+			const uint8_t* Begin = static_cast<const uint8_t*>(Data);
+			Bytes.insert(Bytes.end(), Begin, Begin + Size);
+		}
+	};
+
+	struct FSessionBodyData
+	{
+		FFixedStepBody Body;
+		std::vector<FFixedStepHull> Hulls;
+		std::vector<SyntheticHulls::FHullMesh> Meshes;
+	};
+
+	struct FSession
+	{
+		int32_t StepsPerSecond;
+		SyntheticWaves::FSpectrum Waves;
+		std::vector<FSessionBodyData> Bodies;
+		std::vector<FSessionRecord> Records;
+
+		FSession()
+			: StepsPerSecond(0)
+		{
+		}
+
+		/* Point hulls to meshes, call after bodies stop moving in memory */
+		void FixPointers()
+		{
+			for (FSessionBodyData& Data : Bodies)
+			{
+				for (size_t h = 0; h < Data.Hulls.size(); ++h)
+				{
+					Data.Hulls[h].Mesh = Data.Meshes[h].GetView();
+				}
+				Data.Body.Hulls = Data.Hulls.data();
+				Data.Body.NumHulls = static_cast<int32_t>(Data.Hulls.size());
+			}
+		}
+	};
+
+	class FMemoryReader
+	{
+	public:
+
+		FMemoryReader(const std::vector<uint8_t>& InBytes)
+			: Bytes(InBytes), Offset(0), bError(false)
+		{
+		}
+
+		template <typename DataType>
+		void Read(DataType* Data, int64_t Num)
+		{
+			const size_t Size = static_cast<size_t>(sizeof(DataType) * Num);
+			if (bError || Num < 0 || Offset + Size > Bytes.size())
+			{
+				bError = true;
+				return;
+			}
+
+			std::memcpy(Data, Bytes.data() + Offset, Size);
+			Offset += Size;
+		}
+
+		template <typename DataType>
+		void Read(std::vector<DataType>& Array, int32_t Num)
+		{
+			Array.resize(std::max(Num, 0));
+			Read(Array.data(), Num);
+		}
+
+		bool AtEnd() const { return Offset >= Bytes.size(); }
+		bool HasError() const { return bError; }
+
+	private:
+
+		const std::vector<uint8_t>& Bytes;
+		size_t Offset;
+		bool bError;
+	};
+
+	inline bool ReadSession(const std::vector<uint8_t>& Bytes, FSession& Session)
+	{
+		FMemoryReader Reader(Bytes);
+
+		FSessionHeader Header;
+		Reader.Read(&Header, 1);
+		if (Reader.HasError() || Header.Magic != SessionMagic || Header.Version != SessionVersion || Header.StepsPerSecond <= 0)
+		{
+			return false;
+		}
+
+		Session.StepsPerSecond = Header.StepsPerSecond;
+
+		SyntheticWaves::FSpectrum& Waves = Session.Waves;
+		std::vector<float>* Arrays[] = { &Waves.WaveVectorX, &Waves.WaveVectorY, &Waves.AngularFrequency, &Waves.Phase, &Waves.DisplacementScaleX, &Waves.DisplacementScaleY, &Waves.Amplitude };
+		for (std::vector<float>* Array : Arrays)
+		{
+			Reader.Read(*Array, Header.NumComponents);
+		}
+
+		Session.Bodies.resize(std::max(Header.NumBodies, 0));
+		for (FSessionBodyData& Data : Session.Bodies)
+		{
+			FSessionBody SessionBody;
+			Reader.Read(&SessionBody, 1);
+			if (Reader.HasError() || SessionBody.NumHulls <= 0)
+			{
+				return false;
+			}
+
+			Data.Body.Water = SessionBody.Water;
+			Data.Body.LocalCenterOfMass = SessionBody.LocalCenterOfMass;
+			Data.Body.LocalInertia = SessionBody.LocalInertia;
+			Data.Body.LinearDamping = SessionBody.LinearDamping;
+			Data.Body.AngularDamping = SessionBody.AngularDamping;
+			Data.Body.MaxAngularVelocity = SessionBody.MaxAngularVelocity;
+			Data.Body.SurfaceIterations = SessionBody.SurfaceIterations;
+
+			Data.Hulls.resize(SessionBody.NumHulls);
+			Data.Meshes.resize(SessionBody.NumHulls);
+			for (int32_t h = 0; h < SessionBody.NumHulls; ++h)
+			{
+				FSessionHull SessionHull;
+				Reader.Read(&SessionHull, 1);
+				if (Reader.HasError())
+				{
+					return false;
+				}
+
+				Data.Hulls[h].Body = SessionHull.Body;
+				Data.Hulls[h].MassFraction = SessionHull.MassFraction;
+
+				SyntheticHulls::FHullMesh& Mesh = Data.Meshes[h];
+				Reader.Read(Mesh.VertexX, SessionHull.NumVertices);
+				Reader.Read(Mesh.VertexY, SessionHull.NumVertices);
+				Reader.Read(Mesh.VertexZ, SessionHull.NumVertices);
+				Reader.Read(Mesh.Indices, SessionHull.NumTriangles * 3);
+			}
+		}
+
+		while (!Reader.AtEnd() && !Reader.HasError())
+		{
+			FSessionRecord Record;
+			Reader.Read(&Record, 1);
+
+			if (!Reader.HasError() && Record.Body >= 0 && Record.Body < Header.NumBodies)
+			{
+				Session.Records.push_back(Record);
+			}
+		}
+
+		Session.FixPointers();
+
+		return !Reader.HasError() || Session.Records.size() > 0;
+	}
+
+	inline bool LoadSession(const char* FileName, FSession& Session)
+	{
+		FILE* File = std::fopen(FileName, "rb");
+		if (!File)
+		{
+			return false;
+		}
+
+		std::vector<uint8_t> Bytes;
+		uint8_t Buffer[65536];
+		size_t Read;
+		while ((Read = std::fread(Buffer, 1, sizeof(Buffer), File)) > 0)
+		{
+			Bytes.insert(Bytes.end(), Buffer, Buffer + Read);
+		}
+		std::fclose(File);
+
+		return ReadSession(Bytes, Session);
+	}
+
+	/* Session like server with fixed step bodies would record: box, capsule and ship dropped on default ocean.
+	 * Bodies are simulated by the same StepBody as AActorBuoyant and written by the same core writers as FBuoyancyRecorder.
+	 */
+	inline std::vector<uint8_t> RecordSyntheticSession(float Seconds, int32_t StepsPerSecond)
+	{
+		const SyntheticWaves::FSpectrum Waves = SyntheticWaves::MakeDefaultOcean(0.5f);
+
+		FSession Session;
+		Session.StepsPerSecond = StepsPerSecond;
+
+		struct FSyntheticBody
+		{
+			SyntheticHulls::FHullMesh Mesh;
+			FVec3 Size;
+			float Density;
+			FVec3 Location;
+		};
+
+		const FSyntheticBody Synthetic[] =
+		{
+			{ SyntheticHulls::MakeBox(FVec3(100.0f, 50.0f, 25.0f), 2), FVec3(200.0f, 100.0f, 50.0f), 500.0f, FVec3(0.0f, 0.0f, 150.0f) },
+			{ SyntheticHulls::MakeCapsule(50.0f, 100.0f, 200), FVec3(300.0f, 100.0f, 100.0f), 300.0f, FVec3(1500.0f, 700.0f, 200.0f) },
+			{ SyntheticHulls::MakeShip(1200.0f, 300.0f, 150.0f, 500), FVec3(1200.0f, 300.0f, 300.0f), 400.0f, FVec3(-2000.0f, 1500.0f, 100.0f) },
+		};
+
+		for (const FSyntheticBody& Source : Synthetic)
+		{
+			FSessionBodyData Data;
+			Data.Meshes.push_back(Source.Mesh);
+
+			// Hulls of fixed step body have origin at center of mass, like sections of AActorBuoyant
+			FVec3 Centroid;
+			FFixedStepHull Hull;
+			Hull.Body = FBodyParams(ComputeVolume(Source.Mesh.GetView(), Centroid), Source.Density, Source.Size.X);
+			Data.Body.LocalCenterOfMass = Centroid;
+
+			SyntheticHulls::FHullMesh& Mesh = Data.Meshes.back();
+			for (size_t i = 0; i < Mesh.VertexX.size(); ++i)
+			{
+				Mesh.VertexX[i] -= Centroid.X;
+				Mesh.VertexY[i] -= Centroid.Y;
+				Mesh.VertexZ[i] -= Centroid.Z;
+			}
+
+			Data.Hulls.push_back(Hull);
+
+			// Mass relative to displaced water like density of body relative to 1000
+			const float Mass = FWaterParams().Density * Hull.Body.BodyVolume * Source.Density / 1000.0f;
+			Data.Body.LocalInertia = ComputeBoxInertia(Mass, Source.Size);
+
+			Session.Bodies.push_back(Data);
+		}
+		Session.FixPointers();
+
+		FMemoryWriter Writer;
+		WriteSessionHeader(Writer, Waves.GetView(), StepsPerSecond, static_cast<int32_t>(Session.Bodies.size()));
+
+		for (const FSessionBodyData& Data : Session.Bodies)
+		{
+			WriteSessionBody(Writer, Data.Body);
+		}
+
+		std::vector<FBodyState> States(Session.Bodies.size());
+		for (size_t b = 0; b < States.size(); ++b)
+		{
+			const FFixedStepHull& Hull = Session.Bodies[b].Hulls[0];
+			FBodyState& State = States[b];
+			State.Location = Synthetic[b].Location;
+			State.Rotation = FQuat::FromAxisAngle(FVec3(0.0f, 0.0f, 1.0f), 0.7f * b) * FQuat::FromAxisAngle(FVec3(1.0f, 0.0f, 0.0f), 0.2f);
+			State.CenterOfMass = State.Location + State.Rotation.RotateVector(Session.Bodies[b].Body.LocalCenterOfMass);
+			State.Mass = FWaterParams().Density * Hull.Body.BodyVolume * Hull.Body.DensityOfBody / 1000.0f;
+
+			WriteSessionRecord(Writer, ESessionRecord::Reset, static_cast<int32_t>(b), 0, State);
+		}
+
+		std::vector<float> ScratchBuffer;
+		const int32_t NumSteps = static_cast<int32_t>(Seconds * StepsPerSecond);
+
+		for (int32_t Step = 0; Step < NumSteps; ++Step)
+		{
+			for (size_t b = 0; b < States.size(); ++b)
+			{
+				const FFixedStepBody& Body = Session.Bodies[b].Body;
+				ScratchBuffer.resize(FFixedStepScratch::FloatsPerVertex * Body.GetMaxVertices());
+
+				StepBody(Waves.GetView(), Body, Step, StepsPerSecond, FFixedStepScratch::FromBuffer(ScratchBuffer.data(), Body.GetMaxVertices()), States[b]);
+				WriteSessionRecord(Writer, ESessionRecord::Step, static_cast<int32_t>(b), Step + 1, States[b]);
+			}
+		}
+
+		return Writer.Bytes;
+	}
+
+	/* Divergence of replayed body from recorded one */
+	struct FBodyReplay
+	{
+		int32_t NumSteps;
+		int32_t NumResets;
+		int32_t FirstStep;
+		int32_t LastStep;
+
+		/* Largest distance of replayed origin from recorded one (cm) and angle between rotations (degrees) */
+		double MaxPositionError;
+		double MaxRotationError;
+
+		/* Steps from first state until replay was further than tolerance from recording, -1 if it never was */
+		int32_t StepsWithinTolerance;
+
+		/* Time spent simulating */
+		double TotalNs;
+
+		FBodyReplay()
+			: NumSteps(0), NumResets(0), FirstStep(0), LastStep(0), MaxPositionError(0.0), MaxRotationError(0.0), StepsWithinTolerance(-1), TotalNs(0.0)
+		{
+		}
+	};
+
+	/* Angle between rotations in degrees, through atan2 of relative rotation so equal rotations of not exactly unit size give 0 */
+	inline double GetRotationError(const FQuat& A, const FQuat& B)
+	{
+		const double AX = A.X, AY = A.Y, AZ = A.Z, AW = A.W;
+
+		// Products of floats are exact in double, terms are paired so they cancel exactly for equal rotations
+		const double W = AW * B.W + AX * B.X + AY * B.Y + AZ * B.Z;
+		const double X = (AW * B.X - AX * B.W) + (AZ * B.Y - AY * B.Z);
+		const double Y = (AW * B.Y - AY * B.W) + (AX * B.Z - AZ * B.X);
+		const double Z = (AW * B.Z - AZ * B.W) + (AY * B.X - AX * B.Y);
+
+		return 2.0 * std::atan2(std::sqrt(X * X + Y * Y + Z * Z), std::fabs(W)) * 180.0 / 3.14159265358979;
+	}
+
+	/* Simulate every body again from its recorded resets and compare with every recorded step.
+	 * Resets are applied like client applies corrections, so replay of client recording must match it exactly too.
+	 *	@param bPerturb				Move first state of every body by one float ulp, like different rounding on other machine would
+	 *	@param Tolerance			Position error (cm) for StepsWithinTolerance
+	 */
+	inline std::vector<FBodyReplay> ReplaySession(const FSession& Session, bool bPerturb, double Tolerance)
+	{
+		const FGerstnerSpectrumView Waves = Session.Waves.GetView();
+
+		std::vector<FBodyReplay> Results(Session.Bodies.size());
+		std::vector<FBodyState> States(Session.Bodies.size());
+		std::vector<int32_t> Steps(Session.Bodies.size(), 0);
+		std::vector<bool> bStarted(Session.Bodies.size(), false);
+		std::vector<float> ScratchBuffer;
+
+		for (const FSessionRecord& Record : Session.Records)
+		{
+			FBodyReplay& Result = Results[Record.Body];
+			FBodyState& State = States[Record.Body];
+			int32_t& Step = Steps[Record.Body];
+
+			if (Record.Type == ESessionRecord::Reset)
+			{
+				State = Record.State;
+				Step = Record.Step;
+				++Result.NumResets;
+
+				if (!bStarted[Record.Body])
+				{
+					bStarted[Record.Body] = true;
+					Result.FirstStep = Record.Step;
+
+					if (bPerturb)
+					{
+						State.CenterOfMass.X = std::nextafter(State.CenterOfMass.X, 1e30f);
+					}
+				}
+				continue;
+			}
+
+			if (!bStarted[Record.Body])
+			{
+				continue;
+			}
+
+			const FFixedStepBody& Body = Session.Bodies[Record.Body].Body;
+			ScratchBuffer.resize(FFixedStepScratch::FloatsPerVertex * Body.GetMaxVertices());
+			const FFixedStepScratch Scratch = FFixedStepScratch::FromBuffer(ScratchBuffer.data(), Body.GetMaxVertices());
+
+			const auto Start = std::chrono::steady_clock::now();
+			for (; Step < Record.Step; ++Step)
+			{
+				StepBody(Waves, Body, Step, Session.StepsPerSecond, Scratch, State);
+				++Result.NumSteps;
+			}
+			const auto End = std::chrono::steady_clock::now();
+			Result.TotalNs += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(End - Start).count());
+
+			Result.LastStep = Record.Step;
+
+			const FVec3 Offset = State.Location - Record.State.Location;
+			const double PositionError = std::sqrt(static_cast<double>(Offset.X) * Offset.X + static_cast<double>(Offset.Y) * Offset.Y + static_cast<double>(Offset.Z) * Offset.Z);
+
+			Result.MaxPositionError = std::max(Result.MaxPositionError, PositionError);
+			Result.MaxRotationError = std::max(Result.MaxRotationError, GetRotationError(State.Rotation, Record.State.Rotation));
+
+			if (PositionError > Tolerance && Result.StepsWithinTolerance < 0)
+			{
+				Result.StepsWithinTolerance = Record.Step - Result.FirstStep;
+			}
+		}
+
+		return Results;
+	}
+}
@@ -0,0 +1,255 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "BuoyancyCore/BuoyancyCore.h"
+
+/* Synthetic closed hulls for measuring buoyancy core outside of engine. All sizes are in cm. */
+namespace SyntheticHulls
+{
+	using BuoyancyCore::FVec3;
+
+	struct FHullMesh
+	{
+		std::vector<float> VertexX;
+		std::vector<float> VertexY;
+		std::vector<float> VertexZ;
+		std::vector<int32_t> Indices;
+
+		int32_t AddVertex(const FVec3& Vertex)
+		{
+			VertexX.push_back(Vertex.X);
+			VertexY.push_back(Vertex.Y);
+			VertexZ.push_back(Vertex.Z);
+			return static_cast<int32_t>(VertexX.size()) - 1;
+		}
+
+		void AddTriangle(int32_t I0, int32_t I1, int32_t I2)
+		{
+			Indices.push_back(I0);
+			Indices.push_back(I1);
+			Indices.push_back(I2);
+		}
+
+		int32_t NumTriangles() const
+		{
+			return static_cast<int32_t>(Indices.size() / 3);
+		}
+
+		BuoyancyCore::FMeshView GetView() const
+		{
+			BuoyancyCore::FMeshView View;
+			View.VertexX = VertexX.data();
+			View.VertexY = VertexY.data();
+			View.VertexZ = VertexZ.data();
+			View.Indices = Indices.data();
+			View.NumVertices = static_cast<int32_t>(VertexX.size());
+			View.NumTriangles = NumTriangles();
+			return View;
+		}
+
+		/* Make sure triangles wind so that volume comes out positive */
+		void FixWinding()
+		{
+			FVec3 Centroid;
+			if (BuoyancyCore::ComputeVolume(GetView(), Centroid) < 0.0f)
+			{
+				for (size_t i = 0; i < Indices.size(); i += 3)
+				{
+					const int32_t Temp = Indices[i + 1];
+					Indices[i + 1] = Indices[i + 2];
+					Indices[i + 2] = Temp;
+				}
+			}
+		}
+	};
+
+	/* Box centered at origin, every face split into Subdivisions^2 quads */
+	inline FHullMesh MakeBox(const FVec3& Extent, int32_t Subdivisions)
+	{
+		FHullMesh Mesh;
+		const int32_t N = Subdivisions < 1 ? 1 : Subdivisions;
+
+		for (int32_t Axis = 0; Axis < 3; ++Axis)
+		{
+			for (int32_t Side = -1; Side <= 1; Side += 2)
+			{
+				const int32_t U = (Axis + 1) % 3;
+				const int32_t V = (Axis + 2) % 3;
+				const int32_t FirstVertex = static_cast<int32_t>(Mesh.VertexX.size());
+
+				for (int32_t i = 0; i <= N; ++i)
+				{
+					for (int32_t j = 0; j <= N; ++j)
+					{
+						FVec3 Vertex;
+						Vertex[Axis] = Side * Extent[Axis];
+						Vertex[U] = (-1.0f + 2.0f * i / N) * Extent[U];
+						Vertex[V] = (-1.0f + 2.0f * j / N) * Extent[V];
+						Mesh.AddVertex(Vertex);
+					}
+				}
+
+				for (int32_t i = 0; i < N; ++i)
+				{
+					for (int32_t j = 0; j < N; ++j)
+					{
+						const int32_t I00 = FirstVertex + i * (N + 1) + j;
+						const int32_t I10 = I00 + (N + 1);
+						const int32_t I01 = I00 + 1;
+						const int32_t I11 = I10 + 1;
+
+						// Keep faces wound the same way on both sides
+						if (Side > 0)
+						{
+							Mesh.AddTriangle(I00, I10, I11);
+							Mesh.AddTriangle(I00, I11, I01);
+						}
+						else
+						{
+							Mesh.AddTriangle(I00, I11, I10);
+							Mesh.AddTriangle(I00, I01, I11);
+						}
+					}
+				}
+			}
+		}
+
+		Mesh.FixWinding();
+		return Mesh;
+	}
+
+	/* Closed surface of revolution around X axis from profile of (X, Radius) pairs, first and last radius must be 0.
+	 * Cross section is scaled by ScaleY / ScaleZ and cut flat at DeckZ.
+	 */
+	inline FHullMesh MakeRevolution(const std::vector<float>& ProfileX, const std::vector<float>& ProfileRadius, int32_t Segments, float ScaleY, float ScaleZ, float DeckZ)
+	{
+		const float TwoPi = 6.28318530718f;
+
+		FHullMesh Mesh;
+		const int32_t NumProfile = static_cast<int32_t>(ProfileX.size());
+
+		const int32_t FirstPole = Mesh.AddVertex(FVec3(ProfileX[0], 0.0f, 0.0f));
+
+		for (int32_t p = 1; p < NumProfile - 1; ++p)
+		{
+			for (int32_t s = 0; s < Segments; ++s)
+			{
+				const float Angle = TwoPi * s / Segments;
+				const float Z = ProfileRadius[p] * std::sin(Angle) * ScaleZ;
+				Mesh.AddVertex(FVec3(ProfileX[p], ProfileRadius[p] * std::cos(Angle) * ScaleY, Z < DeckZ ? Z : DeckZ));
+			}
+		}
+
+		const int32_t LastPole = Mesh.AddVertex(FVec3(ProfileX[NumProfile - 1], 0.0f, 0.0f));
+		const int32_t NumRings = NumProfile - 2;
+
+		for (int32_t s = 0; s < Segments; ++s)
+		{
+			const int32_t Next = (s + 1) % Segments;
+
+			Mesh.AddTriangle(FirstPole, 1 + Next, 1 + s);
+
+			for (int32_t r = 0; r + 1 < NumRings; ++r)
+			{
+				const int32_t A = 1 + r * Segments + s;
+				const int32_t B = 1 + r * Segments + Next;
+				const int32_t C = 1 + (r + 1) * Segments + s;
+				const int32_t D = 1 + (r + 1) * Segments + Next;
+
+				Mesh.AddTriangle(A, B, D);
+				Mesh.AddTriangle(A, D, C);
+			}
+
+			Mesh.AddTriangle(LastPole, 1 + (NumRings - 1) * Segments + s, 1 + (NumRings - 1) * Segments + Next);
+		}
+
+		Mesh.FixWinding();
+		return Mesh;
+	}
+
+	/* Segments and rings of surface of revolution with roughly TargetTriangles triangles */
+	inline void GetRevolutionResolution(int32_t TargetTriangles, int32_t& OutSegments, int32_t& OutRings)
+	{
+		OutSegments = static_cast<int32_t>(std::sqrt(static_cast<float>(TargetTriangles)));
+		OutSegments = OutSegments < 6 ? 6 : OutSegments;
+		OutRings = TargetTriangles / (2 * OutSegments);
+		OutRings = OutRings < 2 ? 2 : OutRings;
+	}
+
+	/* Sphere centered at origin */
+	inline FHullMesh MakeSphere(float Radius, int32_t TargetTriangles)
+	{
+		const float Pi = 3.14159265359f;
+
+		int32_t Segments, Rings;
+		GetRevolutionResolution(TargetTriangles, Segments, Rings);
+
+		std::vector<float> ProfileX;
+		std::vector<float> ProfileRadius;
+
+		for (int32_t i = 0; i <= Rings + 1; ++i)
+		{
+			const float Angle = Pi * i / (Rings + 1);
+			ProfileX.push_back(-Radius * std::cos(Angle));
+			ProfileRadius.push_back(i == 0 || i == Rings + 1 ? 0.0f : Radius * std::sin(Angle));
+		}
+
+		return MakeRevolution(ProfileX, ProfileRadius, Segments, 1.0f, 1.0f, Radius);
+	}
+
+	/* Capsule along X axis */
+	inline FHullMesh MakeCapsule(float Radius, float HalfLength, int32_t TargetTriangles)
+	{
+		const float HalfPi = 1.57079632679f;
+
+		int32_t Segments, Rings;
+		GetRevolutionResolution(TargetTriangles, Segments, Rings);
+
+		// Half of rings per hemisphere, cylinder is the band between them
+		const int32_t CapRings = Rings / 2 < 1 ? 1 : Rings / 2;
+
+		std::vector<float> ProfileX;
+		std::vector<float> ProfileRadius;
+
+		for (int32_t i = 0; i <= CapRings; ++i)
+		{
+			const float Angle = HalfPi * i / CapRings;
+			ProfileX.push_back(-HalfLength - Radius * std::cos(Angle));
+			ProfileRadius.push_back(Radius * std::sin(Angle));
+		}
+
+		for (int32_t i = CapRings; i >= 0; --i)
+		{
+			const float Angle = HalfPi * i / CapRings;
+			ProfileX.push_back(HalfLength + Radius * std::cos(Angle));
+			ProfileRadius.push_back(Radius * std::sin(Angle));
+		}
+
+		return MakeRevolution(ProfileX, ProfileRadius, Segments, 1.0f, 1.0f, Radius);
+	}
+
+	/* Ship-like hull along X axis: fine bow and stern, flat deck above waterline */
+	inline FHullMesh MakeShip(float Length, float Beam, float Draft, int32_t TargetTriangles)
+	{
+		int32_t Segments, Rings;
+		GetRevolutionResolution(TargetTriangles, Segments, Rings);
+
+		std::vector<float> ProfileX;
+		std::vector<float> ProfileRadius;
+
+		for (int32_t i = 0; i <= Rings + 1; ++i)
+		{
+			const float T = -1.0f + 2.0f * i / (Rings + 1);
+			const float Fullness = 1.0f - T * T;
+			ProfileX.push_back(0.5f * Length * T);
+			ProfileRadius.push_back(Fullness > 0.0f ? std::sqrt(Fullness) : 0.0f);
+		}
+
+		return MakeRevolution(ProfileX, ProfileRadius, Segments, 0.5f * Beam, Draft, 0.4f * Draft);
+	}
+}
@@ -0,0 +1,130 @@
+// Implementation created by David 'vebski' Niemiec
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "BuoyancyCore/GerstnerWaves.h"
+
+/* Gerstner spectrum built the same way as AOceanManager::UpdateWaveSpectrum, for measuring wave queries outside of engine */
+namespace SyntheticWaves
+{
+	struct FSpectrum
+	{
+		std::vector<float> WaveVectorX;
+		std::vector<float> WaveVectorY;
+		std::vector<float> AngularFrequency;
+		std::vector<float> Phase;
+		std::vector<float> DisplacementScaleX;
+		std::vector<float> DisplacementScaleY;
+		std::vector<float> Amplitude;
+
+		/* Same as FWaveSpectrum::AddComponent */
+		void AddComponent(float WaveLength, float ComponentAmplitude, float DirectionX, float DirectionY, float Angle, float Steepness, float Frequency, float Weight)
+		{
+			const float Lambda = (2.0f * 3.14159265f) / WaveLength;
+
+			// Angle is in turns, like rotation by Angle * 360 degrees in engine
+			const float Radians = Angle * 2.0f * 3.14159265f;
+			const float DirX = DirectionX * std::cos(Radians) - DirectionY * std::sin(Radians);
+			const float DirY = DirectionX * std::sin(Radians) + DirectionY * std::cos(Radians);
+
+			const float WeightedAmplitude = ComponentAmplitude * Weight;
+			const float QA = Steepness * WeightedAmplitude;
+
+			WaveVectorX.push_back(Lambda * DirX);
+			WaveVectorY.push_back(Lambda * DirY);
+			AngularFrequency.push_back(Frequency);
+			Phase.push_back(0.0f);
+			DisplacementScaleX.push_back(QA * DirX);
+			DisplacementScaleY.push_back(QA * DirY);
+			Amplitude.push_back(WeightedAmplitude);
+		}
+
+		/* Largest amplitude first, like FWaveSpectrum::SortByAmplitude */
+		void SortByAmplitude()
+		{
+			std::vector<int32_t> Order(Amplitude.size());
+			std::iota(Order.begin(), Order.end(), 0);
+			std::stable_sort(Order.begin(), Order.end(), [this](int32_t A, int32_t B) { return std::fabs(Amplitude[A]) > std::fabs(Amplitude[B]); });
+
+			Permute(WaveVectorX, Order);
+			Permute(WaveVectorY, Order);
+			Permute(AngularFrequency, Order);
+			Permute(Phase, Order);
+			Permute(DisplacementScaleX, Order);
+			Permute(DisplacementScaleY, Order);
+			Permute(Amplitude, Order);
+		}
+
+		int32_t Num() const
+		{
+			return static_cast<int32_t>(Amplitude.size());
+		}
+
+		/* Sum of Steepness * Amplitude * WaveNumber, fixed point height inversion converges when it is below 1 */
+		float GetHorizontalSlope() const
+		{
+			float Sum = 0.0f;
+			for (int32_t i = 0; i < Num(); ++i)
+			{
+				Sum += std::sqrt(DisplacementScaleX[i] * DisplacementScaleX[i] + DisplacementScaleY[i] * DisplacementScaleY[i])
+					* std::sqrt(WaveVectorX[i] * WaveVectorX[i] + WaveVectorY[i] * WaveVectorY[i]);
+			}
+			return Sum;
+		}
+
+		BuoyancyCore::FGerstnerSpectrumView GetView() const
+		{
+			BuoyancyCore::FGerstnerSpectrumView View;
+			View.WaveVectorX = WaveVectorX.data();
+			View.WaveVectorY = WaveVectorY.data();
+			View.AngularFrequency = AngularFrequency.data();
+			View.Phase = Phase.data();
+			View.DisplacementScaleX = DisplacementScaleX.data();
+			View.DisplacementScaleY = DisplacementScaleY.data();
+			View.Amplitude = Amplitude.data();
+			View.NumComponents = Num();
+			return View;
+		}
+
+	private:
+
+		static void Permute(std::vector<float>& Array, const std::vector<int32_t>& Order)
+		{
+			const std::vector<float> OldArray = Array;
+			for (size_t i = 0; i < Order.size(); ++i)
+			{
+				Array[i] = OldArray[Order[i]];
+			}
+		}
+	};
+
+	/* Default ocean of AOceanManager: two clusters of 8 waves, all with the same steepness */
+	inline FSpectrum MakeDefaultOcean(float Steepness)
+	{
+		static const float Multipliers[] = { 1.0f, 0.5f, 2.0f, 1.25f, 0.75f, 1.5f, 0.825f, 0.65f };
+		static const float Angles[] = { 0.0f, -0.1f, 0.1f, 0.05f, 0.075f, -0.125f, 0.063f, -0.11f };
+
+		const float ClusterWaveLengths[] = { 2500.0f, 1000.0f };
+		const float ClusterAmplitudes[] = { 200.0f, 115.0f };
+
+		const float Weight = 1.0f / (8 * 2);
+
+		FSpectrum Spectrum;
+		for (int32_t c = 0; c < 2; ++c)
+		{
+			for (int32_t i = 0; i < 8; ++i)
+			{
+				Spectrum.AddComponent(ClusterWaveLengths[c] * Multipliers[i], ClusterAmplitudes[c] * Multipliers[i], 0.0f, 1.0f, Angles[i], Steepness, 1.0f, Weight);
+			}
+		}
+
+		Spectrum.SortByAmplitude();
+		return Spectrum;
+	}
+}